@@ -21,6 +21,9 @@
 //
 // NOTE: Statistics *must* be declared as global variables.
 //
+// Tools that run many compilations in one process can read the values with
+// GetStatistics() and clear them with ResetStatistics() between runs.
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef LLVM_ADT_STATISTIC_H
@@ -28,84 +31,99 @@
 
 #include "llvm/Support/Atomic.h"
 #include "llvm/Support/Valgrind.h"
+#include <vector>
 
 namespace llvm {
 class raw_ostream;
 
+/// Statistic - A counter that is shown in the -stats report.  Once registered,
+/// a statistic is bumped in a counter private to the bumping thread, so that
+/// threads compiling in parallel do not contend for it.  Reading the value
+/// adds up the counters of all threads.  Where threads can be told apart on
+/// exit, an exiting thread's counts are added to the value and its counters
+/// are reused by the next new thread.
 class Statistic {
 public:
   const char *Name;
   const char *Desc;
   volatile llvm::sys::cas_flag Value;
   bool Initialized;
+  unsigned ShardIndex;  // One plus the index of the per-thread counters.
 
-  llvm::sys::cas_flag getValue() const { return Value; }
+  /// getValue - Return the value of the statistic, adding up the counts made
+  /// on every thread.
+  llvm::sys::cas_flag getValue() const;
   const char *getName() const { return Name; }
   const char *getDesc() const { return Desc; }
 
   /// construct - This should only be called for non-global statistics.
   void construct(const char *name, const char *desc) {
     Name = name; Desc = desc;
-    Value = 0; Initialized = 0;
+    Value = 0; Initialized = 0; ShardIndex = 0;
   }
 
   // Allow use of this class as the value itself.
-  operator unsigned() const { return Value; }
+  operator unsigned() const { return getValue(); }
 
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
    const Statistic &operator=(unsigned Val) {
-    Value = Val;
-    return init();
+    init();
+    setValue(Val);
+    return *this;
   }
 
+  // FIXME: The values returned by the following operators are not thread
+  // safe: another thread may bump the statistic at the same time.
   const Statistic &operator++() {
-    // FIXME: This function and all those that follow carefully use an
-    // atomic operation to update the value safely in the presence of
-    // concurrent accesses, but not to read the return value, so the
-    // return value is not thread safe.
-    sys::AtomicIncrement(&Value);
-    return init();
+    init();
+    add(1);
+    return *this;
   }
 
   unsigned operator++(int) {
     init();
-    unsigned OldValue = Value;
-    sys::AtomicIncrement(&Value);
+    unsigned OldValue = getValue();
+    add(1);
     return OldValue;
   }
 
   const Statistic &operator--() {
-    sys::AtomicDecrement(&Value);
-    return init();
+    init();
+    add(-1);
+    return *this;
   }
 
   unsigned operator--(int) {
     init();
-    unsigned OldValue = Value;
-    sys::AtomicDecrement(&Value);
+    unsigned OldValue = getValue();
+    add(-1);
     return OldValue;
   }
 
   const Statistic &operator+=(const unsigned &V) {
     if (!V) return *this;
-    sys::AtomicAdd(&Value, V);
-    return init();
+    init();
+    add(V);
+    return *this;
   }
 
   const Statistic &operator-=(const unsigned &V) {
     if (!V) return *this;
-    sys::AtomicAdd(&Value, -V);
-    return init();
+    init();
+    add(-V);
+    return *this;
   }
 
   const Statistic &operator*=(const unsigned &V) {
-    sys::AtomicMul(&Value, V);
-    return init();
+    init();
+    setValue(getValue() * V);
+    return *this;
   }
 
   const Statistic &operator/=(const unsigned &V) {
-    sys::AtomicDiv(&Value, V);
-    return init();
+    init();
+    setValue(getValue() / V);
+    return *this;
   }
 
 #else  // Statistics are disabled in release builds.
@@ -157,12 +175,28 @@ protected:
     return *this;
   }
   void RegisterStatistic();
+
+  /// add - Add V to the counter of the current thread.  Statistics that have
+  /// no per-thread counters are updated atomically instead.
+  void add(llvm::sys::cas_flag V) {
+    if (llvm::sys::cas_flag *Counter = getThreadCounter())
+      *Counter += V;
+    else
+      sys::AtomicAdd(&Value, V);
+  }
+
+  /// getThreadCounter - Return the counter of the current thread for this
+  /// statistic, or null if it has none.
+  llvm::sys::cas_flag *getThreadCounter();
+
+  /// setValue - Clear the counters of all threads and set the value to Val.
+  void setValue(llvm::sys::cas_flag Val);
 };
 
 // STATISTIC - A macro to make definition of statistics really simple.  This
 // automatically passes the DEBUG_TYPE of the file into the statistic.
 #define STATISTIC(VARNAME, DESC) \
-  static llvm::Statistic VARNAME = { DEBUG_TYPE, DESC, 0, 0 }
+  static llvm::Statistic VARNAME = { DEBUG_TYPE, DESC, 0, 0, 0 }
 
 /// \brief Enable the collection and printing of statistics.
 void EnableStatistics();
@@ -176,6 +210,21 @@ void PrintStatistics();
 /// \brief Print statistics to the given output stream.
 void PrintStatistics(raw_ostream &OS);
 
+/// \brief The value of a statistic at the time GetStatistics was called.
+struct StatisticSnapshot {
+  const char *Name;
+  const char *Desc;
+  unsigned Value;
+};
+
+/// \brief Return the current value of every statistic collected since
+/// statistics were enabled, sorted by name.
+std::vector<StatisticSnapshot> GetStatistics();
+
+/// \brief Reset every statistic collected since statistics were enabled to
+/// zero.  Counts made by other threads during the reset may be lost.
+void ResetStatistics();
+
 } // End llvm namespace
 
 #endif
@@ -317,6 +317,17 @@ public:
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
 
+  /// \return The cost of an interleaved load or store group. \p VecTy is the
+  /// wide vector type covering all \p Factor members of the group, and
+  /// \p Indices lists the members that are actually used (for loads, the
+  /// unused members are loaded and dropped). The cost includes the wide
+  /// memory operation and the shuffles that (de)interleave the members.
+  virtual unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              ArrayRef<unsigned> Indices,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const;
+
   /// \returns The cost of Intrinsic instructions.
   virtual unsigned getIntrinsicInstrCost(Intrinsic::ID ID, Type *RetTy,
                                          ArrayRef<Type *> Tys) const;
@@ -477,6 +477,16 @@ class Archive {
     /// @brief Write the symbol table to an ofstream.
     void writeSymbolTable(std::ofstream& ARFile);
 
+    /// Scans the bitcode members and fills in the symbol table and its size,
+    /// without writing anything.
+    /// @returns true if an error occurred, \p error set to error message.
+    /// @brief Build the symbol table ahead of writing the archive.
+    bool buildSymbolTable(bool TruncateNames, std::string* ErrMessage);
+
+    /// @brief Add the symbols of a bitcode member at offset \p filepos.
+    bool addMemberSymbols(const ArchiveMember& member, StringRef data,
+                          unsigned filepos, std::string* ErrMessage);
+
     /// Writes one ArchiveMember to an ofstream. If an error occurs, returns
     /// false, otherwise true. If an error occurs and error is non-null then
     /// it will be set to an error message.
@@ -485,7 +495,6 @@ class Archive {
     bool writeMember(
       const ArchiveMember& member, ///< The member to be written
       std::ofstream& ARFile,       ///< The file to write member onto
-      bool CreateSymbolTable,      ///< Should symbol table be created?
       bool TruncateNames,          ///< Should names be truncated to 11 chars?
       std::string* ErrMessage      ///< If non-null, place were error msg is set
     );
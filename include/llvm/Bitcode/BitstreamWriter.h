@@ -15,9 +15,11 @@
 #ifndef LLVM_BITCODE_BITSTREAMWRITER_H
 #define LLVM_BITCODE_BITSTREAMWRITER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitcode/BitCodes.h"
+#include <algorithm>
 #include <vector>
 
 namespace llvm {
@@ -114,6 +116,21 @@ public:
   /// \brief Retrieve the current position in the stream, in bits.
   uint64_t GetCurrentBitNo() const { return GetBufferOffset() * 8 + CurBit; }
 
+  /// BackpatchFixed32 - Overwrite the 32-bit fixed field that was emitted at
+  /// bit \p BitNo of the stream.  The field need not be word aligned, but it
+  /// must have been flushed to the output already.
+  void BackpatchFixed32(uint64_t BitNo, uint32_t NewValue) {
+    assert(BitNo + 32 <= GetBufferOffset() * 8 && "Field not flushed yet!");
+    unsigned ByteNo = BitNo / 8, Shift = BitNo % 8;
+    uint64_t Mask = uint64_t(~0U) << Shift;
+    uint64_t Value = uint64_t(NewValue) << Shift;
+    for (unsigned i = 0; i != 5 && (Mask >> (i * 8)) != 0; ++i) {
+      unsigned char ByteMask = (unsigned char)(Mask >> (i * 8));
+      Out[ByteNo + i] = (Out[ByteNo + i] & ~ByteMask) |
+                        (unsigned char)(Value >> (i * 8));
+    }
+  }
+
   //===--------------------------------------------------------------------===//
   // Basic Primitives for emitting bits to the stream.
   //===--------------------------------------------------------------------===//
@@ -239,6 +256,33 @@ public:
     }
   }
 
+  /// EmitEncodedBlock - Emit a block encoded by another writer, whose output
+  /// \p Block holds nothing but a block with the specified ID and code length.
+  /// The result is the same as if the block had been written to this stream.
+  void EmitEncodedBlock(unsigned BlockID, unsigned CodeLen,
+                        ArrayRef<char> Block) {
+    // The block header of the other writer was emitted at the start of its
+    // stream, the rest of the block is position independent as it starts at
+    // a word boundary.
+    SmallVector<char, 8> Header;
+    {
+      BitstreamWriter HeaderWriter(Header);
+      HeaderWriter.EmitCode(bitc::ENTER_SUBBLOCK);
+      HeaderWriter.EmitVBR(BlockID, bitc::BlockIDWidth);
+      HeaderWriter.EmitVBR(CodeLen, bitc::CodeLenWidth);
+      HeaderWriter.FlushToWord();
+    }
+    assert(Block.size() > Header.size() &&
+           std::equal(Header.begin(), Header.end(), Block.begin()) &&
+           "Block is not a single block with the specified ID");
+
+    EmitCode(bitc::ENTER_SUBBLOCK);
+    EmitVBR(BlockID, bitc::BlockIDWidth);
+    EmitVBR(CodeLen, bitc::CodeLenWidth);
+    FlushToWord();
+    Out.append(Block.begin() + Header.size(), Block.end());
+  }
+
   void ExitBlock() {
     assert(!BlockScope.empty() && "Block scope imbalance!");
 
@@ -529,6 +573,27 @@ private:
 
 public:
 
+  /// CopyBlockInfo - Make the abbreviations defined in the BLOCKINFO_BLOCK of
+  /// \p Other available in this stream, without emitting them.  This is used
+  /// to encode blocks separately, for EmitEncodedBlock on \p Other.  The
+  /// abbreviations are copied, so the streams can be used on different
+  /// threads.
+  void CopyBlockInfo(const BitstreamWriter &Other) {
+    for (unsigned i = 0, e = static_cast<unsigned>(
+                           Other.BlockInfoRecords.size()); i != e; ++i) {
+      const BlockInfo &OtherInfo = Other.BlockInfoRecords[i];
+      BlockInfo &Info = getOrCreateBlockInfo(OtherInfo.BlockID);
+      for (unsigned j = 0, je = static_cast<unsigned>(
+                             OtherInfo.Abbrevs.size()); j != je; ++j) {
+        const BitCodeAbbrev *OtherAbbv = OtherInfo.Abbrevs[j];
+        BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+        for (unsigned k = 0, ke = OtherAbbv->getNumOperandInfos(); k != ke; ++k)
+          Abbv->Add(OtherAbbv->getOperandInfo(k));
+        Info.Abbrevs.push_back(Abbv);
+      }
+    }
+  }
+
   /// EmitBlockInfoAbbrev - Emit a DEFINE_ABBREV record for the specified
   /// BlockID.
   unsigned EmitBlockInfoAbbrev(unsigned BlockID, BitCodeAbbrev *Abbv) {
@@ -42,7 +42,9 @@ namespace bitc {
 
     TYPE_BLOCK_ID_NEW,
 
-    USELIST_BLOCK_ID
+    USELIST_BLOCK_ID,
+
+    FUNCTION_INDEX_BLOCK_ID
   };
 
 
@@ -71,7 +73,10 @@ namespace bitc {
     // MODULE_CODE_PURGEVALS: [numvals]
     MODULE_CODE_PURGEVALS   = 10,
 
-    MODULE_CODE_GCNAME      = 11   // GCNAME: [strchr x N]
+    MODULE_CODE_GCNAME      = 11,  // GCNAME: [strchr x N]
+
+    // FNINDEXOFFSET: [offset of the FUNCTION_INDEX_BLOCK in 32-bit words]
+    MODULE_CODE_FNINDEXOFFSET = 12
   };
 
   /// PARAMATTR blocks have code for defining a parameter attribute set.
@@ -330,6 +335,12 @@ namespace bitc {
   enum UseListCodes {
     USELIST_CODE_ENTRY = 1   // USELIST_CODE_ENTRY: TBD.
   };
+
+  /// FUNCTION_INDEX blocks map the function bodies to their position in the
+  /// stream, so that a reader can find them without scanning the module.
+  enum FunctionIndexCodes {
+    FNINDEX_CODE_ENTRY = 1   // ENTRY: [valueid, bitoffset, bitsize]
+  };
 } // End bitc namespace
 } // End llvm namespace
 
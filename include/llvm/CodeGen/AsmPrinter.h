@@ -186,6 +186,10 @@ namespace llvm {
 
     void emitPrologLabel(const MachineInstr &MI);
 
+    /// EmitColdFragmentStart - Start the part of the function emitted in the
+    /// cold section, and return its symbol.
+    MCSymbol *EmitColdFragmentStart(const MCSection *ColdSection);
+
     enum CFIMoveType {
       CFI_M_None,
       CFI_M_EH,
@@ -95,6 +95,10 @@ class MachineBasicBlock : public ilist_node<MachineBasicBlock> {
   /// target of an indirect branch.
   bool AddressTaken;
 
+  /// InColdSection - Indicate that this basic block is emitted in the cold
+  /// text section, apart from the hot blocks of its function.
+  bool InColdSection;
+
   /// \brief since getSymbol is a relatively heavy-weight operation, the symbol
   /// is only computed once and is cached.
   mutable MCSymbol *CachedMCSymbol;
@@ -329,6 +333,14 @@ public:
   /// this basic block is entered via an exception handler.
   void setIsLandingPad(bool V = true) { IsLandingPad = V; }
 
+  /// isInColdSection - Returns true if the block is emitted in the cold text
+  /// section. Such blocks follow all other blocks of the function.
+  bool isInColdSection() const { return InColdSection; }
+
+  /// setInColdSection - Indicates the block is emitted in the cold text
+  /// section.
+  void setInColdSection(bool V = true) { InColdSection = V; }
+
   /// getLandingPadSuccessor - If this block has a successor that is a landing
   /// pad, return it. Otherwise return NULL.
   const MachineBasicBlock *getLandingPadSuccessor() const;
@@ -477,6 +477,10 @@ namespace llvm {
   /// information.
   extern char &MachineBlockPlacementStatsID;
 
+  /// ColdCodeSplitting - This pass moves the cold blocks of a function to its
+  /// end, to be emitted in the cold text section.
+  extern char &ColdCodeSplittingID;
+
   /// GCLowering Pass - Performs target-independent LLVM IR transformations for
   /// highly portable strategies.
   ///
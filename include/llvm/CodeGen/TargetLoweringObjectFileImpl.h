@@ -55,6 +55,10 @@ public:
   SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
                          Mangler *Mang, const TargetMachine &TM) const;
 
+  virtual const MCSection *
+  getColdSectionForFunction(const Function *F, Mangler *Mang,
+                            const TargetMachine &TM) const;
+
   /// getTTypeGlobalReference - Return an MCExpr to use for a reference to the
   /// specified type info global variable from exception handling information.
   virtual const MCExpr *
@@ -123,8 +123,10 @@ class DIContext {
 public:
   virtual ~DIContext();
 
-  /// getDWARFContext - get a context for binary DWARF data.
-  static DIContext *getDWARFContext(object::ObjectFile *);
+  /// getDWARFContext - get a context for binary DWARF data. Up to
+  /// \p NumThreads threads are used to parse compile units in parallel.
+  static DIContext *getDWARFContext(object::ObjectFile *,
+                                    unsigned NumThreads = 1);
 
   virtual void dump(raw_ostream &OS, DIDumpType DumpType = DIDT_All) = 0;
 
@@ -16,6 +16,7 @@
 #define LLVM_EXECUTIONENGINE_JITEVENTLISTENER_H
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/DebugLoc.h"
 #include <vector>
@@ -90,6 +91,15 @@ public:
   /// a previously emitted object is released.
   virtual void NotifyFreeingObject(const ObjectImage &Obj) {}
 
+  /// NotifyRelocationsResolved - Called after the relocations of an object
+  /// have been resolved, with the number of relocations and the time spent
+  /// looking up symbols and applying them.  This is called when the object
+  /// is loaded, before NotifyObjectEmitted, and again every time the
+  /// relocations are resolved after its sections have been remapped.
+  virtual void
+  NotifyRelocationsResolved(const ObjectImage &Obj,
+                            const RuntimeDyld::ResolveStats &Stats) {}
+
 #if LLVM_USE_INTEL_JITEVENTS
   // Construct an IntelJITEventListener
   static JITEventListener *createIntelJITEventListener();
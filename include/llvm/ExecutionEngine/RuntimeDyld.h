@@ -71,6 +71,21 @@ public:
   /// default implementation does nothing. Look at SectionMemoryManager for one
   /// that uses __register_frame.
   virtual void registerEHFrames(StringRef SectionData);
+
+  /// Deregister EH frames registered by registerEHFrames, before the memory
+  /// holding them is freed. The default implementation does nothing.
+  virtual void deregisterEHFrames(StringRef SectionData);
+
+  /// Inform the memory manager that the sections allocated from now on belong
+  /// to Owner, usually the module whose object is being loaded. Sections
+  /// allocated before the first call belong to a null owner. The default
+  /// implementation does nothing.
+  virtual void setSectionOwner(const void *Owner);
+
+  /// Inform the memory manager that the sections of Owner are no longer used,
+  /// so that their memory can be reused or returned to the system. The
+  /// default implementation keeps them.
+  virtual void freeSections(const void *Owner);
 };
 
 class RuntimeDyld {
@@ -81,11 +96,33 @@ class RuntimeDyld {
   // interface.
   RuntimeDyldImpl *Dyld;
   RTDyldMemoryManager *MM;
+  unsigned NumThreads;
 protected:
   // Change the address associated with a section when resolving relocations.
   // Any relocations already associated with the symbol will be re-resolved.
   void reassignSectionAddress(unsigned SectionID, uint64_t Addr);
 public:
+  /// Statistics of a call to resolveRelocations. Times are in seconds.
+  struct ResolveStats {
+    ResolveStats()
+      : NumRelocations(0), NumExternalSymbols(0), NumSymbolLookups(0),
+        NumThreads(1), SymbolLookupTime(0), ApplyTime(0) {}
+
+    /// The relocations applied.
+    unsigned NumRelocations;
+    /// The external symbols referred to by the relocations.
+    unsigned NumExternalSymbols;
+    /// The external symbols looked up in the memory manager. Each symbol is
+    /// looked up once and its address reused by later calls.
+    unsigned NumSymbolLookups;
+    /// The threads the relocations were applied on.
+    unsigned NumThreads;
+    /// The time spent finding the addresses the relocations refer to.
+    double SymbolLookupTime;
+    /// The time spent writing the relocated values.
+    double ApplyTime;
+  };
+
   RuntimeDyld(RTDyldMemoryManager *);
   ~RuntimeDyld();
 
@@ -107,6 +144,13 @@ public:
   /// Resolve the relocations for all symbols we currently know about.
   void resolveRelocations();
 
+  /// Apply the relocations on up to N threads. The relocations of a section
+  /// are all applied by the same thread.
+  void setNumThreads(unsigned N);
+
+  /// Get the statistics of the last call to resolveRelocations.
+  ResolveStats getResolveStats() const;
+
   /// Map a section to its target address space value.
   /// Map the address of a JIT section as returned from the memory manager
   /// to the address in the target process as the running code will see it.
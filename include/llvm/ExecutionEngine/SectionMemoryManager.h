@@ -35,14 +35,49 @@ namespace llvm {
 /// in the JITed object.  Permissions can be applied either by calling
 /// MCJIT::finalizeObject or by calling SectionMemoryManager::applyPermissions
 /// directly.  Clients of MCJIT should call MCJIT::finalizeObject.
+///
+/// Sections belong to the owner set by setSectionOwner when they are
+/// allocated, and blocks of memory are never shared between owners.  When an
+/// owner's sections are freed its blocks are kept read-write for reuse by
+/// later allocations, up to a limit, and returned to the system beyond it.
+///
+/// Memory is mapped in slabs of at least the slab size given on construction,
+/// optionally backed by huge pages, and sections are packed into the slabs of
+/// their owner.  Applying permissions changes only the pages written since the
+/// last time, with one system call per contiguous range; the rest of a slab
+/// stays read-write for the sections of the next object.
 class SectionMemoryManager : public RTDyldMemoryManager {
   SectionMemoryManager(const SectionMemoryManager&) LLVM_DELETED_FUNCTION;
   void operator=(const SectionMemoryManager&) LLVM_DELETED_FUNCTION;
 
 public:
-  SectionMemoryManager() { }
+  /// A \p SlabSize of zero maps memory for each section which does not fit
+  /// in the blocks mapped already.
+  explicit SectionMemoryManager(size_t SlabSize = 0, bool HugePages = false)
+    : Owner(0), SlabSize(SlabSize), HugePages(HugePages) { }
   virtual ~SectionMemoryManager();
 
+  /// Memory usage of the manager, in bytes.  The memory which is mapped but
+  /// not counted in the other fields is lost to alignment, and to the pages
+  /// whose permissions have been applied after the end of their sections.
+  struct MemoryStats {
+    /// Memory mapped from the system, including the released blocks.
+    uint64_t MappedBytes;
+    /// Memory handed out for sections which have not been freed.
+    uint64_t SectionBytes;
+    /// Unused tails of allocated blocks, available to their owner.
+    uint64_t FreeBytes;
+    /// Blocks whose sections have been freed, available to any owner.
+    uint64_t ReleasedBytes;
+    /// The largest released block.
+    uint64_t LargestReleasedBlock;
+    unsigned NumAllocatedBlocks;
+    unsigned NumReleasedBlocks;
+  };
+
+  /// \brief Returns the memory usage of the code and data sections.
+  MemoryStats getMemoryStats() const;
+
   /// \brief Allocates a memory block of (at least) the given size suitable for
   /// executable code.
   ///
@@ -74,6 +109,22 @@ public:
 
   void registerEHFrames(StringRef SectionData);
 
+  void deregisterEHFrames(StringRef SectionData);
+
+  /// \brief Sets the owner of the sections allocated from now on.
+  virtual void setSectionOwner(const void *NewOwner);
+
+  /// \brief Frees the sections of the specified owner.
+  ///
+  /// The blocks holding them are made read-write and kept for reuse by later
+  /// allocations of any owner, or released to the system when more than
+  /// MaxReleasedBytes are kept for a kind of section.
+  virtual void freeSections(const void *SectionOwner);
+
+  /// The amount of freed memory kept for reuse by each of the code, read-only
+  /// data and read-write data sections.
+  static const uint64_t MaxReleasedBytes = 1024 * 1024;
+
   /// This method returns the address of the specified function. As such it is
   /// only useful for resolving library symbols, not code generated symbols.
   ///
@@ -93,9 +144,29 @@ public:
   virtual void invalidateInstructionCache();
 
 private:
+  /// A block of memory mapped for the sections of one owner.
+  struct AllocatedBlock {
+    AllocatedBlock(sys::MemoryBlock Block, const void *Owner)
+      : Block(Block), Owner(Owner), SectionBytes(0), ProtectedSize(0) {}
+    sys::MemoryBlock Block;
+    const void *Owner;
+    uint64_t SectionBytes;
+    /// The size of the start of the block whose permissions have been applied.
+    uint64_t ProtectedSize;
+  };
+
+  /// The unused end of an allocated block.
+  struct FreeMemBlock {
+    FreeMemBlock(sys::MemoryBlock Free, unsigned Index)
+      : Free(Free), AllocatedIndex(Index) {}
+    sys::MemoryBlock Free;
+    unsigned AllocatedIndex;
+  };
+
   struct MemoryGroup {
-      SmallVector<sys::MemoryBlock, 16> AllocatedMem;
-      SmallVector<sys::MemoryBlock, 16> FreeMem;
+      SmallVector<AllocatedBlock, 16> AllocatedMem;
+      SmallVector<FreeMemBlock, 16> FreeMem;
+      SmallVector<sys::MemoryBlock, 4> ReleasedMem;
       sys::MemoryBlock Near;
   };
 
@@ -105,6 +176,15 @@ private:
   error_code applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                          unsigned Permissions);
 
+  void freeMemoryGroupSections(MemoryGroup &MemGroup,
+                               const void *SectionOwner);
+
+  static void addMemoryGroupStats(const MemoryGroup &MemGroup,
+                                  MemoryStats &Stats);
+
+  const void *Owner;
+  size_t SlabSize;
+  bool HugePages;
   MemoryGroup CodeMem;
   MemoryGroup RWDataMem;
   MemoryGroup RODataMem;
@@ -14,7 +14,9 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Object/Binary.h"
@@ -234,10 +236,28 @@ public:
   // check if a symbol is in the archive
   child_iterator findSym(StringRef name) const;
 
+  /// Have findSym use a hash index over the symbol table instead of scanning
+  /// it. The index is built on the first lookup and maps each symbol name to
+  /// its member, so it costs one map entry per symbol. Worthwhile when many
+  /// symbols are looked up in the same archive. If the symbol table is
+  /// malformed, no index is built and findSym keeps scanning. Building the
+  /// index is not synchronized, so an archive with an index enabled must not
+  /// be searched from several threads at once.
+  void enableSymbolIndex() { UseSymbolIndex = true; }
+  bool hasSymbolIndex() const { return SymbolMap.get() != 0; }
+
 private:
+  void buildSymbolIndex() const;
+
   child_iterator SymbolTable;
   child_iterator StringTable;
   Kind Format;
+
+  bool UseSymbolIndex;
+  /// Maps symbol names to the member defining them.
+  mutable OwningPtr<StringMap<child_iterator> > SymbolMap;
+  /// Set if building the index failed, so that it is not tried again.
+  mutable bool SymbolIndexFailed;
 };
 
 }
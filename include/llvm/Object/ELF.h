@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_ELF_H
 #define LLVM_OBJECT_ELF_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/SmallVector.h"
@@ -590,6 +591,8 @@ private:
   const Elf_Shdr *dot_shstrtab_sec; // Section header string table.
   const Elf_Shdr *dot_strtab_sec;   // Symbol header string table.
   const Elf_Shdr *dot_dynstr_sec;   // Dynamic symbol string table.
+  StringRef StrtabData;             // Contents of .strtab.
+  StringRef DynstrData;             // Contents of .dynstr.
 
   // SymbolTableSections[0] always points to the dynamic string table section
   // header, or NULL if there is no dynamic string table.
@@ -671,6 +674,24 @@ public:
   error_code      getSymbolName(const Elf_Shdr *section,
                                 const Elf_Sym *Symb,
                                 StringRef &Res) const;
+
+  /// \name Direct symbol access
+  /// These work on the Elf_Sym entries of a symbol table section, as
+  /// returned by begin_elf_symbols() and begin_elf_dynamic_symbols(). They
+  /// give the same results as the SymbolRef interface without going
+  /// through virtual calls and DataRefImpl decoding for every symbol.
+  /// Those that read other parts of the file return an error for a symbol
+  /// whose section index or name offset is out of range.
+  /// @{
+  error_code getElfSymbolName(const Elf_Shdr *SymTab, const Elf_Sym *Sym,
+                              StringRef &Res) const;
+  error_code getElfSymbolAddress(const Elf_Sym *Sym, uint64_t &Res) const;
+  uint64_t getElfSymbolSize(const Elf_Sym *Sym) const { return Sym->st_size; }
+  uint32_t getElfSymbolFlags(const Elf_Sym *Sym) const;
+  error_code getElfSymbolNMTypeChar(const Elf_Shdr *SymTab, const Elf_Sym *Sym,
+                                    char &Res) const;
+  /// @}
+
   error_code      getSectionName(const Elf_Shdr *section,
                                  StringRef &Res) const;
   const Elf_Dyn  *getDyn(DataRefImpl DynData) const;
@@ -779,6 +800,27 @@ public:
     return Elf_Sym_iterator(0, 0);
   }
 
+  /// \brief The SHT_SYMTAB sections, in the order begin_symbols() visits
+  /// them.
+  ArrayRef<const Elf_Shdr *> getSymbolTableSectionHeaders() const {
+    return makeArrayRef(SymbolTableSections).slice(1);
+  }
+
+  /// \brief Iterate over the entries of a symbol table section, skipping the
+  /// null symbol at index 0.
+  Elf_Sym_iterator begin_elf_symbols(const Elf_Shdr *SymTab) const {
+    if (SymTab->getEntityCount() == 0)
+      return end_elf_symbols(SymTab);
+    return Elf_Sym_iterator(SymTab->sh_entsize, (const char *)base() +
+                            SymTab->sh_offset + SymTab->sh_entsize);
+  }
+
+  Elf_Sym_iterator end_elf_symbols(const Elf_Shdr *SymTab) const {
+    return Elf_Sym_iterator(SymTab->sh_entsize, (const char *)base() +
+                            SymTab->sh_offset +
+                            SymTab->getEntityCount() * SymTab->sh_entsize);
+  }
+
   Elf_Rela_Iter beginELFRela(const Elf_Shdr *sec) const {
     return Elf_Rela_Iter(sec->sh_entsize,
                          (const char *)(base() + sec->sh_offset));
@@ -827,6 +869,8 @@ public:
   ELF::Elf64_Word getSymbolTableIndex(const Elf_Sym *symb) const;
   const Elf_Ehdr *getElfHeader() const;
   const Elf_Shdr *getSection(const Elf_Sym *symb) const;
+  error_code getElfSymbolSection(const Elf_Sym *symb,
+                                 const Elf_Shdr *&Res) const;
   const Elf_Shdr *getElfSection(section_iterator &It) const;
   const Elf_Sym *getElfSymbol(symbol_iterator &It) const;
   const Elf_Sym *getElfSymbol(uint32_t index) const;
@@ -1011,6 +1055,19 @@ ELFObjectFile<ELFT>::getSection(const Elf_Sym *symb) const {
   return getSection(symb->st_shndx);
 }
 
+template<class ELFT>
+error_code
+ELFObjectFile<ELFT>::getElfSymbolSection(const Elf_Sym *symb,
+                                         const Elf_Shdr *&Res) const {
+  ELF::Elf64_Word index = getSymbolTableIndex(symb);
+  if (symb->st_shndx != ELF::SHN_XINDEX && index >= ELF::SHN_LORESERVE)
+    index = 0;
+  if (index != 0 && (!SectionHeaderTable || index >= getNumSections()))
+    return object_error::parse_failed;
+  Res = getSection(index);
+  return object_error::success;
+}
+
 template<class ELFT>
 const typename ELFObjectFile<ELFT>::Elf_Ehdr *
 ELFObjectFile<ELFT>::getElfHeader() const {
@@ -1077,7 +1134,12 @@ template<class ELFT>
 error_code ELFObjectFile<ELFT>::getSymbolAddress(DataRefImpl Symb,
                                                  uint64_t &Result) const {
   validateSymbol(Symb);
-  const Elf_Sym  *symb = getSymbol(Symb);
+  return getElfSymbolAddress(getSymbol(Symb), Result);
+}
+
+template<class ELFT>
+error_code ELFObjectFile<ELFT>::getElfSymbolAddress(const Elf_Sym *symb,
+                                                    uint64_t &Result) const {
   const Elf_Shdr *Section;
   switch (getSymbolTableIndex(symb)) {
   case ELF::SHN_COMMON:
@@ -1087,7 +1149,9 @@ error_code ELFObjectFile<ELFT>::getSymbolAddress(DataRefImpl Symb,
   case ELF::SHN_ABS:
     Result = symb->st_value;
     return object_error::success;
-  default: Section = getSection(symb);
+  default:
+    if (error_code ec = getElfSymbolSection(symb, Section))
+      return ec;
   }
 
   switch (symb->getType()) {
@@ -1096,7 +1160,7 @@ error_code ELFObjectFile<ELFT>::getSymbolAddress(DataRefImpl Symb,
     return object_error::success;
   case ELF::STT_FUNC:
   case ELF::STT_OBJECT:
-  case ELF::STT_NOTYPE:
+  case ELF::STT_NOTYPE: {
     bool IsRelocatable;
     switch(Header->e_type) {
     case ELF::ET_EXEC:
@@ -1115,6 +1179,7 @@ error_code ELFObjectFile<ELFT>::getSymbolAddress(DataRefImpl Symb,
     if (IsRelocatable && Section != 0)
       Result += Section->sh_addr;
     return object_error::success;
+  }
   default:
     Result = UnknownAddressOrSize;
     return object_error::success;
@@ -1140,10 +1205,7 @@ template<class ELFT>
 error_code ELFObjectFile<ELFT>::getSymbolSize(DataRefImpl Symb,
                                               uint64_t &Result) const {
   validateSymbol(Symb);
-  const Elf_Sym  *symb = getSymbol(Symb);
-  if (symb->st_size == 0)
-    Result = UnknownAddressOrSize;
-  Result = symb->st_size;
+  Result = getElfSymbolSize(getSymbol(Symb));
   return object_error::success;
 }
 
@@ -1151,8 +1213,17 @@ template<class ELFT>
 error_code ELFObjectFile<ELFT>::getSymbolNMTypeChar(DataRefImpl Symb,
                                                     char &Result) const {
   validateSymbol(Symb);
-  const Elf_Sym  *symb = getSymbol(Symb);
-  const Elf_Shdr *Section = getSection(symb);
+  return getElfSymbolNMTypeChar(SymbolTableSections[Symb.d.b],
+                                getSymbol(Symb), Result);
+}
+
+template<class ELFT>
+error_code ELFObjectFile<ELFT>::getElfSymbolNMTypeChar(const Elf_Shdr *SymTab,
+                                                       const Elf_Sym *symb,
+                                                       char &Result) const {
+  const Elf_Shdr *Section;
+  if (error_code ec = getElfSymbolSection(symb, Section))
+    return ec;
 
   char ret = '?';
 
@@ -1198,7 +1269,7 @@ error_code ELFObjectFile<ELFT>::getSymbolNMTypeChar(DataRefImpl Symb,
 
   if (ret == '?' && symb->getType() == ELF::STT_SECTION) {
     StringRef name;
-    if (error_code ec = getSymbolName(Symb, name))
+    if (error_code ec = getElfSymbolName(SymTab, symb, name))
       return ec;
     Result = StringSwitch<char>(name)
       .StartsWith(".debug", 'N')
@@ -1246,9 +1317,13 @@ template<class ELFT>
 error_code ELFObjectFile<ELFT>::getSymbolFlags(DataRefImpl Symb,
                                                uint32_t &Result) const {
   validateSymbol(Symb);
-  const Elf_Sym  *symb = getSymbol(Symb);
+  Result = getElfSymbolFlags(getSymbol(Symb));
+  return object_error::success;
+}
 
-  Result = SymbolRef::SF_None;
+template<class ELFT>
+uint32_t ELFObjectFile<ELFT>::getElfSymbolFlags(const Elf_Sym *symb) const {
+  uint32_t Result = SymbolRef::SF_None;
 
   if (symb->getBinding() != ELF::STB_LOCAL)
     Result |= SymbolRef::SF_Global;
@@ -1273,7 +1348,7 @@ error_code ELFObjectFile<ELFT>::getSymbolFlags(DataRefImpl Symb,
   if (symb->getType() == ELF::STT_TLS)
     Result |= SymbolRef::SF_ThreadLocal;
 
-  return object_error::success;
+  return Result;
 }
 
 template<class ELFT>
@@ -2465,12 +2540,16 @@ ELFObjectFile<ELFT>::ELFObjectFile(MemoryBuffer *Object, error_code &ec)
           report_fatal_error("Already found section named .strtab!");
         dot_strtab_sec = sh;
         VerifyStrTab(dot_strtab_sec);
+        StrtabData = StringRef((const char*)base() + sh->sh_offset,
+                               sh->sh_size);
       } else if (SectionName == ".dynstr") {
         if (dot_dynstr_sec != 0)
           // FIXME: Proper error handling.
           report_fatal_error("Already found section named .dynstr!");
         dot_dynstr_sec = sh;
         VerifyStrTab(dot_dynstr_sec);
+        DynstrData = StringRef((const char*)base() + sh->sh_offset,
+                               sh->sh_size);
       }
     }
   }
@@ -2847,22 +2926,34 @@ template<class ELFT>
 error_code ELFObjectFile<ELFT>::getSymbolName(const Elf_Shdr *section,
                                               const Elf_Sym *symb,
                                               StringRef &Result) const {
+  return getElfSymbolName(section, symb, Result);
+}
+
+template<class ELFT>
+error_code ELFObjectFile<ELFT>::getElfSymbolName(const Elf_Shdr *SymTab,
+                                                 const Elf_Sym *symb,
+                                                 StringRef &Result) const {
   if (symb->st_name == 0) {
-    const Elf_Shdr *section = getSection(symb);
-    if (!section)
+    const Elf_Shdr *section;
+    if (error_code ec = getElfSymbolSection(symb, section))
+      return ec;
+    if (!section) {
       Result = "";
-    else
-      Result = getString(dot_shstrtab_sec, section->sh_name);
+      return object_error::success;
+    }
+    if (!dot_shstrtab_sec || section->sh_name >= dot_shstrtab_sec->sh_size)
+      return object_error::parse_failed;
+    Result = getString(dot_shstrtab_sec, section->sh_name);
     return object_error::success;
   }
 
-  if (section == SymbolTableSections[0]) {
-    // Symbol is in .dynsym, use .dynstr string table
-    Result = getString(dot_dynstr_sec, symb->st_name);
-  } else {
-    // Use the default symbol table name section.
-    Result = getString(dot_strtab_sec, symb->st_name);
-  }
+  // Symbols in .dynsym use .dynstr, all others use the default symbol table
+  // name section. A missing string table is empty.
+  StringRef StrTab = SymTab == SymbolTableSections[0] ? DynstrData
+                                                      : StrtabData;
+  if (symb->st_name >= StrTab.size())
+    return object_error::parse_failed;
+  Result = StrTab.data() + symb->st_name;
   return object_error::success;
 }
 
@@ -68,6 +68,17 @@ public:
                              PassInfo& Registeree, bool isDefault,
                              bool ShouldFree = false);
   
+  /// addLazyInitializer - Defer a call to Init, which registers passes, until
+  /// a pass is scheduled in a pass manager, a pass is looked up by argument
+  /// string, or the registered passes are enumerated.  Passes still register
+  /// themselves when they are created.  Tools use this to avoid registering
+  /// every pass they link in when they end up running none.
+  void addLazyInitializer(void (*Init)(PassRegistry &));
+
+  /// runLazyInitializers - Register the passes deferred with
+  /// addLazyInitializer, if that has not been done yet.
+  void runLazyInitializers();
+
   /// enumerateWith - Enumerate the registered passes, calling the provided
   /// PassRegistrationListener's passEnumerate() callback on each of them.
   void enumerateWith(PassRegistrationListener *L);
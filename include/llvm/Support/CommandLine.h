@@ -67,6 +67,14 @@ void SetVersionPrinter(void (*func)());
 ///                          information specific to the tool.
 void AddExtraVersionPrinter(void (*func)());
 
+///===---------------------------------------------------------------------===//
+/// AddLazyOptionRegistrar - Add a function that registers more options, for
+///                          a tool that registers some of its options only
+///                          when they are needed.  The function is called,
+///                          once, when an argument names no registered
+///                          option or when all of the options are listed.
+void AddLazyOptionRegistrar(void (*func)());
+
 
 // PrintOptionValues - Print option values.
 // With -print-options print the difference between option values and defaults.
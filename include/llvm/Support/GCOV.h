@@ -15,6 +15,7 @@
 #ifndef LLVM_SUPPORT_GCOV_H
 #define LLVM_SUPPORT_GCOV_H
 
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -141,11 +142,13 @@ public:
     return Result;
   }
 
+  /// readString - Read a string padded with nulls to a multiple of four
+  /// bytes. The padding is not part of the result.
   StringRef readString() {
     uint32_t Len = readInt() * 4;
     StringRef Str = Buffer->getBuffer().slice(Cursor, Cursor+Len);
     Cursor += Len;
-    return Str;
+    return Str.substr(0, Str.find('\0'));
   }
 
   uint64_t getCursor() const { return Cursor; }
@@ -205,19 +208,45 @@ class GCOVLines {
 public:
   ~GCOVLines() { Lines.clear(); }
   void add(uint32_t N) { Lines.push_back(N); }
-  void collectLineCounts(FileInfo &FI, StringRef Filename, uint32_t Count);
+  void collectLineCounts(FileInfo &FI, StringRef Filename, uint64_t Count);
   void dump();
 
 private:
   SmallVector<uint32_t, 4> Lines;
 };
 
-typedef SmallVector<uint32_t, 16> LineCounts;
+/// LineCounts - Execution counts for the lines of one source file, indexed
+/// by line number minus one. Lines that no block maps to are not
+/// instrumented and are never counted.
+struct LineCounts {
+  SmallVector<uint64_t, 16> Counts;
+  BitVector Instrumented;
+
+  void add(uint32_t Line, uint64_t Count);
+  void merge(const LineCounts &Other);
+  unsigned getNumInstrumented() const { return Instrumented.count(); }
+  unsigned getNumExecuted() const;
+};
+
+/// FileInfo - Line counts for a set of source files. Counts collected from
+/// one .gcno/.gcda pair can be merged into another FileInfo, which sums the
+/// counts of runs or of translation units that share a source file. The
+/// source files themselves are only read when printing.
 class FileInfo {
 public:
-  void addLineCount(StringRef Filename, uint32_t Line, uint32_t Count);
-  void print();
+  void addLineCount(StringRef Filename, uint32_t Line, uint64_t Count);
+  void merge(const FileInfo &Other);
+  bool empty() const { return LineInfo.empty(); }
+
+  /// print - Print each source file annotated with its line counts.
+  void print(raw_ostream &OS);
+
+  /// printSummary - Print how many of the instrumented lines of each file
+  /// were executed, followed by the totals.
+  void printSummary(raw_ostream &OS);
 private:
+  void getSortedFilenames(SmallVectorImpl<StringRef> &Filenames) const;
+
   StringMap<LineCounts> LineInfo;
 };
 
@@ -47,7 +47,11 @@ namespace sys {
     enum ProtectionFlags {
       MF_READ  = 0x1000000,
       MF_WRITE = 0x2000000,
-      MF_EXEC  = 0x4000000
+      MF_EXEC  = 0x4000000,
+      /// A hint to allocateMappedMemory that the block should be backed by
+      /// large pages where the system supports it. It is ignored otherwise,
+      /// and by protectMappedMemory.
+      MF_HUGE_HINT = 0x0000001
     };
 
     /// This method allocates a block of memory that is suitable for loading
@@ -58,7 +62,7 @@ namespace sys {
     /// The actual allocated address is not guaranteed to be near the requested
     /// address.
     /// \p Flags is used to set the initial protection flags for the block
-    /// of the memory.
+    /// of the memory, optionally combined with MF_HUGE_HINT.
     /// \p EC [out] returns an object describing any error that occurs.
     ///
     /// This method may allocate more than the number of bytes requested.  The
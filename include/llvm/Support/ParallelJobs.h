@@ -0,0 +1,127 @@
+//===- llvm/Support/ParallelJobs.h - Jobs with ordered output ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares ParallelJobQueue, which runs independent jobs on several
+// threads and prints their output in the order in which they were queued, so
+// that a tool dumping many inputs with -j prints exactly what it would print
+// dumping them one by one.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PARALLELJOBS_H
+#define LLVM_SUPPORT_PARALLELJOBS_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+/// jobOuts - The stream the job running on the current thread prints its
+/// output to, or outs() outside of a job.  This is a thread-local lookup, so
+/// bind the result once rather than calling it for every line.
+raw_ostream &jobOuts();
+
+/// jobErrs - The stream the job running on the current thread prints its
+/// diagnostics to, or errs() outside of a job.
+raw_ostream &jobErrs();
+
+/// JobStreamsScope - Makes jobOuts() and jobErrs() return the given streams
+/// on the current thread while it is alive.
+class JobStreamsScope {
+  JobStreamsScope(const JobStreamsScope &) LLVM_DELETED_FUNCTION;
+  void operator=(const JobStreamsScope &) LLVM_DELETED_FUNCTION;
+public:
+  JobStreamsScope(raw_ostream &Out, raw_ostream &Err);
+  ~JobStreamsScope();
+
+  raw_ostream &Out;
+  raw_ostream &Err;
+};
+
+/// printJobOutput - Print the buffered output and diagnostics of a finished
+/// job to outs() and errs(), keeping them in order with respect to each other.
+void printJobOutput(StringRef Out, StringRef Err);
+
+/// ParallelJobQueue - A batch of jobs of type JobT run by RunFn on up to
+/// NumThreads threads.  Each job's output is buffered and printed, in queue
+/// order, when the batch is flushed.  The queue flushes itself when it holds
+/// MaxJobs jobs and when it is destroyed; callers flush it explicitly before
+/// anything the queued jobs point into goes away.
+template <typename JobT>
+class ParallelJobQueue {
+public:
+  typedef void (*RunFnTy)(JobT &Job, raw_ostream &Out, raw_ostream &Err);
+
+private:
+  struct Entry {
+    JobT Job;
+    std::string Out, Err;
+    bool Done;
+
+    explicit Entry(const JobT &Job) : Job(Job), Done(false) {}
+  };
+
+  std::vector<Entry> Entries;
+  RunFnTy RunFn;
+  unsigned NumThreads;
+  unsigned MaxJobs;
+
+  ParallelJobQueue(const ParallelJobQueue &) LLVM_DELETED_FUNCTION;
+  void operator=(const ParallelJobQueue &) LLVM_DELETED_FUNCTION;
+
+  static void runEntry(void *Data, unsigned Index) {
+    ParallelJobQueue *Q = static_cast<ParallelJobQueue*>(Data);
+    Entry &E = Q->Entries[Index];
+    if (E.Done)
+      return;
+    raw_string_ostream OS(E.Out), ES(E.Err);
+    JobStreamsScope Streams(OS, ES);
+    Q->RunFn(E.Job, OS, ES);
+  }
+
+public:
+  ParallelJobQueue(RunFnTy RunFn, unsigned NumThreads)
+    : RunFn(RunFn), NumThreads(NumThreads), MaxJobs(NumThreads * 64) {}
+  ~ParallelJobQueue() { flush(); }
+
+  /// add - Queue Job, flushing the queue first if it is full.
+  void add(const JobT &Job) {
+    if (Entries.size() >= MaxJobs)
+      flush();
+    Entries.push_back(Entry(Job));
+  }
+
+  /// addOutput - Queue output that has already been produced, to be printed
+  /// after the output of the jobs queued before it.
+  void addOutput(StringRef Out, StringRef Err) {
+    if (Entries.size() >= MaxJobs)
+      flush();
+    Entries.push_back(Entry(JobT()));
+    Entries.back().Out = Out;
+    Entries.back().Err = Err;
+    Entries.back().Done = true;
+  }
+
+  /// flush - Run the queued jobs and print their output in queue order.
+  void flush() {
+    llvm_parallel_for(Entries.size(), runEntry, this, NumThreads);
+    for (typename std::vector<Entry>::iterator I = Entries.begin(),
+         E = Entries.end(); I != E; ++I)
+      printJobOutput(I->Out, I->Err);
+    Entries.clear();
+  }
+};
+
+} // end namespace llvm
+
+#endif
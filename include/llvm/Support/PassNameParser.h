@@ -63,22 +63,27 @@ public:
            P->getNormalCtor() == 0 || ignorablePassImpl(P);
   }
 
-  // Implement the PassRegistrationListener callbacks used to populate our map
+  // Implement the PassRegistrationListener callbacks used to populate our map.
+  // The PassRegistry has already made sure that the argument is not taken.
   //
   virtual void passRegistered(const PassInfo *P) {
     if (ignorablePass(P) || !Opt) return;
-    if (findOption(P->getPassArgument()) != getNumOptions()) {
-      errs() << "Two passes with the same argument (-"
-           << P->getPassArgument() << ") attempted to be registered!\n";
-      llvm_unreachable(0);
-    }
     addLiteralOption(P->getPassArgument(), P, P->getPassName());
   }
   virtual void passEnumerate(const PassInfo *P) { passRegistered(P); }
 
+  // parse - Register the passes whose registration was deferred before looking
+  // up the pass named by Arg.
+  bool parse(cl::Option &O, StringRef ArgName, StringRef Arg,
+             const PassInfo *&Val) {
+    PassRegistry::getPassRegistry()->runLazyInitializers();
+    return cl::parser<const PassInfo*>::parse(O, ArgName, Arg, Val);
+  }
+
   // printOptionInfo - Print out information about this option.  Override the
-  // default implementation to sort the table before we print...
+  // default implementation to list every pass, sorted.
   virtual void printOptionInfo(const cl::Option &O, size_t GlobalWidth) const {
+    PassRegistry::getPassRegistry()->runLazyInitializers();
     PassNameParser *PNP = const_cast<PassNameParser*>(this);
     array_pod_sort(PNP->Values.begin(), PNP->Values.end(), ValLessThan);
     cl::parser<const PassInfo*>::printOptionInfo(O, GlobalWidth);
@@ -54,6 +54,18 @@ namespace llvm {
   /// the thread stack.
   void llvm_execute_on_thread(void (*UserFn)(void*), void *UserData,
                               unsigned RequestedStackSize = 0);
+
+  /// llvm_parallel_for - Call \p UserFn(UserData, I) for every I in
+  /// [0, NumItems), spreading the calls over up to \p NumThreads threads, and
+  /// wait for all of them to finish. Items are handed out one at a time, so
+  /// \p UserFn must be safe to run concurrently for distinct items.
+  ///
+  /// The calling thread takes part in the work. When \p NumThreads is at most
+  /// one, or threads are not available, the items are processed in order on
+  /// the calling thread.
+  void llvm_parallel_for(unsigned NumItems,
+                         void (*UserFn)(void*, unsigned), void *UserData,
+                         unsigned NumThreads);
 }
 
 #endif
@@ -29,6 +29,7 @@ namespace llvm {
   class MCSymbol;
   class MCSymbolRefExpr;
   class MCStreamer;
+  class Function;
   class GlobalValue;
   class TargetMachine;
   
@@ -109,6 +110,15 @@ public:
     return 0;
   }
   
+  /// getColdSectionForFunction - Return the section the cold basic blocks of
+  /// the specified function definition are moved to, or null if they must
+  /// stay in the section of the function.
+  virtual const MCSection *
+  getColdSectionForFunction(const Function *F, Mangler *Mang,
+                            const TargetMachine &TM) const {
+    return 0;
+  }
+
   /// getTTypeGlobalReference - Return an MCExpr to use for a reference
   /// to the specified global variable from exception handling information.
   ///
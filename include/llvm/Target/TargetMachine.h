@@ -225,6 +225,10 @@ public:
   /// their own section, corresponding to -ffunction-sections.
   static bool getFunctionSections();
 
+  /// getSplitColdCode - Return true if functions and basic blocks found to be
+  /// cold should be emitted apart from the hot code, in .text.unlikely.
+  static bool getSplitColdCode();
+
   /// setDataSections - Set if the data are emit into separate sections.
   static void setDataSections(bool);
 
@@ -232,6 +236,9 @@ public:
   /// sections.
   static void setFunctionSections(bool);
 
+  /// setSplitColdCode - Set if cold code is emitted apart from the hot code.
+  static void setSplitColdCode(bool);
+
   /// \brief Register analysis passes for this target with a pass manager.
   virtual void addAnalysisPasses(PassManagerBase &) {}
 
@@ -31,16 +31,25 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace llvm;
 
 STATISTIC(NumEdgesRead, "The # of edges read.");
 STATISTIC(NumTermsAnnotated, "The # of terminator instructions annotated.");
+STATISTIC(NumColdFunctions, "The # of functions marked cold.");
+STATISTIC(NumHotFunctions, "The # of functions marked hot.");
 
 static cl::opt<std::string>
 ProfileMetadataFilename("profile-file", cl::init("llvmprof.out"),
                   cl::value_desc("filename"),
                   cl::desc("Profile file loaded by -profile-metadata-loader"));
 
+static cl::opt<unsigned>
+ProfileHotFunctionRatio("profile-hot-function-ratio", cl::init(1000),
+                  cl::value_desc("N"),
+                  cl::desc("Mark functions entered at least once per N entries "
+                           "of the most frequently entered function hot"));
+
 namespace {
   /// This pass loads profiling data from a dump file and sets branch weight
   /// metadata.
@@ -66,6 +75,7 @@ namespace {
                           ArrayRef<unsigned>);
     virtual unsigned matchEdges(Module&, ProfileData&, ArrayRef<unsigned>);
     virtual void setBranchWeightMetadata(Module&, ProfileData&);
+    virtual void setFunctionTemperature(Module&, ProfileData&);
 
     virtual bool runOnModule(Module &M);
   };
@@ -168,6 +178,35 @@ void ProfileMetadataLoaderPass::setBranchWeightMetadata(Module &M,
   }
 }
 
+/// setFunctionTemperature - Mark the functions which were never entered with
+/// the "cold" attribute, and the ones entered about as often as the most
+/// frequently entered function with the "hot" attribute. Code generation can
+/// place them apart from the rest of the code.
+void ProfileMetadataLoaderPass::setFunctionTemperature(Module &M,
+                                                       ProfileData &PB) {
+  uint64_t MaxEntryCount = 0;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration()) continue;
+    uint64_t EntryCount = PB.getEdgeWeight(PB.getEdge(0, &F->getEntryBlock()));
+    MaxEntryCount = std::max(MaxEntryCount, EntryCount);
+  }
+  if (MaxEntryCount == 0) return;
+
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration()) continue;
+    uint64_t EntryCount = PB.getEdgeWeight(PB.getEdge(0, &F->getEntryBlock()));
+    if (EntryCount == 0) {
+      DEBUG(dbgs() << "Marking '" << F->getName() << "' cold\n");
+      F->addFnAttr("cold");
+      NumColdFunctions++;
+    } else if (EntryCount * ProfileHotFunctionRatio >= MaxEntryCount) {
+      DEBUG(dbgs() << "Marking '" << F->getName() << "' hot\n");
+      F->addFnAttr("hot");
+      NumHotFunctions++;
+    }
+  }
+}
+
 bool ProfileMetadataLoaderPass::runOnModule(Module &M) {
   ProfileDataLoader PDL("profile-data-loader", Filename);
   ProfileData PB;
@@ -184,5 +223,9 @@ bool ProfileMetadataLoaderPass::runOnModule(Module &M) {
 
   setBranchWeightMetadata(M, PB);
 
+  // Entry counts of an inconsistent profile may belong to other functions.
+  if (ReadCount > 0 && ReadCount == Counters.size())
+    setFunctionTemperature(M, PB);
+
   return ReadCount > 0;
 }
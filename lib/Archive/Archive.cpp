@@ -201,9 +201,11 @@ static void getSymbols(Module*M, std::vector<std::string>& symbols) {
       if (!GI->getName().empty())
         symbols.push_back(GI->getName());
 
-  // Loop over functions
+  // Loop over functions. Functions whose bodies have not been read in yet by a
+  // lazily loaded module are still definitions.
   for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI)
-    if (!FI->isDeclaration() && !FI->hasLocalLinkage())
+    if ((!FI->isDeclaration() || FI->isMaterializable()) &&
+        !FI->hasLocalLinkage())
       if (!FI->getName().empty())
         symbols.push_back(FI->getName());
 
@@ -260,3 +262,23 @@ llvm::GetBitcodeSymbols(const char *BufPtr, unsigned Length,
   // the Module.
   return M;
 }
+
+// Get just the externally visible defined symbols from the bitcode without
+// copying the buffer or reading in any function bodies.
+bool llvm::GetBitcodeSymbolNames(StringRef Buffer, StringRef ModuleID,
+                                 LLVMContext& Context,
+                                 std::vector<std::string>& symbols,
+                                 std::string* ErrMsg) {
+  MemoryBuffer *MemBuf = MemoryBuffer::getMemBuffer(Buffer, ModuleID, false);
+  Module *M = getLazyBitcodeModule(MemBuf, Context, ErrMsg);
+  if (!M) {
+    delete MemBuf;
+    return true;
+  }
+
+  getSymbols(M, symbols);
+
+  // Deleting the module also deletes MemBuf, which it took ownership of.
+  delete M;
+  return false;
+}
@@ -81,6 +81,14 @@ namespace llvm {
                             LLVMContext& Context,
                             std::vector<std::string>& symbols,
                             std::string* ErrMsg);
+
+  // Get just the externally visible defined symbols from the bitcode in
+  // Buffer. Function bodies are not read and Buffer is not copied. Returns
+  // true on error.
+  bool GetBitcodeSymbolNames(StringRef Buffer, StringRef ModuleID,
+                             LLVMContext& Context,
+                             std::vector<std::string>& symbols,
+                             std::string* ErrMsg);
 }
 
 #endif
@@ -198,71 +198,115 @@ Archive::addFileBefore(const sys::Path& filePath, iterator where,
   return false;
 }
 
+// Map the contents of a member that is not already in memory.
+static bool getMemberContents(const ArchiveMember& member,
+                              OwningPtr<MemoryBuffer>& File,
+                              StringRef& Contents,
+                              std::string* ErrMsg) {
+  if (const char *data = (const char*)member.getData()) {
+    Contents = StringRef(data, member.getSize());
+    return false;
+  }
+  if (error_code ec = MemoryBuffer::getFile(member.getPath().c_str(), File)) {
+    if (ErrMsg)
+      *ErrMsg = ec.message();
+    return true;
+  }
+  Contents = File->getBuffer();
+  return false;
+}
+
+// Add the symbols defined by a bitcode member at offset filepos to the symbol
+// table.
+bool
+Archive::addMemberSymbols(const ArchiveMember& member, StringRef data,
+                          unsigned filepos, std::string* ErrMsg) {
+  std::vector<std::string> symbols;
+  std::string FullMemberName = archPath.str() + "(" + member.getPath().str()
+    + ")";
+  if (GetBitcodeSymbolNames(data, FullMemberName, Context, symbols, ErrMsg)) {
+    if (ErrMsg)
+      *ErrMsg = "Can't parse bitcode member: " + member.getPath().str()
+        + ": " + *ErrMsg;
+    return true;
+  }
+
+  for (std::vector<std::string>::iterator SI = symbols.begin(),
+       SE = symbols.end(); SI != SE; ++SI) {
+    std::pair<SymTabType::iterator,bool> Res =
+      symTab.insert(std::make_pair(*SI,filepos));
+
+    if (Res.second) {
+      symTabSize += SI->length() +
+                    numVbrBytes(SI->length()) +
+                    numVbrBytes(filepos);
+    }
+  }
+  return false;
+}
+
+// Build the symbol table before anything is written. The offsets in the
+// symbol table are relative to the first member following the symbol table,
+// so they can be computed from the member sizes alone. Only one member is
+// mapped at a time.
+bool
+Archive::buildSymbolTable(bool TruncateNames, std::string* ErrMsg) {
+  symTabSize = 0;
+  symTab.clear();
+
+  unsigned filepos = 0;
+  for (MembersList::iterator I = begin(), E = end(); I != E; ++I) {
+    size_t fSize = I->getSize();
+    if (I->isBitcode()) {
+      OwningPtr<MemoryBuffer> File;
+      StringRef data;
+      if (getMemberContents(*I, File, data, ErrMsg))
+        return true;
+      if (data.size() != fSize) {
+        if (ErrMsg)
+          *ErrMsg = "File changed while writing archive: " +
+            I->getPath().str();
+        return true;
+      }
+      if (addMemberSymbols(*I, data, filepos, ErrMsg))
+        return true;
+    }
+
+    ArchiveMemberHeader Hdr;
+    filepos += sizeof(Hdr);
+    if (fillHeader(*I, Hdr, fSize, TruncateNames))
+      filepos += I->getPath().str().length();
+    filepos += fSize;
+    filepos += filepos & 1;
+  }
+  return false;
+}
+
 // Write one member out to the file.
 bool
 Archive::writeMember(
   const ArchiveMember& member,
   std::ofstream& ARFile,
-  bool CreateSymbolTable,
   bool TruncateNames,
   std::string* ErrMsg
 ) {
-
-  unsigned filepos = ARFile.tellp();
-  filepos -= 8;
-
   // Get the data and its size either from the
   // member's in-memory data or directly from the file.
-  size_t fSize = member.getSize();
-  const char *data = (const char*)member.getData();
-  MemoryBuffer *mFile = 0;
-  if (!data) {
-    OwningPtr<MemoryBuffer> File;
-    if (error_code ec = MemoryBuffer::getFile(member.getPath().c_str(), File)) {
-      if (ErrMsg)
-        *ErrMsg = ec.message();
-      return true;
-    }
-    mFile = File.take();
-    data = mFile->getBufferStart();
-    fSize = mFile->getBufferSize();
-  }
+  OwningPtr<MemoryBuffer> File;
+  StringRef data;
+  if (getMemberContents(member, File, data, ErrMsg))
+    return true;
 
-  // Now that we have the data in memory, update the
-  // symbol table if it's a bitcode file.
-  if (CreateSymbolTable && member.isBitcode()) {
-    std::vector<std::string> symbols;
-    std::string FullMemberName = archPath.str() + "(" + member.getPath().str()
-      + ")";
-    Module* M =
-      GetBitcodeSymbols(data, fSize, FullMemberName, Context, symbols, ErrMsg);
-
-    // If the bitcode parsed successfully
-    if ( M ) {
-      for (std::vector<std::string>::iterator SI = symbols.begin(),
-           SE = symbols.end(); SI != SE; ++SI) {
-
-        std::pair<SymTabType::iterator,bool> Res =
-          symTab.insert(std::make_pair(*SI,filepos));
-
-        if (Res.second) {
-          symTabSize += SI->length() +
-                        numVbrBytes(SI->length()) +
-                        numVbrBytes(filepos);
-        }
-      }
-      // We don't need this module any more.
-      delete M;
-    } else {
-      delete mFile;
-      if (ErrMsg)
-        *ErrMsg = "Can't parse bitcode member: " + member.getPath().str()
-          + ": " + *ErrMsg;
-      return true;
-    }
+  // The symbol table offsets were computed from the size the member had when
+  // the table was built.
+  if (data.size() != member.getSize()) {
+    if (ErrMsg)
+      *ErrMsg = "File changed while writing archive: " +
+        member.getPath().str();
+    return true;
   }
 
-  int hdrSize = fSize;
+  int hdrSize = data.size();
 
   // Compute the fields of the header
   ArchiveMemberHeader Hdr;
@@ -277,15 +321,13 @@ Archive::writeMember(
                  member.getPath().str().length());
   }
 
-  // Write the (possibly compressed) member's content to the file.
-  ARFile.write(data,fSize);
+  // Write the member's content to the file.
+  ARFile.write(data.data(),data.size());
 
   // Make sure the member is an even length
   if ((ARFile.tellp() & 1) == 1)
     ARFile << ARFILE_PAD;
 
-  // Close the mapped file if it was opened
-  delete mFile;
   return false;
 }
 
@@ -346,8 +388,9 @@ Archive::writeSymbolTable(std::ofstream& ARFile) {
 
 // Write the entire archive to the file specified when the archive was created.
 // This writes to a temporary file first. Options are for creating a symbol
-// table, flattening the file names (no directories, 15 chars max) and
-// compressing each archive member.
+// table and flattening the file names (no directories, 15 chars max). The
+// symbol table is computed up front so that the archive can be written in a
+// single pass, with each member streamed from its mapped file.
 bool
 Archive::writeToDisk(bool CreateSymbolTable, bool TruncateNames,
                      std::string* ErrMsg)
@@ -360,6 +403,25 @@ Archive::writeToDisk(bool CreateSymbolTable, bool TruncateNames,
     return true;
   }
 
+  // Refresh the sizes of the members read from disk. Both the symbol table
+  // offsets and the check in writeMember use these sizes.
+  for (MembersList::iterator I = begin(), E = end(); I != E; ++I) {
+    if (I->getData())
+      continue;
+    uint64_t Size;
+    if (error_code ec = sys::fs::file_size(I->getPath().str(), Size)) {
+      if (ErrMsg)
+        *ErrMsg = ec.message();
+      return true;
+    }
+    I->info.fileSize = Size;
+  }
+
+  // If we're creating a symbol table, build it now so that it can be placed
+  // ahead of the members.
+  if (CreateSymbolTable && buildSymbolTable(TruncateNames, ErrMsg))
+    return true;
+
   // Create a temporary file to store the archive in
   sys::Path TmpArchive = archPath;
   if (TmpArchive.createTemporaryFileOnDisk(ErrMsg))
@@ -381,93 +443,43 @@ Archive::writeToDisk(bool CreateSymbolTable, bool TruncateNames,
     return true;
   }
 
-  // If we're creating a symbol table, reset it now
-  if (CreateSymbolTable) {
-    symTabSize = 0;
-    symTab.clear();
-  }
-
   // Write magic string to archive.
   ArchiveFile << ARFILE_MAGIC;
 
-  // Loop over all member files, and write them out. Note that this also
-  // builds the symbol table, symTab.
-  for (MembersList::iterator I = begin(), E = end(); I != E; ++I) {
-    if (writeMember(*I, ArchiveFile, CreateSymbolTable,
-                     TruncateNames, ErrMsg)) {
-      TmpArchive.eraseFromDisk();
-      ArchiveFile.close();
-      return true;
-    }
-  }
-
-  // Close archive file.
-  ArchiveFile.close();
-
-  // Write the symbol table
   if (CreateSymbolTable) {
-    // At this point we have written a file that is a legal archive but it
-    // doesn't have a symbol table in it. To aid in faster reading and to
-    // ensure compatibility with other archivers we need to put the symbol
-    // table first in the file. Unfortunately, this means mapping the file
-    // we just wrote back in and copying it to the destination file.
-    sys::Path FinalFilePath = archPath;
-
-    // Map in the archive we just wrote.
-    {
-    OwningPtr<MemoryBuffer> arch;
-    if (error_code ec = MemoryBuffer::getFile(TmpArchive.c_str(), arch)) {
-      if (ErrMsg)
-        *ErrMsg = ec.message();
-      return true;
-    }
-    const char* base = arch->getBufferStart();
-
-    // Open another temporary file in order to avoid invalidating the
-    // mmapped data
-    if (FinalFilePath.createTemporaryFileOnDisk(ErrMsg))
-      return true;
-    sys::RemoveFileOnSignal(FinalFilePath);
-
-    std::ofstream FinalFile(FinalFilePath.c_str(), io_mode);
-    if (!FinalFile.is_open() || FinalFile.bad()) {
-      TmpArchive.eraseFromDisk();
-      if (ErrMsg)
-        *ErrMsg = "Error opening archive file: " + FinalFilePath.str();
-      return true;
-    }
-
-    // Write the file magic number
-    FinalFile << ARFILE_MAGIC;
-
     // If there is a foreign symbol table, put it into the file now. Most
     // ar(1) implementations require the symbol table to be first but llvm-ar
     // can deal with it being after a foreign symbol table. This ensures
     // compatibility with other ar(1) implementations as well as allowing the
     // archive to store both native .o and LLVM .bc files, both indexed.
     if (foreignST) {
-      if (writeMember(*foreignST, FinalFile, false, false, ErrMsg)) {
-        FinalFile.close();
+      if (writeMember(*foreignST, ArchiveFile, false, ErrMsg)) {
+        ArchiveFile.close();
         TmpArchive.eraseFromDisk();
         return true;
       }
     }
 
     // Put out the LLVM symbol table now.
-    writeSymbolTable(FinalFile);
-
-    // Copy the temporary file contents being sure to skip the file's magic
-    // number.
-    FinalFile.write(base + sizeof(ARFILE_MAGIC)-1,
-      arch->getBufferSize()-sizeof(ARFILE_MAGIC)+1);
-
-    // Close up shop
-    FinalFile.close();
-    } // free arch.
+    writeSymbolTable(ArchiveFile);
+  }
 
-    // Move the final file over top of TmpArchive
-    if (FinalFilePath.renamePathOnDisk(TmpArchive, ErrMsg))
+  // Loop over all member files, and write them out.
+  for (MembersList::iterator I = begin(), E = end(); I != E; ++I) {
+    if (writeMember(*I, ArchiveFile, TruncateNames, ErrMsg)) {
+      ArchiveFile.close();
+      TmpArchive.eraseFromDisk();
       return true;
+    }
+  }
+
+  // Close archive file.
+  ArchiveFile.close();
+  if (ArchiveFile.fail()) {
+    TmpArchive.eraseFromDisk();
+    if (ErrMsg)
+      *ErrMsg = "Error writing archive file: " + archPath.str();
+    return true;
   }
 
   // Before we replace the actual archive, we need to forget all the
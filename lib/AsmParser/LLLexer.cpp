@@ -161,6 +161,7 @@ LLLexer::LLLexer(MemoryBuffer *StartBuf, SourceMgr &sm, SMDiagnostic &Err,
                  LLVMContext &C)
   : CurBuf(StartBuf), ErrorInfo(Err), SM(sm), Context(C), APFloatVal(0.0) {
   CurPtr = CurBuf->getBufferStart();
+  InitKeywords();
 }
 
 std::string LLLexer::getFilename() const {
@@ -210,7 +211,7 @@ lltok::Kind LLLexer::LexToken() {
   case '.':
     if (const char *Ptr = isLabelTail(CurPtr)) {
       CurPtr = Ptr;
-      StrVal.assign(TokStart, CurPtr-1);
+      StrVal = StringRef(TokStart, CurPtr-1-TokStart);
       return lltok::LabelStr;
     }
     if (CurPtr[0] == '.' && CurPtr[1] == '.') {
@@ -221,7 +222,7 @@ lltok::Kind LLLexer::LexToken() {
   case '$':
     if (const char *Ptr = isLabelTail(CurPtr)) {
       CurPtr = Ptr;
-      StrVal.assign(TokStart, CurPtr-1);
+      StrVal = StringRef(TokStart, CurPtr-1-TokStart);
       return lltok::LabelStr;
     }
     return lltok::Error;
@@ -273,8 +274,7 @@ lltok::Kind LLLexer::LexAt() {
         return lltok::Error;
       }
       if (CurChar == '"') {
-        StrVal.assign(TokStart+2, CurPtr-1);
-        UnEscapeLexed(StrVal);
+        SetUnescapedStrVal(TokStart+2, CurPtr-1);
         return lltok::GlobalVar;
       }
     }
@@ -299,6 +299,17 @@ lltok::Kind LLLexer::LexAt() {
   return lltok::Error;
 }
 
+/// SetUnescapedStrVal - Set the token value to the text from Start to End,
+/// with its \xx escapes expanded.  Text without escapes is not copied.
+void LLLexer::SetUnescapedStrVal(const char *Start, const char *End) {
+  StrVal = StringRef(Start, End-Start);
+  if (StrVal.find('\\') == StringRef::npos)
+    return;
+  StrStorage.assign(Start, End);
+  UnEscapeLexed(StrStorage);
+  StrVal = StrStorage;
+}
+
 /// ReadString - Read a string until the closing quote.
 lltok::Kind LLLexer::ReadString(lltok::Kind kind) {
   const char *Start = CurPtr;
@@ -310,8 +321,7 @@ lltok::Kind LLLexer::ReadString(lltok::Kind kind) {
       return lltok::Error;
     }
     if (CurChar == '"') {
-      StrVal.assign(Start, CurPtr-1);
-      UnEscapeLexed(StrVal);
+      SetUnescapedStrVal(Start, CurPtr-1);
       return kind;
     }
   }
@@ -329,7 +339,7 @@ bool LLLexer::ReadVarName() {
            CurPtr[0] == '.' || CurPtr[0] == '_')
       ++CurPtr;
 
-    StrVal.assign(NameStart, CurPtr);
+    StrVal = StringRef(NameStart, CurPtr-NameStart);
     return true;
   }
   return false;
@@ -395,8 +405,7 @@ lltok::Kind LLLexer::LexExclaim() {
            CurPtr[0] == '.' || CurPtr[0] == '_' || CurPtr[0] == '\\')
       ++CurPtr;
 
-    StrVal.assign(TokStart+1, CurPtr);   // Skip !
-    UnEscapeLexed(StrVal);
+    SetUnescapedStrVal(TokStart+1, CurPtr);   // Skip !
     return lltok::MetadataVar;
   }
   return lltok::exclaim;
@@ -420,56 +429,10 @@ lltok::Kind LLLexer::LexHash() {
   return lltok::Error;
 }
 
-/// LexIdentifier: Handle several related productions:
-///    Label           [-a-zA-Z$._0-9]+:
-///    IntegerType     i[0-9]+
-///    Keyword         sdiv, float, ...
-///    HexIntConstant  [us]0x[0-9A-Fa-f]+
-lltok::Kind LLLexer::LexIdentifier() {
-  const char *StartChar = CurPtr;
-  const char *IntEnd = CurPtr[-1] == 'i' ? 0 : StartChar;
-  const char *KeywordEnd = 0;
-
-  for (; isLabelChar(*CurPtr); ++CurPtr) {
-    // If we decide this is an integer, remember the end of the sequence.
-    if (!IntEnd && !isdigit(static_cast<unsigned char>(*CurPtr)))
-      IntEnd = CurPtr;
-    if (!KeywordEnd && !isalnum(static_cast<unsigned char>(*CurPtr)) &&
-        *CurPtr != '_')
-      KeywordEnd = CurPtr;
-  }
-
-  // If we stopped due to a colon, this really is a label.
-  if (*CurPtr == ':') {
-    StrVal.assign(StartChar-1, CurPtr++);
-    return lltok::LabelStr;
-  }
-
-  // Otherwise, this wasn't a label.  If this was valid as an integer type,
-  // return it.
-  if (IntEnd == 0) IntEnd = CurPtr;
-  if (IntEnd != StartChar) {
-    CurPtr = IntEnd;
-    uint64_t NumBits = atoull(StartChar, CurPtr);
-    if (NumBits < IntegerType::MIN_INT_BITS ||
-        NumBits > IntegerType::MAX_INT_BITS) {
-      Error("bitwidth for integer type out of range!");
-      return lltok::Error;
-    }
-    TyVal = IntegerType::get(Context, NumBits);
-    return lltok::Type;
-  }
-
-  // Otherwise, this was a letter sequence.  See which keyword this is.
-  if (KeywordEnd == 0) KeywordEnd = CurPtr;
-  CurPtr = KeywordEnd;
-  --StartChar;
-  unsigned Len = CurPtr-StartChar;
-#define KEYWORD(STR)                                                    \
-  do {                                                                  \
-    if (Len == strlen(#STR) && !memcmp(StartChar, #STR, strlen(#STR)))  \
-      return lltok::kw_##STR;                                           \
-  } while (0)
+/// InitKeywords - Fill in the table of keywords, which LexIdentifier looks
+/// letter sequences up in.
+void LLLexer::InitKeywords() {
+#define KEYWORD(STR) Keywords[#STR] = KeywordInfo(lltok::kw_##STR, 0, 0)
 
   KEYWORD(true);    KEYWORD(false);
   KEYWORD(declare); KEYWORD(define);
@@ -617,8 +580,7 @@ lltok::Kind LLLexer::LexIdentifier() {
 
   // Keywords for types.
 #define TYPEKEYWORD(STR, LLVMTY) \
-  if (Len == strlen(STR) && !memcmp(StartChar, STR, strlen(STR))) { \
-    TyVal = LLVMTY; return lltok::Type; }
+  Keywords[STR] = KeywordInfo(lltok::Type, 0, LLVMTY)
   TYPEKEYWORD("void",      Type::getVoidTy(Context));
   TYPEKEYWORD("half",      Type::getHalfTy(Context));
   TYPEKEYWORD("float",     Type::getFloatTy(Context));
@@ -633,8 +595,7 @@ lltok::Kind LLLexer::LexIdentifier() {
 
   // Keywords for instructions.
 #define INSTKEYWORD(STR, Enum) \
-  if (Len == strlen(#STR) && !memcmp(StartChar, #STR, strlen(#STR))) { \
-    UIntVal = Instruction::Enum; return lltok::kw_##STR; }
+  Keywords[#STR] = KeywordInfo(lltok::kw_##STR, Instruction::Enum, 0)
 
   INSTKEYWORD(add,   Add);  INSTKEYWORD(fadd,   FAdd);
   INSTKEYWORD(sub,   Sub);  INSTKEYWORD(fsub,   FSub);
@@ -684,6 +645,63 @@ lltok::Kind LLLexer::LexIdentifier() {
   INSTKEYWORD(insertvalue,    InsertValue);
   INSTKEYWORD(landingpad,     LandingPad);
 #undef INSTKEYWORD
+}
+
+/// LexIdentifier: Handle several related productions:
+///    Label           [-a-zA-Z$._0-9]+:
+///    IntegerType     i[0-9]+
+///    Keyword         sdiv, float, ...
+///    HexIntConstant  [us]0x[0-9A-Fa-f]+
+lltok::Kind LLLexer::LexIdentifier() {
+  const char *StartChar = CurPtr;
+  const char *IntEnd = CurPtr[-1] == 'i' ? 0 : StartChar;
+  const char *KeywordEnd = 0;
+
+  for (; isLabelChar(*CurPtr); ++CurPtr) {
+    // If we decide this is an integer, remember the end of the sequence.
+    if (!IntEnd && !isdigit(static_cast<unsigned char>(*CurPtr)))
+      IntEnd = CurPtr;
+    if (!KeywordEnd && !isalnum(static_cast<unsigned char>(*CurPtr)) &&
+        *CurPtr != '_')
+      KeywordEnd = CurPtr;
+  }
+
+  // If we stopped due to a colon, this really is a label.
+  if (*CurPtr == ':') {
+    StrVal = StringRef(StartChar-1, CurPtr-StartChar+1);
+    ++CurPtr;
+    return lltok::LabelStr;
+  }
+
+  // Otherwise, this wasn't a label.  If this was valid as an integer type,
+  // return it.
+  if (IntEnd == 0) IntEnd = CurPtr;
+  if (IntEnd != StartChar) {
+    CurPtr = IntEnd;
+    uint64_t NumBits = atoull(StartChar, CurPtr);
+    if (NumBits < IntegerType::MIN_INT_BITS ||
+        NumBits > IntegerType::MAX_INT_BITS) {
+      Error("bitwidth for integer type out of range!");
+      return lltok::Error;
+    }
+    TyVal = IntegerType::get(Context, NumBits);
+    return lltok::Type;
+  }
+
+  // Otherwise, this was a letter sequence.  See which keyword this is.
+  if (KeywordEnd == 0) KeywordEnd = CurPtr;
+  CurPtr = KeywordEnd;
+  --StartChar;
+  StringMap<KeywordInfo>::const_iterator KI =
+    Keywords.find(StringRef(StartChar, CurPtr-StartChar));
+  if (KI != Keywords.end()) {
+    const KeywordInfo &Info = KI->getValue();
+    if (Info.Kind == lltok::Type)
+      TyVal = Info.Ty;
+    else if (Info.Opcode)
+      UIntVal = Info.Opcode;
+    return Info.Kind;
+  }
 
   // Check for [us]0x[0-9A-Fa-f]+ which are Hexadecimal constant generated by
   // the CFE to avoid forcing it to deal with 64-bit numbers.
@@ -786,7 +804,7 @@ lltok::Kind LLLexer::LexDigitOrNegative() {
       !isdigit(static_cast<unsigned char>(CurPtr[0]))) {
     // Okay, this is not a number after the -, it's probably a label.
     if (const char *End = isLabelTail(CurPtr)) {
-      StrVal.assign(TokStart, End-1);
+      StrVal = StringRef(TokStart, End-1-TokStart);
       CurPtr = End;
       return lltok::LabelStr;
     }
@@ -803,7 +821,7 @@ lltok::Kind LLLexer::LexDigitOrNegative() {
   // Check to see if this really is a label afterall, e.g. "-1:".
   if (isLabelChar(CurPtr[0]) || CurPtr[0] == ':') {
     if (const char *End = isLabelTail(CurPtr)) {
-      StrVal.assign(TokStart, End-1);
+      StrVal = StringRef(TokStart, End-1-TokStart);
       CurPtr = End;
       return lltok::LabelStr;
     }
@@ -17,6 +17,8 @@
 #include "LLToken.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/SourceMgr.h"
 #include <string>
 
@@ -33,15 +35,29 @@ namespace llvm {
     SourceMgr &SM;
     LLVMContext &Context;
 
-    // Information about the current token.
+    // Information about the current token.  StrVal points into the buffer,
+    // or into StrStorage if escapes had to be expanded.
     const char *TokStart;
     lltok::Kind CurKind;
-    std::string StrVal;
+    StringRef StrVal;
+    std::string StrStorage;
     unsigned UIntVal;
     Type *TyVal;
     APFloat APFloatVal;
     APSInt  APSIntVal;
 
+    /// KeywordInfo - What a keyword lexes to.  Type keywords set TyVal and
+    /// instruction keywords set UIntVal to their opcode.
+    struct KeywordInfo {
+      lltok::Kind Kind;
+      unsigned Opcode;
+      Type *Ty;
+      KeywordInfo() : Kind(lltok::Error), Opcode(0), Ty(0) {}
+      KeywordInfo(lltok::Kind K, unsigned Op, Type *T)
+        : Kind(K), Opcode(Op), Ty(T) {}
+    };
+    StringMap<KeywordInfo> Keywords;
+
   public:
     explicit LLLexer(MemoryBuffer *StartBuf, SourceMgr &SM, SMDiagnostic &,
                      LLVMContext &C);
@@ -54,7 +70,7 @@ namespace llvm {
     typedef SMLoc LocTy;
     LocTy getLoc() const { return SMLoc::getFromPointer(TokStart); }
     lltok::Kind getKind() const { return CurKind; }
-    const std::string &getStrVal() const { return StrVal; }
+    StringRef getStrVal() const { return StrVal; }
     Type *getTyVal() const { return TyVal; }
     unsigned getUIntVal() const { return UIntVal; }
     const APSInt &getAPSIntVal() const { return APSIntVal; }
@@ -67,9 +83,11 @@ namespace llvm {
 
   private:
     lltok::Kind LexToken();
+    void InitKeywords();
 
     int getNextChar();
     void SkipLineComment();
+    void SetUnescapedStrVal(const char *Start, const char *End);
     lltok::Kind ReadString(lltok::Kind kind);
     bool ReadVarName();
 
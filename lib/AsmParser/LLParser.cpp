@@ -24,6 +24,7 @@
 #include "llvm/IR/ValueSymbolTable.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 using namespace llvm;
 
 static std::string getTypeString(Type *T) {
@@ -33,6 +34,19 @@ static std::string getTypeString(Type *T) {
   return Tmp.str();
 }
 
+/// getFirstForwardRef - Return the entry of a forward reference table whose
+/// reference comes first in the file.  The tables are hashed, this keeps the
+/// diagnostic for several undefined values independent of the hash order.
+template <typename MapTy>
+static typename MapTy::const_iterator getFirstForwardRef(const MapTy &Map) {
+  typename MapTy::const_iterator First = Map.begin();
+  for (typename MapTy::const_iterator I = Map.begin(), E = Map.end(); I != E;
+       ++I)
+    if (I->second.second.getPointer() < First->second.second.getPointer())
+      First = I;
+  return First;
+}
+
 /// Run: module ::= toplevelentity*
 bool LLParser::Run() {
   // Prime the lexer.
@@ -125,27 +139,41 @@ bool LLParser::ValidateEndOfModule() {
   }
 
   // If there are entries in ForwardRefBlockAddresses at this point, they are
-  // references after the function was defined.  Resolve those now.
-  while (!ForwardRefBlockAddresses.empty()) {
-    // Okay, we are referencing an already-parsed function, resolve them now.
+  // references after the function was defined.  Resolve those now, in the
+  // order of the first reference to each function.
+  typedef std::pair<Function*, BlockAddressRefs*> FunctionRefs;
+  std::vector<std::pair<const char*, FunctionRefs> > PendingBlockAddresses;
+  for (StringMap<BlockAddressRefs>::iterator
+         I = ForwardRefBlockAddresses.begin(),
+         E = ForwardRefBlockAddresses.end(); I != E; ++I)
+    PendingBlockAddresses.push_back(
+      std::make_pair(I->second.FnLoc.getPointer(),
+                     FunctionRefs(M->getFunction(I->getKey()), &I->second)));
+  for (DenseMap<unsigned, BlockAddressRefs>::iterator
+         I = ForwardRefBlockAddressIDs.begin(),
+         E = ForwardRefBlockAddressIDs.end(); I != E; ++I) {
     Function *TheFn = 0;
-    const ValID &Fn = ForwardRefBlockAddresses.begin()->first;
-    if (Fn.Kind == ValID::t_GlobalName)
-      TheFn = M->getFunction(Fn.StrVal);
-    else if (Fn.UIntVal < NumberedVals.size())
-      TheFn = dyn_cast<Function>(NumberedVals[Fn.UIntVal]);
+    if (I->first < NumberedVals.size())
+      TheFn = dyn_cast<Function>(NumberedVals[I->first]);
+    PendingBlockAddresses.push_back(
+      std::make_pair(I->second.FnLoc.getPointer(),
+                     FunctionRefs(TheFn, &I->second)));
+  }
+  std::sort(PendingBlockAddresses.begin(), PendingBlockAddresses.end());
 
+  for (unsigned i = 0, e = PendingBlockAddresses.size(); i != e; ++i) {
+    // Okay, we are referencing an already-parsed function, resolve them now.
+    Function *TheFn = PendingBlockAddresses[i].second.first;
+    BlockAddressRefs &Refs = *PendingBlockAddresses[i].second.second;
     if (TheFn == 0)
-      return Error(Fn.Loc, "unknown function referenced by blockaddress");
+      return Error(Refs.FnLoc, "unknown function referenced by blockaddress");
 
     // Resolve all these references.
-    if (ResolveForwardRefBlockAddresses(TheFn,
-                                      ForwardRefBlockAddresses.begin()->second,
-                                        0))
+    if (ResolveForwardRefBlockAddresses(TheFn, Refs.Refs, 0))
       return true;
-
-    ForwardRefBlockAddresses.erase(ForwardRefBlockAddresses.begin());
   }
+  ForwardRefBlockAddresses.clear();
+  ForwardRefBlockAddressIDs.clear();
 
   for (unsigned i = 0, e = NumberedTypes.size(); i != e; ++i)
     if (NumberedTypes[i].second.isValid())
@@ -158,15 +186,19 @@ bool LLParser::ValidateEndOfModule() {
       return Error(I->second.second,
                    "use of undefined type named '" + I->getKey() + "'");
 
-  if (!ForwardRefVals.empty())
-    return Error(ForwardRefVals.begin()->second.second,
-                 "use of undefined value '@" + ForwardRefVals.begin()->first +
-                 "'");
+  if (!ForwardRefVals.empty()) {
+    StringMap<std::pair<GlobalValue*, LocTy> >::const_iterator I =
+      getFirstForwardRef(ForwardRefVals);
+    return Error(I->second.second,
+                 "use of undefined value '@" + I->getKey() + "'");
+  }
 
-  if (!ForwardRefValIDs.empty())
-    return Error(ForwardRefValIDs.begin()->second.second,
-                 "use of undefined value '@" +
-                 Twine(ForwardRefValIDs.begin()->first) + "'");
+  if (!ForwardRefValIDs.empty()) {
+    DenseMap<unsigned, std::pair<GlobalValue*, LocTy> >::const_iterator I =
+      getFirstForwardRef(ForwardRefValIDs);
+    return Error(I->second.second,
+                 "use of undefined value '@" + Twine(I->first) + "'");
+  }
 
   if (!ForwardRefMDNodes.empty())
     return Error(ForwardRefMDNodes.begin()->second.second,
@@ -665,7 +697,7 @@ bool LLParser::ParseAlias(const std::string &Name, LocTy NameLoc,
   if (GlobalValue *Val = M->getNamedValue(Name)) {
     // See if this was a redefinition.  If so, there is no entry in
     // ForwardRefVals.
-    std::map<std::string, std::pair<GlobalValue*, LocTy> >::iterator
+    StringMap<std::pair<GlobalValue*, LocTy> >::iterator
       I = ForwardRefVals.find(Name);
     if (I == ForwardRefVals.end())
       return Error(NameLoc, "redefinition of global named '@" + Name + "'");
@@ -745,7 +777,7 @@ bool LLParser::ParseGlobal(const std::string &Name, LocTy NameLoc,
       GV = cast<GlobalVariable>(GVal);
     }
   } else {
-    std::map<unsigned, std::pair<GlobalValue*, LocTy> >::iterator
+    DenseMap<unsigned, std::pair<GlobalValue*, LocTy> >::iterator
       I = ForwardRefValIDs.find(NumberedVals.size());
     if (I != ForwardRefValIDs.end()) {
       GV = cast<GlobalVariable>(I->second.first);
@@ -978,7 +1010,7 @@ GlobalValue *LLParser::GetGlobalVal(const std::string &Name, Type *Ty,
   // If this is a forward reference for the value, see if we already created a
   // forward ref record.
   if (Val == 0) {
-    std::map<std::string, std::pair<GlobalValue*, LocTy> >::iterator
+    StringMap<std::pair<GlobalValue*, LocTy> >::iterator
       I = ForwardRefVals.find(Name);
     if (I != ForwardRefVals.end())
       Val = I->second.first;
@@ -1018,7 +1050,7 @@ GlobalValue *LLParser::GetGlobalVal(unsigned ID, Type *Ty, LocTy Loc) {
   // If this is a forward reference for the value, see if we already created a
   // forward ref record.
   if (Val == 0) {
-    std::map<unsigned, std::pair<GlobalValue*, LocTy> >::iterator
+    DenseMap<unsigned, std::pair<GlobalValue*, LocTy> >::iterator
       I = ForwardRefValIDs.find(ID);
     if (I != ForwardRefValIDs.end())
       Val = I->second.first;
@@ -1958,7 +1990,7 @@ LLParser::PerFunctionState::PerFunctionState(LLParser &p, Function &f,
 
 LLParser::PerFunctionState::~PerFunctionState() {
   // If there were any forward referenced non-basicblock values, delete them.
-  for (std::map<std::string, std::pair<Value*, LocTy> >::iterator
+  for (StringMap<std::pair<Value*, LocTy> >::iterator
        I = ForwardRefVals.begin(), E = ForwardRefVals.end(); I != E; ++I)
     if (!isa<BasicBlock>(I->second.first)) {
       I->second.first->replaceAllUsesWith(
@@ -1967,7 +1999,7 @@ LLParser::PerFunctionState::~PerFunctionState() {
       I->second.first = 0;
     }
 
-  for (std::map<unsigned, std::pair<Value*, LocTy> >::iterator
+  for (DenseMap<unsigned, std::pair<Value*, LocTy> >::iterator
        I = ForwardRefValIDs.begin(), E = ForwardRefValIDs.end(); I != E; ++I)
     if (!isa<BasicBlock>(I->second.first)) {
       I->second.first->replaceAllUsesWith(
@@ -1979,35 +2011,40 @@ LLParser::PerFunctionState::~PerFunctionState() {
 
 bool LLParser::PerFunctionState::FinishFunction() {
   // Check to see if someone took the address of labels in this block.
-  if (!P.ForwardRefBlockAddresses.empty()) {
-    ValID FunctionID;
-    if (!F.getName().empty()) {
-      FunctionID.Kind = ValID::t_GlobalName;
-      FunctionID.StrVal = F.getName();
-    } else {
-      FunctionID.Kind = ValID::t_GlobalID;
-      FunctionID.UIntVal = FunctionNumber;
-    }
-
-    std::map<ValID, std::vector<std::pair<ValID, GlobalValue*> > >::iterator
-      FRBAI = P.ForwardRefBlockAddresses.find(FunctionID);
+  if (!F.getName().empty()) {
+    StringMap<BlockAddressRefs>::iterator
+      FRBAI = P.ForwardRefBlockAddresses.find(F.getName());
     if (FRBAI != P.ForwardRefBlockAddresses.end()) {
       // Resolve all these references.
-      if (P.ResolveForwardRefBlockAddresses(&F, FRBAI->second, this))
+      if (P.ResolveForwardRefBlockAddresses(&F, FRBAI->second.Refs, this))
         return true;
 
       P.ForwardRefBlockAddresses.erase(FRBAI);
     }
+  } else {
+    DenseMap<unsigned, BlockAddressRefs>::iterator
+      FRBAI = P.ForwardRefBlockAddressIDs.find(FunctionNumber);
+    if (FRBAI != P.ForwardRefBlockAddressIDs.end()) {
+      // Resolve all these references.
+      if (P.ResolveForwardRefBlockAddresses(&F, FRBAI->second.Refs, this))
+        return true;
+
+      P.ForwardRefBlockAddressIDs.erase(FRBAI);
+    }
   }
 
-  if (!ForwardRefVals.empty())
-    return P.Error(ForwardRefVals.begin()->second.second,
-                   "use of undefined value '%" + ForwardRefVals.begin()->first +
-                   "'");
-  if (!ForwardRefValIDs.empty())
-    return P.Error(ForwardRefValIDs.begin()->second.second,
-                   "use of undefined value '%" +
-                   Twine(ForwardRefValIDs.begin()->first) + "'");
+  if (!ForwardRefVals.empty()) {
+    StringMap<std::pair<Value*, LocTy> >::const_iterator I =
+      getFirstForwardRef(ForwardRefVals);
+    return P.Error(I->second.second,
+                   "use of undefined value '%" + I->getKey() + "'");
+  }
+  if (!ForwardRefValIDs.empty()) {
+    DenseMap<unsigned, std::pair<Value*, LocTy> >::const_iterator I =
+      getFirstForwardRef(ForwardRefValIDs);
+    return P.Error(I->second.second,
+                   "use of undefined value '%" + Twine(I->first) + "'");
+  }
   return false;
 }
 
@@ -2023,7 +2060,7 @@ Value *LLParser::PerFunctionState::GetVal(const std::string &Name,
   // If this is a forward reference for the value, see if we already created a
   // forward ref record.
   if (Val == 0) {
-    std::map<std::string, std::pair<Value*, LocTy> >::iterator
+    StringMap<std::pair<Value*, LocTy> >::iterator
       I = ForwardRefVals.find(Name);
     if (I != ForwardRefVals.end())
       Val = I->second.first;
@@ -2065,7 +2102,7 @@ Value *LLParser::PerFunctionState::GetVal(unsigned ID, Type *Ty,
   // If this is a forward reference for the value, see if we already created a
   // forward ref record.
   if (Val == 0) {
-    std::map<unsigned, std::pair<Value*, LocTy> >::iterator
+    DenseMap<unsigned, std::pair<Value*, LocTy> >::iterator
       I = ForwardRefValIDs.find(ID);
     if (I != ForwardRefValIDs.end())
       Val = I->second.first;
@@ -2121,7 +2158,7 @@ bool LLParser::PerFunctionState::SetInstName(int NameID,
       return P.Error(NameLoc, "instruction expected to be numbered '%" +
                      Twine(NumberedVals.size()) + "'");
 
-    std::map<unsigned, std::pair<Value*, LocTy> >::iterator FI =
+    DenseMap<unsigned, std::pair<Value*, LocTy> >::iterator FI =
       ForwardRefValIDs.find(NameID);
     if (FI != ForwardRefValIDs.end()) {
       if (FI->second.first->getType() != Inst->getType())
@@ -2137,7 +2174,7 @@ bool LLParser::PerFunctionState::SetInstName(int NameID,
   }
 
   // Otherwise, the instruction had a name.  Resolve forward refs and set it.
-  std::map<std::string, std::pair<Value*, LocTy> >::iterator
+  StringMap<std::pair<Value*, LocTy> >::iterator
     FI = ForwardRefVals.find(NameStr);
   if (FI != ForwardRefVals.end()) {
     if (FI->second.first->getType() != Inst->getType())
@@ -2390,7 +2427,12 @@ bool LLParser::ParseValID(ValID &ID, PerFunctionState *PFS) {
     GlobalVariable *FwdRef = new GlobalVariable(*M, Type::getInt8Ty(Context),
                                            false, GlobalValue::InternalLinkage,
                                                 0, "");
-    ForwardRefBlockAddresses[Fn].push_back(std::make_pair(Label, FwdRef));
+    BlockAddressRefs &Refs = Fn.Kind == ValID::t_GlobalName ?
+      ForwardRefBlockAddresses[Fn.StrVal] :
+      ForwardRefBlockAddressIDs[Fn.UIntVal];
+    if (Refs.Refs.empty())
+      Refs.FnLoc = Fn.Loc;
+    Refs.Refs.push_back(std::make_pair(Label, FwdRef));
     ID.ConstantVal = FwdRef;
     ID.Kind = ValID::t_Constant;
     return false;
@@ -3045,7 +3087,7 @@ bool LLParser::ParseFunctionHeader(Function *&Fn, bool isDefine) {
   if (!FunctionName.empty()) {
     // If this was a definition of a forward reference, remove the definition
     // from the forward reference table and fill in the forward ref.
-    std::map<std::string, std::pair<GlobalValue*, LocTy> >::iterator FRVI =
+    StringMap<std::pair<GlobalValue*, LocTy> >::iterator FRVI =
       ForwardRefVals.find(FunctionName);
     if (FRVI != ForwardRefVals.end()) {
       Fn = M->getFunction(FunctionName);
@@ -3068,7 +3110,7 @@ bool LLParser::ParseFunctionHeader(Function *&Fn, bool isDefine) {
   } else {
     // If this is a definition of a forward referenced function, make sure the
     // types agree.
-    std::map<unsigned, std::pair<GlobalValue*, LocTy> >::iterator I
+    DenseMap<unsigned, std::pair<GlobalValue*, LocTy> >::iterator I
       = ForwardRefValIDs.find(NumberedVals.size());
     if (I != ForwardRefValIDs.end()) {
       Fn = cast<Function>(I->second.first);
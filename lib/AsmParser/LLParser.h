@@ -116,14 +116,19 @@ namespace llvm {
     std::map<unsigned, std::pair<TrackingVH<MDNode>, LocTy> > ForwardRefMDNodes;
 
     // Global Value reference information.
-    std::map<std::string, std::pair<GlobalValue*, LocTy> > ForwardRefVals;
-    std::map<unsigned, std::pair<GlobalValue*, LocTy> > ForwardRefValIDs;
+    StringMap<std::pair<GlobalValue*, LocTy> > ForwardRefVals;
+    DenseMap<unsigned, std::pair<GlobalValue*, LocTy> > ForwardRefValIDs;
     std::vector<GlobalValue*> NumberedVals;
 
-    // References to blockaddress.  The key is the function ValID, the value is
-    // a list of references to blocks in that function.
-    std::map<ValID, std::vector<std::pair<ValID, GlobalValue*> > >
-      ForwardRefBlockAddresses;
+    // References to blockaddress.  The key is the name or number of the
+    // function, the value is the location of the first reference to the
+    // function and a list of references to blocks in that function.
+    struct BlockAddressRefs {
+      LocTy FnLoc;
+      std::vector<std::pair<ValID, GlobalValue*> > Refs;
+    };
+    StringMap<BlockAddressRefs> ForwardRefBlockAddresses;
+    DenseMap<unsigned, BlockAddressRefs> ForwardRefBlockAddressIDs;
 
     // Attribute builder reference information.
     std::map<Value*, std::vector<unsigned> > ForwardRefAttrGroups;
@@ -263,8 +268,8 @@ namespace llvm {
     class PerFunctionState {
       LLParser &P;
       Function &F;
-      std::map<std::string, std::pair<Value*, LocTy> > ForwardRefVals;
-      std::map<unsigned, std::pair<Value*, LocTy> > ForwardRefValIDs;
+      StringMap<std::pair<Value*, LocTy> > ForwardRefVals;
+      DenseMap<unsigned, std::pair<Value*, LocTy> > ForwardRefValIDs;
       std::vector<Value*> NumberedVals;
 
       /// FunctionNumber - If this is an unnamed function, this is the slot
@@ -1469,6 +1469,66 @@ bool BitcodeReader::RememberAndSkipFunctionBody() {
   return false;
 }
 
+/// ParseFunctionIndex - Read the FUNCTION_INDEX_BLOCK at the specified word
+/// offset, which records the position of each function body, and return to the
+/// current position.
+bool BitcodeReader::ParseFunctionIndex(uint64_t IndexWordOffset) {
+  uint64_t CurBit = Stream.GetCurrentBitNo();
+  if (!Stream.canSkipToPos(IndexWordOffset * 4))
+    return Error("Invalid function index offset");
+  Stream.JumpToBit(IndexWordOffset * 32);
+
+  BitstreamEntry Entry = Stream.advance();
+  if (Entry.Kind != BitstreamEntry::SubBlock ||
+      Entry.ID != bitc::FUNCTION_INDEX_BLOCK_ID)
+    return Error("Function index offset does not point at the index");
+  if (Stream.EnterSubBlock(bitc::FUNCTION_INDEX_BLOCK_ID))
+    return Error("Malformed block record");
+
+  SmallVector<uint64_t, 3> Record;
+
+  // Read all the records for this function index.
+  while (1) {
+    BitstreamEntry Entry = Stream.advanceSkippingSubblocks();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::SubBlock: // Handled for us already.
+    case BitstreamEntry::Error:
+      return Error("Malformed function index");
+    case BitstreamEntry::EndBlock:
+      Stream.JumpToBit(CurBit);
+      UseFunctionIndex = true;
+      return false;
+    case BitstreamEntry::Record:
+      // The interesting case.
+      break;
+    }
+
+    // Read a record.
+    Record.clear();
+    switch (Stream.readRecord(Entry.ID, Record)) {
+    default:  // Default behavior: unknown type.
+      break;
+    case bitc::FNINDEX_CODE_ENTRY: { // ENTRY: [valueid, bitoffset, bitsize]
+      if (Record.size() < 3)
+        return Error("Invalid FNINDEX_CODE_ENTRY record");
+      Function *F = 0;
+      if (Record[0] < ValueList.size())
+        F = dyn_cast_or_null<Function>(ValueList[Record[0]]);
+      if (!F)
+        return Error("Invalid function in function index");
+      // Check that the whole block is in the stream, without reading it.
+      uint64_t EndBit = Record[1] + Record[2];
+      if (Record[1] == 0 || EndBit < Record[1] ||
+          !Stream.canSkipToPos((EndBit + 7) / 8))
+        return Error("Invalid function body position");
+      DeferredFunctionInfo[F] = Record[1];
+      break;
+    }
+    }
+  }
+}
+
 bool BitcodeReader::GlobalCleanup() {
   // Patch the initializers for globals and aliases up.
   ResolveGlobalAndAliasInits();
@@ -1561,6 +1621,19 @@ bool BitcodeReader::ParseModule(bool Resume) {
           SeenFirstFunctionBody = true;
         }
 
+        // With a function index, the position of every body is known, and
+        // the module has nothing else after them.  Stop parsing here; the
+        // bodies are read from their indexed positions when materialized.
+        if (UseFunctionIndex) {
+          if (DeferredFunctionInfo.size() != FunctionsWithBodies.size())
+            return Error("Function index does not match the function bodies");
+          for (unsigned i = 0, e = FunctionsWithBodies.size(); i != e; ++i)
+            if (!DeferredFunctionInfo.count(FunctionsWithBodies[i]))
+              return Error("Function body missing from the function index");
+          std::vector<Function*>().swap(FunctionsWithBodies);
+          return false;
+        }
+
         if (RememberAndSkipFunctionBody())
           return true;
         // For streaming bitcode, suspend parsing when we reach the function
@@ -1770,6 +1843,14 @@ bool BitcodeReader::ParseModule(bool Resume) {
       AliasInits.push_back(std::make_pair(NewGA, Record[1]));
       break;
     }
+    /// MODULE_CODE_FNINDEXOFFSET: [offset]
+    case bitc::MODULE_CODE_FNINDEXOFFSET:
+      if (Record.size() < 1)
+        return Error("Invalid MODULE_CODE_FNINDEXOFFSET record");
+      // A streaming reader finds the bodies as they arrive instead.
+      if (!LazyStreamer && ParseFunctionIndex(Record[0]))
+        return true;
+      break;
     /// MODULE_CODE_PURGEVALS: [numvals]
     case bitc::MODULE_CODE_PURGEVALS:
       // Trim down the value list to the specified size.
@@ -1825,7 +1906,7 @@ bool BitcodeReader::ParseBitcodeInto(Module *M) {
         TheModule = M;
         if (ParseModule(false))
           return true;
-        if (LazyStreamer) return false;
+        if (LazyStreamer || UseFunctionIndex) return false;
         break;
       default:
         if (Stream.SkipBlock())
@@ -2895,6 +2976,17 @@ bool BitcodeReader::Materialize(GlobalValue *GV, std::string *ErrInfo) {
   // Move the bit stream to the saved position of the deferred function body.
   Stream.JumpToBit(DFII->second);
 
+  // Positions from the function index are those of the block headers.
+  if (UseFunctionIndex) {
+    BitstreamEntry Entry = Stream.advance();
+    if (Entry.Kind != BitstreamEntry::SubBlock ||
+        Entry.ID != bitc::FUNCTION_BLOCK_ID) {
+      Error("Function index does not point at a function body");
+      if (ErrInfo) *ErrInfo = ErrorString;
+      return true;
+    }
+  }
+
   if (ParseFunctionBody(F)) {
     if (ErrInfo) *ErrInfo = ErrorString;
     return true;
@@ -177,6 +177,12 @@ class BitcodeReader : public GVMaterializer {
   /// stream.
   DenseMap<Function*, uint64_t> DeferredFunctionInfo;
 
+  /// UseFunctionIndex - True if DeferredFunctionInfo was read from the
+  /// FUNCTION_INDEX_BLOCK of the module.  Its positions are then those of the
+  /// function blocks themselves, rather than past their ENTER_SUBBLOCK
+  /// headers, and the module is not parsed beyond the first function block.
+  bool UseFunctionIndex;
+
   /// BlockAddrFwdRefs - These are blockaddr references to basic blocks.  These
   /// are resolved lazily when functions are loaded.
   typedef std::pair<unsigned, GlobalVariable*> BlockAddrRefTy;
@@ -196,13 +202,15 @@ public:
     : Context(C), TheModule(0), Buffer(buffer), BufferOwned(false),
       LazyStreamer(0), NextUnreadBit(0), SeenValueSymbolTable(false),
       ErrorString(0), ValueList(C), MDValueList(C),
-      SeenFirstFunctionBody(false), UseRelativeIDs(false) {
+      SeenFirstFunctionBody(false), UseFunctionIndex(false),
+      UseRelativeIDs(false) {
   }
   explicit BitcodeReader(DataStreamer *streamer, LLVMContext &C)
     : Context(C), TheModule(0), Buffer(0), BufferOwned(false),
       LazyStreamer(streamer), NextUnreadBit(0), SeenValueSymbolTable(false),
       ErrorString(0), ValueList(C), MDValueList(C),
-      SeenFirstFunctionBody(false), UseRelativeIDs(false) {
+      SeenFirstFunctionBody(false), UseFunctionIndex(false),
+      UseRelativeIDs(false) {
   }
   ~BitcodeReader() {
     FreeState();
@@ -330,6 +338,7 @@ private:
   bool ParseValueSymbolTable();
   bool ParseConstants();
   bool RememberAndSkipFunctionBody();
+  bool ParseFunctionIndex(uint64_t IndexWordOffset);
   bool ParseFunctionBody(Function *F);
   bool GlobalCleanup();
   bool ResolveGlobalAndAliasInits();
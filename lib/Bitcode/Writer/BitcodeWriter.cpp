@@ -23,10 +23,12 @@
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Operator.h"
 #include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/Support/Atomic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cctype>
 #include <map>
@@ -38,6 +40,19 @@ EnablePreserveUseListOrdering("enable-bc-uselist-preserve",
                                        "use-list order preservation."),
                               cl::init(false), cl::Hidden);
 
+static cl::opt<unsigned>
+BitcodeWriterThreads("bitcode-writer-threads",
+                     cl::desc("Number of threads used to encode function "
+                              "bodies (default = 1)"),
+                     cl::init(1), cl::Hidden);
+
+static cl::opt<bool>
+EmitFunctionIndex("bitcode-function-index",
+                  cl::desc("Emit an index of the function bodies, so that "
+                           "lazy readers can find them without scanning "
+                           "the module"),
+                  cl::init(false), cl::Hidden);
+
 /// These are manifest constants used by the bitcode writer. They do not need to
 /// be kept in sync with the reader, but need to be consistent within this file.
 enum {
@@ -1859,8 +1874,148 @@ static void WriteModuleUseLists(const Module *M, ValueEnumerator &VE,
   Stream.ExitBlock();
 }
 
-/// WriteModule - Emit the specified module to the bitstream.
-static void WriteModule(const Module *M, BitstreamWriter &Stream) {
+namespace {
+/// FunctionIndexEntry - The bits of the stream occupied by the block of a
+/// function body.
+struct FunctionIndexEntry {
+  const Function *F;
+  uint64_t StartBit, EndBit;
+  FunctionIndexEntry(const Function *F, uint64_t StartBit, uint64_t EndBit)
+    : F(F), StartBit(StartBit), EndBit(EndBit) {}
+};
+
+/// FunctionBlockEncoder - The state shared by the threads encoding a batch of
+/// function blocks.  Each thread incorporates the functions into its own
+/// ValueEnumerator and writes each block to a buffer of its own.
+struct FunctionBlockEncoder {
+  const BitstreamWriter *Stream;
+  std::vector<ValueEnumerator*> Enumerators;
+  ArrayRef<const Function*> Functions;
+  std::vector<SmallVector<char, 0> > Buffers;
+  volatile sys::cas_flag NextFunction;
+};
+}
+
+static void EncodeFunctionBlocks(void *Data, unsigned Thread) {
+  FunctionBlockEncoder &Encoder = *static_cast<FunctionBlockEncoder*>(Data);
+  ValueEnumerator &VE = *Encoder.Enumerators[Thread];
+  for (;;) {
+    unsigned i = sys::AtomicIncrement(&Encoder.NextFunction) - 1;
+    if (i >= Encoder.Functions.size())
+      break;
+    BitstreamWriter FunctionStream(Encoder.Buffers[i]);
+    FunctionStream.CopyBlockInfo(*Encoder.Stream);
+    WriteFunction(*Encoder.Functions[i], VE, FunctionStream);
+  }
+}
+
+/// WriteFunctionsInParallel - Emit the function bodies of the module, encoding
+/// them on several threads.  The blocks are emitted in the module order, so
+/// the result is the same as when they are written one by one.  If \p Index is
+/// not null, the position of each block is appended to it.
+static void WriteFunctionsInParallel(const Module *M, ValueEnumerator &VE,
+                                     BitstreamWriter &Stream,
+                                     unsigned NumThreads,
+                                     std::vector<FunctionIndexEntry> *Index) {
+  // Functions are encoded in batches, to bound the memory used to hold the
+  // encoded blocks.
+  const unsigned FunctionsPerBatch = 1024;
+
+  std::vector<const Function*> Functions;
+  for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Functions.push_back(F);
+  if (Functions.empty())
+    return;
+  NumThreads = std::min<unsigned>(NumThreads, Functions.size());
+
+  FunctionBlockEncoder Encoder;
+  Encoder.Stream = &Stream;
+  Encoder.Enumerators.push_back(&VE);
+  for (unsigned i = 1; i < NumThreads; ++i)
+    Encoder.Enumerators.push_back(new ValueEnumerator(VE));
+  Encoder.Buffers.resize(std::min<unsigned>(FunctionsPerBatch,
+                                            Functions.size()));
+
+  for (unsigned Begin = 0, E = Functions.size(); Begin != E;) {
+    unsigned NumFunctions = std::min(FunctionsPerBatch, E - Begin);
+    Encoder.Functions = makeArrayRef(&Functions[Begin], NumFunctions);
+    Encoder.NextFunction = 0;
+    llvm_parallel_for(NumThreads, EncodeFunctionBlocks, &Encoder, NumThreads);
+
+    for (unsigned i = 0; i != NumFunctions; ++i) {
+      uint64_t StartBit = Stream.GetCurrentBitNo();
+      Stream.EmitEncodedBlock(bitc::FUNCTION_BLOCK_ID, 4, Encoder.Buffers[i]);
+      Encoder.Buffers[i].clear();
+      if (Index)
+        Index->push_back(FunctionIndexEntry(Functions[Begin + i], StartBit,
+                                            Stream.GetCurrentBitNo()));
+    }
+    Begin += NumFunctions;
+  }
+
+  for (unsigned i = 1; i < NumThreads; ++i)
+    delete Encoder.Enumerators[i];
+}
+
+/// WriteFunctionIndexOffset - Emit a FNINDEXOFFSET record whose offset is
+/// filled in by WriteFunctionIndex, and return the bit position of the offset.
+static uint64_t WriteFunctionIndexOffset(BitstreamWriter &Stream) {
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::MODULE_CODE_FNINDEXOFFSET));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32));
+  unsigned FnIndexOffsetAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<unsigned, 1> Vals;
+  Vals.push_back(0);
+  Stream.EmitRecord(bitc::MODULE_CODE_FNINDEXOFFSET, Vals, FnIndexOffsetAbbrev);
+  // The offset is the last field of the record.
+  return Stream.GetCurrentBitNo() - 32;
+}
+
+/// WriteFunctionIndex - Emit the FUNCTION_INDEX_BLOCK after the function
+/// bodies, and patch its position into the FNINDEXOFFSET record.  Positions
+/// are relative to \p BitcodeStartBit, the start of the bitcode magic number,
+/// which is where the positions of a reader start too.
+static void WriteFunctionIndex(const std::vector<FunctionIndexEntry> &Index,
+                               uint64_t BitcodeStartBit,
+                               uint64_t FnIndexOffsetBit,
+                               const ValueEnumerator &VE,
+                               BitstreamWriter &Stream) {
+  // The index follows the last function block, so it starts on a word
+  // boundary.
+  uint64_t IndexBit = Stream.GetCurrentBitNo() - BitcodeStartBit;
+  assert(IndexBit % 32 == 0 && "Function index is not word aligned");
+  assert(IndexBit / 32 == (uint32_t)(IndexBit / 32) &&
+         "Function index offset does not fit in 32 bits");
+  Stream.BackpatchFixed32(FnIndexOffsetBit, IndexBit / 32);
+
+  Stream.EnterSubblock(bitc::FUNCTION_INDEX_BLOCK_ID, 3);
+
+  BitCodeAbbrev *Abbv = new BitCodeAbbrev();
+  Abbv->Add(BitCodeAbbrevOp(bitc::FNINDEX_CODE_ENTRY));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16));
+  Abbv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16));
+  unsigned EntryAbbrev = Stream.EmitAbbrev(Abbv);
+
+  SmallVector<uint64_t, 3> Vals;
+  for (unsigned i = 0, e = Index.size(); i != e; ++i) {
+    const FunctionIndexEntry &Entry = Index[i];
+    Vals.push_back(VE.getValueID(Entry.F));
+    Vals.push_back(Entry.StartBit - BitcodeStartBit);
+    Vals.push_back(Entry.EndBit - Entry.StartBit);
+    Stream.EmitRecord(bitc::FNINDEX_CODE_ENTRY, Vals, EntryAbbrev);
+    Vals.clear();
+  }
+
+  Stream.ExitBlock();
+}
+
+/// WriteModule - Emit the specified module to the bitstream.  \p BitcodeStartBit
+/// is the position of the bitcode magic number in the stream.
+static void WriteModule(const Module *M, BitstreamWriter &Stream,
+                        uint64_t BitcodeStartBit) {
   Stream.EnterSubblock(bitc::MODULE_BLOCK_ID, 3);
 
   SmallVector<unsigned, 1> Vals;
@@ -1903,10 +2058,38 @@ static void WriteModule(const Module *M, BitstreamWriter &Stream) {
   if (EnablePreserveUseListOrdering)
     WriteModuleUseLists(M, VE, Stream);
 
-  // Emit function bodies.
+  // If requested, emit an index of the function bodies after them, and a
+  // record pointing at it before them.
+  bool HasFunctionBodies = false;
   for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
-    if (!F->isDeclaration())
-      WriteFunction(*F, VE, Stream);
+    if (!F->isDeclaration()) {
+      HasFunctionBodies = true;
+      break;
+    }
+  std::vector<FunctionIndexEntry> FunctionIndex;
+  std::vector<FunctionIndexEntry> *Index = 0;
+  uint64_t FnIndexOffsetBit = 0;
+  if (EmitFunctionIndex && HasFunctionBodies) {
+    Index = &FunctionIndex;
+    FnIndexOffsetBit = WriteFunctionIndexOffset(Stream);
+  }
+
+  // Emit function bodies.
+  if (BitcodeWriterThreads > 1)
+    WriteFunctionsInParallel(M, VE, Stream, BitcodeWriterThreads, Index);
+  else
+    for (Module::const_iterator F = M->begin(), E = M->end(); F != E; ++F)
+      if (!F->isDeclaration()) {
+        uint64_t StartBit = Stream.GetCurrentBitNo();
+        WriteFunction(*F, VE, Stream);
+        if (Index)
+          Index->push_back(FunctionIndexEntry(F, StartBit,
+                                              Stream.GetCurrentBitNo()));
+      }
+
+  if (Index)
+    WriteFunctionIndex(FunctionIndex, BitcodeStartBit, FnIndexOffsetBit, VE,
+                       Stream);
 
   Stream.ExitBlock();
 }
@@ -1999,6 +2182,7 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out) {
   // Emit the module into the buffer.
   {
     BitstreamWriter Stream(Buffer);
+    uint64_t BitcodeStartBit = Stream.GetCurrentBitNo();
 
     // Emit the file header.
     Stream.Emit((unsigned)'B', 8);
@@ -2009,7 +2193,7 @@ void llvm::WriteBitcodeToFile(const Module *M, raw_ostream &Out) {
     Stream.Emit(0xD, 4);
 
     // Emit the module.
-    WriteModule(M, Stream);
+    WriteModule(M, Stream, BitcodeStartBit);
   }
 
   if (TT.isOSDarwin())
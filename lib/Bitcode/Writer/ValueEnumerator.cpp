@@ -440,6 +440,17 @@ void ValueEnumerator::EnumerateAttributes(AttributeSet PAL) {
   }
 }
 
+ValueEnumerator::ValueEnumerator(const ValueEnumerator &VE)
+  : TypeMap(VE.TypeMap), Types(VE.Types), ValueMap(VE.ValueMap),
+    Values(VE.Values), MDValues(VE.MDValues), MDValueMap(VE.MDValueMap),
+    AttributeGroupMap(VE.AttributeGroupMap),
+    AttributeGroups(VE.AttributeGroups), AttributeMap(VE.AttributeMap),
+    Attribute(VE.Attribute), InstructionCount(0), NumModuleValues(0),
+    NumModuleMDValues(0), FirstFuncConstantID(0), FirstInstID(0) {
+  assert(VE.BasicBlocks.empty() && VE.FunctionLocalMDs.empty() &&
+         "Cannot copy an enumerator with an incorporated function");
+}
+
 void ValueEnumerator::incorporateFunction(const Function &F) {
   InstructionCount = 0;
   NumModuleValues = Values.size();
@@ -83,11 +83,15 @@ private:
   unsigned FirstFuncConstantID;
   unsigned FirstInstID;
 
-  ValueEnumerator(const ValueEnumerator &) LLVM_DELETED_FUNCTION;
   void operator=(const ValueEnumerator &) LLVM_DELETED_FUNCTION;
 public:
   ValueEnumerator(const Module *M);
 
+  /// A copy of a ValueEnumerator with no function incorporated can
+  /// incorporate functions independently of the original, so that function
+  /// bodies can be written on several threads.
+  ValueEnumerator(const ValueEnumerator &VE);
+
   void dump() const;
   void print(raw_ostream &OS, const ValueMapType &Map, const char *Name) const;
 
@@ -649,6 +649,39 @@ void AsmPrinter::emitPrologLabel(const MachineInstr &MI) {
   assert(FoundOne);
 }
 
+/// hasOpenFrame - Return true if Streamer is between .cfi_startproc and
+/// .cfi_endproc.
+static bool hasOpenFrame(MCStreamer &Streamer) {
+  unsigned NumFrames = Streamer.getNumFrameInfos();
+  return NumFrames && !Streamer.getFrameInfo(NumFrames - 1).End;
+}
+
+/// EmitColdFragmentStart - Switch to the cold section to emit the cold blocks
+/// of the function, and return the symbol starting them. The cold blocks all
+/// follow the prologue, so their frame is described by its moves. Functions
+/// with frame moves outside of the entry block are not split, so these are
+/// all of the function's moves.
+MCSymbol *AsmPrinter::EmitColdFragmentStart(const MCSection *ColdSection) {
+  bool HasFrame = hasOpenFrame(OutStreamer);
+  if (HasFrame)
+    OutStreamer.EmitCFIEndProc();
+
+  OutStreamer.SwitchSection(ColdSection);
+  MCSymbol *ColdSym =
+    OutContext.GetOrCreateSymbol(Twine(CurrentFnSym->getName()) + ".cold");
+  if (MAI->hasDotTypeDotSizeDirective())
+    OutStreamer.EmitSymbolAttribute(ColdSym, MCSA_ELF_TypeFunction);
+  OutStreamer.EmitLabel(ColdSym);
+
+  if (HasFrame) {
+    OutStreamer.EmitCFIStartProc();
+    const std::vector<MCCFIInstruction> &Moves = MMI->getFrameInstructions();
+    for (unsigned i = 0, e = Moves.size(); i != e; ++i)
+      emitCFIInstruction(Moves[i]);
+  }
+  return ColdSym;
+}
+
 /// EmitFunctionBody - This method emits the body and trailer for a
 /// function.
 void AsmPrinter::EmitFunctionBody() {
@@ -657,11 +690,25 @@ void AsmPrinter::EmitFunctionBody() {
 
   bool ShouldPrintDebugScopes = DD && MMI->hasDebugInfo();
 
+  // Blocks in the cold section follow all of the hot blocks. They are emitted
+  // as a separate fragment when the object file format has a cold section.
+  const MCSection *ColdSection = 0;
+  if (MF->back().isInColdSection())
+    ColdSection = getObjFileLowering().getColdSectionForFunction(
+        MF->getFunction(), Mang, TM);
+  MCSymbol *HotEndLabel = 0, *ColdSym = 0;
+
   // Print out code for the function.
   bool HasAnyRealCode = false;
   const MachineInstr *LastMI = 0;
   for (MachineFunction::const_iterator I = MF->begin(), E = MF->end();
        I != E; ++I) {
+    if (ColdSection && !ColdSym && I->isInColdSection()) {
+      HotEndLabel = OutContext.CreateTempSymbol();
+      OutStreamer.EmitLabel(HotEndLabel);
+      ColdSym = EmitColdFragmentStart(ColdSection);
+    }
+
     // Print a label for the basic block.
     EmitBasicBlockStart(I);
     for (MachineBasicBlock::const_iterator II = I->begin(), IE = I->end();
@@ -765,6 +812,15 @@ void AsmPrinter::EmitFunctionBody() {
     MCSymbol *FnEndLabel = OutContext.CreateTempSymbol();
     OutStreamer.EmitLabel(FnEndLabel);
 
+    // The function ends where its cold fragment starts.
+    if (ColdSym) {
+      OutStreamer.EmitELFSize(ColdSym,
+        MCBinaryExpr::CreateSub(MCSymbolRefExpr::Create(FnEndLabel, OutContext),
+                                MCSymbolRefExpr::Create(ColdSym, OutContext),
+                                OutContext));
+      FnEndLabel = HotEndLabel;
+    }
+
     const MCExpr *SizeExp =
       MCBinaryExpr::CreateSub(MCSymbolRefExpr::Create(FnEndLabel, OutContext),
                               MCSymbolRefExpr::Create(CurrentFnSymForSize,
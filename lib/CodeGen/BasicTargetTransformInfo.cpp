@@ -100,6 +100,11 @@ public:
   virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
+  virtual unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              ArrayRef<unsigned> Indices,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const;
   virtual unsigned getIntrinsicInstrCost(Intrinsic::ID, Type *RetTy,
                                          ArrayRef<Type*> Tys) const;
   virtual unsigned getNumberOfParts(Type *Tp) const;
@@ -388,6 +393,32 @@ unsigned BasicTTI::getMemoryOpCost(unsigned Opcode, Type *Src,
   return LT.first;
 }
 
+unsigned BasicTTI::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              ArrayRef<unsigned> Indices,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const {
+  VectorType *VT = cast<VectorType>(VecTy);
+  unsigned NumElts = VT->getNumElements();
+  assert(Factor > 1 && NumElts % Factor == 0 && "Invalid interleave factor");
+  VectorType *SubVT = VectorType::get(VT->getElementType(), NumElts / Factor);
+
+  // The cost of the wide load/store itself.
+  unsigned Cost = TopTTI->getMemoryOpCost(Opcode, VecTy, Alignment,
+                                          AddressSpace);
+
+  // Without target knowledge, assume that the shuffles are scalarized: every
+  // member element is extracted from one vector and inserted into another.
+  if (Opcode == Instruction::Load)
+    return Cost + Indices.size() *
+           (getScalarizationOverhead(SubVT, true, false) +
+            SubVT->getNumElements() *
+            TopTTI->getVectorInstrCost(Instruction::ExtractElement, VT));
+
+  return Cost + Factor * getScalarizationOverhead(SubVT, false, true) +
+         getScalarizationOverhead(VT, true, false);
+}
+
 unsigned BasicTTI::getIntrinsicInstrCost(Intrinsic::ID IID, Type *RetTy,
                                          ArrayRef<Type *> Tys) const {
   unsigned ISD = 0;
@@ -0,0 +1,196 @@
+//===-- ColdCodeSplitting.cpp - Move cold blocks out of the function ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass runs after block placement and moves the blocks whose frequency is
+// a small fraction of the entry frequency to the end of the function, marking
+// them to be emitted in the cold text section. The AsmPrinter emits them there
+// as a separate fragment of the function, so that rarely executed code does
+// not share instruction cache lines and pages with the hot code.
+//
+// Blocks which can fall through without an analyzable branch are kept with
+// their layout successor. Every other branch crossing the boundary between
+// the hot and cold parts is made explicit.
+//
+// Functions with landing pads, jump tables, blocks whose address is taken or
+// debug information are left alone: their tables refer to the blocks relative
+// to the start of the function.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "cold-code-splitting"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/IR/Function.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetMachine.h"
+using namespace llvm;
+
+STATISTIC(NumSplitFunctions, "Number of functions with a cold part");
+STATISTIC(NumColdBlocks, "Number of blocks moved to the cold section");
+
+static cl::opt<unsigned>
+ColdBlockRatio("cold-block-ratio",
+               cl::desc("A block is cold if it runs at most once per N "
+                        "entries of its function (default = 1000)"),
+               cl::init(1000), cl::Hidden);
+
+namespace {
+class ColdCodeSplitting : public MachineFunctionPass {
+  const TargetInstrInfo *TII;
+
+  bool canSplit(MachineFunction &MF);
+  bool canFallThroughUnanalyzable(MachineBasicBlock *MBB);
+
+public:
+  static char ID; // Pass identification, replacement for typeid
+  ColdCodeSplitting() : MachineFunctionPass(ID) {
+    initializeColdCodeSplittingPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF);
+
+  void getAnalysisUsage(AnalysisUsage &AU) const {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    AU.addPreserved<MachineBlockFrequencyInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+};
+}
+
+char ColdCodeSplitting::ID = 0;
+char &llvm::ColdCodeSplittingID = ColdCodeSplitting::ID;
+INITIALIZE_PASS_BEGIN(ColdCodeSplitting, "cold-code-splitting",
+                      "Move cold blocks to the cold section", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_END(ColdCodeSplitting, "cold-code-splitting",
+                    "Move cold blocks to the cold section", false, false)
+
+/// canSplit - Return true if the blocks of MF can be emitted in two separate
+/// fragments.
+bool ColdCodeSplitting::canSplit(MachineFunction &MF) {
+  // A cold function is emitted in the cold section as a whole, and the cold
+  // part of a linkonce or weak function would have to join its section group.
+  const Function *F = MF.getFunction();
+  if (F->hasFnAttribute("cold") || F->isWeakForLinker() || F->hasSection())
+    return false;
+
+  // The second fragment gets its own unwind information when the frame is
+  // described with CFI directives. Other unwind formats cannot describe it.
+  ExceptionHandling::ExceptionsType EHType =
+    MF.getTarget().getMCAsmInfo()->getExceptionHandlingType();
+  if (EHType != ExceptionHandling::None && EHType != ExceptionHandling::DwarfCFI)
+    return false;
+
+  if (MF.getMMI().hasDebugInfo())
+    return false;
+
+  const MachineJumpTableInfo *JTI = MF.getJumpTableInfo();
+  if (JTI && !JTI->isEmpty())
+    return false;
+
+  for (MachineFunction::iterator I = MF.begin(), E = MF.end(); I != E; ++I) {
+    if (I->isLandingPad() || I->hasAddressTaken())
+      return false;
+    // The cold fragment starts with all of the function's frame moves, which
+    // is only right if they all describe the prologue in the entry block.
+    if (I == MF.begin())
+      continue;
+    for (MachineBasicBlock::iterator MI = I->begin(), ME = I->end(); MI != ME;
+         ++MI)
+      if (MI->isPrologLabel())
+        return false;
+  }
+  return true;
+}
+
+/// canFallThroughUnanalyzable - Return true if MBB may fall through to its
+/// layout successor with terminators that cannot be rewritten.
+bool ColdCodeSplitting::canFallThroughUnanalyzable(MachineBasicBlock *MBB) {
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 4> Cond;
+  return MBB->canFallThrough() && TII->AnalyzeBranch(*MBB, TBB, FBB, Cond);
+}
+
+bool ColdCodeSplitting::runOnMachineFunction(MachineFunction &MF) {
+  // Check for single-block functions and skip them.
+  if (llvm::next(MF.begin()) == MF.end())
+    return false;
+
+  TII = MF.getTarget().getInstrInfo();
+  if (!canSplit(MF))
+    return false;
+
+  MachineBlockFrequencyInfo &MBFI = getAnalysis<MachineBlockFrequencyInfo>();
+  uint64_t ColdFreq =
+    MBFI.getBlockFreq(&MF.front()).getFrequency() / ColdBlockRatio;
+
+  // Classify the blocks in layout order. A block which falls through to its
+  // layout successor without an analyzable branch keeps it in its own part.
+  SmallVector<MachineBasicBlock*, 16> Hot, Cold;
+  Hot.push_back(&MF.front());
+  bool PrevIsCold = false;
+  for (MachineFunction::iterator I = llvm::next(MF.begin()), E = MF.end();
+       I != E; ++I) {
+    bool IsCold = MBFI.getBlockFreq(I).getFrequency() <= ColdFreq;
+    if (canFallThroughUnanalyzable(llvm::prior(I)))
+      IsCold = PrevIsCold;
+    (IsCold ? Cold : Hot).push_back(I);
+    PrevIsCold = IsCold;
+  }
+  if (Cold.empty())
+    return false;
+
+  DEBUG(dbgs() << "Moving " << Cold.size() << " cold blocks of "
+               << MF.getName() << " to the cold section\n");
+
+  // Lay out the hot blocks followed by the cold blocks, both in their current
+  // order, and fix up the branches whose fall through changed.
+  for (unsigned i = 0, e = Cold.size(); i != e; ++i) {
+    Cold[i]->moveAfter(&MF.back());
+    Cold[i]->setInColdSection();
+  }
+  for (MachineFunction::iterator I = MF.begin(), E = MF.end(); I != E; ++I) {
+    MachineBasicBlock *TBB = 0, *FBB = 0;
+    SmallVector<MachineOperand, 4> Cond;
+    if (!TII->AnalyzeBranch(*I, TBB, FBB, Cond))
+      I->updateTerminator();
+  }
+
+  // The last hot block cannot fall through into the cold section, branch to
+  // the first cold block explicitly.
+  MachineBasicBlock *LastHot = Hot.back(), *FirstCold = Cold.front();
+  if (LastHot->canFallThrough()) {
+    MachineBasicBlock *TBB = 0, *FBB = 0;
+    SmallVector<MachineOperand, 4> Cond;
+    bool Unanalyzable = TII->AnalyzeBranch(*LastHot, TBB, FBB, Cond);
+    assert(!Unanalyzable && "Splitting an unanalyzable fall through!");
+    (void)Unanalyzable;
+    DebugLoc dl = FirstCold->findDebugLoc(FirstCold->begin());
+    if (!TBB) {
+      TII->InsertBranch(*LastHot, FirstCold, 0, Cond, dl);
+    } else {
+      TII->RemoveBranch(*LastHot);
+      TII->InsertBranch(*LastHot, TBB, FirstCold, Cond, dl);
+    }
+  }
+
+  ++NumSplitFunctions;
+  NumColdBlocks += Cold.size();
+  return true;
+}
@@ -531,9 +531,14 @@ void TargetPassConfig::addMachinePasses() {
   }
 
   // Basic block placement.
-  if (getOptLevel() != CodeGenOpt::None)
+  if (getOptLevel() != CodeGenOpt::None) {
     addBlockPlacement();
 
+    // Move the cold blocks out of line once the layout is final.
+    if (TargetMachine::getSplitColdCode() && addPass(&ColdCodeSplittingID))
+      printAndVerify("After cold code splitting");
+  }
+
   if (addPreEmitPass())
     printAndVerify("After PreEmit passes");
 }
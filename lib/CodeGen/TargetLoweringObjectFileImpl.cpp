@@ -233,9 +233,37 @@ static const char *getSectionPrefixForGlobal(SectionKind Kind) {
 }
 
 
+/// getTextSectionWithSuffix - Return the text section named ".text.<Suffix>",
+/// or ".text.<Suffix>.<symbol>" with -ffunction-sections.
+static const MCSection *getTextSectionWithSuffix(MCContext &Ctx,
+                                                 StringRef Suffix,
+                                                 const GlobalValue *GV,
+                                                 Mangler *Mang) {
+  SmallString<128> Name(".text.");
+  Name += Suffix;
+  if (TargetMachine::getFunctionSections()) {
+    Name += '.';
+    Name += Mang->getSymbol(GV)->getName();
+  }
+  return Ctx.getELFSection(Name.str(), ELF::SHT_PROGBITS,
+                           ELF::SHF_ALLOC | ELF::SHF_EXECINSTR,
+                           SectionKind::getText());
+}
+
 const MCSection *TargetLoweringObjectFileELF::
 SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
                        Mangler *Mang, const TargetMachine &TM) const {
+  // With -fsplit-cold-code, functions the profile found to be cold or hot are
+  // grouped in .text.unlikely and .text.hot, which linkers place before the
+  // rest of .text. Linkonce and weak functions keep their own group section.
+  if (Kind.isText() && TM.getSplitColdCode() && !GV->isWeakForLinker())
+    if (const Function *F = dyn_cast<Function>(GV)) {
+      if (F->hasFnAttribute("cold"))
+        return getTextSectionWithSuffix(getContext(), "unlikely", GV, Mang);
+      if (F->hasFnAttribute("hot"))
+        return getTextSectionWithSuffix(getContext(), "hot", GV, Mang);
+    }
+
   // If we have -ffunction-section or -fdata-section then we should emit the
   // global value to a uniqued section specifically for it.
   bool EmitUniquedSection;
@@ -324,6 +352,16 @@ SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
   return DataRelROSection;
 }
 
+const MCSection *TargetLoweringObjectFileELF::
+getColdSectionForFunction(const Function *F, Mangler *Mang,
+                          const TargetMachine &TM) const {
+  // The cold blocks of a linkonce or weak function would have to join its
+  // section group, and an explicit section is kept whole.
+  if (F->isWeakForLinker() || F->hasSection())
+    return 0;
+  return getTextSectionWithSuffix(getContext(), "unlikely", F, Mang);
+}
+
 /// getSectionForConstant - Given a mergeable constant with the
 /// specified size and relocation information, return a section that it
 /// should be placed in.
@@ -11,6 +11,7 @@
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cassert>
 using namespace llvm;
 using namespace dwarf;
 
@@ -19,11 +20,51 @@ DWARFAbbreviationDeclaration::extract(DataExtractor data, uint32_t* offset_ptr){
   return extract(data, offset_ptr, data.getULEB128(offset_ptr));
 }
 
+/// Adds the size of a value of the given form to \p Bytes, or counts it in
+/// \p NumAddr or \p NumRefAddr if its size depends on the compile unit.
+/// Returns false if the size of the value depends on its contents.
+static bool addFixedFormSize(uint16_t Form, uint32_t &Bytes,
+                             uint16_t &NumAddr, uint16_t &NumRefAddr) {
+  switch (Form) {
+  case DW_FORM_addr:
+    ++NumAddr;
+    return true;
+  case DW_FORM_ref_addr:
+    ++NumRefAddr;
+    return true;
+  case DW_FORM_flag_present:
+    return true;
+  case DW_FORM_data1:
+  case DW_FORM_flag:
+  case DW_FORM_ref1:
+    Bytes += 1;
+    return true;
+  case DW_FORM_data2:
+  case DW_FORM_ref2:
+    Bytes += 2;
+    return true;
+  case DW_FORM_data4:
+  case DW_FORM_ref4:
+  case DW_FORM_strp:
+  case DW_FORM_sec_offset:
+    Bytes += 4;
+    return true;
+  case DW_FORM_data8:
+  case DW_FORM_ref8:
+  case DW_FORM_ref_sig8:
+    Bytes += 8;
+    return true;
+  default:
+    return false;
+  }
+}
+
 bool
 DWARFAbbreviationDeclaration::extract(DataExtractor data, uint32_t* offset_ptr,
                                       uint32_t code) {
   Code = code;
   Attribute.clear();
+  FixedOffsets.clear();
   if (Code) {
     Tag = data.getULEB128(offset_ptr);
     HasChildren = data.getU8(offset_ptr);
@@ -38,6 +79,15 @@ DWARFAbbreviationDeclaration::extract(DataExtractor data, uint32_t* offset_ptr,
         break;
     }
 
+    FixedOffset Offset = { 0, 0, 0 };
+    FixedOffsets.push_back(Offset);
+    for (unsigned i = 0, e = Attribute.size(); i != e; ++i) {
+      if (!addFixedFormSize(Attribute[i].getForm(), Offset.Bytes,
+                            Offset.NumAddr, Offset.NumRefAddr))
+        break;
+      FixedOffsets.push_back(Offset);
+    }
+
     return Tag != 0;
   } else {
     Tag = 0;
@@ -81,3 +131,13 @@ DWARFAbbreviationDeclaration::findAttributeIndex(uint16_t attr) const {
   }
   return -1U;
 }
+
+uint32_t
+DWARFAbbreviationDeclaration::getFixedOffset(uint32_t idx,
+                                             const uint8_t *FixedFormSizes)
+                                             const {
+  assert(idx < FixedOffsets.size() && "Offset depends on the DIE data!");
+  const FixedOffset &Offset = FixedOffsets[idx];
+  return Offset.Bytes + Offset.NumAddr * FixedFormSizes[DW_FORM_addr] +
+         Offset.NumRefAddr * FixedFormSizes[DW_FORM_ref_addr];
+}
@@ -19,10 +19,24 @@ namespace llvm {
 class raw_ostream;
 
 class DWARFAbbreviationDeclaration {
+  /// Offset of an attribute value from the first attribute value of a DIE.
+  /// The sizes of DW_FORM_addr and DW_FORM_ref_addr depend on the compile
+  /// unit, so they are counted rather than added up.
+  struct FixedOffset {
+    uint32_t Bytes;
+    uint16_t NumAddr;
+    uint16_t NumRefAddr;
+  };
+
   uint32_t Code;
   uint32_t Tag;
   bool HasChildren;
   SmallVector<DWARFAttribute, 8> Attribute;
+  /// Offsets of the leading attribute values that can be found without
+  /// looking at the DIE data, i.e. up to and including the first attribute
+  /// after a variable-size form. If all forms have a fixed size, the last
+  /// entry holds the size of all attribute values.
+  SmallVector<FixedOffset, 8> FixedOffsets;
 public:
   enum { InvalidCode = 0 };
   DWARFAbbreviationDeclaration()
@@ -40,6 +54,16 @@ public:
   }
 
   uint32_t findAttributeIndex(uint16_t attr) const;
+
+  /// getNumFixedOffsets - Returns the number of attribute indices, counted
+  /// from zero, whose value offsets are known up front. An index equal to
+  /// getNumAttributes() stands for the end of the attribute values.
+  uint32_t getNumFixedOffsets() const { return FixedOffsets.size(); }
+  /// getFixedOffset - Returns the offset of the value of the attribute at
+  /// \p idx from the first attribute value of a DIE, for a compile unit with
+  /// the given fixed form sizes. Requires idx < getNumFixedOffsets().
+  uint32_t getFixedOffset(uint32_t idx, const uint8_t *FixedFormSizes) const;
+
   bool extract(DataExtractor data, uint32_t* offset_ptr);
   bool extract(DataExtractor data, uint32_t* offset_ptr, uint32_t code);
   bool isValid() const { return Code != 0 && Tag != 0; }
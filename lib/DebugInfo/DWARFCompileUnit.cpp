@@ -117,10 +117,12 @@ void DWARFCompileUnit::setDIERelations() {
     return;
   DWARFDebugInfoEntryMinimal *die_array_begin = &DieArray.front();
   DWARFDebugInfoEntryMinimal *die_array_end = &DieArray.back();
-  DWARFDebugInfoEntryMinimal *curr_die;
+  // DIEs whose children are being visited, innermost last.
+  SmallVector<DWARFDebugInfoEntryMinimal *, 16> parents;
   // We purposely are skipping the last element in the array in the loop below
   // so that we can always have a valid next item
-  for (curr_die = die_array_begin; curr_die < die_array_end; ++curr_die) {
+  for (DWARFDebugInfoEntryMinimal *curr_die = die_array_begin;
+       curr_die < die_array_end; ++curr_die) {
     // Since our loop doesn't include the last element, we can always
     // safely access the next die in the array.
     DWARFDebugInfoEntryMinimal *next_die = curr_die + 1;
@@ -131,20 +133,15 @@ void DWARFCompileUnit::setDIERelations() {
     if (curr_die_abbrev) {
       // Normal DIE
       if (curr_die_abbrev->hasChildren())
-        next_die->setParent(curr_die);
+        parents.push_back(curr_die);
       else
         curr_die->setSibling(next_die);
-    } else {
+    } else if (!parents.empty()) {
       // NULL DIE that terminates a sibling chain
-      DWARFDebugInfoEntryMinimal *parent = curr_die->getParent();
-      if (parent)
-        parent->setSibling(next_die);
+      parents.back()->setSibling(next_die);
+      parents.pop_back();
     }
   }
-
-  // Since we skipped the last element, we need to fix it up!
-  if (die_array_begin < die_array_end)
-    curr_die->setParent(die_array_begin);
 }
 
 size_t DWARFCompileUnit::extractDIEsIfNeeded(bool cu_die_only) {
@@ -238,7 +235,11 @@ DWARFCompileUnit::buildAddressRangeTable(DWARFDebugAranges *debug_aranges,
                                          bool clear_dies_if_already_not_parsed){
   // This function is usually called if there in no .debug_aranges section
   // in order to produce a compile unit level set of address ranges that
-  // is accurate. If the DIEs weren't parsed, then we don't want all dies for
+  // is accurate. Producers normally put these on the compile unit DIE.
+  if (buildAddressRangeTableFromCUDIE(debug_aranges))
+    return;
+
+  // If the DIEs weren't parsed, then we don't want all dies for
   // all compile units to stay loaded when they weren't needed. So we can end
   // up parsing the DWARF and then throwing them all away to keep memory usage
   // down.
@@ -252,6 +253,13 @@ DWARFCompileUnit::buildAddressRangeTable(DWARFDebugAranges *debug_aranges,
     clearDIEs(true);
 }
 
+bool
+DWARFCompileUnit::buildAddressRangeTableFromCUDIE(
+    DWARFDebugAranges *debug_aranges) {
+  const DWARFDebugInfoEntryMinimal *CUDie = getCompileUnitDIE(true);
+  return CUDie && CUDie->appendAddressRanges(this, debug_aranges);
+}
+
 DWARFDebugInfoEntryMinimal::InlinedChain
 DWARFCompileUnit::getInlinedChainForAddress(uint64_t Address) {
   // First, find a subprogram that contains the given address (the root
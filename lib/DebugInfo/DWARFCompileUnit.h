@@ -127,10 +127,22 @@ public:
     DieArray.push_back(die);
   }
 
+  /// hasExtractedAllDIEs - Returns true if the DIEs below the compile unit
+  /// DIE are currently in memory.
+  bool hasExtractedAllDIEs() const { return DieArray.size() > 1; }
+
   void clearDIEs(bool keep_compile_unit_die);
 
+  /// buildAddressRangeTable - Appends the address ranges of this compile
+  /// unit to \p debug_aranges. The ranges on the compile unit DIE are used
+  /// when present; only otherwise are all DIEs parsed to collect the ranges
+  /// of the subprograms.
   void buildAddressRangeTable(DWARFDebugAranges *debug_aranges,
                               bool clear_dies_if_already_not_parsed);
+  /// buildAddressRangeTableFromCUDIE - Appends the address ranges given on
+  /// the compile unit DIE to \p debug_aranges, extracting only that DIE.
+  /// Returns false if the compile unit DIE does not describe its ranges.
+  bool buildAddressRangeTableFromCUDIE(DWARFDebugAranges *debug_aranges);
 
   /// getInlinedChainForAddress - fetches inlined chain for a given address.
   /// Returns empty chain if there is no subprogram containing address.
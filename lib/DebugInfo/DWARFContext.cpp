@@ -15,6 +15,7 @@
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 using namespace llvm;
@@ -30,8 +31,22 @@ void DWARFContext::dump(raw_ostream &OS, DIDumpType DumpType) {
 
   if (DumpType == DIDT_All || DumpType == DIDT_Info) {
     OS << "\n.debug_info contents:\n";
-    for (unsigned i = 0, e = getNumCompileUnits(); i != e; ++i)
-      getCompileUnitAtIndex(i)->dump(OS);
+    // Parse a batch of units in parallel, print them in order and drop the
+    // DIEs parsed here before moving on, so only a few units are in memory at
+    // a time.
+    SmallVector<DWARFCompileUnit *, 8> Parsed;
+    for (unsigned i = 0, e = getNumCompileUnits(); i != e; ) {
+      unsigned BatchEnd = std::min(e, i + NumThreads);
+      Parsed.clear();
+      for (unsigned j = i; j != BatchEnd; ++j)
+        if (!getCompileUnitAtIndex(j)->hasExtractedAllDIEs())
+          Parsed.push_back(getCompileUnitAtIndex(j));
+      extractDIEs(Parsed);
+      for (; i != BatchEnd; ++i)
+        getCompileUnitAtIndex(i)->dump(OS);
+      for (unsigned j = 0, je = Parsed.size(); j != je; ++j)
+        Parsed[j]->clearDIEs(true);
+    }
   }
 
   if (DumpType == DIDT_All || DumpType == DIDT_Frames) {
@@ -283,6 +298,20 @@ namespace {
   };
 }
 
+static void extractCompileUnitDIEs(void *Data, unsigned Index) {
+  static_cast<DWARFCompileUnit **>(Data)[Index]->extractDIEsIfNeeded(false);
+}
+
+void DWARFContext::extractDIEs(ArrayRef<DWARFCompileUnit *> Units) {
+  llvm_parallel_for(Units.size(), extractCompileUnitDIEs,
+                    const_cast<DWARFCompileUnit **>(Units.data()), NumThreads);
+}
+
+void DWARFContext::clearDIEs() {
+  for (unsigned i = 0, e = getNumCompileUnits(); i != e; ++i)
+    getCompileUnitAtIndex(i)->clearDIEs(true);
+}
+
 DWARFCompileUnit *DWARFContext::getCompileUnitForOffset(uint32_t Offset) {
   if (CUs.empty())
     parseCompileUnits();
@@ -336,7 +365,7 @@ static bool getFileLineInfoForCompileUnit(DWARFCompileUnit *CU,
   if (RowIndex == -1U)
     return false;
   // Take file number and line/column from the row.
-  const DWARFDebugLine::Row &Row = LineTable->Rows[RowIndex];
+  DWARFDebugLine::Row Row = LineTable->getRow(RowIndex);
   if (!getFileNameForCompileUnit(CU, LineTable, Row.File,
                                  NeedsAbsoluteFilePath, FileName))
     return false;
@@ -424,7 +453,7 @@ DILineInfoTable DWARFContext::getLineInfoForAddressRange(uint64_t Address,
   for (uint32_t i = 0; i < NumRows; ++i) {
     uint32_t RowIndex = RowVector[i];
     // Take file number and line/column from the row.
-    const DWARFDebugLine::Row &Row = LineTable->Rows[RowIndex];
+    DWARFDebugLine::Row Row = LineTable->getRow(RowIndex);
     std::string FileName = "<invalid>";
     getFileNameForCompileUnit(CU, LineTable, Row.File,
                               NeedsAbsoluteFilePath, FileName);
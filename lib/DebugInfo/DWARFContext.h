@@ -15,6 +15,7 @@
 #include "DWARFDebugFrame.h"
 #include "DWARFDebugLine.h"
 #include "DWARFDebugRangeList.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/DebugInfo/DIContext.h"
@@ -35,6 +36,10 @@ class DWARFContext : public DIContext {
   SmallVector<DWARFCompileUnit, 1> DWOCUs;
   OwningPtr<DWARFDebugAbbrev> AbbrevDWO;
 
+  /// Number of threads used to parse the DIEs of several compile units at
+  /// once.
+  unsigned NumThreads;
+
   DWARFContext(DWARFContext &) LLVM_DELETED_FUNCTION;
   DWARFContext &operator=(DWARFContext &) LLVM_DELETED_FUNCTION;
 
@@ -46,9 +51,22 @@ class DWARFContext : public DIContext {
   void parseDWOCompileUnits();
 
 public:
-  DWARFContext() {}
+  DWARFContext() : NumThreads(1) {}
   virtual void dump(raw_ostream &OS, DIDumpType DumpType = DIDT_All);
 
+  /// Set the number of threads used when DIEs of several compile units are
+  /// needed together, e.g. when dumping or indexing addresses.
+  void setNumThreads(unsigned N) { NumThreads = N ? N : 1; }
+  unsigned getNumThreads() const { return NumThreads; }
+
+  /// Parse all DIEs of the given compile units. Units are independent of each
+  /// other, so they are spread over the threads of this context.
+  void extractDIEs(ArrayRef<DWARFCompileUnit *> Units);
+
+  /// Release the DIEs of all compile units, keeping only the compile unit
+  /// DIEs. The rest is parsed again when it is needed.
+  void clearDIEs();
+
   /// Get the number of compile units in this context.
   unsigned getNumCompileUnits() {
     if (CUs.empty())
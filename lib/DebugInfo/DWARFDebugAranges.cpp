@@ -90,14 +90,37 @@ bool DWARFDebugAranges::extract(DataExtractor debug_aranges_data) {
 
 bool DWARFDebugAranges::generate(DWARFContext *ctx) {
   if (ctx) {
+    // Most compile units describe their address ranges on the compile unit
+    // DIE, which is all that needs to be read for them.
+    SmallVector<DWARFCompileUnit *, 8> Pending;
     const uint32_t num_compile_units = ctx->getNumCompileUnits();
     for (uint32_t cu_idx = 0; cu_idx < num_compile_units; ++cu_idx) {
       if (DWARFCompileUnit *cu = ctx->getCompileUnitAtIndex(cu_idx)) {
         uint32_t CUOffset = cu->getOffset();
-        if (ParsedCUOffsets.insert(CUOffset).second)
-          cu->buildAddressRangeTable(this, true);
+        if (ParsedCUOffsets.insert(CUOffset).second &&
+            !cu->buildAddressRangeTableFromCUDIE(this))
+          Pending.push_back(cu);
       }
     }
+
+    // The rest have to be parsed fully to find their subprograms. Do that a
+    // few units at a time in parallel, and drop the DIEs this parsed again
+    // to keep memory usage down.
+    const unsigned BatchSize = ctx->getNumThreads();
+    SmallVector<DWARFCompileUnit *, 8> Parsed;
+    for (unsigned i = 0, e = Pending.size(); i < e; i += BatchSize) {
+      ArrayRef<DWARFCompileUnit *> Batch =
+          makeArrayRef(Pending).slice(i, std::min(BatchSize, e - i));
+      Parsed.clear();
+      for (unsigned j = 0, je = Batch.size(); j != je; ++j)
+        if (!Batch[j]->hasExtractedAllDIEs())
+          Parsed.push_back(Batch[j]);
+      ctx->extractDIEs(Parsed);
+      for (unsigned j = 0, je = Batch.size(); j != je; ++j)
+        Batch[j]->buildAddressRangeTable(this, false);
+      for (unsigned j = 0, je = Parsed.size(); j != je; ++j)
+        Parsed[j]->clearDIEs(true);
+    }
   }
   sort(true, /* overlap size */ 0);
   return !isEmpty();
@@ -109,8 +109,14 @@ bool DWARFDebugInfoEntryMinimal::extractFast(const DWARFCompileUnit *CU,
   assert(AbbrevDecl);
   assert(FixedFormSizes); // For best performance this should be specified!
 
-  // Skip all data in the .debug_info for the attributes
-  for (uint32_t i = 0, n = AbbrevDecl->getNumAttributes(); i < n; ++i) {
+  // Jump over the attributes whose offsets are known from the abbreviation;
+  // if all of them have fixed-size forms this skips the whole DIE.
+  uint32_t FirstVarIdx = AbbrevDecl->getNumFixedOffsets() - 1;
+  *OffsetPtr += AbbrevDecl->getFixedOffset(FirstVarIdx, FixedFormSizes);
+
+  // Skip the remaining data in the .debug_info for the attributes
+  for (uint32_t i = FirstVarIdx, n = AbbrevDecl->getNumAttributes(); i < n;
+       ++i) {
     uint16_t Form = AbbrevDecl->getFormByIndex(i);
 
     // FIXME: Currently we're checking if this is less than the last
@@ -204,7 +210,12 @@ DWARFDebugInfoEntryMinimal::getAttributeValue(const DWARFCompileUnit *cu,
       // Skip the abbreviation code so we are at the data for the attributes
       debug_info_data.getULEB128(&offset);
 
-      uint32_t idx = 0;
+      // Most attributes are at a fixed offset; otherwise start from the
+      // nearest one that is and skip the variable-size values in between.
+      uint32_t idx = std::min(attr_idx, AbbrevDecl->getNumFixedOffsets() - 1);
+      offset += AbbrevDecl->getFixedOffset(idx,
+          DWARFFormValue::getFixedFormSizes(cu->getAddressByteSize(),
+                                            cu->getVersion()));
       while (idx < attr_idx)
         DWARFFormValue::skipValue(AbbrevDecl->getFormByIndex(idx++),
                                   debug_info_data, &offset, cu);
@@ -285,13 +296,8 @@ DWARFDebugInfoEntryMinimal::buildAddressRangeTable(const DWARFCompileUnit *CU,
                                                DWARFDebugAranges *DebugAranges)
                                                    const {
   if (AbbrevDecl) {
-    if (isSubprogramDIE()) {
-      uint64_t LowPC, HighPC;
-      if (getLowAndHighPC(CU, LowPC, HighPC)) {
-        DebugAranges->appendRange(CU->getOffset(), LowPC, HighPC);
-      }
-      // FIXME: try to append ranges from .debug_ranges section.
-    }
+    if (isSubprogramDIE())
+      appendAddressRanges(CU, DebugAranges);
 
     const DWARFDebugInfoEntryMinimal *child = getFirstChild();
     while (child) {
@@ -301,6 +307,34 @@ DWARFDebugInfoEntryMinimal::buildAddressRangeTable(const DWARFCompileUnit *CU,
   }
 }
 
+bool
+DWARFDebugInfoEntryMinimal::appendAddressRanges(const DWARFCompileUnit *CU,
+                                                DWARFDebugAranges *DebugAranges)
+                                                    const {
+  if (isNULL())
+    return false;
+  uint64_t LowPC, HighPC;
+  if (getLowAndHighPC(CU, LowPC, HighPC)) {
+    if (LowPC >= HighPC)
+      return false;
+    DebugAranges->appendRange(CU->getOffset(), LowPC, HighPC);
+    return true;
+  }
+  // Try to get address ranges from .debug_ranges section.
+  uint32_t RangesOffset = getAttributeValueAsReference(CU, DW_AT_ranges, -1U);
+  if (RangesOffset == -1U)
+    return false;
+  DWARFDebugRangeList RangeList;
+  if (!CU->extractRangeList(RangesOffset, RangeList))
+    return false;
+  SmallVector<std::pair<uint64_t, uint64_t>, 8> Ranges;
+  RangeList.getAbsoluteRanges(CU->getBaseAddress(), Ranges);
+  for (unsigned i = 0, e = Ranges.size(); i != e; ++i)
+    DebugAranges->appendRange(CU->getOffset(), Ranges[i].first,
+                              Ranges[i].second);
+  return !Ranges.empty();
+}
+
 bool
 DWARFDebugInfoEntryMinimal::addressRangeContainsAddress(
                                                      const DWARFCompileUnit *CU,
@@ -23,21 +23,21 @@ class DWARFFormValue;
 class DWARFInlinedSubroutineChain;
 
 /// DWARFDebugInfoEntryMinimal - A DIE with only the minimum required data.
+/// Compile units keep large arrays of these, so only what cannot be
+/// recomputed cheaply is stored: attribute values are decoded from the
+/// .debug_info data on demand, and parents are only needed while the
+/// sibling links are set up.
 class DWARFDebugInfoEntryMinimal {
   /// Offset within the .debug_info of the start of this entry.
   uint32_t Offset;
 
-  /// How many to subtract from "this" to get the parent.
-  /// If zero this die has no parent.
-  uint32_t ParentIdx;
-
   /// How many to add to "this" to get the sibling.
   uint32_t SiblingIdx;
 
   const DWARFAbbreviationDeclaration *AbbrevDecl;
 public:
   DWARFDebugInfoEntryMinimal()
-    : Offset(0), ParentIdx(0), SiblingIdx(0), AbbrevDecl(0) {}
+    : Offset(0), SiblingIdx(0), AbbrevDecl(0) {}
 
   void dump(raw_ostream &OS, const DWARFCompileUnit *cu,
             unsigned recurseDepth, unsigned indent = 0) const;
@@ -72,14 +72,6 @@ public:
   }
   bool hasChildren() const { return !isNULL() && AbbrevDecl->hasChildren(); }
 
-  // We know we are kept in a vector of contiguous entries, so we know
-  // our parent will be some index behind "this".
-  DWARFDebugInfoEntryMinimal *getParent() {
-    return ParentIdx > 0 ? this - ParentIdx : 0;
-  }
-  const DWARFDebugInfoEntryMinimal *getParent() const {
-    return ParentIdx > 0 ? this - ParentIdx : 0;
-  }
   // We know we are kept in a vector of contiguous entries, so we know
   // our sibling will be some index after "this".
   DWARFDebugInfoEntryMinimal *getSibling() {
@@ -98,20 +90,11 @@ public:
     return hasChildren() ? this + 1 : 0;
   }
 
-  void setParent(DWARFDebugInfoEntryMinimal *parent) {
-    if (parent) {
-      // We know we are kept in a vector of contiguous entries, so we know
-      // our parent will be some index behind "this".
-      ParentIdx = this - parent;
-    } else
-      ParentIdx = 0;
-  }
   void setSibling(DWARFDebugInfoEntryMinimal *sibling) {
     if (sibling) {
       // We know we are kept in a vector of contiguous entries, so we know
       // our sibling will be some index after "this".
       SiblingIdx = sibling - this;
-      sibling->setParent(getParent());
     } else
       SiblingIdx = 0;
   }
@@ -148,6 +131,12 @@ public:
   void buildAddressRangeTable(const DWARFCompileUnit *CU,
                               DWARFDebugAranges *DebugAranges) const;
 
+  /// Appends the address ranges covered by this DIE, taken either from
+  /// DW_AT_low_pc/DW_AT_high_pc or from DW_AT_ranges, to \p DebugAranges.
+  /// Returns true if at least one non-empty range was appended.
+  bool appendAddressRanges(const DWARFCompileUnit *CU,
+                           DWARFDebugAranges *DebugAranges) const;
+
   bool addressRangeContainsAddress(const DWARFCompileUnit *CU,
                                    const uint64_t Address) const;
 
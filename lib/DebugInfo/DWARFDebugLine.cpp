@@ -13,6 +13,7 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <cassert>
 using namespace llvm;
 using namespace dwarf;
 
@@ -80,16 +81,43 @@ void DWARFDebugLine::Row::dump(raw_ostream &OS) const {
      << '\n';
 }
 
+void DWARFDebugLine::LineTable::appendRow(const DWARFDebugLine::Row &state) {
+  RowAddresses.push_back(state.Address);
+  RowLines.push_back(state.Line);
+  RowColumns.push_back(state.Column);
+  RowFiles.push_back(state.File);
+  RowIsas.push_back(state.Isa);
+  RowFlags.push_back(state.IsStmt | state.BasicBlock << 1 |
+                     state.EndSequence << 2 | state.PrologueEnd << 3 |
+                     state.EpilogueBegin << 4);
+}
+
+DWARFDebugLine::Row
+DWARFDebugLine::LineTable::getRow(uint32_t index) const {
+  Row row;
+  row.Address = RowAddresses[index];
+  row.Line = RowLines[index];
+  row.Column = RowColumns[index];
+  row.File = RowFiles[index];
+  row.Isa = RowIsas[index];
+  uint8_t flags = RowFlags[index];
+  row.IsStmt = flags & 1;
+  row.BasicBlock = (flags >> 1) & 1;
+  row.EndSequence = (flags >> 2) & 1;
+  row.PrologueEnd = (flags >> 3) & 1;
+  row.EpilogueBegin = (flags >> 4) & 1;
+  return row;
+}
+
 void DWARFDebugLine::LineTable::dump(raw_ostream &OS) const {
   Prologue.dump(OS);
   OS << '\n';
 
-  if (!Rows.empty()) {
+  if (getNumRows() != 0) {
     OS << "Address            Line   Column File   ISA Flags\n"
        << "------------------ ------ ------ ------ --- -------------\n";
-    for (std::vector<Row>::const_iterator pos = Rows.begin(),
-         end = Rows.end(); pos != end; ++pos)
-      pos->dump(OS);
+    for (uint32_t i = 0, e = getNumRows(); i != e; ++i)
+      getRow(i).dump(OS);
   }
 }
 
@@ -478,6 +506,41 @@ DWARFDebugLine::parseStatementTable(DataExtractor debug_line_data,
   return end_offset;
 }
 
+const DWARFDebugLine::Sequence *
+DWARFDebugLine::LineTable::findSequence(SequenceIter seq_pos,
+                                        uint64_t address) const {
+  const Sequence *found_seq;
+  if (seq_pos == Sequences.end()) {
+    found_seq = &Sequences.back();
+  } else if (seq_pos->LowPC == address) {
+    found_seq = &*seq_pos;
+  } else {
+    if (seq_pos == Sequences.begin())
+      return 0;
+    found_seq = &*(seq_pos - 1);
+  }
+  if (!found_seq->containsPC(address))
+    return 0;
+  return found_seq;
+}
+
+uint32_t
+DWARFDebugLine::LineTable::findRowInSequence(const Sequence &seq,
+                                             RowAddressIter row_pos,
+                                             uint64_t address) const {
+  RowAddressIter first_row = RowAddresses.begin() + seq.FirstRowIndex;
+  RowAddressIter last_row = RowAddresses.begin() + seq.LastRowIndex;
+  if (row_pos == last_row)
+    return seq.LastRowIndex - 1;
+  uint32_t index = row_pos - RowAddresses.begin();
+  if (*row_pos > address) {
+    if (row_pos == first_row)
+      return UINT32_MAX;
+    index--;
+  }
+  return index;
+}
+
 uint32_t
 DWARFDebugLine::LineTable::lookupAddress(uint64_t address) const {
   uint32_t unknown_index = UINT32_MAX;
@@ -486,42 +549,17 @@ DWARFDebugLine::LineTable::lookupAddress(uint64_t address) const {
   // First, find an instruction sequence containing the given address.
   DWARFDebugLine::Sequence sequence;
   sequence.LowPC = address;
-  SequenceIter first_seq = Sequences.begin();
-  SequenceIter last_seq = Sequences.end();
-  SequenceIter seq_pos = std::lower_bound(first_seq, last_seq, sequence,
-      DWARFDebugLine::Sequence::orderByLowPC);
-  DWARFDebugLine::Sequence found_seq;
-  if (seq_pos == last_seq) {
-    found_seq = Sequences.back();
-  } else if (seq_pos->LowPC == address) {
-    found_seq = *seq_pos;
-  } else {
-    if (seq_pos == first_seq)
-      return unknown_index;
-    found_seq = *(seq_pos - 1);
-  }
-  if (!found_seq.containsPC(address))
+  SequenceIter seq_pos = std::lower_bound(Sequences.begin(), Sequences.end(),
+      sequence, DWARFDebugLine::Sequence::orderByLowPC);
+  const Sequence *found_seq = findSequence(seq_pos, address);
+  if (!found_seq)
     return unknown_index;
   // Search for instruction address in the rows describing the sequence.
-  // Rows are stored in a vector, so we may use arithmetical operations with
-  // iterators.
-  DWARFDebugLine::Row row;
-  row.Address = address;
-  RowIter first_row = Rows.begin() + found_seq.FirstRowIndex;
-  RowIter last_row = Rows.begin() + found_seq.LastRowIndex;
-  RowIter row_pos = std::lower_bound(first_row, last_row, row,
-      DWARFDebugLine::Row::orderByAddress);
-  if (row_pos == last_row) {
-    return found_seq.LastRowIndex - 1;
-  }
-  uint32_t index = found_seq.FirstRowIndex + (row_pos - first_row);
-  if (row_pos->Address > address) {
-    if (row_pos == first_row)
-      return unknown_index;
-    else
-      index--;
-  }
-  return index;
+  RowAddressIter row_pos =
+      std::lower_bound(RowAddresses.begin() + found_seq->FirstRowIndex,
+                       RowAddresses.begin() + found_seq->LastRowIndex,
+                       address);
+  return findRowInSequence(*found_seq, row_pos, address);
 }
 
 bool
@@ -555,16 +593,12 @@ DWARFDebugLine::LineTable::lookupAddressRange(uint64_t address,
     DWARFDebugLine::Sequence cur_seq = *seq_pos;
     uint32_t first_row_index;
     uint32_t last_row_index;
+    RowAddressIter first_row = RowAddresses.begin() + cur_seq.FirstRowIndex;
+    RowAddressIter last_row = RowAddresses.begin() + cur_seq.LastRowIndex;
     if (seq_pos == start_pos) {
       // For the first sequence, we need to find which row in the sequence is the
-      // first in our range. Rows are stored in a vector, so we may use
-      // arithmetical operations with iterators.
-      DWARFDebugLine::Row row;
-      row.Address = address;
-      RowIter first_row = Rows.begin() + cur_seq.FirstRowIndex;
-      RowIter last_row = Rows.begin() + cur_seq.LastRowIndex;
-      RowIter row_pos = std::upper_bound(first_row, last_row, row,
-                                         DWARFDebugLine::Row::orderByAddress);
+      // first in our range.
+      RowAddressIter row_pos = std::upper_bound(first_row, last_row, address);
       // The 'row_pos' iterator references the first row that is greater than
       // our start address. Unless that's the first row, we want to start at
       // the row before that.
@@ -577,12 +611,7 @@ DWARFDebugLine::LineTable::lookupAddressRange(uint64_t address,
     // For the last sequence in our range, we need to figure out the last row in
     // range.  For all other sequences we can go to the end of the sequence.
     if (cur_seq.HighPC > end_addr) {
-      DWARFDebugLine::Row row;
-      row.Address = end_addr;
-      RowIter first_row = Rows.begin() + cur_seq.FirstRowIndex;
-      RowIter last_row = Rows.begin() + cur_seq.LastRowIndex;
-      RowIter row_pos = std::upper_bound(first_row, last_row, row,
-                                         DWARFDebugLine::Row::orderByAddress);
+      RowAddressIter row_pos = std::upper_bound(first_row, last_row, end_addr);
       // The 'row_pos' iterator references the first row that is greater than
       // our end address.  The row before that is the last row we want.
       last_row_index = cur_seq.FirstRowIndex + (row_pos - first_row) - 1;
@@ -164,16 +164,25 @@ public:
   };
 
   struct LineTable {
-    void appendRow(const DWARFDebugLine::Row &state) { Rows.push_back(state); }
+    void appendRow(const DWARFDebugLine::Row &state);
     void appendSequence(const DWARFDebugLine::Sequence &sequence) {
       Sequences.push_back(sequence);
     }
     void clear() {
       Prologue.clear();
-      Rows.clear();
+      RowAddresses.clear();
+      RowLines.clear();
+      RowColumns.clear();
+      RowFiles.clear();
+      RowIsas.clear();
+      RowFlags.clear();
       Sequences.clear();
     }
 
+    uint32_t getNumRows() const { return RowAddresses.size(); }
+    // Reassembles the row at the given index.
+    Row getRow(uint32_t index) const;
+
     // Returns the index of the row with file/line info for a given address,
     // or -1 if there is no such row.
     uint32_t lookupAddress(uint64_t address) const;
@@ -191,12 +200,32 @@ public:
     void dump(raw_ostream &OS) const;
 
     struct Prologue Prologue;
-    typedef std::vector<Row> RowVector;
-    typedef RowVector::const_iterator RowIter;
+    // The rows are stored column by column. Lookups only search the
+    // addresses, so keeping them apart from the rest of the row makes the
+    // searches touch a third of the memory.
+    typedef std::vector<uint64_t>::const_iterator RowAddressIter;
+    std::vector<uint64_t> RowAddresses;
+    std::vector<uint32_t> RowLines;
+    std::vector<uint16_t> RowColumns;
+    std::vector<uint16_t> RowFiles;
+    std::vector<uint8_t> RowIsas;
+    // IsStmt, BasicBlock, EndSequence, PrologueEnd and EpilogueBegin, from
+    // the lowest bit up.
+    std::vector<uint8_t> RowFlags;
     typedef std::vector<Sequence> SequenceVector;
     typedef SequenceVector::const_iterator SequenceIter;
-    RowVector Rows;
     SequenceVector Sequences;
+
+  private:
+    // Returns the sequence to search for the given address, given the first
+    // sequence whose LowPC is not below it, or null if no sequence contains
+    // the address.
+    const Sequence *findSequence(SequenceIter seq_pos,
+                                 uint64_t address) const;
+    // Returns the index of the row for the given address in a sequence,
+    // given the first row of the sequence whose address is not below it.
+    uint32_t findRowInSequence(const Sequence &seq, RowAddressIter row_pos,
+                               uint64_t address) const;
   };
 
   struct State : public Row, public Sequence, public LineTable {
@@ -10,6 +10,7 @@
 #ifndef LLVM_DEBUGINFO_DWARFDEBUGRANGELIST_H
 #define LLVM_DEBUGINFO_DWARFDEBUGRANGELIST_H
 
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/DataExtractor.h"
 #include <vector>
 
@@ -71,6 +72,13 @@ public:
   /// address. Has to be passed base address of the compile unit that
   /// references this range list.
   bool containsAddress(uint64_t BaseAddress, uint64_t Address) const;
+  /// getAbsoluteRanges - Appends the [LowPC, HighPC) address ranges described
+  /// by this range list to \p Ranges, applying base address selection entries.
+  /// Has to be passed base address of the compile unit that references this
+  /// range list. Empty ranges are skipped.
+  void getAbsoluteRanges(uint64_t BaseAddress,
+                         SmallVectorImpl<std::pair<uint64_t, uint64_t> > &Ranges)
+                         const;
 };
 
 }  // namespace llvm
@@ -19,6 +19,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -26,6 +27,12 @@
 
 using namespace llvm;
 
+static cl::opt<unsigned>
+LinkThreads("mcjit-link-threads",
+            cl::desc("Number of threads used to apply the relocations of "
+                     "JIT compiled objects"),
+            cl::init(1), cl::Hidden);
+
 namespace {
 
 static struct RegisterJIT {
@@ -53,9 +60,10 @@ ExecutionEngine *MCJIT::createJIT(Module *M,
 
 MCJIT::MCJIT(Module *m, TargetMachine *tm, RTDyldMemoryManager *MM,
              bool AllocateGVsWithCode)
-  : ExecutionEngine(m), TM(tm), Ctx(0), MemMgr(MM), Dyld(MM),
+  : ExecutionEngine(m), TM(tm), Ctx(0), MemMgr(MM), Dyld(new RuntimeDyld(MM)),
     IsLoaded(false), M(m), ObjCache(0) {
 
+  Dyld->setNumThreads(LinkThreads);
   setDataLayout(TM->getDataLayout());
 }
 
@@ -70,6 +78,36 @@ void MCJIT::setObjectCache(ObjectCache* NewCache) {
   ObjCache = NewCache;
 }
 
+void MCJIT::addModule(Module *NewM) {
+  MutexGuard locked(lock);
+  ExecutionEngine::addModule(NewM);
+  // FIXME: Add support for multiple modules
+  if (!M)
+    M = NewM;
+}
+
+bool MCJIT::removeModule(Module *RemovedM) {
+  MutexGuard locked(lock);
+  if (RemovedM == M) {
+    if (LoadedObject) {
+      NotifyFreeingObject(*LoadedObject.get());
+      LoadedObject.reset();
+    }
+    if (!RegisteredEHFrames.empty())
+      MemMgr->deregisterEHFrames(RegisteredEHFrames);
+    RegisteredEHFrames = StringRef();
+
+    // The dynamic linker keeps the symbols of the object it loaded, start
+    // over with a new one.
+    MemMgr->freeSections(M);
+    Dyld.reset(new RuntimeDyld(MemMgr));
+    Dyld->setNumThreads(LinkThreads);
+    IsLoaded = false;
+    M = 0;
+  }
+  return ExecutionEngine::removeModule(RemovedM);
+}
+
 ObjectBufferStream* MCJIT::emitObject(Module *m) {
   /// Currently, MCJIT only supports a single module and the module passed to
   /// this function call is expected to be the contained module.  The module
@@ -125,6 +163,8 @@ void MCJIT::loadObject(Module *M) {
   // Re-compilation is not supported
   if (IsLoaded)
     return;
+  if (!M)
+    report_fatal_error("MCJIT has no module to compile!");
 
   OwningPtr<ObjectBuffer> ObjectToLoad;
   // Try to load the pre-compiled object from cache if possible
@@ -142,12 +182,14 @@ void MCJIT::loadObject(Module *M) {
 
   // Load the object into the dynamic linker.
   // handing off ownership of the buffer
-  LoadedObject.reset(Dyld.loadObject(ObjectToLoad.take()));
+  MemMgr->setSectionOwner(M);
+  LoadedObject.reset(Dyld->loadObject(ObjectToLoad.take()));
   if (!LoadedObject)
-    report_fatal_error(Dyld.getErrorString());
+    report_fatal_error(Dyld->getErrorString());
 
   // Resolve any relocations.
-  Dyld.resolveRelocations();
+  Dyld->resolveRelocations();
+  NotifyRelocationsResolved(*LoadedObject);
 
   // FIXME: Make this optional, maybe even move it to a JIT event listener
   LoadedObject->registerWithDebugger();
@@ -165,17 +207,20 @@ void MCJIT::loadObject(Module *M) {
 void MCJIT::finalizeObject() {
   // If the module hasn't been compiled, just do that.
   if (!IsLoaded) {
-    // If the call to Dyld.resolveRelocations() is removed from loadObject()
+    // If the call to Dyld->resolveRelocations() is removed from loadObject()
     // we'll need to do that here.
     loadObject(M);
   } else {
     // Resolve any relocations.
-    Dyld.resolveRelocations();
+    Dyld->resolveRelocations();
+    NotifyRelocationsResolved(*LoadedObject);
   }
 
-  StringRef EHData = Dyld.getEHFrameSection();
-  if (!EHData.empty())
+  StringRef EHData = Dyld->getEHFrameSection();
+  if (!EHData.empty() && EHData.data() != RegisteredEHFrames.data()) {
     MemMgr->registerEHFrames(EHData);
+    RegisteredEHFrames = EHData;
+  }
 
   // Set page permissions.
   MemMgr->applyPermissions();
@@ -209,8 +254,8 @@ void *MCJIT::getPointerToFunction(Function *F) {
   // load address of the symbol, not the local address.
   StringRef BaseName = F->getName();
   if (BaseName[0] == '\1')
-    return (void*)Dyld.getSymbolLoadAddress(BaseName.substr(1));
-  return (void*)Dyld.getSymbolLoadAddress((TM->getMCAsmInfo()->getGlobalPrefix()
+    return (void*)Dyld->getSymbolLoadAddress(BaseName.substr(1));
+  return (void*)Dyld->getSymbolLoadAddress((TM->getMCAsmInfo()->getGlobalPrefix()
                                        + BaseName).str());
 }
 
@@ -375,3 +420,12 @@ void MCJIT::NotifyFreeingObject(const ObjectImage& Obj) {
     EventListeners[I]->NotifyFreeingObject(Obj);
   }
 }
+void MCJIT::NotifyRelocationsResolved(const ObjectImage& Obj) {
+  MutexGuard locked(lock);
+  if (EventListeners.empty())
+    return;
+  RuntimeDyld::ResolveStats Stats = Dyld->getResolveStats();
+  for (unsigned I = 0, S = EventListeners.size(); I < S; ++I) {
+    EventListeners[I]->NotifyRelocationsResolved(Obj, Stats);
+  }
+}
@@ -31,13 +31,14 @@ class MCJIT : public ExecutionEngine {
   TargetMachine *TM;
   MCContext *Ctx;
   RTDyldMemoryManager *MemMgr;
-  RuntimeDyld Dyld;
+  OwningPtr<RuntimeDyld> Dyld;
   SmallVector<JITEventListener*, 2> EventListeners;
 
   // FIXME: Add support for multiple modules
   bool IsLoaded;
   Module *M;
   OwningPtr<ObjectImage> LoadedObject;
+  StringRef RegisteredEHFrames;
 
   // An optional ObjectCache to be notified of compiled objects and used to
   // perform lookup of pre-compiled code to avoid re-compilation.
@@ -52,6 +53,15 @@ public:
   /// Sets the object manager that MCJIT should use to avoid compilation.
   virtual void setObjectCache(ObjectCache *manager);
 
+  /// addModule - Add a module to the engine. If the module of the engine was
+  /// removed, the new module takes its place and is compiled on first use.
+  virtual void addModule(Module *M);
+
+  /// removeModule - Remove a module from the engine. If it is the module
+  /// compiled by the engine, its code and data are freed and the memory
+  /// manager may reuse the memory for the next module.
+  virtual bool removeModule(Module *M);
+
   virtual void finalizeObject();
 
   virtual void *getPointerToBasicBlock(BasicBlock *BB);
@@ -82,7 +92,7 @@ public:
   /// This is the address which will be used for relocation resolution.
   virtual void mapSectionAddress(const void *LocalAddress,
                                  uint64_t TargetAddress) {
-    Dyld.mapSectionAddress(LocalAddress, TargetAddress);
+    Dyld->mapSectionAddress(LocalAddress, TargetAddress);
   }
 
   virtual void RegisterJITEventListener(JITEventListener *L);
@@ -116,6 +126,7 @@ protected:
 
   void NotifyObjectEmitted(const ObjectImage& Obj);
   void NotifyFreeingObject(const ObjectImage& Obj);
+  void NotifyRelocationsResolved(const ObjectImage& Obj);
 };
 
 } // End llvm namespace
@@ -16,6 +16,8 @@
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Process.h"
+#include <algorithm>
 
 #ifdef __linux__
   // These includes used by SectionMemoryManager::getPointerToNamedFunction()
@@ -55,46 +57,66 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   uintptr_t RequiredSize = Alignment * ((Size + Alignment - 1)/Alignment + 1);
   uintptr_t Addr = 0;
 
-  // Look in the list of free memory regions and use a block there if one
-  // is available.
+  // Look in the list of free memory regions of the current owner and use a
+  // block there if one is available.
   for (int i = 0, e = MemGroup.FreeMem.size(); i != e; ++i) {
-    sys::MemoryBlock &MB = MemGroup.FreeMem[i];
+    FreeMemBlock &FreeMB = MemGroup.FreeMem[i];
+    AllocatedBlock &Allocated = MemGroup.AllocatedMem[FreeMB.AllocatedIndex];
+    if (Allocated.Owner != Owner)
+      continue;
+    sys::MemoryBlock &MB = FreeMB.Free;
     if (MB.size() >= RequiredSize) {
       Addr = (uintptr_t)MB.base();
       uintptr_t EndOfBlock = Addr + MB.size();
       // Align the address.
       Addr = (Addr + Alignment - 1) & ~(uintptr_t)(Alignment - 1);
       // Store cutted free memory block.
-      MemGroup.FreeMem[i] = sys::MemoryBlock((void*)(Addr + Size),
-                                             EndOfBlock - Addr - Size);
+      MB = sys::MemoryBlock((void*)(Addr + Size), EndOfBlock - Addr - Size);
+      Allocated.SectionBytes += Size;
       return (uint8_t*)Addr;
     }
   }
 
-  // No pre-allocated free block was large enough. Allocate a new memory region.
-  // Note that all sections get allocated as read-write.  The permissions will
-  // be updated later based on memory group.
-  //
-  // FIXME: It would be useful to define a default allocation size (or add
-  // it as a constructor parameter) to minimize the number of allocations.
-  //
-  // FIXME: Initialize the Near member for each memory group to avoid
-  // interleaving.
-  error_code ec;
-  sys::MemoryBlock MB = sys::Memory::allocateMappedMemory(RequiredSize,
-                                                          &MemGroup.Near,
-                                                          sys::Memory::MF_READ |
-                                                            sys::Memory::MF_WRITE,
-                                                          ec);
-  if (ec) {
-    // FIXME: Add error propogation to the interface.
-    return NULL;
+  // No pre-allocated free block was large enough. Reuse the smallest released
+  // block which fits; it has been made read-write again when it was freed.
+  sys::MemoryBlock MB;
+  unsigned BestFit = MemGroup.ReleasedMem.size();
+  for (unsigned i = 0, e = MemGroup.ReleasedMem.size(); i != e; ++i) {
+    size_t ReleasedSize = MemGroup.ReleasedMem[i].size();
+    if (ReleasedSize >= RequiredSize &&
+        (BestFit == e || ReleasedSize < MemGroup.ReleasedMem[BestFit].size()))
+      BestFit = i;
   }
 
-  // Save this address as the basis for our next request
-  MemGroup.Near = MB;
+  if (BestFit != MemGroup.ReleasedMem.size()) {
+    MB = MemGroup.ReleasedMem[BestFit];
+    MemGroup.ReleasedMem.erase(MemGroup.ReleasedMem.begin() + BestFit);
+  } else {
+    // Allocate a new memory region. Note that all sections get allocated as
+    // read-write.  The permissions will be updated later based on memory
+    // group.  Regions are at least SlabSize bytes, so that the sections
+    // allocated afterwards are packed next to this one.
+    //
+    // FIXME: Initialize the Near member for each memory group to avoid
+    // interleaving.
+    error_code ec;
+    unsigned Flags = sys::Memory::MF_READ | sys::Memory::MF_WRITE;
+    if (HugePages)
+      Flags |= sys::Memory::MF_HUGE_HINT;
+    MB = sys::Memory::allocateMappedMemory(std::max<uintptr_t>(RequiredSize,
+                                                               SlabSize),
+                                           &MemGroup.Near, Flags, ec);
+    if (ec) {
+      // FIXME: Add error propogation to the interface.
+      return NULL;
+    }
 
-  MemGroup.AllocatedMem.push_back(MB);
+    // Save this address as the basis for our next request
+    MemGroup.Near = MB;
+  }
+
+  MemGroup.AllocatedMem.push_back(AllocatedBlock(MB, Owner));
+  MemGroup.AllocatedMem.back().SectionBytes = Size;
   Addr = (uintptr_t)MB.base();
   uintptr_t EndOfBlock = Addr + MB.size();
 
@@ -105,12 +127,97 @@ uint8_t *SectionMemoryManager::allocateSection(MemoryGroup &MemGroup,
   // this case, we store the unused memory as a free memory block.
   unsigned FreeSize = EndOfBlock-Addr-Size;
   if (FreeSize > 16)
-    MemGroup.FreeMem.push_back(sys::MemoryBlock((void*)(Addr + Size), FreeSize));
+    MemGroup.FreeMem.push_back(
+      FreeMemBlock(sys::MemoryBlock((void*)(Addr + Size), FreeSize),
+                   MemGroup.AllocatedMem.size() - 1));
 
   // Return aligned address
   return (uint8_t*)Addr;
 }
 
+void SectionMemoryManager::setSectionOwner(const void *NewOwner) {
+  Owner = NewOwner;
+}
+
+void SectionMemoryManager::freeSections(const void *SectionOwner) {
+  freeMemoryGroupSections(CodeMem, SectionOwner);
+  freeMemoryGroupSections(RODataMem, SectionOwner);
+  freeMemoryGroupSections(RWDataMem, SectionOwner);
+}
+
+void SectionMemoryManager::freeMemoryGroupSections(MemoryGroup &MemGroup,
+                                                   const void *SectionOwner) {
+  uint64_t ReleasedBytes = 0;
+  for (unsigned i = 0, e = MemGroup.ReleasedMem.size(); i != e; ++i)
+    ReleasedBytes += MemGroup.ReleasedMem[i].size();
+
+  // Remove the blocks of the owner, remembering where the others moved.
+  SmallVector<unsigned, 16> NewIndex;
+  unsigned NumKept = 0;
+  for (unsigned i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
+    AllocatedBlock &Allocated = MemGroup.AllocatedMem[i];
+    if (Allocated.Owner != SectionOwner) {
+      NewIndex.push_back(NumKept);
+      MemGroup.AllocatedMem[NumKept++] = Allocated;
+      continue;
+    }
+    NewIndex.push_back(~0U);
+
+    // Keep the block for reuse unless too much memory is kept already. It
+    // loses the execute permission, so that stale calls into it fault.
+    sys::MemoryBlock MB = Allocated.Block;
+    if (ReleasedBytes + MB.size() <= MaxReleasedBytes &&
+        !sys::Memory::protectMappedMemory(MB, sys::Memory::MF_READ |
+                                                sys::Memory::MF_WRITE)) {
+      MemGroup.ReleasedMem.push_back(MB);
+      ReleasedBytes += MB.size();
+    } else {
+      sys::Memory::releaseMappedMemory(MB);
+    }
+  }
+  MemGroup.AllocatedMem.erase(MemGroup.AllocatedMem.begin() + NumKept,
+                              MemGroup.AllocatedMem.end());
+
+  // Drop the free memory of the removed blocks.
+  unsigned NumFree = 0;
+  for (unsigned i = 0, e = MemGroup.FreeMem.size(); i != e; ++i) {
+    FreeMemBlock &FreeMB = MemGroup.FreeMem[i];
+    if (NewIndex[FreeMB.AllocatedIndex] == ~0U)
+      continue;
+    FreeMB.AllocatedIndex = NewIndex[FreeMB.AllocatedIndex];
+    MemGroup.FreeMem[NumFree++] = FreeMB;
+  }
+  MemGroup.FreeMem.erase(MemGroup.FreeMem.begin() + NumFree,
+                         MemGroup.FreeMem.end());
+}
+
+void SectionMemoryManager::addMemoryGroupStats(const MemoryGroup &MemGroup,
+                                               MemoryStats &Stats) {
+  for (unsigned i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
+    Stats.MappedBytes += MemGroup.AllocatedMem[i].Block.size();
+    Stats.SectionBytes += MemGroup.AllocatedMem[i].SectionBytes;
+    ++Stats.NumAllocatedBlocks;
+  }
+  for (unsigned i = 0, e = MemGroup.FreeMem.size(); i != e; ++i)
+    Stats.FreeBytes += MemGroup.FreeMem[i].Free.size();
+  for (unsigned i = 0, e = MemGroup.ReleasedMem.size(); i != e; ++i) {
+    uint64_t Size = MemGroup.ReleasedMem[i].size();
+    Stats.MappedBytes += Size;
+    Stats.ReleasedBytes += Size;
+    Stats.LargestReleasedBlock = std::max(Stats.LargestReleasedBlock, Size);
+    ++Stats.NumReleasedBlocks;
+  }
+}
+
+SectionMemoryManager::MemoryStats
+SectionMemoryManager::getMemoryStats() const {
+  MemoryStats Stats = MemoryStats();
+  addMemoryGroupStats(CodeMem, Stats);
+  addMemoryGroupStats(RODataMem, Stats);
+  addMemoryGroupStats(RWDataMem, Stats);
+  return Stats;
+}
+
 bool SectionMemoryManager::applyPermissions(std::string *ErrMsg)
 {
   // FIXME: Should in-progress permissions be reverted if an error occurs?
@@ -157,13 +264,15 @@ bool SectionMemoryManager::applyPermissions(std::string *ErrMsg)
 #if HAVE_EHTABLE_SUPPORT
 extern "C" void __register_frame(void*);
 
-static const char *processFDE(const char *Entry) {
+extern "C" void __deregister_frame(void*);
+
+static const char *processFDE(const char *Entry, void (*Process)(void*)) {
   const char *P = Entry;
   uint32_t Length = *((uint32_t*)P);
   P += 4;
   uint32_t Offset = *((uint32_t*)P);
   if (Offset != 0)
-    __register_frame((void*)Entry);
+    Process((void*)Entry);
   return P + Length;
 }
 #endif
@@ -173,30 +282,90 @@ void SectionMemoryManager::registerEHFrames(StringRef SectionData) {
   const char *P = SectionData.data();
   const char *End = SectionData.data() + SectionData.size();
   do  {
-    P = processFDE(P);
+    P = processFDE(P, __register_frame);
+  } while(P != End);
+#endif
+}
+
+void SectionMemoryManager::deregisterEHFrames(StringRef SectionData) {
+#if HAVE_EHTABLE_SUPPORT
+  const char *P = SectionData.data();
+  const char *End = SectionData.data() + SectionData.size();
+  do  {
+    P = processFDE(P, __deregister_frame);
   } while(P != End);
 #endif
 }
 
+static bool compareBlockAddress(const sys::MemoryBlock &A,
+                                const sys::MemoryBlock &B) {
+  return A.base() < B.base();
+}
+
 error_code SectionMemoryManager::applyMemoryGroupPermissions(MemoryGroup &MemGroup,
                                                              unsigned Permissions) {
-
-  for (int i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
-      error_code ec;
-      ec = sys::Memory::protectMappedMemory(MemGroup.AllocatedMem[i],
-                                            Permissions);
-      if (ec) {
-        return ec;
+  static const size_t PageSize = sys::process::get_self()->page_size();
+
+  SmallVector<int, 16> FreeIndex(MemGroup.AllocatedMem.size(), -1);
+  for (unsigned i = 0, e = MemGroup.FreeMem.size(); i != e; ++i)
+    FreeIndex[MemGroup.FreeMem[i].AllocatedIndex] = i;
+
+  // Only the pages written since the permissions were last applied change.
+  // The pages of a block past the end of its sections stay read-write for
+  // later sections, so that a block is filled before a new one is mapped.
+  SmallVector<sys::MemoryBlock, 16> Ranges;
+  for (unsigned i = 0, e = MemGroup.AllocatedMem.size(); i != e; ++i) {
+    AllocatedBlock &Allocated = MemGroup.AllocatedMem[i];
+    uintptr_t Base = (uintptr_t)Allocated.Block.base();
+    uintptr_t End = Base + Allocated.Block.size();
+    if (FreeIndex[i] != -1) {
+      sys::MemoryBlock &Free = MemGroup.FreeMem[FreeIndex[i]].Free;
+      uintptr_t Used = RoundUpToAlignment((uintptr_t)Free.base(), PageSize);
+      if (Used < End) {
+        Free = sys::MemoryBlock((void*)Used, End - Used);
+        End = Used;
+      } else {
+        Free = sys::MemoryBlock();
       }
+    }
+    uintptr_t Start = Base + Allocated.ProtectedSize;
+    if (Start < End)
+      Ranges.push_back(sys::MemoryBlock((void*)Start, End - Start));
+    Allocated.ProtectedSize = End - Base;
+  }
+
+  // Blocks are usually mapped next to each other, so change the permissions
+  // of adjacent ranges together.
+  std::sort(Ranges.begin(), Ranges.end(), compareBlockAddress);
+  for (unsigned i = 0, e = Ranges.size(); i != e;) {
+    uintptr_t Start = (uintptr_t)Ranges[i].base();
+    uintptr_t End = Start + Ranges[i].size();
+    for (++i; i != e && (uintptr_t)Ranges[i].base() == End; ++i)
+      End += Ranges[i].size();
+    error_code ec;
+    ec = sys::Memory::protectMappedMemory(
+        sys::MemoryBlock((void*)Start, End - Start), Permissions);
+    if (ec) {
+      return ec;
+    }
   }
 
+  // Drop the free memory which is no longer writable.
+  unsigned NumFree = 0;
+  for (unsigned i = 0, e = MemGroup.FreeMem.size(); i != e; ++i)
+    if (MemGroup.FreeMem[i].Free.size())
+      MemGroup.FreeMem[NumFree++] = MemGroup.FreeMem[i];
+  MemGroup.FreeMem.erase(MemGroup.FreeMem.begin() + NumFree,
+                         MemGroup.FreeMem.end());
+
   return error_code::success();
 }
 
 void SectionMemoryManager::invalidateInstructionCache() {
   for (int i = 0, e = CodeMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::InvalidateInstructionCache(CodeMem.AllocatedMem[i].base(),
-                                            CodeMem.AllocatedMem[i].size());
+    sys::Memory::InvalidateInstructionCache(
+      CodeMem.AllocatedMem[i].Block.base(),
+      CodeMem.AllocatedMem[i].Block.size());
 }
 
 static int jit_noop() {
@@ -250,13 +419,21 @@ void *SectionMemoryManager::getPointerToNamedFunction(const std::string &Name,
   return 0;
 }
 
+static void releaseMemoryGroup(SmallVectorImpl<sys::MemoryBlock> &Blocks) {
+  for (unsigned i = 0, e = Blocks.size(); i != e; ++i)
+    sys::Memory::releaseMappedMemory(Blocks[i]);
+}
+
 SectionMemoryManager::~SectionMemoryManager() {
   for (unsigned i = 0, e = CodeMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::releaseMappedMemory(CodeMem.AllocatedMem[i]);
+    sys::Memory::releaseMappedMemory(CodeMem.AllocatedMem[i].Block);
   for (unsigned i = 0, e = RWDataMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::releaseMappedMemory(RWDataMem.AllocatedMem[i]);
+    sys::Memory::releaseMappedMemory(RWDataMem.AllocatedMem[i].Block);
   for (unsigned i = 0, e = RODataMem.AllocatedMem.size(); i != e; ++i)
-    sys::Memory::releaseMappedMemory(RODataMem.AllocatedMem[i]);
+    sys::Memory::releaseMappedMemory(RODataMem.AllocatedMem[i].Block);
+  releaseMemoryGroup(CodeMem.ReleasedMem);
+  releaseMemoryGroup(RWDataMem.ReleasedMem);
+  releaseMemoryGroup(RODataMem.ReleasedMem);
 }
 
 } // namespace llvm
@@ -19,6 +19,10 @@
 #include "RuntimeDyldMachO.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/Timer.h"
+#include <algorithm>
+#include <vector>
 
 using namespace llvm;
 using namespace llvm::object;
@@ -26,6 +30,9 @@ using namespace llvm::object;
 // Empty out-of-line virtual destructor as the key function.
 RTDyldMemoryManager::~RTDyldMemoryManager() {}
 void RTDyldMemoryManager::registerEHFrames(StringRef SectionData) {}
+void RTDyldMemoryManager::deregisterEHFrames(StringRef SectionData) {}
+void RTDyldMemoryManager::setSectionOwner(const void *Owner) {}
+void RTDyldMemoryManager::freeSections(const void *Owner) {}
 RuntimeDyldImpl::~RuntimeDyldImpl() {}
 
 namespace llvm {
@@ -36,18 +43,33 @@ StringRef RuntimeDyldImpl::getEHFrameSection() {
 
 // Resolve the relocations for all symbols we currently know about.
 void RuntimeDyldImpl::resolveRelocations() {
-  // First, resolve relocations associated with external symbols.
-  resolveExternalSymbols();
+  LastResolveStats = RuntimeDyld::ResolveStats();
+  double StartTime = TimeRecord::getCurrentTime(true).getWallTime();
 
-  // Just iterate over the sections we have and resolve all the relocations
-  // in them. Gross overkill, but it gets the job done.
+  // First, find the addresses of the external symbols.
+  SmallVector<RelocationListValue, 64> Lists;
+  resolveExternalSymbols(Lists);
+
+  // Then add the relocations based on every section we have, whose address
+  // may have changed since the last call.
   for (int i = 0, e = Sections.size(); i != e; ++i) {
+    DenseMap<unsigned, RelocationList>::const_iterator I = Relocations.find(i);
+    if (I == Relocations.end())
+      continue;
     uint64_t Addr = Sections[i].LoadAddress;
     DEBUG(dbgs() << "Resolving relocations Section #" << i
             << "\t" << format("%p", (uint8_t *)Addr)
             << "\n");
-    resolveRelocationList(Relocations[i], Addr);
+    Lists.push_back(RelocationListValue(&I->second, Addr));
   }
+
+  double LookupTime = TimeRecord::getCurrentTime(false).getWallTime();
+  LastResolveStats.SymbolLookupTime = LookupTime - StartTime;
+
+  applyRelocationLists(Lists);
+
+  LastResolveStats.ApplyTime =
+    TimeRecord::getCurrentTime(false).getWallTime() - LookupTime;
 }
 
 void RuntimeDyldImpl::mapSectionAddress(const void *LocalAddress,
@@ -438,32 +460,96 @@ void RuntimeDyldImpl::resolveRelocationList(const RelocationList &Relocs,
   }
 }
 
-void RuntimeDyldImpl::resolveExternalSymbols() {
+void RuntimeDyldImpl::resolveExternalSymbols(
+    SmallVectorImpl<RelocationListValue> &Lists) {
   StringMap<RelocationList>::iterator i = ExternalSymbolRelocations.begin(),
                                       e = ExternalSymbolRelocations.end();
   for (; i != e; i++) {
     StringRef Name = i->first();
-    RelocationList &Relocs = i->second;
+    const RelocationList &Relocs = i->second;
     SymbolTableMap::const_iterator Loc = GlobalSymbolTable.find(Name);
-    if (Loc == GlobalSymbolTable.end()) {
-      if (Name.size() == 0) {
-        // This is an absolute symbol, use an address of zero.
-        DEBUG(dbgs() << "Resolving absolute relocations." << "\n");
-        resolveRelocationList(Relocs, 0);
-      } else {
-        // This is an external symbol, try to get its address from
-        // MemoryManager.
-        uint8_t *Addr = (uint8_t*) MemMgr->getPointerToNamedFunction(Name.data(),
-                                                                   true);
-        DEBUG(dbgs() << "Resolving relocations Name: " << Name
-                << "\t" << format("%p", Addr)
-                << "\n");
-        resolveRelocationList(Relocs, (uintptr_t)Addr);
-      }
-    } else {
+    if (Loc != GlobalSymbolTable.end())
       report_fatal_error("Expected external symbol");
+
+    ++LastResolveStats.NumExternalSymbols;
+    if (Name.size() == 0) {
+      // This is an absolute symbol, use an address of zero.
+      DEBUG(dbgs() << "Resolving absolute relocations." << "\n");
+      Lists.push_back(RelocationListValue(&Relocs, 0));
+      continue;
+    }
+
+    // This is an external symbol, try to get its address from MemoryManager
+    // unless it was found by an earlier call.
+    uint64_t Addr;
+    StringMap<uint64_t>::iterator Cached = ExternalSymbolAddresses.find(Name);
+    if (Cached == ExternalSymbolAddresses.end()) {
+      Addr = (uintptr_t)MemMgr->getPointerToNamedFunction(Name.data(), true);
+      ExternalSymbolAddresses[Name] = Addr;
+      ++LastResolveStats.NumSymbolLookups;
+    } else {
+      Addr = Cached->second;
+    }
+    DEBUG(dbgs() << "Resolving relocations Name: " << Name
+            << "\t" << format("%p", (uint8_t*)(uintptr_t)Addr)
+            << "\n");
+    Lists.push_back(RelocationListValue(&Relocs, Addr));
+  }
+}
+
+namespace {
+/// SectionRelocationInfo - The relocations to apply, grouped by the section
+/// they patch.
+struct SectionRelocationInfo {
+  typedef std::vector<std::pair<const RelocationEntry *, uint64_t> >
+    RelocationValueList;
+
+  RuntimeDyldImpl *Dyld;
+  std::vector<RelocationValueList> Sections;
+};
+}
+
+void RuntimeDyldImpl::applySectionRelocations(void *Data, unsigned SectionID) {
+  SectionRelocationInfo &Info = *static_cast<SectionRelocationInfo*>(Data);
+  const SectionRelocationInfo::RelocationValueList &Relocs =
+    Info.Sections[SectionID];
+  for (unsigned i = 0, e = Relocs.size(); i != e; ++i)
+    Info.Dyld->resolveRelocation(*Relocs[i].first, Relocs[i].second);
+}
+
+void RuntimeDyldImpl::applyRelocationLists(
+    ArrayRef<RelocationListValue> Lists) {
+  for (unsigned i = 0, e = Lists.size(); i != e; ++i)
+    LastResolveStats.NumRelocations += Lists[i].first->size();
+
+  if (NumThreads <= 1 || Sections.size() <= 1) {
+    for (unsigned i = 0, e = Lists.size(); i != e; ++i)
+      resolveRelocationList(*Lists[i].first, Lists[i].second);
+    return;
+  }
+
+  // Relocations patching different sections write to different memory, give
+  // each section to a single thread. The relocations of a section keep their
+  // order.
+  SectionRelocationInfo Info;
+  Info.Dyld = this;
+  Info.Sections.resize(Sections.size());
+  for (unsigned i = 0, e = Lists.size(); i != e; ++i) {
+    const RelocationList &Relocs = *Lists[i].first;
+    for (unsigned j = 0, je = Relocs.size(); j != je; ++j) {
+      const RelocationEntry &RE = Relocs[j];
+      // Ignore relocations for sections that were not loaded
+      if (Sections[RE.SectionID].Address == 0)
+        continue;
+      Info.Sections[RE.SectionID].push_back(std::make_pair(&RE,
+                                                           Lists[i].second));
     }
   }
+
+  LastResolveStats.NumThreads = std::min<unsigned>(NumThreads,
+                                                   Sections.size());
+  llvm_parallel_for(Info.Sections.size(), applySectionRelocations, &Info,
+                    NumThreads);
 }
 
 
@@ -478,6 +564,7 @@ RuntimeDyld::RuntimeDyld(RTDyldMemoryManager *mm) {
   // permissions are applied.
   Dyld = 0;
   MM = mm;
+  NumThreads = 1;
 }
 
 RuntimeDyld::~RuntimeDyld() {
@@ -514,6 +601,7 @@ ObjectImage *RuntimeDyld::loadObject(ObjectBuffer *InputBuffer) {
       case sys::COFF_FileType:
         report_fatal_error("Incompatible object format!");
     }
+    Dyld->setNumThreads(NumThreads);
   } else {
     if (!Dyld->isCompatibleFormat(InputBuffer))
       report_fatal_error("Incompatible object format!");
@@ -534,6 +622,18 @@ void RuntimeDyld::resolveRelocations() {
   Dyld->resolveRelocations();
 }
 
+void RuntimeDyld::setNumThreads(unsigned N) {
+  NumThreads = N;
+  if (Dyld)
+    Dyld->setNumThreads(N);
+}
+
+RuntimeDyld::ResolveStats RuntimeDyld::getResolveStats() const {
+  if (!Dyld)
+    return ResolveStats();
+  return Dyld->getResolveStats();
+}
+
 void RuntimeDyld::reassignSectionAddress(unsigned SectionID,
                                          uint64_t Addr) {
   Dyld->reassignSectionAddress(SectionID, Addr);
@@ -14,6 +14,7 @@
 #ifndef LLVM_RUNTIME_DYLD_IMPL_H
 #define LLVM_RUNTIME_DYLD_IMPL_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
@@ -161,6 +162,18 @@ protected:
   // modules.  This map is indexed by symbol name.
   StringMap<RelocationList> ExternalSymbolRelocations;
 
+  // Addresses of the external symbols which have been looked up in the
+  // memory manager, indexed by symbol name.
+  StringMap<uint64_t> ExternalSymbolAddresses;
+
+  // A list of relocations and the address they refer to.
+  typedef std::pair<const RelocationList *, uint64_t> RelocationListValue;
+
+  // The number of threads relocations are applied on.
+  unsigned NumThreads;
+
+  RuntimeDyld::ResolveStats LastResolveStats;
+
   typedef std::map<RelocationValueRef, uintptr_t> StubMap;
 
   Triple::ArchType Arch;
@@ -290,11 +303,20 @@ protected:
                                     const SymbolTableMap &Symbols,
                                     StubMap &Stubs) = 0;
 
-  /// \brief Resolve relocations to external symbols.
-  void resolveExternalSymbols();
+  /// \brief Adds the relocations to external symbols to Lists, with the
+  ///        addresses of their symbols.
+  void resolveExternalSymbols(SmallVectorImpl<RelocationListValue> &Lists);
+
+  /// \brief Applies the relocations of Lists, in parallel when more than one
+  ///        thread is allowed.
+  void applyRelocationLists(ArrayRef<RelocationListValue> Lists);
+
+  static void applySectionRelocations(void *Data, unsigned SectionID);
+
   virtual ObjectImage *createObjectImage(ObjectBuffer *InputBuffer);
 public:
-  RuntimeDyldImpl(RTDyldMemoryManager *mm) : MemMgr(mm), HasError(false) {}
+  RuntimeDyldImpl(RTDyldMemoryManager *mm)
+    : MemMgr(mm), NumThreads(1), HasError(false) {}
 
   virtual ~RuntimeDyldImpl();
 
@@ -320,6 +342,12 @@ public:
 
   void resolveRelocations();
 
+  void setNumThreads(unsigned N) { NumThreads = N ? N : 1; }
+
+  const RuntimeDyld::ResolveStats &getResolveStats() const {
+    return LastResolveStats;
+  }
+
   void reassignSectionAddress(unsigned SectionID, uint64_t Addr);
 
   void mapSectionAddress(const void *LocalAddress, uint64_t TargetAddress);
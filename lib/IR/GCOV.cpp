@@ -15,8 +15,10 @@
 #include "llvm/Support/GCOV.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryObject.h"
 #include "llvm/Support/system_error.h"
+#include <algorithm>
 using namespace llvm;
 
 //===----------------------------------------------------------------------===//
@@ -74,7 +76,6 @@ void GCOVFile::collectLineCounts(FileInfo &FI) {
   for (SmallVector<GCOVFunction *, 16>::iterator I = Functions.begin(),
          E = Functions.end(); I != E; ++I) 
     (*I)->collectLineCounts(FI);
-  FI.print();
 }
 
 //===----------------------------------------------------------------------===//
@@ -219,7 +220,7 @@ void GCOVBlock::dump() {
 /// collectLineCounts - Collect line counts. This must be used after
 /// reading .gcno and .gcda files.
 void GCOVLines::collectLineCounts(FileInfo &FI, StringRef Filename, 
-                                  uint32_t Count) {
+                                  uint64_t Count) {
   for (SmallVector<uint32_t, 16>::iterator I = Lines.begin(),
          E = Lines.end(); I != E; ++I)
     FI.addLineCount(Filename, *I, Count);
@@ -232,52 +233,117 @@ void GCOVLines::dump() {
     outs() << (*I) << ",";
 }
 
+//===----------------------------------------------------------------------===//
+// LineCounts implementation.
+
+/// add - Record that a block with the given count maps to Line. A line that
+/// several blocks map to gets the largest of their counts.
+void LineCounts::add(uint32_t Line, uint64_t Count) {
+  assert(Line != 0 && "Line numbers start at 1!");
+  if (Line > Counts.size()) {
+    Counts.resize(Line);
+    Instrumented.resize(Line);
+  }
+  Counts[Line-1] = std::max(Counts[Line-1], Count);
+  Instrumented.set(Line-1);
+}
+
+/// merge - Add the counts of Other, collected from another run or
+/// translation unit, to these counts.
+void LineCounts::merge(const LineCounts &Other) {
+  if (Other.Counts.size() > Counts.size()) {
+    Counts.resize(Other.Counts.size());
+    Instrumented.resize(Other.Counts.size());
+  }
+  for (unsigned i = 0, e = Other.Counts.size(); i != e; ++i)
+    Counts[i] += Other.Counts[i];
+  Instrumented |= Other.Instrumented;
+}
+
+/// getNumExecuted - Return the number of instrumented lines with a non-zero
+/// count.
+unsigned LineCounts::getNumExecuted() const {
+  unsigned Executed = 0;
+  for (unsigned i = 0, e = Counts.size(); i != e; ++i)
+    if (Counts[i])
+      ++Executed;
+  return Executed;
+}
+
 //===----------------------------------------------------------------------===//
 // FileInfo implementation.
 
 /// addLineCount - Add line count for the given line number in a file.
-void FileInfo::addLineCount(StringRef Filename, uint32_t Line, uint32_t Count) {
-  if (LineInfo.find(Filename) == LineInfo.end()) {
-    OwningPtr<MemoryBuffer> Buff;
-    if (error_code ec = MemoryBuffer::getFileOrSTDIN(Filename, Buff)) {
-      errs() << Filename << ": " << ec.message() << "\n";
-      return;
-    }
-    StringRef AllLines = Buff.take()->getBuffer();
-    LineCounts L(AllLines.count('\n')+2);
-    L[Line-1] = Count;
-    LineInfo[Filename] = L;
-    return;
-  }
-  LineCounts &L = LineInfo[Filename];
-  L[Line-1] = Count;
+void FileInfo::addLineCount(StringRef Filename, uint32_t Line, uint64_t Count) {
+  LineInfo[Filename].add(Line, Count);
+}
+
+/// merge - Merge the line counts of Other into this FileInfo.
+void FileInfo::merge(const FileInfo &Other) {
+  for (StringMap<LineCounts>::const_iterator I = Other.LineInfo.begin(),
+         E = Other.LineInfo.end(); I != E; ++I)
+    LineInfo[I->first()].merge(I->second);
+}
+
+void FileInfo::getSortedFilenames(SmallVectorImpl<StringRef> &Filenames) const {
+  for (StringMap<LineCounts>::const_iterator I = LineInfo.begin(),
+         E = LineInfo.end(); I != E; ++I)
+    Filenames.push_back(I->first());
+  std::sort(Filenames.begin(), Filenames.end());
 }
 
 /// print -  Print source files with collected line count information.
-void FileInfo::print() {
-  for (StringMap<LineCounts>::iterator I = LineInfo.begin(), E = LineInfo.end();
-       I != E; ++I) {
-    StringRef Filename = I->first();
-    outs() << Filename << "\n";
-    LineCounts &L = LineInfo[Filename];
+void FileInfo::print(raw_ostream &OS) {
+  SmallVector<StringRef, 16> Filenames;
+  getSortedFilenames(Filenames);
+  for (unsigned i = 0, e = Filenames.size(); i != e; ++i) {
+    StringRef Filename = Filenames[i];
+    OS << Filename << "\n";
+    const LineCounts &L = LineInfo[Filename];
     OwningPtr<MemoryBuffer> Buff;
     if (error_code ec = MemoryBuffer::getFileOrSTDIN(Filename, Buff)) {
       errs() << Filename << ": " << ec.message() << "\n";
-      return;
+      continue;
     }
-    StringRef AllLines = Buff.take()->getBuffer();
-    for (unsigned i = 0, e = L.size(); i != e; ++i) {
-      if (L[i])
-        outs() << L[i] << ":\t";
+    StringRef AllLines = Buff->getBuffer();
+    for (unsigned Line = 0; !AllLines.empty(); ++Line) {
+      if (Line < L.Counts.size() && L.Counts[Line])
+        OS << L.Counts[Line] << ":\t";
       else
-        outs() << " :\t";
+        OS << " :\t";
       std::pair<StringRef, StringRef> P = AllLines.split('\n');
-      if (AllLines != P.first)
-        outs() << P.first;
-      outs() << "\n";
+      OS << P.first << "\n";
       AllLines = P.second;
     }
   }
 }
 
+static void printLinesExecuted(raw_ostream &OS, unsigned Executed,
+                               unsigned Instrumented) {
+  OS << "Lines executed:";
+  if (Instrumented)
+    OS << format("%.2f", Executed * 100.0 / Instrumented) << "% of "
+       << Instrumented << "\n";
+  else
+    OS << "No executable lines\n";
+}
 
+/// printSummary - Print the number of executed lines of each file. This
+/// does not read the source files.
+void FileInfo::printSummary(raw_ostream &OS) {
+  SmallVector<StringRef, 16> Filenames;
+  getSortedFilenames(Filenames);
+  unsigned TotalExecuted = 0, TotalInstrumented = 0;
+  for (unsigned i = 0, e = Filenames.size(); i != e; ++i) {
+    const LineCounts &L = LineInfo[Filenames[i]];
+    unsigned Executed = L.getNumExecuted();
+    unsigned Instrumented = L.getNumInstrumented();
+    OS << "File '" << Filenames[i] << "'\n";
+    printLinesExecuted(OS, Executed, Instrumented);
+    OS << "\n";
+    TotalExecuted += Executed;
+    TotalInstrumented += Instrumented;
+  }
+  OS << "Total: " << Filenames.size() << " files\n";
+  printLinesExecuted(OS, TotalExecuted, TotalInstrumented);
+}
@@ -23,6 +23,8 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/PassNameParser.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -488,6 +490,183 @@ public:
 
 static TimingInfo *TheTimeInfo;
 
+static cl::opt<std::string>
+PassTraceFile("pass-trace", cl::Hidden, cl::value_desc("filename"),
+              cl::desc("Write a CSV record of every pass execution to the "
+                       "specified file"));
+
+static cl::opt<unsigned>
+PassTraceThreshold("pass-trace-threshold", cl::Hidden, cl::init(0),
+                   cl::value_desc("microseconds"),
+                   cl::desc("Only record the pass executions in the "
+                            "-pass-trace file that take at least this long"));
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+/// PassTrace Class - This class writes a line to the -pass-trace file for each
+/// pass execution: the pass, the function it ran on, the wall time it took,
+/// the number of instructions it saw before and after running, and how much
+/// the heap grew meanwhile.  Unlike -time-passes, nothing is aggregated, so
+/// the trace shows which input functions a pass spends its time on.
+///
+/// With -pass-trace-threshold, only the time is measured up front, so that
+/// the many short executions which are not recorded don't pay for walking the
+/// IR.  The instructions before and the heap growth are then left empty, and
+/// the instructions after are counted only for executions that are recorded.
+///
+class PassTrace {
+  raw_fd_ostream *OS;
+  sys::SmartMutex<true> Lock;
+
+  void writeField(StringRef Str);
+public:
+  PassTrace();
+  ~PassTrace() { delete OS; }
+
+  /// get - Return the trace, or null if -pass-trace is not enabled.
+  static PassTrace *get();
+
+  /// isFiltered - Return true if only the executions that take at least
+  /// -pass-trace-threshold are recorded.
+  static bool isFiltered() { return PassTraceThreshold != 0; }
+
+  /// record - Append an execution of P on the named function to the trace.
+  /// InstsBefore and HeapGrowth are only written if HaveBefore is set.
+  void record(Pass *P, StringRef FunctionName, uint64_t WallTime,
+              bool HaveBefore, unsigned InstsBefore, unsigned InstsAfter,
+              int64_t HeapGrowth);
+};
+
+/// PassTraceRegion - Measure the execution of a pass on a module, function or
+/// basic block for as long as this object lives, and record it in the trace.
+/// The region is a no-op when -pass-trace is not enabled.
+///
+class PassTraceRegion {
+  PassTrace *Trace;
+  Pass *P;
+  Module *M;
+  Function *F;
+  BasicBlock *BB;
+  unsigned InstsBefore;
+  size_t HeapBefore;
+  sys::TimeValue StartTime;
+
+  unsigned getInstructionCount() const;
+  void start();
+public:
+  PassTraceRegion(Pass *P, Module &M)
+    : Trace(PassTrace::get()), P(P), M(&M), F(0), BB(0) { start(); }
+  PassTraceRegion(Pass *P, Function &F)
+    : Trace(PassTrace::get()), P(P), M(0), F(&F), BB(0) { start(); }
+  PassTraceRegion(Pass *P, BasicBlock &BB)
+    : Trace(PassTrace::get()), P(P), M(0), F(BB.getParent()), BB(&BB) {
+    start();
+  }
+  ~PassTraceRegion();
+};
+
+} // End of anon namespace
+
+static ManagedStatic<PassTrace> ThePassTrace;
+
+PassTrace::PassTrace() {
+  std::string Error;
+  OS = new raw_fd_ostream(PassTraceFile.c_str(), Error);
+  if (!Error.empty()) {
+    errs() << "Error opening pass trace file '" << PassTraceFile << "': "
+           << Error << '\n';
+    delete OS;
+    OS = 0;
+    return;
+  }
+  *OS << "pass,function,wall_usec,insts_before,insts_after,heap_growth\n";
+}
+
+PassTrace *PassTrace::get() {
+  if (PassTraceFile.empty())
+    return 0;
+  PassTrace *T = &*ThePassTrace;
+  return T->OS ? T : 0;
+}
+
+/// writeField - Write Str as a quoted CSV field.
+void PassTrace::writeField(StringRef Str) {
+  *OS << '"';
+  for (StringRef::iterator I = Str.begin(), E = Str.end(); I != E; ++I) {
+    if (*I == '"')
+      *OS << '"';
+    *OS << *I;
+  }
+  *OS << '"';
+}
+
+void PassTrace::record(Pass *P, StringRef FunctionName, uint64_t WallTime,
+                       bool HaveBefore, unsigned InstsBefore,
+                       unsigned InstsAfter, int64_t HeapGrowth) {
+  sys::SmartScopedLock<true> Guard(Lock);
+  writeField(P->getPassName());
+  *OS << ',';
+  writeField(FunctionName);
+  *OS << ',' << WallTime << ',';
+  if (HaveBefore)
+    *OS << InstsBefore;
+  *OS << ',' << InstsAfter << ',';
+  if (HaveBefore)
+    *OS << HeapGrowth;
+  *OS << '\n';
+}
+
+/// getInstructionCount - Return the number of instructions in the unit of IR
+/// the pass runs on.
+unsigned PassTraceRegion::getInstructionCount() const {
+  if (BB)
+    return BB->size();
+
+  unsigned Count = 0;
+  if (F) {
+    for (Function::iterator I = F->begin(), E = F->end(); I != E; ++I)
+      Count += I->size();
+    return Count;
+  }
+
+  for (Module::iterator FI = M->begin(), FE = M->end(); FI != FE; ++FI)
+    for (Function::iterator I = FI->begin(), E = FI->end(); I != E; ++I)
+      Count += I->size();
+  return Count;
+}
+
+void PassTraceRegion::start() {
+  if (!Trace)
+    return;
+  // Count instructions first, so that counting is not part of the time.
+  if (!PassTrace::isFiltered()) {
+    InstsBefore = getInstructionCount();
+    HeapBefore = sys::Process::GetMallocUsage();
+  }
+  StartTime = sys::TimeValue::now();
+}
+
+PassTraceRegion::~PassTraceRegion() {
+  if (!Trace)
+    return;
+  sys::TimeValue Elapsed = sys::TimeValue::now() - StartTime;
+  StringRef FunctionName = F ? F->getName() : StringRef();
+  if (PassTrace::isFiltered()) {
+    // Most executions are below the threshold; don't walk the IR for them.
+    if (Elapsed.usec() < PassTraceThreshold)
+      return;
+    Trace->record(P, FunctionName, Elapsed.usec(), false, 0,
+                  getInstructionCount(), 0);
+    return;
+  }
+
+  int64_t HeapGrowth =
+    int64_t(sys::Process::GetMallocUsage()) - int64_t(HeapBefore);
+  Trace->record(P, FunctionName, Elapsed.usec(), true, InstsBefore,
+                getInstructionCount(), HeapGrowth);
+}
+
 //===----------------------------------------------------------------------===//
 // PMTopLevelManager implementation
 
@@ -586,6 +765,10 @@ AnalysisUsage *PMTopLevelManager::findAnalysisUsage(Pass *P) {
 /// the manager. Remove dead passes. This is a recursive function.
 void PMTopLevelManager::schedulePass(Pass *P) {
 
+  // Scheduling looks passes up by ID and creates the ones P requires, so the
+  // passes whose registration was deferred have to be registered now.
+  PassRegistry::getPassRegistry()->runLazyInitializers();
+
   // TODO : Allocate function manager for this pass, other wise required set
   // may be inserted into previous function manager
 
@@ -1299,6 +1482,7 @@ bool BBPassManager::runOnFunction(Function &F) {
         // If the pass crashes, remember this.
         PassManagerPrettyStackEntry X(BP, *I);
         TimeRegion PassTimer(getPassTimer(BP));
+        PassTraceRegion Trace(BP, *I);
 
         LocalChanged |= BP->runOnBasicBlock(*I);
       }
@@ -1526,6 +1710,7 @@ bool FPPassManager::runOnFunction(Function &F) {
     {
       PassManagerPrettyStackEntry X(FP, F);
       TimeRegion PassTimer(getPassTimer(FP));
+      PassTraceRegion Trace(FP, F);
 
       LocalChanged |= FP->runOnFunction(F);
     }
@@ -1604,6 +1789,7 @@ MPPassManager::runOnModule(Module &M) {
     {
       PassManagerPrettyStackEntry X(MP, M);
       TimeRegion PassTimer(getPassTimer(MP));
+      PassTraceRegion Trace(MP, M);
 
       LocalChanged |= MP->runOnModule(M);
     }
@@ -18,9 +18,12 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/IR/Function.h"
 #include "llvm/PassSupport.h"
+#include "llvm/Support/Atomic.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/raw_ostream.h"
 #include <vector>
 
 using namespace llvm;
@@ -37,6 +40,16 @@ PassRegistry *PassRegistry::getPassRegistry() {
 
 static ManagedStatic<sys::SmartMutex<true> > Lock;
 
+/// LazyLock - Held while the lazy initializers run, so that a thread needing
+/// the passes they register waits for all of them.  It is not Lock because
+/// the initializers take Lock to register each pass.
+static ManagedStatic<sys::SmartMutex<true> > LazyLock;
+
+/// PendingLazyInitializers - The number of lazy initializers that have been
+/// added but have not finished running.  Once it is zero, runLazyInitializers
+/// returns without taking either lock.
+static volatile sys::cas_flag PendingLazyInitializers = 0;
+
 //===----------------------------------------------------------------------===//
 // PassRegistryImpl
 //
@@ -58,6 +71,10 @@ struct PassRegistryImpl {
   
   std::vector<const PassInfo*> ToFree;
   std::vector<PassRegistrationListener*> Listeners;
+
+  /// LazyInitializers - The initializers deferred with addLazyInitializer
+  /// that have not been run yet.
+  std::vector<void (*)(PassRegistry &)> LazyInitializers;
 };
 } // end anonymous namespace
 
@@ -91,8 +108,20 @@ const PassInfo *PassRegistry::getPassInfo(const void *TI) const {
 }
 
 const PassInfo *PassRegistry::getPassInfo(StringRef Arg) const {
-  sys::SmartScopedLock<true> Guard(*Lock);
   PassRegistryImpl *Impl = static_cast<PassRegistryImpl*>(getImpl());
+  {
+    sys::SmartScopedLock<true> Guard(*Lock);
+    PassRegistryImpl::StringMapType::const_iterator
+      I = Impl->PassInfoStringMap.find(Arg);
+    if (I != Impl->PassInfoStringMap.end())
+      return I->second;
+    if (Impl->LazyInitializers.empty())
+      return 0;
+  }
+
+  // The pass may be one of those whose registration was deferred.
+  const_cast<PassRegistry*>(this)->runLazyInitializers();
+  sys::SmartScopedLock<true> Guard(*Lock);
   PassRegistryImpl::StringMapType::const_iterator
     I = Impl->PassInfoStringMap.find(Arg);
   return I != Impl->PassInfoStringMap.end() ? I->second : 0;
@@ -109,7 +138,16 @@ void PassRegistry::registerPass(const PassInfo &PI, bool ShouldFree) {
     Impl->PassInfoMap.insert(std::make_pair(PI.getTypeInfo(),&PI)).second;
   assert(Inserted && "Pass registered multiple times!");
   (void)Inserted;
-  Impl->PassInfoStringMap[PI.getPassArgument()] = &PI;
+
+  // Passes that can be created from the command line need distinct arguments.
+  const PassInfo *&ArgInfo = Impl->PassInfoStringMap[PI.getPassArgument()];
+  if (ArgInfo && ArgInfo != &PI && *PI.getPassArgument() &&
+      PI.getNormalCtor() && ArgInfo->getNormalCtor()) {
+    errs() << "Two passes with the same argument (-"
+           << PI.getPassArgument() << ") attempted to be registered!\n";
+    llvm_unreachable(0);
+  }
+  ArgInfo = &PI;
   
   // Notify any listeners.
   for (std::vector<PassRegistrationListener*>::iterator
@@ -132,6 +170,7 @@ void PassRegistry::unregisterPass(const PassInfo &PI) {
 }
 
 void PassRegistry::enumerateWith(PassRegistrationListener *L) {
+  runLazyInitializers();
   sys::SmartScopedLock<true> Guard(*Lock);
   PassRegistryImpl *Impl = static_cast<PassRegistryImpl*>(getImpl());
   for (PassRegistryImpl::MapType::const_iterator I = Impl->PassInfoMap.begin(),
@@ -185,6 +224,36 @@ void PassRegistry::registerAnalysisGroup(const void *InterfaceID,
   if (ShouldFree) Impl->ToFree.push_back(&Registeree);
 }
 
+void PassRegistry::addLazyInitializer(void (*Init)(PassRegistry &)) {
+  sys::SmartScopedLock<true> Guard(*Lock);
+  PassRegistryImpl *Impl = static_cast<PassRegistryImpl*>(getImpl());
+  Impl->LazyInitializers.push_back(Init);
+  sys::AtomicIncrement(&PendingLazyInitializers);
+}
+
+void PassRegistry::runLazyInitializers() {
+  // The count only drops to zero after the last initializer has run, so the
+  // passes they register are all visible once it is seen to be zero.
+  if (PendingLazyInitializers == 0) {
+    sys::MemoryFence();
+    return;
+  }
+
+  sys::SmartScopedLock<true> LazyGuard(*LazyLock);
+  std::vector<void (*)(PassRegistry &)> Inits;
+  {
+    sys::SmartScopedLock<true> Guard(*Lock);
+    PassRegistryImpl *Impl = static_cast<PassRegistryImpl*>(getImpl());
+    Inits.swap(Impl->LazyInitializers);
+  }
+
+  for (std::vector<void (*)(PassRegistry &)>::iterator I = Inits.begin(),
+       E = Inits.end(); I != E; ++I) {
+    (*I)(*this);
+    sys::AtomicDecrement(&PendingLazyInitializers);
+  }
+}
+
 void PassRegistry::addRegistrationListener(PassRegistrationListener *L) {
   sys::SmartScopedLock<true> Guard(*Lock);
   PassRegistryImpl *Impl = static_cast<PassRegistryImpl*>(getImpl());
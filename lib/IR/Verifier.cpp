@@ -64,17 +64,38 @@
 #include "llvm/InstVisitor.h"
 #include "llvm/Pass.h"
 #include "llvm/PassManager.h"
+#include "llvm/Support/Atomic.h"
 #include "llvm/Support/CFG.h"
 #include "llvm/Support/CallSite.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ConstantRange.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdarg>
 using namespace llvm;
 
+static cl::opt<unsigned>
+VerifierThreads("verifier-threads",
+                cl::desc("Number of threads verifyModule uses to check "
+                         "function bodies (default = 1)"),
+                cl::init(1), cl::Hidden);
+
 namespace {  // Anonymous namespace for class
+  /// ContextGuard - Holds the given lock, if any, for as long as it lives.
+  /// Function bodies verified concurrently share the LLVMContext, so the few
+  /// checks that unique new types or attributes in it take the lock.
+  class ContextGuard {
+    sys::Mutex *Lock;
+  public:
+    explicit ContextGuard(sys::Mutex *L) : Lock(L) { if (Lock) Lock->acquire(); }
+    ~ContextGuard() { if (Lock) Lock->release(); }
+  };
+
   struct PreVerifier : public FunctionPass {
     static char ID; // Pass ID, replacement for typeid
 
@@ -137,20 +158,42 @@ namespace {
     /// already.
     SmallPtrSet<MDNode *, 32> MDNodes;
 
+    /// MDNodeReport - The range of Messages holding the diagnostic about a
+    /// metadata node, or an empty range if the node had none.
+    struct MDNodeReport {
+      MDNode *Node;
+      size_t Begin, End;
+    };
+
+    /// MDNodeReports - When function bodies are verified on several threads,
+    /// the diagnostics about metadata nodes in the current function, and the
+    /// function-local nodes it visited.  A node shared by functions checked
+    /// on different threads is visited by each thread, and these let the
+    /// diagnostics be merged the way the serial verifier reports them.
+    SmallVector<MDNodeReport, 4> MDNodeReports;
+    bool RecordMDNodeReports;
+    size_t MDNodeReportEnd;
+
     /// PersonalityFn - The personality function referenced by the
     /// LandingPadInsts. All LandingPadInsts within the same function must use
     /// the same personality function.
     const Value *PersonalityFn;
 
+    /// ContextLock - When function bodies are verified on several threads,
+    /// the lock guarding the changes made to the shared LLVMContext.
+    sys::Mutex *ContextLock;
+
     Verifier()
       : FunctionPass(ID), Broken(false),
         action(AbortProcessAction), Mod(0), Context(0), DT(0),
-        MessagesStr(Messages), PersonalityFn(0) {
+        MessagesStr(Messages), RecordMDNodeReports(false), MDNodeReportEnd(0),
+        PersonalityFn(0), ContextLock(0) {
       initializeVerifierPass(*PassRegistry::getPassRegistry());
     }
     explicit Verifier(VerifierFailureAction ctn)
       : FunctionPass(ID), Broken(false), action(ctn), Mod(0),
-        Context(0), DT(0), MessagesStr(Messages), PersonalityFn(0) {
+        Context(0), DT(0), MessagesStr(Messages), RecordMDNodeReports(false),
+        MDNodeReportEnd(0), PersonalityFn(0), ContextLock(0) {
       initializeVerifierPass(*PassRegistry::getPassRegistry());
     }
 
@@ -167,16 +210,22 @@ namespace {
       // Get dominator information if we are being run by PassManager
       DT = &getAnalysis<DominatorTree>();
 
+      verifyFunctionBody(F);
+
+      // We must abort before returning back to the pass manager, or else the
+      // pass manager may try to run other passes on the broken module.
+      return abortIfBroken();
+    }
+
+    /// verifyFunctionBody - Run the function-level checks on F, using the
+    /// dominator tree in DT.
+    void verifyFunctionBody(Function &F) {
       Mod = F.getParent();
       if (!Context) Context = &F.getContext();
 
       visit(F);
       InstsInThisBlock.clear();
       PersonalityFn = 0;
-
-      // We must abort before returning back to the pass manager, or else the
-      // pass manager may try to run other passes on the broken module.
-      return abortIfBroken();
     }
 
     bool doFinalization(Module &M) {
@@ -242,6 +291,7 @@ namespace {
     void visitGlobalAlias(GlobalAlias &GA);
     void visitNamedMDNode(NamedMDNode &NMD);
     void visitMDNode(MDNode &MD, Function *F);
+    void visitMDNodeOperands(MDNode &MD, Function *F);
     void visitModuleFlags(Module &M);
     void visitModuleFlag(MDNode *Op, DenseMap<MDString*, MDNode*> &SeenIDs,
                          SmallVectorImpl<MDNode*> &Requirements);
@@ -522,7 +572,25 @@ void Verifier::visitMDNode(MDNode &MD, Function *F) {
   // avoids infinite recursion here, as well as being an optimization.
   if (!MDNodes.insert(&MD))
     return;
+  if (!RecordMDNodeReports) {
+    visitMDNodeOperands(MD, F);
+    return;
+  }
 
+  // A failed check returns right away, so the diagnostic about MD itself is
+  // written after those about the nodes it refers to, which move
+  // MDNodeReportEnd past theirs.
+  MDNodeReportEnd = MessagesStr.tell();
+  visitMDNodeOperands(MD, F);
+  size_t End = MessagesStr.tell();
+  if (End != MDNodeReportEnd || MD.isFunctionLocal()) {
+    MDNodeReport R = { &MD, MDNodeReportEnd, End };
+    MDNodeReports.push_back(R);
+  }
+  MDNodeReportEnd = End;
+}
+
+void Verifier::visitMDNodeOperands(MDNode &MD, Function *F) {
   for (unsigned i = 0, e = MD.getNumOperands(); i != e; ++i) {
     Value *Op = MD.getOperand(i);
     if (!Op)
@@ -756,10 +824,13 @@ void Verifier::VerifyParameterAttrs(AttributeSet Attrs, unsigned Idx, Type *Ty,
             Attrs.hasAttribute(Idx, Attribute::AlwaysInline)), "Attributes "
           "'noinline and alwaysinline' are incompatible!", V);
 
-  Assert1(!AttrBuilder(Attrs, Idx).
-            hasAttributes(AttributeFuncs::typeIncompatible(Ty, Idx), Idx),
-          "Wrong types for attribute: " +
-          AttributeFuncs::typeIncompatible(Ty, Idx).getAsString(Idx), V);
+  AttributeSet Incompatible;
+  {
+    ContextGuard Guard(ContextLock);
+    Incompatible = AttributeFuncs::typeIncompatible(Ty, Idx);
+  }
+  Assert1(!AttrBuilder(Attrs, Idx).hasAttributes(Incompatible, Idx),
+          "Wrong types for attribute: " + Incompatible.getAsString(Idx), V);
 
   if (PointerType *PTy = dyn_cast<PointerType>(Ty))
     Assert1(!Attrs.hasAttribute(Idx, Attribute::ByVal) ||
@@ -2031,20 +2102,26 @@ bool Verifier::VerifyIntrinsicType(Type *Ty,
     }
     llvm_unreachable("all argument kinds not covered");
       
-  case IITDescriptor::ExtendVecArgument:
+  case IITDescriptor::ExtendVecArgument: {
     // This may only be used when referring to a previous vector argument.
-    return D.getArgumentNumber() >= ArgTys.size() ||
-           !isa<VectorType>(ArgTys[D.getArgumentNumber()]) ||
-           VectorType::getExtendedElementVectorType(
+    if (D.getArgumentNumber() >= ArgTys.size() ||
+        !isa<VectorType>(ArgTys[D.getArgumentNumber()]))
+      return true;
+    ContextGuard Guard(ContextLock);
+    return VectorType::getExtendedElementVectorType(
                        cast<VectorType>(ArgTys[D.getArgumentNumber()])) != Ty;
+  }
 
-  case IITDescriptor::TruncVecArgument:
+  case IITDescriptor::TruncVecArgument: {
     // This may only be used when referring to a previous vector argument.
-    return D.getArgumentNumber() >= ArgTys.size() ||
-           !isa<VectorType>(ArgTys[D.getArgumentNumber()]) ||
-           VectorType::getTruncatedElementVectorType(
+    if (D.getArgumentNumber() >= ArgTys.size() ||
+        !isa<VectorType>(ArgTys[D.getArgumentNumber()]))
+      return true;
+    ContextGuard Guard(ContextLock);
+    return VectorType::getTruncatedElementVectorType(
                          cast<VectorType>(ArgTys[D.getArgumentNumber()])) != Ty;
   }
+  }
   llvm_unreachable("unhandled");
 }
 
@@ -2188,8 +2265,125 @@ bool llvm::verifyFunction(const Function &f, VerifierFailureAction action) {
 /// verifyModule - Check a module for errors, printing messages on stderr.
 /// Return true if the module is corrupt.
 ///
+namespace {
+/// ParallelVerifier - The state shared by the threads verifying the function
+/// bodies of a module.  Each thread checks functions with its own Verifier
+/// and DominatorTree, and leaves the diagnostics of every function in a
+/// buffer of its own.
+struct ParallelVerifier {
+  typedef SmallVector<Verifier::MDNodeReport, 4> MDNodeReportList;
+
+  std::vector<Verifier*> Verifiers;
+  std::vector<DominatorTree*> DomTrees;
+  std::vector<Function*> Functions;
+  std::vector<std::string> Messages;
+  std::vector<MDNodeReportList> MDNodeReports;
+  volatile sys::cas_flag NextFunction;
+};
+}
+
+static void VerifyFunctionBodies(void *Data, unsigned Thread) {
+  ParallelVerifier &PV = *static_cast<ParallelVerifier*>(Data);
+  Verifier &V = *PV.Verifiers[Thread];
+  DominatorTree &DT = *PV.DomTrees[Thread];
+  for (;;) {
+    unsigned i = sys::AtomicIncrement(&PV.NextFunction) - 1;
+    if (i >= PV.Functions.size())
+      break;
+    Function &F = *PV.Functions[i];
+    DT.runOnFunction(F);
+    V.DT = &DT;
+    V.verifyFunctionBody(F);
+    PV.Messages[i] = V.MessagesStr.str();
+    PV.MDNodeReports[i] = V.MDNodeReports;
+    V.Messages.clear();
+    V.MDNodeReports.clear();
+  }
+}
+
+/// verifyModuleInParallel - Check a module like the Verifier pass does, but
+/// check the function bodies on several threads.  The diagnostics are reported
+/// in the order the serial verifier would produce them, and those about a
+/// metadata node only for the first function that visits it.
+static bool verifyModuleInParallel(Module &M, VerifierFailureAction action,
+                                   std::string *ErrorInfo,
+                                   unsigned NumThreads) {
+  ParallelVerifier PV;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration())
+      PV.Functions.push_back(F);
+  NumThreads = std::max(1U, std::min<unsigned>(NumThreads,
+                                               PV.Functions.size()));
+
+  Verifier V(action);
+  V.doInitialization(M);
+
+  {
+    NamedRegionTimer T("Function checks", "Module Verifier",
+                       TimePassesIsEnabled);
+
+    // Dominator tree construction requires every block to be terminated.
+    PreVerifier PreV;
+    for (unsigned i = 0, e = PV.Functions.size(); i != e; ++i)
+      PreV.runOnFunction(*PV.Functions[i]);
+
+    sys::Mutex ContextLock;
+    for (unsigned i = 0; i != NumThreads; ++i) {
+      PV.Verifiers.push_back(new Verifier(ReturnStatusAction));
+      PV.Verifiers.back()->doInitialization(M);
+      PV.Verifiers.back()->ContextLock = &ContextLock;
+      PV.Verifiers.back()->RecordMDNodeReports = true;
+      PV.DomTrees.push_back(new DominatorTree());
+    }
+    PV.Messages.resize(PV.Functions.size());
+    PV.MDNodeReports.resize(PV.Functions.size());
+    PV.NextFunction = 0;
+    llvm_parallel_for(NumThreads, VerifyFunctionBodies, &PV, NumThreads);
+    DeleteContainerPointers(PV.Verifiers);
+    DeleteContainerPointers(PV.DomTrees);
+  }
+
+  // Report the functions in module order, reacting to a broken function the
+  // way the Verifier pass does after running on it.  A metadata node that an
+  // earlier function visited is skipped, as the serial verifier skips it;
+  // recording it in V.MDNodes also keeps the module-level checks from
+  // visiting it again.  Every check that fails writes a diagnostic, so a
+  // function is broken if anything is left to report for it.
+  for (unsigned i = 0, e = PV.Functions.size(); i != e; ++i) {
+    StringRef Messages = PV.Messages[i];
+    const ParallelVerifier::MDNodeReportList &Reports = PV.MDNodeReports[i];
+    size_t Pos = 0;
+    for (unsigned j = 0, je = Reports.size(); j != je; ++j) {
+      if (V.MDNodes.insert(Reports[j].Node))
+        continue;
+      V.MessagesStr << Messages.slice(Pos, Reports[j].Begin);
+      if (Pos != Reports[j].Begin)
+        V.Broken = true;
+      Pos = Reports[j].End;
+    }
+    V.MessagesStr << Messages.substr(Pos);
+    if (Pos != Messages.size())
+      V.Broken = true;
+    V.abortIfBroken();
+  }
+
+  {
+    NamedRegionTimer T("Module-level checks", "Module Verifier",
+                       TimePassesIsEnabled);
+    V.doFinalization(M);
+  }
+
+  if (ErrorInfo && V.Broken)
+    *ErrorInfo = V.MessagesStr.str();
+  return V.Broken;
+}
+
 bool llvm::verifyModule(const Module &M, VerifierFailureAction action,
                         std::string *ErrorInfo) {
+  if (VerifierThreads > 1)
+    return verifyModuleInParallel(const_cast<Module&>(M), action, ErrorInfo,
+                                  VerifierThreads);
+
   PassManager PM;
   Verifier *V = new Verifier(action);
   PM.add(V);
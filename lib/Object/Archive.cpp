@@ -102,7 +102,8 @@ error_code Archive::Child::getAsBinary(OwningPtr<Binary> &Result) const {
 }
 
 Archive::Archive(MemoryBuffer *source, error_code &ec)
-  : Binary(Binary::ID_Archive, source) {
+  : Binary(Binary::ID_Archive, source), UseSymbolIndex(false),
+    SymbolIndexFailed(false) {
   // Check for sufficient magic.
   if (!source || source->getBufferSize()
                  < (8 + sizeof(ArchiveMemberHeader) + 2) // Smallest archive.
@@ -282,7 +283,32 @@ Archive::symbol_iterator Archive::end_symbols() const {
     Symbol(this, symbol_count, 0));
 }
 
+void Archive::buildSymbolIndex() const {
+  OwningPtr<StringMap<child_iterator> > Index(new StringMap<child_iterator>());
+  StringRef symname;
+  child_iterator member;
+  for (symbol_iterator bs = begin_symbols(), es = end_symbols(); bs != es;
+       ++bs) {
+    if (bs->getName(symname) || bs->getMember(member)) {
+      SymbolIndexFailed = true;
+      return;
+    }
+    // Keep the first definition, as the linear scan would find it first.
+    Index->GetOrCreateValue(symname, member);
+  }
+  SymbolMap.swap(Index);
+}
+
 Archive::child_iterator Archive::findSym(StringRef name) const {
+  if (UseSymbolIndex && !SymbolMap && !SymbolIndexFailed)
+    buildSymbolIndex();
+  if (SymbolMap) {
+    StringMap<child_iterator>::const_iterator I = SymbolMap->find(name);
+    if (I == SymbolMap->end())
+      return end_children();
+    return I->getValue();
+  }
+
   Archive::symbol_iterator bs = begin_symbols();
   Archive::symbol_iterator es = end_symbols();
   Archive::child_iterator result;
@@ -107,6 +107,24 @@ void Option::addArgument() {
   MarkOptionsChanged();
 }
 
+/// LazyOptionRegistrars - The functions added with AddLazyOptionRegistrar that
+/// have not been run yet.
+static std::vector<void (*)()> *LazyOptionRegistrars = 0;
+
+/// RunLazyOptionRegistrars - Register the options that are registered on
+/// demand.  Return true if there were any left to register.
+static bool RunLazyOptionRegistrars() {
+  if (LazyOptionRegistrars == 0 || LazyOptionRegistrars->empty())
+    return false;
+
+  std::vector<void (*)()> Registrars;
+  Registrars.swap(*LazyOptionRegistrars);
+  for (std::vector<void (*)()>::iterator I = Registrars.begin(),
+       E = Registrars.end(); I != E; ++I)
+    (*I)();
+  return true;
+}
+
 // This collects the different option categories that have been registered.
 typedef SmallPtrSet<OptionCategory*,16> OptionCatSet;
 static ManagedStatic<OptionCatSet> RegisteredOptionCategories;
@@ -123,36 +141,54 @@ void OptionCategory::registerCategory()
 // Basic, shared command line option processing machinery.
 //
 
-/// GetOptionInfo - Scan the list of registered options, turning them into data
-/// structures that are easier to handle.
-static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
-                          SmallVectorImpl<Option*> &SinkOpts,
-                          StringMap<Option*> &OptionsMap) {
-  SmallVector<const char*, 16> OptionNames;
-  Option *CAOpt = 0;  // The ConsumeAfter option if it exists.
-  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
-    // If this option wants to handle multiple option names, get the full set.
-    // This handles enum options like "-O1 -O2" etc.
-    O->getExtraOptionNames(OptionNames);
-    if (O->ArgStr[0])
-      OptionNames.push_back(O->ArgStr);
+namespace {
+/// OptionTable - The registered options, arranged for parsing.  Each part is
+/// built the first time it is needed and kept until the set of registered
+/// options changes, so that it is not rebuilt on every parse, and the map of
+/// option names, which takes an entry for every name of every option, is not
+/// built at all unless an option is looked up by name.
+struct OptionTable {
+  /// PositionalOpts - The positional options in order of registration,
+  /// preceded by the cl::ConsumeAfter option if there is one.
+  SmallVector<Option*, 4> PositionalOpts;
 
-    // Handle named options.
-    for (size_t i = 0, e = OptionNames.size(); i != e; ++i) {
-      // Add argument to the argument map!
-      if (OptionsMap.GetOrCreateValue(OptionNames[i], O).second != O) {
-        errs() << ProgramName << ": CommandLine Error: Argument '"
-             << OptionNames[i] << "' defined more than once!\n";
-      }
-    }
+  /// SinkOpts - The options given the arguments that match no option.
+  SmallVector<Option*, 4> SinkOpts;
 
-    OptionNames.clear();
+  /// OptionsMap - Every name of every named option, mapped to the option.
+  StringMap<Option*> OptionsMap;
+
+  bool HaveLists, HaveMap;
 
+  OptionTable() : HaveLists(false), HaveMap(false) {}
+};
+}
+
+static ManagedStatic<OptionTable> RegisteredOptionTable;
+
+/// GetOptionLists - Return the option table with its positional and sink
+/// options, scanning the list of registered options for them if needed.  If
+/// options have been registered since the table was built, it is rebuilt.
+static OptionTable &GetOptionLists() {
+  OptionTable &Table = *RegisteredOptionTable;
+  if (OptionListChanged) {
+    Table.PositionalOpts.clear();
+    Table.SinkOpts.clear();
+    Table.OptionsMap.clear();
+    Table.HaveLists = Table.HaveMap = false;
+    OptionListChanged = false;
+  }
+  if (Table.HaveLists)
+    return Table;
+
+  SmallVectorImpl<Option*> &PositionalOpts = Table.PositionalOpts;
+  Option *CAOpt = 0;  // The ConsumeAfter option if it exists.
+  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
     // Remember information about positional options.
     if (O->getFormattingFlag() == cl::Positional)
       PositionalOpts.push_back(O);
     else if (O->getMiscFlags() & cl::Sink) // Remember sink options
-      SinkOpts.push_back(O);
+      Table.SinkOpts.push_back(O);
     else if (O->getNumOccurrencesFlag() == cl::ConsumeAfter) {
       if (CAOpt)
         O->error("Cannot specify more than one option with cl::ConsumeAfter!");
@@ -165,8 +201,40 @@ static void GetOptionInfo(SmallVectorImpl<Option*> &PositionalOpts,
 
   // Make sure that they are in order of registration not backwards.
   std::reverse(PositionalOpts.begin(), PositionalOpts.end());
+  Table.HaveLists = true;
+  return Table;
 }
 
+/// GetOptionsMap - Return the map from the names of the registered options to
+/// the options, building it if needed.
+static const StringMap<Option*> &GetOptionsMap() {
+  OptionTable &Table = GetOptionLists();
+  if (Table.HaveMap)
+    return Table.OptionsMap;
+
+  StringMap<Option*> &OptionsMap = Table.OptionsMap;
+  SmallVector<const char*, 16> OptionNames;
+  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
+    // If this option wants to handle multiple option names, get the full set.
+    // This handles enum options like "-O1 -O2" etc.
+    O->getExtraOptionNames(OptionNames);
+    if (O->ArgStr[0])
+      OptionNames.push_back(O->ArgStr);
+
+    // Handle named options.
+    for (size_t i = 0, e = OptionNames.size(); i != e; ++i) {
+      // Add argument to the argument map!
+      if (OptionsMap.GetOrCreateValue(OptionNames[i], O).second != O) {
+        errs() << ProgramName << ": CommandLine Error: Argument '"
+             << OptionNames[i] << "' defined more than once!\n";
+      }
+    }
+
+    OptionNames.clear();
+  }
+  Table.HaveMap = true;
+  return OptionsMap;
+}
 
 /// LookupOption - Lookup the option specified by the specified option on the
 /// command line.  If there is a value specified (after an equal sign) return
@@ -543,13 +611,11 @@ static void ExpandResponseFiles(unsigned argc, const char*const* argv,
 void cl::ParseCommandLineOptions(int argc, const char * const *argv,
                                  const char *Overview) {
   // Process all registered options.
-  SmallVector<Option*, 4> PositionalOpts;
-  SmallVector<Option*, 4> SinkOpts;
-  StringMap<Option*> Opts;
-  GetOptionInfo(PositionalOpts, SinkOpts, Opts);
+  OptionTable &Table = GetOptionLists();
+  SmallVectorImpl<Option*> &PositionalOpts = Table.PositionalOpts;
+  SmallVectorImpl<Option*> &SinkOpts = Table.SinkOpts;
 
-  assert((!Opts.empty() || !PositionalOpts.empty()) &&
-         "No options specified!");
+  assert(RegisteredOptionList && "No options specified!");
 
   // Expand response files.
   std::vector<char*> newArgv;
@@ -633,13 +699,7 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
     // If the option list changed, this means that some command line
     // option has just been registered or deregistered.  This can occur in
     // response to things like -load, etc.  If this happens, rescan the options.
-    if (OptionListChanged) {
-      PositionalOpts.clear();
-      SinkOpts.clear();
-      Opts.clear();
-      GetOptionInfo(PositionalOpts, SinkOpts, Opts);
-      OptionListChanged = false;
-    }
+    GetOptionLists();
 
     // Check to see if this is a positional argument.  This argument is
     // considered to be positional if it doesn't start with '-', if it is "-"
@@ -682,7 +742,7 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
       while (!ArgName.empty() && ArgName[0] == '-')
         ArgName = ArgName.substr(1);
 
-      Handler = LookupOption(ArgName, Value, Opts);
+      Handler = LookupOption(ArgName, Value, GetOptionsMap());
       if (!Handler || Handler->getFormattingFlag() != cl::Positional) {
         ProvidePositionalOption(ActivePositionalArg, argv[i], i);
         continue;  // We are done!
@@ -694,17 +754,21 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
       while (!ArgName.empty() && ArgName[0] == '-')
         ArgName = ArgName.substr(1);
 
-      Handler = LookupOption(ArgName, Value, Opts);
+      Handler = LookupOption(ArgName, Value, GetOptionsMap());
+
+      // The option may be one of those registered on demand.
+      if (Handler == 0 && RunLazyOptionRegistrars())
+        Handler = LookupOption(ArgName, Value, GetOptionsMap());
 
       // Check to see if this "option" is really a prefixed or grouped argument.
       if (Handler == 0)
         Handler = HandlePrefixedOrGroupedOption(ArgName, Value,
-                                                ErrorParsing, Opts);
+                                                ErrorParsing, GetOptionsMap());
 
       // Otherwise, look for the closest available option to report to the user
       // in the upcoming error.
       if (Handler == 0 && SinkOpts.empty())
-        NearestHandler = LookupNearestOption(ArgName, Opts,
+        NearestHandler = LookupNearestOption(ArgName, GetOptionsMap(),
                                              NearestHandlerString);
     }
 
@@ -817,17 +881,22 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
                                               PositionalVals[ValNo].second);
   }
 
-  // Loop over args and make sure all required args are specified!
-  for (StringMap<Option*>::iterator I = Opts.begin(),
-         E = Opts.end(); I != E; ++I) {
-    switch (I->second->getNumOccurrencesFlag()) {
+  // Loop over args and make sure all required args are specified!  Positional
+  // arguments were checked above, unless they can also be given by name.
+  SmallVector<const char*, 16> OptionNames;
+  for (Option *O = RegisteredOptionList; O; O = O->getNextRegisteredOption()) {
+    switch (O->getNumOccurrencesFlag()) {
     case Required:
     case OneOrMore:
-      if (I->second->getNumOccurrences() == 0) {
-        I->second->error("must be specified at least once!");
+      if (O->getNumOccurrences() != 0)
+        break;
+      O->getExtraOptionNames(OptionNames);
+      if (O->ArgStr[0] || !OptionNames.empty()) {
+        O->error("must be specified at least once!");
         ErrorParsing = true;
       }
-      // Fall through
+      OptionNames.clear();
+      break;
     default:
       break;
     }
@@ -842,10 +911,8 @@ void cl::ParseCommandLineOptions(int argc, const char * const *argv,
         dbgs() << '\n';
        );
 
-  // Free all of the memory allocated to the map.  Command line options may only
-  // be processed once!
-  Opts.clear();
-  PositionalOpts.clear();
+  // The option table is kept for the next parse, but the extra help is only
+  // printed for this one.
   MoreHelp->clear();
 
   // Free the memory allocated by ExpandResponseFiles.
@@ -1212,13 +1279,13 @@ static int OptNameCompare(const void *LHS, const void *RHS) {
 
 // Copy Options into a vector so we can sort them as we like.
 static void
-sortOpts(StringMap<Option*> &OptMap,
+sortOpts(const StringMap<Option*> &OptMap,
          SmallVectorImpl< std::pair<const char *, Option*> > &Opts,
          bool ShowHidden) {
   SmallPtrSet<Option*, 128> OptionSet;  // Duplicate option detection.
 
-  for (StringMap<Option*>::iterator I = OptMap.begin(), E = OptMap.end();
-       I != E; ++I) {
+  for (StringMap<Option*>::const_iterator I = OptMap.begin(),
+       E = OptMap.end(); I != E; ++I) {
     // Ignore really-hidden options.
     if (I->second->getOptionHiddenFlag() == ReallyHidden)
       continue;
@@ -1259,14 +1326,12 @@ public:
   void operator=(bool Value) {
     if (Value == false) return;
 
-    // Get all the options.
-    SmallVector<Option*, 4> PositionalOpts;
-    SmallVector<Option*, 4> SinkOpts;
-    StringMap<Option*> OptMap;
-    GetOptionInfo(PositionalOpts, SinkOpts, OptMap);
+    // Get all the options, including those registered on demand.
+    RunLazyOptionRegistrars();
+    SmallVectorImpl<Option*> &PositionalOpts = GetOptionLists().PositionalOpts;
 
     StrOptionPairVector Opts;
-    sortOpts(OptMap, Opts, ShowHidden);
+    sortOpts(GetOptionsMap(), Opts, ShowHidden);
 
     if (ProgramOverview)
       outs() << "OVERVIEW: " << ProgramOverview << "\n";
@@ -1488,14 +1553,10 @@ void HelpPrinterWrapper::operator=(bool Value) {
 void cl::PrintOptionValues() {
   if (!PrintOptions && !PrintAllOptions) return;
 
-  // Get all the options.
-  SmallVector<Option*, 4> PositionalOpts;
-  SmallVector<Option*, 4> SinkOpts;
-  StringMap<Option*> OptMap;
-  GetOptionInfo(PositionalOpts, SinkOpts, OptMap);
-
+  // Get all the options, including those registered on demand.
+  RunLazyOptionRegistrars();
   SmallVector<std::pair<const char *, Option*>, 128> Opts;
-  sortOpts(OptMap, Opts, /*ShowHidden*/true);
+  sortOpts(GetOptionsMap(), Opts, /*ShowHidden*/true);
 
   // Compute the maximum argument length...
   size_t MaxArgLen = 0;
@@ -1605,12 +1666,20 @@ void cl::AddExtraVersionPrinter(void (*func)()) {
   ExtraVersionPrinters->push_back(func);
 }
 
+void cl::AddLazyOptionRegistrar(void (*func)()) {
+  if (LazyOptionRegistrars == 0)
+    LazyOptionRegistrars = new std::vector<void (*)()>;
+
+  LazyOptionRegistrars->push_back(func);
+}
+
 void cl::getRegisteredOptions(StringMap<Option*> &Map)
 {
-  // Get all the options.
-  SmallVector<Option*, 4> PositionalOpts; //NOT USED
-  SmallVector<Option*, 4> SinkOpts;  //NOT USED
+  // Get all the options, including those registered on demand.
   assert(Map.size() == 0 && "StringMap must be empty");
-  GetOptionInfo(PositionalOpts, SinkOpts, Map);
-  return;
+  RunLazyOptionRegistrars();
+  const StringMap<Option*> &Opts = GetOptionsMap();
+  for (StringMap<Option*>::const_iterator I = Opts.begin(), E = Opts.end();
+       I != E; ++I)
+    Map[I->getKey()] = I->second;
 }
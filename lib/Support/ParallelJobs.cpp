@@ -0,0 +1,49 @@
+//===-- ParallelJobs.cpp - Jobs with ordered output -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the per-thread job streams used by ParallelJobQueue.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ParallelJobs.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/ThreadLocal.h"
+
+using namespace llvm;
+
+static ManagedStatic<sys::ThreadLocal<const JobStreamsScope> > CurrentStreams;
+
+JobStreamsScope::JobStreamsScope(raw_ostream &Out, raw_ostream &Err)
+  : Out(Out), Err(Err) {
+  CurrentStreams->set(this);
+}
+
+JobStreamsScope::~JobStreamsScope() {
+  CurrentStreams->erase();
+}
+
+raw_ostream &llvm::jobOuts() {
+  if (const JobStreamsScope *Streams = CurrentStreams->get())
+    return Streams->Out;
+  return outs();
+}
+
+raw_ostream &llvm::jobErrs() {
+  if (const JobStreamsScope *Streams = CurrentStreams->get())
+    return Streams->Err;
+  return errs();
+}
+
+void llvm::printJobOutput(StringRef Out, StringRef Err) {
+  outs() << Out;
+  if (!Err.empty()) {
+    outs().flush();
+    errs() << Err;
+  }
+}
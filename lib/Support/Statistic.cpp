@@ -23,14 +23,20 @@
 
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/config.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/ThreadLocal.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstring>
+#if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#define LLVM_STATISTIC_THREAD_EXIT 1
+#endif
 using namespace llvm;
 
 // CreateInfoOutputFile - Return a file stream to print our output on.
@@ -46,24 +52,179 @@ Enabled(
 
 
 namespace {
+/// StatisticShard - The counters of one thread, one for each statistic with a
+/// shard index.  They are allocated in chunks the first time the thread bumps
+/// a statistic in the chunk.  Only the owning thread writes to its counters,
+/// except when statistics are reset.
+struct StatisticShard {
+  enum { ChunkSize = 512, MaxChunks = 32 };
+  sys::cas_flag *Chunks[MaxChunks];
+
+  /// Overflow - Set for the shard standing for the threads that found no room
+  /// for a shard of their own.  They update the statistics atomically.
+  bool Overflow;
+
+  explicit StatisticShard(bool Overflow = false) : Overflow(Overflow) {
+    std::memset(Chunks, 0, sizeof(Chunks));
+  }
+  ~StatisticShard() {
+    for (unsigned i = 0; i != MaxChunks; ++i)
+      delete[] Chunks[i];
+  }
+
+  /// getCounter - Return the counter with the given index, allocating its
+  /// chunk if needed.  Only the owning thread may call this.
+  sys::cas_flag *getCounter(unsigned Index) {
+    sys::cas_flag *&Chunk = Chunks[Index / ChunkSize];
+    if (!Chunk) {
+      sys::cas_flag *NewChunk = new sys::cas_flag[ChunkSize]();
+      // Other threads must not see the chunk before it is cleared.
+      sys::MemoryFence();
+      Chunk = NewChunk;
+    }
+    return &Chunk[Index % ChunkSize];
+  }
+
+  /// lookup - Return the counter with the given index, or null if its chunk
+  /// has not been allocated.
+  volatile sys::cas_flag *lookup(unsigned Index) const {
+    sys::cas_flag *Chunk = Chunks[Index / ChunkSize];
+    return Chunk ? &Chunk[Index % ChunkSize] : 0;
+  }
+
+  /// foldInto - Add the counters to the values of their statistics, given by
+  /// Owners, and clear them.
+  void foldInto(const std::vector<Statistic*> &Owners) {
+    for (unsigned i = 0, e = Owners.size(); i != e; ++i) {
+      volatile sys::cas_flag *Counter = lookup(i);
+      if (!Counter || !*Counter)
+        continue;
+      sys::cas_flag Count = *Counter;
+      *Counter = 0;
+      sys::AtomicAdd(&Owners[i]->Value, Count);
+    }
+  }
+};
+
 /// StatisticInfo - This class is used in a ManagedStatic so that it is created
 /// on demand (when the first statistic is bumped) and destroyed only when
-/// llvm_shutdown is called.  We print statistics from the destructor.
+/// llvm_shutdown is called.  We print statistics from the destructor.  It also
+/// owns the counters of every thread, which are added up when a value is read.
 class StatisticInfo {
   std::vector<const Statistic*> Stats;
   friend void llvm::PrintStatistics();
   friend void llvm::PrintStatistics(raw_ostream &OS);
+  friend std::vector<StatisticSnapshot> llvm::GetStatistics();
+  friend void llvm::ResetStatistics();
+
+  enum { MaxShards = 256 };
+  StatisticShard *Shards[MaxShards];
+  volatile sys::cas_flag NumShards;
+
+  /// FreeShards - The shards of threads that have exited, cleared and ready
+  /// to be handed to new threads.
+  std::vector<StatisticShard*> FreeShards;
+
+  /// ShardOwners - The statistic of each shard index, minus one.
+  std::vector<Statistic*> ShardOwners;
+
+#ifdef LLVM_STATISTIC_THREAD_EXIT
+  /// ThreadExitKey - Set on each thread that has a shard, so that the shard
+  /// is released when the thread exits.
+  pthread_key_t ThreadExitKey;
+#endif
 public:
+  StatisticShard OverflowShard;
+
+  StatisticInfo();
   ~StatisticInfo();
 
   void addStatistic(const Statistic *S) {
     Stats.push_back(S);
   }
+
+  /// allocateShardIndex - Return a new shard index for S, or zero if all of
+  /// the per-thread counters are in use.
+  unsigned allocateShardIndex(Statistic *S) {
+    if (ShardOwners.size() ==
+        StatisticShard::ChunkSize * StatisticShard::MaxChunks)
+      return 0;
+    ShardOwners.push_back(S);
+    return ShardOwners.size();
+  }
+
+  /// addShard - Return a shard for the calling thread, reusing the shard of a
+  /// thread that has exited if there is one.  Return null if there is no room
+  /// for a new shard.
+  StatisticShard *addShard() {
+    StatisticShard *Shard;
+    if (!FreeShards.empty()) {
+      Shard = FreeShards.back();
+      FreeShards.pop_back();
+    } else {
+      if (NumShards == MaxShards)
+        return 0;
+      Shard = new StatisticShard();
+      Shards[NumShards] = Shard;
+      // Readers must see the shard before they see the new count.
+      sys::MemoryFence();
+      ++NumShards;
+    }
+#ifdef LLVM_STATISTIC_THREAD_EXIT
+    ::pthread_setspecific(ThreadExitKey, Shard);
+#endif
+    return Shard;
+  }
+
+  /// releaseShard - Fold the counters of a thread that is exiting into the
+  /// values of the statistics, and keep its shard for another thread.  A
+  /// value read meanwhile may miss some of that thread's counts.
+  void releaseShard(StatisticShard *Shard) {
+    Shard->foldInto(ShardOwners);
+    FreeShards.push_back(Shard);
+  }
+
+  /// sumThreadCounters - Add up the counters with the given index of every
+  /// thread.
+  sys::cas_flag sumThreadCounters(unsigned Index) const {
+    sys::cas_flag Sum = 0;
+    unsigned N = NumShards;
+    sys::MemoryFence();
+    for (unsigned i = 0; i != N; ++i)
+      if (volatile sys::cas_flag *Counter = Shards[i]->lookup(Index))
+        Sum += *Counter;
+    return Sum;
+  }
+
+  /// clearThreadCounters - Set the counters with the given index of every
+  /// thread to zero.
+  void clearThreadCounters(unsigned Index) {
+    for (unsigned i = 0, e = NumShards; i != e; ++i)
+      if (volatile sys::cas_flag *Counter = Shards[i]->lookup(Index))
+        *Counter = 0;
+  }
 };
 }
 
 static ManagedStatic<StatisticInfo> StatInfo;
 static ManagedStatic<sys::SmartMutex<true> > StatLock;
+static ManagedStatic<sys::ThreadLocal<const StatisticShard> > ThreadShard;
+
+#ifdef LLVM_STATISTIC_THREAD_EXIT
+/// ReleaseThreadShard - Called when a thread with a shard exits.  Without
+/// this, every thread would keep its shard, and once MaxShards threads had
+/// come and gone all later threads would share OverflowShard.
+static void ReleaseThreadShard(void *Shard) {
+  sys::SmartScopedLock<true> Writer(*StatLock);
+  StatInfo->releaseShard(static_cast<StatisticShard*>(Shard));
+}
+#endif
+
+StatisticInfo::StatisticInfo() : NumShards(0), OverflowShard(true) {
+#ifdef LLVM_STATISTIC_THREAD_EXIT
+  ::pthread_key_create(&ThreadExitKey, ReleaseThreadShard);
+#endif
+}
 
 /// RegisterStatistic - The first time a statistic is bumped, this method is
 /// called.
@@ -72,6 +233,7 @@ void Statistic::RegisterStatistic() {
   // printed.
   sys::SmartScopedLock<true> Writer(*StatLock);
   if (!Initialized) {
+    ShardIndex = StatInfo->allocateShardIndex(this);
     if (Enabled)
       StatInfo->addStatistic(this);
 
@@ -84,6 +246,37 @@ void Statistic::RegisterStatistic() {
   }
 }
 
+sys::cas_flag *Statistic::getThreadCounter() {
+  if (!ShardIndex)
+    return 0;
+
+  StatisticShard *Shard = const_cast<StatisticShard*>(ThreadShard->get());
+  if (!Shard) {
+    sys::SmartScopedLock<true> Writer(*StatLock);
+    Shard = StatInfo->addShard();
+    if (!Shard)
+      Shard = &StatInfo->OverflowShard;
+    ThreadShard->set(Shard);
+  }
+  if (Shard->Overflow)
+    return 0;
+  return Shard->getCounter(ShardIndex - 1);
+}
+
+sys::cas_flag Statistic::getValue() const {
+  sys::cas_flag Result = Value;
+  if (ShardIndex)
+    Result += StatInfo->sumThreadCounters(ShardIndex - 1);
+  return Result;
+}
+
+void Statistic::setValue(sys::cas_flag Val) {
+  sys::SmartScopedLock<true> Writer(*StatLock);
+  if (ShardIndex)
+    StatInfo->clearThreadCounters(ShardIndex - 1);
+  Value = Val;
+}
+
 namespace {
 
 struct NameCompare {
@@ -100,7 +293,13 @@ struct NameCompare {
 
 // Print information when destroyed, iff command line option is specified.
 StatisticInfo::~StatisticInfo() {
+#ifdef LLVM_STATISTIC_THREAD_EXIT
+  // Threads exiting from now on must not release their shards.
+  ::pthread_key_delete(ThreadExitKey);
+#endif
   llvm::PrintStatistics();
+  for (unsigned i = 0, e = NumShards; i != e; ++i)
+    delete Shards[i];
 }
 
 void llvm::EnableStatistics() {
@@ -143,6 +342,31 @@ void llvm::PrintStatistics(raw_ostream &OS) {
 
 }
 
+std::vector<StatisticSnapshot> llvm::GetStatistics() {
+  sys::SmartScopedLock<true> Reader(*StatLock);
+  std::vector<const Statistic*> Stats(StatInfo->Stats);
+  std::stable_sort(Stats.begin(), Stats.end(), NameCompare());
+
+  std::vector<StatisticSnapshot> Snapshot;
+  for (size_t i = 0, e = Stats.size(); i != e; ++i) {
+    StatisticSnapshot S = { Stats[i]->getName(), Stats[i]->getDesc(),
+                            Stats[i]->getValue() };
+    Snapshot.push_back(S);
+  }
+  return Snapshot;
+}
+
+void llvm::ResetStatistics() {
+  sys::SmartScopedLock<true> Writer(*StatLock);
+  StatisticInfo &Stats = *StatInfo;
+  for (size_t i = 0, e = Stats.Stats.size(); i != e; ++i) {
+    Statistic *S = const_cast<Statistic*>(Stats.Stats[i]);
+    if (S->ShardIndex)
+      Stats.clearThreadCounters(S->ShardIndex - 1);
+    S->Value = 0;
+  }
+}
+
 void llvm::PrintStatistics() {
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_STATS)
   StatisticInfo &Stats = *StatInfo;
@@ -16,6 +16,7 @@
 #include "llvm/Support/Atomic.h"
 #include "llvm/Support/Mutex.h"
 #include <cassert>
+#include <vector>
 
 using namespace llvm;
 
@@ -63,6 +64,24 @@ void llvm::llvm_release_global_lock() {
   if (multithreaded_mode) global_lock->release();
 }
 
+namespace {
+struct ParallelForInfo {
+  void (*UserFn)(void *, unsigned);
+  void *UserData;
+  unsigned NumItems;
+  volatile sys::cas_flag NextItem;
+};
+}
+
+static void RunParallelForItems(ParallelForInfo *PI) {
+  while (true) {
+    unsigned Item = sys::AtomicIncrement(&PI->NextItem) - 1;
+    if (Item >= PI->NumItems)
+      return;
+    PI->UserFn(PI->UserData, Item);
+  }
+}
+
 #if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
 #include <pthread.h>
 
@@ -102,6 +121,38 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
  error:
   ::pthread_attr_destroy(&Attr);
 }
+
+static void *ParallelFor_Dispatch(void *Arg) {
+  RunParallelForItems(reinterpret_cast<ParallelForInfo*>(Arg));
+  return 0;
+}
+
+void llvm::llvm_parallel_for(unsigned NumItems,
+                             void (*Fn)(void*, unsigned), void *UserData,
+                             unsigned NumThreads) {
+  ParallelForInfo Info = { Fn, UserData, NumItems, 0 };
+#if LLVM_HAS_ATOMICS == 0
+  // The item counter can only be shared between threads if it is atomic.
+  NumThreads = 1;
+#endif
+  if (NumThreads > NumItems)
+    NumThreads = NumItems;
+
+  // Start the helpers; if one cannot be created the remaining threads simply
+  // pick up its share of the items.
+  std::vector<pthread_t> Threads;
+  for (unsigned i = 1; i < NumThreads; ++i) {
+    pthread_t Thread;
+    if (::pthread_create(&Thread, 0, ParallelFor_Dispatch, &Info) != 0)
+      break;
+    Threads.push_back(Thread);
+  }
+
+  RunParallelForItems(&Info);
+
+  for (unsigned i = 0, e = Threads.size(); i != e; ++i)
+    ::pthread_join(Threads[i], 0);
+}
 #elif LLVM_ENABLE_THREADS!=0 && defined(LLVM_ON_WIN32)
 #include "Windows/Windows.h"
 #include <process.h>
@@ -136,6 +187,39 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
     ::CloseHandle(hThread);
   }
 }
+
+static unsigned __stdcall ParallelForCallback(void *param) {
+  RunParallelForItems(reinterpret_cast<ParallelForInfo *>(param));
+  return 0;
+}
+
+void llvm::llvm_parallel_for(unsigned NumItems,
+                             void (*Fn)(void*, unsigned), void *UserData,
+                             unsigned NumThreads) {
+  ParallelForInfo Info = { Fn, UserData, NumItems, 0 };
+#if LLVM_HAS_ATOMICS == 0
+  // The item counter can only be shared between threads if it is atomic.
+  NumThreads = 1;
+#endif
+  if (NumThreads > NumItems)
+    NumThreads = NumItems;
+
+  std::vector<HANDLE> Threads;
+  for (unsigned i = 1; i < NumThreads; ++i) {
+    HANDLE hThread = (HANDLE)::_beginthreadex(NULL, 0, ParallelForCallback,
+                                              &Info, 0, NULL);
+    if (!hThread)
+      break;
+    Threads.push_back(hThread);
+  }
+
+  RunParallelForItems(&Info);
+
+  for (unsigned i = 0, e = Threads.size(); i != e; ++i) {
+    (void)::WaitForSingleObject(Threads[i], INFINITE);
+    ::CloseHandle(Threads[i]);
+  }
+}
 #else
 // Support for non-Win32, non-pthread implementation.
 void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
@@ -144,4 +228,12 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
   Fn(UserData);
 }
 
+void llvm::llvm_parallel_for(unsigned NumItems,
+                             void (*Fn)(void*, unsigned), void *UserData,
+                             unsigned NumThreads) {
+  (void) NumThreads;
+  ParallelForInfo Info = { Fn, UserData, NumItems, 0 };
+  RunParallelForItems(&Info);
+}
+
 #endif
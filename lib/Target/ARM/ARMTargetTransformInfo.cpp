@@ -126,6 +126,12 @@ public:
 
   unsigned getAddressComputationCost(Type *Val) const;
 
+  unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                      unsigned Factor,
+                                      ArrayRef<unsigned> Indices,
+                                      unsigned Alignment,
+                                      unsigned AddressSpace) const;
+
   unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty,
                                   OperandValueKind Op1Info = OK_AnyValue,
                                   OperandValueKind Op2Info = OK_AnyValue) const;
@@ -524,3 +530,25 @@ unsigned ARMTTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty, OperandValueK
                                                      Op2Info);
 }
 
+unsigned ARMTTI::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                            unsigned Factor,
+                                            ArrayRef<unsigned> Indices,
+                                            unsigned Alignment,
+                                            unsigned AddressSpace) const {
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(VecTy);
+
+  // NEON (de)interleaves two members with a single vuzp/vzip and four members
+  // with two levels of them. Other factors go through the generic path.
+  if (!ST->hasNEON() || !LT.second.isVector() ||
+      LT.second.getScalarType().getSizeInBits() > 32 ||
+      (Factor != 2 && Factor != 4))
+    return TargetTransformInfo::getInterleavedMemoryOpCost(Opcode, VecTy,
+                                                           Factor, Indices,
+                                                           Alignment,
+                                                           AddressSpace);
+
+  unsigned ShufflesPerReg = Factor == 2 ? 1 : 2;
+  unsigned RegsPerMember = std::max(LT.first / Factor, 1u);
+  unsigned NumMembers = Opcode == Instruction::Load ? Indices.size() : Factor;
+  return LT.first + NumMembers * RegsPerMember * ShufflesPerReg;
+}
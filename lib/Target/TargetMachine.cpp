@@ -39,6 +39,10 @@ static cl::opt<bool>
 FunctionSections("ffunction-sections",
   cl::desc("Emit functions into separate sections"),
   cl::init(false));
+static cl::opt<bool>
+SplitColdCode("fsplit-cold-code",
+  cl::desc("Emit cold functions and cold basic blocks into .text.unlikely"),
+  cl::init(false));
 
 //---------------------------------------------------------------------------
 // TargetMachine Class
@@ -181,6 +185,10 @@ bool TargetMachine::getDataSections() {
   return DataSections;
 }
 
+bool TargetMachine::getSplitColdCode() {
+  return SplitColdCode;
+}
+
 void TargetMachine::setFunctionSections(bool V) {
   FunctionSections = V;
 }
@@ -188,3 +196,7 @@ void TargetMachine::setFunctionSections(bool V) {
 void TargetMachine::setDataSections(bool V) {
   DataSections = V;
 }
+
+void TargetMachine::setSplitColdCode(bool V) {
+  SplitColdCode = V;
+}
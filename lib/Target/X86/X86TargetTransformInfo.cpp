@@ -100,6 +100,11 @@ public:
   virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
                                    unsigned Alignment,
                                    unsigned AddressSpace) const;
+  virtual unsigned getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                              unsigned Factor,
+                                              ArrayRef<unsigned> Indices,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const;
 
   /// @}
 };
@@ -528,3 +533,45 @@ unsigned X86TTI::getMemoryOpCost(unsigned Opcode, Type *Src, unsigned Alignment,
 
   return Cost;
 }
+
+unsigned X86TTI::getInterleavedMemoryOpCost(unsigned Opcode, Type *VecTy,
+                                            unsigned Factor,
+                                            ArrayRef<unsigned> Indices,
+                                            unsigned Alignment,
+                                            unsigned AddressSpace) const {
+  std::pair<unsigned, MVT> LT = TLI->getTypeLegalizationCost(VecTy);
+
+  // Byte and word elements need pshufb to be (de)interleaved efficiently.
+  if (!ST->hasSSE2() || !LT.second.isVector() ||
+      (LT.second.getScalarType().getSizeInBits() < 32 && !ST->hasSSSE3()))
+    return TargetTransformInfo::getInterleavedMemoryOpCost(Opcode, VecTy,
+                                                           Factor, Indices,
+                                                           Alignment,
+                                                           AddressSpace);
+
+  // The number of shuffles needed to produce one register of a member.
+  // A factor of two is a single shufps/unpck, a factor of four is two levels
+  // of unpck and a factor of three needs shuffles plus blends.
+  unsigned ShufflesPerReg;
+  switch (Factor) {
+  case 2: ShufflesPerReg = 1; break;
+  case 3: ShufflesPerReg = 3; break;
+  case 4: ShufflesPerReg = 2; break;
+  default:
+    return TargetTransformInfo::getInterleavedMemoryOpCost(Opcode, VecTy,
+                                                           Factor, Indices,
+                                                           Alignment,
+                                                           AddressSpace);
+  }
+
+  // 256-bit AVX shuffles don't cross 128-bit lanes; fix that up with a
+  // vperm2f128.
+  if (LT.second.getSizeInBits() > 128)
+    ++ShufflesPerReg;
+
+  // Each member occupies 1/Factor of the legalized registers.
+  unsigned RegsPerMember = std::max(LT.first / Factor, 1u);
+  unsigned NumMembers = Opcode == Instruction::Load ? Indices.size() : Factor;
+  return getMemoryOpCost(Opcode, VecTy, Alignment, AddressSpace) +
+         NumMembers * RegsPerMember * ShufflesPerReg;
+}
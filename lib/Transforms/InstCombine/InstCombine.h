@@ -18,6 +18,7 @@
 #include "llvm/InstVisitor.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/TargetFolder.h"
+#include "llvm/Support/ValueHandle.h"
 #include "llvm/Transforms/Utils/SimplifyLibCalls.h"
 
 namespace llvm {
@@ -77,6 +78,18 @@ class LLVM_LIBRARY_VISIBILITY InstCombiner
   bool MadeIRChange;
   LibCallSimplifier *Simplifier;
   bool MinimizeSize;
+
+  /// ChangedInsts - Instructions changed during the current iteration.  In
+  /// sparse revisit mode only these (and their users and operands) are put
+  /// back on the worklist for the next iteration, instead of the whole
+  /// function.
+  SmallVector<WeakVH, 64> ChangedInsts;
+
+  /// NumConstantConditions - The number of branches and switches on a
+  /// constant seen by the last full sweep.  If it changes, a sparse iteration
+  /// does a full sweep instead, so that the blocks made unreachable are
+  /// cleaned up.
+  unsigned NumConstantConditions;
 public:
   /// Worklist - All of the instructions that need to be simplified.
   InstCombineWorklist Worklist;
@@ -87,7 +100,8 @@ public:
   BuilderTy *Builder;
 
   static char ID; // Pass identification, replacement for typeid
-  InstCombiner() : FunctionPass(ID), TD(0), Builder(0) {
+  InstCombiner()
+    : FunctionPass(ID), TD(0), NumConstantConditions(0), Builder(0) {
     MinimizeSize = false;
     initializeInstCombinerPass(*PassRegistry::getPassRegistry());
   }
@@ -65,12 +65,20 @@ STATISTIC(NumSunkInst , "Number of instructions sunk");
 STATISTIC(NumExpand,    "Number of expansions");
 STATISTIC(NumFactor   , "Number of factorizations");
 STATISTIC(NumReassoc  , "Number of reassociations");
+STATISTIC(NumVisited  , "Number of insts visited");
+STATISTIC(NumSweeps   , "Number of full function sweeps");
 
 static cl::opt<bool> UnsafeFPShrink("enable-double-float-shrink", cl::Hidden,
                                    cl::init(false),
                                    cl::desc("Enable unsafe double to float "
                                             "shrinking for math lib calls"));
 
+static cl::opt<bool>
+SparseRevisit("instcombine-sparse-revisit", cl::Hidden, cl::init(false),
+              cl::desc("After the first iteration, only revisit the users and "
+                       "operands of changed instructions instead of sweeping "
+                       "the whole function again"));
+
 // Initialization Routines
 void llvm::initializeInstCombine(PassRegistry &Registry) {
   initializeInstCombinerPass(Registry);
@@ -2290,13 +2298,61 @@ static bool AddReachableCodeToWorklist(BasicBlock *BB,
   return MadeIRChange;
 }
 
+/// countConstantConditions - Return the number of conditional branches and
+/// switches in F whose condition is a constant.
+static unsigned countConstantConditions(Function &F) {
+  unsigned Count = 0;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB) {
+    TerminatorInst *TI = BB->getTerminator();
+    if (BranchInst *BI = dyn_cast<BranchInst>(TI)) {
+      if (BI->isConditional() && isa<ConstantInt>(BI->getCondition()))
+        ++Count;
+    } else if (SwitchInst *SI = dyn_cast<SwitchInst>(TI)) {
+      if (isa<ConstantInt>(SI->getCondition()))
+        ++Count;
+    }
+  }
+  return Count;
+}
+
 bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
   MadeIRChange = false;
 
   DEBUG(errs() << "\n\nINSTCOMBINE ITERATION #" << Iteration << " on "
                << F.getName() << "\n");
 
-  {
+  // A full sweep only visits the successors of a branch on a constant that
+  // are taken, and empties the blocks that are no longer reachable.  Sparse
+  // revisiting does not, so fall back to a sweep when a branch condition was
+  // folded to a constant by the previous iteration.
+  bool FullSweep = !SparseRevisit || Iteration == 0;
+  if (!FullSweep)
+    FullSweep = countConstantConditions(F) != NumConstantConditions;
+
+  if (!FullSweep) {
+    // Only the instructions changed by the previous iteration can expose new
+    // opportunities, so seed the worklist with them and their neighbours.
+    // Everything else has already been visited and left alone.
+    SmallVector<WeakVH, 64> Changed;
+    Changed.swap(ChangedInsts);
+    for (unsigned i = 0, e = Changed.size(); i != e; ++i) {
+      // The handle is null if the instruction was deleted, and may have been
+      // replaced by a non-instruction value.
+      Value *V = Changed[i];
+      Instruction *I = dyn_cast_or_null<Instruction>(V);
+      if (I == 0) continue;
+      for (User::op_iterator OI = I->op_begin(), OE = I->op_end();
+           OI != OE; ++OI)
+        Worklist.AddValue(*OI);
+      Worklist.AddUsersToWorkList(*I);
+      Worklist.Add(I);
+    }
+  } else {
+    ++NumSweeps;
+    ChangedInsts.clear();
+    if (SparseRevisit)
+      NumConstantConditions = countConstantConditions(F);
+
     // Do a depth-first traversal of the function, populate the worklist with
     // the reachable instructions.  Ignore blocks that are not reachable.  Keep
     // track of which blocks we visit.
@@ -2335,6 +2391,7 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
   while (!Worklist.isEmpty()) {
     Instruction *I = Worklist.RemoveOne();
     if (I == 0) continue;  // skip null values.
+    ++NumVisited;
 
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I, TLI)) {
@@ -2384,7 +2441,10 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
         // otherwise), we can keep going.
         if (UserIsSuccessor && UserParent->getSinglePredecessor())
           // Okay, the CFG is simple enough, try to sink this instruction.
-          MadeIRChange |= TryToSinkInstruction(I, UserParent);
+          if (TryToSinkInstruction(I, UserParent)) {
+            ChangedInsts.push_back(I);
+            MadeIRChange = true;
+          }
       }
     }
 
@@ -2427,6 +2487,7 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
           InsertPos = InstParent->getFirstInsertionPt();
 
         InstParent->getInstList().insert(InsertPos, Result);
+        ChangedInsts.push_back(Result);
 
         EraseInstFromFunction(*I);
       } else {
@@ -2442,6 +2503,7 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
         } else {
           Worklist.Add(I);
           Worklist.AddUsersToWorkList(*I);
+          ChangedInsts.push_back(I);
         }
       }
       MadeIRChange = true;
@@ -2499,6 +2561,7 @@ bool InstCombiner::runOnFunction(Function &F) {
   while (DoOneIteration(F, Iteration++))
     EverMadeChange = true;
 
+  ChangedInsts.clear();
   Builder = 0;
   return EverMadeChange;
 }
@@ -15,14 +15,21 @@
 // edge in the program, instead of using control flow information to prune the
 // number of counters inserted.
 //
+// With -edge-profiling-shards=N the counters are kept in N cache-line padded
+// copies, and each thread increments its own copy. The runtime sums the copies
+// when the program exits. This keeps counts of multi-threaded programs exact
+// (up to N threads) and cheap.
+//
 //===----------------------------------------------------------------------===//
 #define DEBUG_TYPE "insert-edge-profiling"
 
 #include "llvm/Transforms/Instrumentation.h"
 #include "ProfilingUtils.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include <set>
@@ -30,6 +37,11 @@ using namespace llvm;
 
 STATISTIC(NumEdgesInserted, "The # of edges inserted.");
 
+static cl::opt<unsigned>
+NumCounterShards("edge-profiling-shards", cl::init(0), cl::value_desc("N"),
+                 cl::desc("Keep a copy of the edge counters for each of up "
+                          "to N threads"));
+
 namespace {
   class EdgeProfiler : public ModulePass {
     bool runOnModule(Module &M);
@@ -51,6 +63,16 @@ INITIALIZE_PASS(EdgeProfiler, "insert-edge-profiling",
 
 ModulePass *llvm::createEdgeProfilerPass() { return new EdgeProfiler(); }
 
+static void IncrementEdgeCounter(BasicBlock *BB, unsigned CounterNum,
+                                 GlobalVariable *Counters,
+                                 GlobalVariable *ShardSlot,
+                                 bool beginning = true) {
+  if (ShardSlot)
+    IncrementShardedCounterInBlock(BB, CounterNum, ShardSlot, beginning);
+  else
+    IncrementCounterInBlock(BB, CounterNum, Counters, beginning);
+}
+
 bool EdgeProfiler::runOnModule(Module &M) {
   Function *Main = M.getFunction("main");
   if (Main == 0) {
@@ -74,10 +96,17 @@ bool EdgeProfiler::runOnModule(Module &M) {
     }
   }
 
-  Type *ATy = ArrayType::get(Type::getInt32Ty(M.getContext()), NumEdges);
-  GlobalVariable *Counters =
-    new GlobalVariable(M, ATy, false, GlobalValue::InternalLinkage,
-                       Constant::getNullValue(ATy), "EdgeProfCounters");
+  GlobalVariable *Counters, *ShardSlot = 0;
+  if (NumCounterShards) {
+    Counters = CreateShardedCounters(M, NumEdges, NumCounterShards,
+                                     "EdgeProfCounters");
+    ShardSlot = CreateCounterShardSlot(Counters);
+  } else {
+    Type *ATy = ArrayType::get(Type::getInt32Ty(M.getContext()), NumEdges);
+    Counters =
+      new GlobalVariable(M, ATy, false, GlobalValue::InternalLinkage,
+                         Constant::getNullValue(ATy), "EdgeProfCounters");
+  }
   NumEdgesInserted = NumEdges;
 
   // Instrument all of the edges...
@@ -85,7 +114,7 @@ bool EdgeProfiler::runOnModule(Module &M) {
   for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
     if (F->isDeclaration()) continue;
     // Create counter for (0,entry) edge.
-    IncrementCounterInBlock(&F->getEntryBlock(), i++, Counters);
+    IncrementEdgeCounter(&F->getEntryBlock(), i++, Counters, ShardSlot);
     for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
       if (BlocksToInstrument.count(BB)) {  // Don't instrument inserted blocks
         // Okay, we have to add a counter of each outgoing edge.  If the
@@ -101,17 +130,34 @@ bool EdgeProfiler::runOnModule(Module &M) {
           // otherwise insert it in the successor block.
           if (TI->getNumSuccessors() == 1) {
             // Insert counter at the start of the block
-            IncrementCounterInBlock(BB, i++, Counters, false);
+            IncrementEdgeCounter(BB, i++, Counters, ShardSlot, false);
           } else {
             // Insert counter at the start of the block
-            IncrementCounterInBlock(TI->getSuccessor(s), i++, Counters);
+            IncrementEdgeCounter(TI->getSuccessor(s), i++, Counters,
+                                 ShardSlot);
           }
         }
       }
+
+    if (ShardSlot)
+      InsertCounterShardSelection(F, Counters, ShardSlot);
   }
 
   // Add the initialization call to main.
-  InsertProfilingInitCall(Main, "llvm_start_edge_profiling", Counters);
+  if (!ShardSlot) {
+    InsertProfilingInitCall(Main, "llvm_start_edge_profiling", Counters);
+    return true;
+  }
+
+  ArrayType *ATy = cast<ArrayType>(Counters->getType()->getElementType());
+  ArrayType *ShardTy = cast<ArrayType>(ATy->getElementType());
+  Constant *ExtraArgs[2] = {
+    ConstantInt::get(Type::getInt32Ty(M.getContext()), NumEdges),
+    ConstantInt::get(Type::getInt32Ty(M.getContext()),
+                     ShardTy->getNumElements())
+  };
+  InsertProfilingInitCall(Main, "llvm_start_sharded_edge_profiling", Counters,
+                          PointerType::getUnqual(ShardTy), ExtraArgs);
   return true;
 }
 
@@ -19,26 +19,35 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MathExtras.h"
 
 void llvm::InsertProfilingInitCall(Function *MainFn, const char *FnName,
                                    GlobalValue *Array,
-                                   PointerType *arrayType) {
+                                   PointerType *arrayType,
+                                   ArrayRef<Constant*> ExtraArgs) {
   LLVMContext &Context = MainFn->getContext();
   Type *ArgVTy =
     PointerType::getUnqual(Type::getInt8PtrTy(Context));
   PointerType *UIntPtr = arrayType ? arrayType :
     Type::getInt32PtrTy(Context);
   Module &M = *MainFn->getParent();
-  Constant *InitFn = M.getOrInsertFunction(FnName, Type::getInt32Ty(Context),
-                                           Type::getInt32Ty(Context),
-                                           ArgVTy, UIntPtr,
-                                           Type::getInt32Ty(Context),
-                                           (Type *)0);
+  std::vector<Type*> ParamTys;
+  ParamTys.push_back(Type::getInt32Ty(Context));
+  ParamTys.push_back(ArgVTy);
+  ParamTys.push_back(UIntPtr);
+  ParamTys.push_back(Type::getInt32Ty(Context));
+  for (unsigned i = 0, e = ExtraArgs.size(); i != e; ++i)
+    ParamTys.push_back(ExtraArgs[i]->getType());
+  Constant *InitFn = M.getOrInsertFunction(FnName,
+                       FunctionType::get(Type::getInt32Ty(Context), ParamTys,
+                                         false));
 
   // This could force argc and argv into programs that wouldn't otherwise have
   // them, but instead we just pass null values in.
   std::vector<Value*> Args(4);
+  Args.insert(Args.end(), ExtraArgs.begin(), ExtraArgs.end());
   Args[0] = Constant::getNullValue(Type::getInt32Ty(Context));
   Args[1] = Constant::getNullValue(ArgVTy);
 
@@ -129,6 +138,135 @@ void llvm::IncrementCounterInBlock(BasicBlock *BB, unsigned CounterNum,
   new StoreInst(NewVal, ElementPtr, InsertPos);
 }
 
+/// CreateShardedCounters - Create a zero-initialized array of NumShards
+/// copies of NumCounters counters. Each copy is padded to a multiple of 64
+/// bytes and the array is aligned to 64 bytes, so no two shards share a cache
+/// line.
+llvm::GlobalVariable *llvm::CreateShardedCounters(Module &M,
+                                                  unsigned NumCounters,
+                                                  unsigned NumShards,
+                                                  const char *Name) {
+  const unsigned CountersPerLine = 64 / 4;
+  unsigned Stride = RoundUpToAlignment(NumCounters, CountersPerLine);
+  Type *ShardTy = ArrayType::get(Type::getInt32Ty(M.getContext()), Stride);
+  Type *ATy = ArrayType::get(ShardTy, NumShards);
+  GlobalVariable *Counters =
+    new GlobalVariable(M, ATy, false, GlobalValue::InternalLinkage,
+                       Constant::getNullValue(ATy), Name);
+  Counters->setAlignment(64);
+  return Counters;
+}
+
+/// CreateCounterShardSlot - Create the thread-local pointer to the shard of
+/// Counters used by the current thread. It is null until the thread calls an
+/// instrumented function.
+llvm::GlobalVariable *
+llvm::CreateCounterShardSlot(GlobalVariable *Counters) {
+  ArrayType *ATy = cast<ArrayType>(Counters->getType()->getElementType());
+  PointerType *ShardPtrTy = PointerType::getUnqual(ATy->getElementType());
+  return new GlobalVariable(*Counters->getParent(), ShardPtrTy, false,
+                            GlobalValue::InternalLinkage,
+                            ConstantPointerNull::get(ShardPtrTy),
+                            Counters->getName() + "Shard", 0,
+                            GlobalVariable::GeneralDynamicTLSModel);
+}
+
+/// IncrementShardedCounterInBlock - Like IncrementCounterInBlock, but
+/// increment counter CounterNum of the current thread's shard. The shard is
+/// loaded from ShardSlot until InsertCounterShardSelection replaces the load.
+void llvm::IncrementShardedCounterInBlock(BasicBlock *BB, unsigned CounterNum,
+                                          GlobalVariable *ShardSlot,
+                                          bool beginning) {
+  BasicBlock::iterator InsertPos = beginning ? BB->getFirstInsertionPt() :
+                                   BB->getTerminator();
+  while (isa<AllocaInst>(InsertPos))
+    ++InsertPos;
+
+  LLVMContext &Context = BB->getContext();
+  Value *Shard = new LoadInst(ShardSlot, "CounterShard", InsertPos);
+  Value *Indices[2] = {
+    Constant::getNullValue(Type::getInt32Ty(Context)),
+    ConstantInt::get(Type::getInt32Ty(Context), CounterNum)
+  };
+  Value *ElementPtr =
+    GetElementPtrInst::CreateInBounds(Shard, Indices, "", InsertPos);
+
+  Value *OldVal = new LoadInst(ElementPtr, "OldFuncCounter", InsertPos);
+  Value *NewVal = BinaryOperator::Create(Instruction::Add, OldVal,
+                                 ConstantInt::get(Type::getInt32Ty(Context), 1),
+                                         "NewFuncCounter", InsertPos);
+  new StoreInst(NewVal, ElementPtr, InsertPos);
+}
+
+/// InsertCounterShardSelection - Make the entry of F pick a shard of Counters
+/// for the current thread if it has none yet. Threads take shards in turn
+/// from the llvm_next_counter_shard runtime function, and share them once
+/// there are more threads than shards. This must be called after F has been
+/// instrumented, since it splits the entry block. The shard is then kept in
+/// a phi, and the loads of ShardSlot made by IncrementShardedCounterInBlock
+/// in F are replaced with it, so that each increment does not read the
+/// thread-local slot again.
+void llvm::InsertCounterShardSelection(Function *F, GlobalVariable *Counters,
+                                       GlobalVariable *ShardSlot) {
+  LLVMContext &Context = F->getContext();
+  Module &M = *F->getParent();
+  BasicBlock *Entry = F->begin();
+  BasicBlock::iterator SplitPt = Entry->begin();
+  while (isa<AllocaInst>(SplitPt))
+    ++SplitPt;
+  BasicBlock *Body = Entry->splitBasicBlock(SplitPt, "shard.selected");
+  BasicBlock *Select = BasicBlock::Create(Context, "shard.select", F, Body);
+
+  // entry:
+  //   %CounterShard = load ShardSlot
+  //   br (%CounterShard == null), %shard.select, %shard.selected
+  Entry->getTerminator()->eraseFromParent();
+  Value *Shard = new LoadInst(ShardSlot, "CounterShard", Entry);
+  Value *NoShard = new ICmpInst(*Entry, ICmpInst::ICMP_EQ, Shard,
+                                Constant::getNullValue(Shard->getType()));
+  BranchInst *Br = BranchInst::Create(Select, Body, NoShard, Entry);
+  Br->setMetadata(LLVMContext::MD_prof,
+                  MDBuilder(Context).createBranchWeights(1, 1 << 20));
+
+  // shard.select:
+  //   %N = call @llvm_next_counter_shard()
+  //   store &Counters[%N % NumShards], ShardSlot
+  Constant *NextShardFn =
+    M.getOrInsertFunction("llvm_next_counter_shard",
+                          Type::getInt32Ty(Context), (Type *)0);
+  Value *N = CallInst::Create(NextShardFn, "", Select);
+  unsigned NumShards =
+    cast<ArrayType>(Counters->getType()->getElementType())->getNumElements();
+  Value *Index = BinaryOperator::CreateURem(N,
+                   ConstantInt::get(Type::getInt32Ty(Context), NumShards),
+                   "", Select);
+  Value *Indices[2] = {
+    Constant::getNullValue(Type::getInt32Ty(Context)), Index
+  };
+  Value *NewShard =
+    GetElementPtrInst::CreateInBounds(Counters, Indices, "", Select);
+  new StoreInst(NewShard, ShardSlot, Select);
+  BranchInst::Create(Body, Select);
+
+  // shard.selected:
+  //   %CounterShard = phi [%CounterShard, %entry], [%NewShard, %shard.select]
+  PHINode *PN = PHINode::Create(Shard->getType(), 2, "CounterShard",
+                                Body->begin());
+  PN->addIncoming(Shard, Entry);
+  PN->addIncoming(NewShard, Select);
+
+  // Entry and Select only branch to Body, so the phi dominates every
+  // increment.
+  for (Value::use_iterator UI = ShardSlot->use_begin(),
+       UE = ShardSlot->use_end(); UI != UE; ) {
+    LoadInst *LI = dyn_cast<LoadInst>(*UI++);
+    if (!LI || LI == Shard || LI->getParent()->getParent() != F)
+      continue;
+    LI->replaceAllUsesWith(PN);
+    LI->eraseFromParent();
+  }
+}
+
 void llvm::InsertProfilingShutdownCall(Function *Callee, Module *Mod) {
   // llvm.global_dtors is an array of type { i32, void ()* }. Prepare those
   // types.
@@ -17,20 +17,39 @@
 #ifndef PROFILINGUTILS_H
 #define PROFILINGUTILS_H
 
+#include "llvm/ADT/ArrayRef.h"
+
 namespace llvm {
   class BasicBlock;
+  class Constant;
   class Function;
   class GlobalValue;
+  class GlobalVariable;
   class Module;
   class PointerType;
 
   void InsertProfilingInitCall(Function *MainFn, const char *FnName,
                                GlobalValue *Arr = 0,
-                               PointerType *arrayType = 0);
+                               PointerType *arrayType = 0,
+                               ArrayRef<Constant*> ExtraArgs =
+                                 ArrayRef<Constant*>());
   void IncrementCounterInBlock(BasicBlock *BB, unsigned CounterNum,
                                GlobalValue *CounterArray,
                                bool beginning = true);
   void InsertProfilingShutdownCall(Function *Callee, Module *Mod);
+
+  // Sharded counters keep several copies, or shards, of a counter array of
+  // type [NumShards x [N x i32]]. Each thread increments the shard that the
+  // thread-local pointer ShardSlot points to. This avoids both lost updates
+  // and cache lines bouncing between the threads that share a counter.
+  GlobalVariable *CreateShardedCounters(Module &M, unsigned NumCounters,
+                                        unsigned NumShards, const char *Name);
+  GlobalVariable *CreateCounterShardSlot(GlobalVariable *Counters);
+  void IncrementShardedCounterInBlock(BasicBlock *BB, unsigned CounterNum,
+                                      GlobalVariable *ShardSlot,
+                                      bool beginning = true);
+  void InsertCounterShardSelection(Function *F, GlobalVariable *Counters,
+                                   GlobalVariable *ShardSlot);
 }
 
 #endif
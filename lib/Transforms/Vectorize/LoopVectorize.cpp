@@ -111,6 +111,19 @@ TinyTripCountVectorThreshold("vectorizer-min-trip-count", cl::init(16),
                                       "trip count that is smaller than this "
                                       "value."));
 
+static cl::opt<bool>
+EnableInterleavedMemAccesses("enable-interleaved-mem-accesses", cl::init(true),
+                             cl::Hidden,
+                             cl::desc("Enable vectorization of interleaved "
+                                      "(constant stride) memory accesses "
+                                      "with wide loads/stores and shuffles."));
+
+/// We don't form interleave groups with a stride larger than this number.
+static cl::opt<unsigned>
+MaxInterleaveFactor("max-interleave-group-factor", cl::init(4), cl::Hidden,
+                    cl::desc("Maximum stride (in elements) of an interleaved "
+                             "access group."));
+
 /// We don't unroll loops with a known constant trip count below this number.
 static const unsigned TinyTripCountUnrollThreshold = 128;
 
@@ -206,6 +219,12 @@ private:
   void vectorizeMemoryInstruction(Instruction *Instr,
                                   LoopVectorizationLegality *Legal);
 
+  /// Vectorize a member of an interleave group. The whole group is emitted as
+  /// one wide load (followed by shuffles that extract each member) or as
+  /// shuffles that interleave the members followed by one wide store.
+  void vectorizeInterleaveGroup(Instruction *Instr,
+                                LoopVectorizationLegality *Legal);
+
   /// Create a broadcast instruction. This method generates a broadcast
   /// instruction (shuffle) for loop invariant values and for the induction
   /// value. If this is the induction variable then we extend it to N, N+1, ...
@@ -438,7 +457,8 @@ public:
     RK_IntegerMinMax, ///< Min/max implemented in terms of select(cmp()).
     RK_FloatAdd,    ///< Sum of floats.
     RK_FloatMult,   ///< Product of floats.
-    RK_FloatMinMax  ///< Min/max implemented in terms of select(cmp()).
+    RK_FloatMinMax, ///< Min/max implemented in terms of select(cmp()).
+    RK_IntegerMinMaxIdx ///< Position of the first min/max (argmin/argmax).
   };
 
   /// This enum represents the kinds of inductions that we support.
@@ -464,11 +484,13 @@ public:
   /// This POD struct holds information about reduction variables.
   struct ReductionDescriptor {
     ReductionDescriptor() : StartValue(0), LoopExitInstr(0),
-      Kind(RK_NoReduction), MinMaxKind(MRK_Invalid) {}
+      Kind(RK_NoReduction), MinMaxKind(MRK_Invalid), IndexSelect(0),
+      MinMaxPhi(0) {}
 
     ReductionDescriptor(Value *Start, Instruction *Exit, ReductionKind K,
                         MinMaxReductionKind MK)
-        : StartValue(Start), LoopExitInstr(Exit), Kind(K), MinMaxKind(MK) {}
+        : StartValue(Start), LoopExitInstr(Exit), Kind(K), MinMaxKind(MK),
+          IndexSelect(0), MinMaxPhi(0) {}
 
     // The starting value of the reduction.
     // It does not have to be zero!
@@ -479,6 +501,11 @@ public:
     ReductionKind Kind;
     // If this a min/max reduction the kind of reduction.
     MinMaxReductionKind MinMaxKind;
+    // If this is a min/max reduction, a second select on the min/max compare
+    // that records the position of the min/max.
+    SelectInst *IndexSelect;
+    // If this is a min/max index reduction, the min/max reduction it tracks.
+    PHINode *MinMaxPhi;
   };
 
   /// This POD struct holds information about a potential reduction operation.
@@ -511,8 +538,10 @@ public:
       Ends.clear();
     }
 
-    /// Insert a pointer and calculate the start and end SCEVs.
-    void insert(ScalarEvolution *SE, Loop *Lp, Value *Ptr, bool WritePtr);
+    /// Insert a pointer and calculate the start and end SCEVs. The access
+    /// extends \p TailBytes past the address of the last iteration.
+    void insert(ScalarEvolution *SE, Loop *Lp, Value *Ptr, bool WritePtr,
+                uint64_t TailBytes = 0);
 
     /// This flag indicates if we need to add the runtime check.
     bool Need;
@@ -526,6 +555,51 @@ public:
     SmallVector<bool, 2> IsWritePtr;
   };
 
+  /// An interleave group is a set of loads or a set of stores in one block
+  /// that access the same array with the same constant stride, at distinct
+  /// offsets smaller than the stride. For example:
+  ///   for (i = 0; i < n; ++i) { x = A[3*i]; y = A[3*i+1]; z = A[3*i+2]; }
+  /// is a load group with a factor of three. Such a group is vectorized with
+  /// a single wide load of VF * Factor elements and one shuffle per member.
+  struct InterleaveGroup {
+    InterleaveGroup(unsigned F, bool Store)
+        : Factor(F), IsStore(Store), Align(0), Start(0), FirstInst(0),
+          LastInst(0) {
+      Members.resize(F);
+    }
+
+    /// The member at index \p Index, or null if there is a gap.
+    Instruction *getMember(unsigned Index) const { return Members[Index]; }
+
+    /// The index of \p I in the group.
+    unsigned getIndex(Instruction *I) const {
+      for (unsigned i = 0; i < Factor; ++i)
+        if (Members[i] == I)
+          return i;
+      llvm_unreachable("Not a member of this interleave group");
+    }
+
+    /// The position at which the wide access is emitted. Loads are hoisted to
+    /// the first member and stores are sunk to the last member, so that all
+    /// loaded values are available to their users and all stored values are
+    /// available to the store.
+    Instruction *getInsertPos() const { return IsStore ? LastInst : FirstInst; }
+
+    /// The stride of the group, in elements.
+    unsigned Factor;
+    /// True if this is a group of stores.
+    bool IsStore;
+    /// The alignment of the wide access (the alignment of member zero).
+    unsigned Align;
+    /// The address of member zero in the first iteration.
+    const SCEV *Start;
+    /// The members, indexed by their offset from member zero.
+    SmallVector<Instruction*, 4> Members;
+    /// The first and last members in program order.
+    Instruction *FirstInst;
+    Instruction *LastInst;
+  };
+
   /// A POD for saving information about induction variables.
   struct InductionInfo {
     InductionInfo(Value *Start, InductionKind K) : StartValue(Start), IK(K) {}
@@ -592,6 +666,16 @@ public:
   /// Returns the information that we collected about runtime memory check.
   RuntimePointerCheck *getRuntimePointerCheck() { return &PtrRtCheck; }
 
+  /// Returns the interleave group that \p I belongs to, or null if \p I is
+  /// not part of an interleaved access.
+  const InterleaveGroup *getInterleaveGroup(Instruction *I) const {
+    DenseMap<Instruction*, unsigned>::const_iterator It =
+      InterleaveGroupMap.find(I);
+    if (It == InterleaveGroupMap.end())
+      return 0;
+    return &InterleaveGroups[It->second];
+  }
+
   /// This function returns the identity element (or neutral element) for
   /// the operation K.
   static Constant *getReductionIdentity(ReductionKind K, Type *Tp);
@@ -611,6 +695,24 @@ private:
   /// transformation.
   bool canVectorizeWithIfConvert();
 
+  /// Find the groups of interleaved loads and stores in the loop.
+  void analyzeInterleaving();
+
+  /// Returns the store group that writes exactly the memory read by the load
+  /// group of \p Ld, if all of the loads of that group come before all of
+  /// the stores. Such loads and stores touch disjoint memory in different
+  /// iterations and can be vectorized without a dependence check between
+  /// them.
+  const InterleaveGroup *getCoveringStoreGroup(Instruction *Ld) const;
+
+  /// Returns true if all of \p Insts are members of the group \p Group.
+  bool areAllInInterleaveGroup(const std::vector<Instruction*> &Insts,
+                               const InterleaveGroup *Group) const;
+
+  /// Returns the number of bytes that the group of \p Inst accesses past the
+  /// address of \p Ptr, or zero if \p Inst is not part of a group.
+  uint64_t getInterleaveTailBytes(Value *Ptr, Instruction *Inst) const;
+
   /// Collect the variables that need to stay uniform after vectorization.
   void collectLoopUniforms();
 
@@ -621,6 +723,10 @@ private:
   /// Returns True, if 'Phi' is the kind of reduction variable for type
   /// 'Kind'. If this is a reduction variable, it adds it to ReductionList.
   bool AddReductionVar(PHINode *Phi, ReductionKind Kind);
+  /// Returns true if 'Phi' holds the position of the first min/max element
+  /// of a min/max reduction (argmin/argmax). Must be called after all other
+  /// PHIs of the header were classified. Adds 'Phi' to ReductionList.
+  bool AddMinMaxIndexVar(PHINode *Phi);
   /// Returns a struct describing if the instruction 'I' can be a reduction
   /// variable of type 'Kind'. If the reduction is a min/max pattern of
   /// select(icmp()) this function advances the instruction pointer 'I' from the
@@ -689,6 +795,12 @@ private:
 
   /// Utility to determine whether loads can be speculated.
   LoadHoisting LoadSpeculation;
+
+  /// Holds the interleave groups found in the loop.
+  SmallVector<InterleaveGroup, 4> InterleaveGroups;
+  /// Maps each member of an interleave group to the group's index in
+  /// InterleaveGroups.
+  DenseMap<Instruction*, unsigned> InterleaveGroupMap;
 };
 
 /// LoopVectorizationCostModel - estimates the expected speedups due to
@@ -892,12 +1004,16 @@ struct LoopVectorize : public LoopPass {
 void
 LoopVectorizationLegality::RuntimePointerCheck::insert(ScalarEvolution *SE,
                                                        Loop *Lp, Value *Ptr,
-                                                       bool WritePtr) {
+                                                       bool WritePtr,
+                                                       uint64_t TailBytes) {
   const SCEV *Sc = SE->getSCEV(Ptr);
   const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(Sc);
   assert(AR && "Invalid addrec expression");
   const SCEV *Ex = SE->getExitCount(Lp, Lp->getLoopLatch());
   const SCEV *ScEnd = AR->evaluateAtIteration(Ex, *SE);
+  if (TailBytes)
+    ScEnd = SE->getAddExpr(ScEnd, SE->getConstant(
+      SE->getEffectiveSCEVType(Ptr->getType()), TailBytes));
   Pointers.push_back(Ptr);
   Starts.push_back(AR->getStart());
   Ends.push_back(ScEnd);
@@ -1049,8 +1165,129 @@ Value *InnerLoopVectorizer::reverseVector(Value *Vec) {
 }
 
 
+/// \brief Returns a mask that selects every \p Stride'th element starting at
+/// \p Start: <Start, Start + Stride, ..., Start + (VF - 1) * Stride>.
+static Constant *getStridedMask(IRBuilder<> &Builder, unsigned Start,
+                                unsigned Stride, unsigned VF) {
+  SmallVector<Constant*, 16> Mask;
+  for (unsigned i = 0; i < VF; ++i)
+    Mask.push_back(Builder.getInt32(Start + i * Stride));
+  return ConstantVector::get(Mask);
+}
+
+/// \brief Returns a mask that interleaves \p NumVecs concatenated vectors of
+/// \p VF elements: <0, VF, 2*VF, ..., 1, VF+1, 2*VF+1, ...>.
+static Constant *getInterleaveMask(IRBuilder<> &Builder, unsigned VF,
+                                   unsigned NumVecs) {
+  SmallVector<Constant*, 16> Mask;
+  for (unsigned i = 0; i < VF; ++i)
+    for (unsigned j = 0; j < NumVecs; ++j)
+      Mask.push_back(Builder.getInt32(j * VF + i));
+  return ConstantVector::get(Mask);
+}
+
+/// \brief Concatenate vectors of the same element type into one vector. The
+/// shorter operand of each step is padded with undef elements, because both
+/// shufflevector operands must have the same type.
+static Value *concatenateVectors(IRBuilder<> &Builder,
+                                 ArrayRef<Value *> Vecs) {
+  Value *Result = Vecs[0];
+  for (unsigned i = 1, e = Vecs.size(); i != e; ++i) {
+    Value *V = Vecs[i];
+    unsigned NumResElts = Result->getType()->getVectorNumElements();
+    unsigned NumVElts = V->getType()->getVectorNumElements();
+    assert(NumVElts <= NumResElts && "Unexpected vector length");
+
+    if (NumVElts < NumResElts) {
+      SmallVector<Constant*, 16> PadMask;
+      for (unsigned j = 0; j < NumResElts; ++j)
+        if (j < NumVElts)
+          PadMask.push_back(Builder.getInt32(j));
+        else
+          PadMask.push_back(UndefValue::get(Builder.getInt32Ty()));
+      V = Builder.CreateShuffleVector(V, UndefValue::get(V->getType()),
+                                      ConstantVector::get(PadMask));
+    }
+
+    SmallVector<Constant*, 16> ConcatMask;
+    for (unsigned j = 0; j < NumResElts + NumVElts; ++j)
+      ConcatMask.push_back(Builder.getInt32(j));
+    Result = Builder.CreateShuffleVector(Result, V,
+                                         ConstantVector::get(ConcatMask));
+  }
+  return Result;
+}
+
+void InnerLoopVectorizer::vectorizeInterleaveGroup(Instruction *Instr,
+                                             LoopVectorizationLegality *Legal) {
+  const LoopVectorizationLegality::InterleaveGroup *Group =
+    Legal->getInterleaveGroup(Instr);
+  assert(Group && "Not an interleaved access");
+
+  // The whole group is emitted at its insert position. The other loads have
+  // already been given their vector values there, and the other stores are
+  // emitted together with the last one.
+  if (Instr != Group->getInsertPos())
+    return;
+
+  LoadInst *LI = dyn_cast<LoadInst>(Instr);
+  StoreInst *SI = dyn_cast<StoreInst>(Instr);
+  Type *ScalarDataTy = LI ? LI->getType() : SI->getValueOperand()->getType();
+  Value *Ptr = LI ? LI->getPointerOperand() : SI->getPointerOperand();
+  unsigned AS = cast<PointerType>(Ptr->getType())->getAddressSpace();
+  unsigned Factor = Group->Factor;
+  Type *WideTy = VectorType::get(ScalarDataTy, VF * Factor);
+  Type *WidePtrTy = WideTy->getPointerTo(AS);
+  int Index = Group->getIndex(Instr);
+
+  Constant *Zero = Builder.getInt32(0);
+  VectorParts &PtrParts = getVectorValue(Ptr);
+
+  for (unsigned Part = 0; Part < UF; ++Part) {
+    // The address of member zero of the first iteration of this part.
+    Value *NewPtr = Builder.CreateExtractElement(PtrParts[Part], Zero);
+    NewPtr = Builder.CreateGEP(NewPtr, Builder.getInt32(-Index));
+    NewPtr = Builder.CreateBitCast(NewPtr, WidePtrTy);
+
+    if (LI) {
+      LoadInst *WideLoad = Builder.CreateLoad(NewPtr, "wide.vec");
+      WideLoad->setAlignment(Group->Align);
+
+      // Extract each member with a strided shuffle.
+      for (unsigned i = 0; i < Factor; ++i) {
+        Instruction *Member = Group->getMember(i);
+        if (!Member)
+          continue;
+        WidenMap.get(Member)[Part] =
+          Builder.CreateShuffleVector(WideLoad, UndefValue::get(WideTy),
+                                      getStridedMask(Builder, i, Factor, VF),
+                                      "strided.vec");
+      }
+      continue;
+    }
+
+    // Concatenate the stored values of all members and interleave them.
+    SmallVector<Value*, 4> StoredVecs;
+    for (unsigned i = 0; i < Factor; ++i) {
+      StoreInst *Member = cast<StoreInst>(Group->getMember(i));
+      StoredVecs.push_back(getVectorValue(Member->getValueOperand())[Part]);
+    }
+    Value *WideVec = concatenateVectors(Builder, StoredVecs);
+    Value *IVec = Builder.CreateShuffleVector(WideVec,
+                                              UndefValue::get(WideTy),
+                                              getInterleaveMask(Builder, VF,
+                                                                Factor),
+                                              "interleaved.vec");
+    Builder.CreateStore(IVec, NewPtr)->setAlignment(Group->Align);
+  }
+}
+
 void InnerLoopVectorizer::vectorizeMemoryInstruction(Instruction *Instr,
                                              LoopVectorizationLegality *Legal) {
+  // Interleaved accesses are combined into one wide access per group.
+  if (Legal->getInterleaveGroup(Instr))
+    return vectorizeInterleaveGroup(Instr, Legal);
+
   // Attempt to issue a wide load.
   LoadInst *LI = dyn_cast<LoadInst>(Instr);
   StoreInst *SI = dyn_cast<StoreInst>(Instr);
@@ -1776,6 +2013,7 @@ getReductionBinOp(LoopVectorizationLegality::ReductionKind Kind) {
     case LoopVectorizationLegality::RK_FloatAdd:
       return Instruction::FAdd;
     case LoopVectorizationLegality::RK_IntegerMinMax:
+    case LoopVectorizationLegality::RK_IntegerMinMaxIdx:
       return Instruction::ICmp;
     case LoopVectorizationLegality::RK_FloatMinMax:
       return Instruction::FCmp;
@@ -1859,6 +2097,24 @@ InnerLoopVectorizer::vectorizeLoop(LoopVectorizationLegality *Legal) {
   // not want to introduce cycles. Notice that the remaining PHI nodes
   // that we need to fix are reduction variables.
 
+  // Min/max index reductions need the final value of their min/max reduction,
+  // so they are reduced last.
+  PhiVector IndexPHIs;
+  for (unsigned i = 0; i < RdxPHIsToFix.size();) {
+    PHINode *RdxPhi = RdxPHIsToFix[i];
+    if ((*Legal->getReductionVars())[RdxPhi].Kind ==
+        LoopVectorizationLegality::RK_IntegerMinMaxIdx) {
+      IndexPHIs.push_back(RdxPhi);
+      RdxPHIsToFix.erase(RdxPHIsToFix.begin() + i);
+    } else
+      ++i;
+  }
+  RdxPHIsToFix.append(IndexPHIs.begin(), IndexPHIs.end());
+
+  // The reduced min/max and the vector exit values of each min/max reduction.
+  DenseMap<PHINode *, Value *> MinMaxResults;
+  DenseMap<PHINode *, VectorParts> MinMaxParts;
+
   // Create the 'reduced' values for each of the induction vars.
   // The reduced values are the vector values that we scalarize and combine
   // after the loop is finished.
@@ -1888,7 +2144,8 @@ InnerLoopVectorizer::vectorizeLoop(LoopVectorizationLegality *Legal) {
     Value *Identity;
     Value *VectorStart;
     if (RdxDesc.Kind == LoopVectorizationLegality::RK_IntegerMinMax ||
-        RdxDesc.Kind == LoopVectorizationLegality::RK_FloatMinMax) {
+        RdxDesc.Kind == LoopVectorizationLegality::RK_FloatMinMax ||
+        RdxDesc.Kind == LoopVectorizationLegality::RK_IntegerMinMaxIdx) {
       // MinMax reduction have the start value as their identify.
       VectorStart = Identity = Builder.CreateVectorSplat(VF, RdxDesc.StartValue,
                                                          "minmax.ident");
@@ -1942,6 +2199,32 @@ InnerLoopVectorizer::vectorizeLoop(LoopVectorizationLegality *Legal) {
       RdxParts.push_back(NewPhi);
     }
 
+    if (RdxDesc.Kind == LoopVectorizationLegality::RK_IntegerMinMaxIdx) {
+      // Only keep the positions of the lanes that hold the final min/max. The
+      // smallest of them is the first occurrence. This code uses the reduced
+      // min/max, so emit it after it.
+      Builder.SetInsertPoint(LoopMiddleBlock->getTerminator());
+      assert(MinMaxResults.count(RdxDesc.MinMaxPhi) &&
+             "Min/max must be reduced before its position");
+      Value *MinMax = Builder.CreateVectorSplat(
+          VF, MinMaxResults[RdxDesc.MinMaxPhi], "minmax.splat");
+      VectorParts &MinMaxVals = MinMaxParts[RdxDesc.MinMaxPhi];
+      Type *IdxTy = VecTy->getScalarType();
+      Value *NoIdx = ConstantVector::getSplat(VF, ConstantInt::get(IdxTy,
+          APInt::getSignedMaxValue(IdxTy->getPrimitiveSizeInBits())));
+      for (unsigned part = 0; part < UF; ++part) {
+        Value *IsMinMax;
+        if (MinMax->getType()->isFPOrFPVectorTy())
+          IsMinMax = Builder.CreateFCmpOEQ(MinMaxVals[part], MinMax,
+                                           "rdx.minmax.eq");
+        else
+          IsMinMax = Builder.CreateICmpEQ(MinMaxVals[part], MinMax,
+                                          "rdx.minmax.eq");
+        RdxParts[part] = Builder.CreateSelect(IsMinMax, RdxParts[part], NoIdx,
+                                              "rdx.idx");
+      }
+    }
+
     // Reduce all of the unrolled parts into a single vector.
     Value *ReducedPartRdx = RdxParts[0];
     unsigned Op = getReductionBinOp(RdxDesc.Kind);
@@ -1987,6 +2270,12 @@ InnerLoopVectorizer::vectorizeLoop(LoopVectorizationLegality *Legal) {
     // The result is in the first element of the vector.
     Value *Scalar0 = Builder.CreateExtractElement(TmpVec, Builder.getInt32(0));
 
+    if (RdxDesc.Kind == LoopVectorizationLegality::RK_IntegerMinMax ||
+        RdxDesc.Kind == LoopVectorizationLegality::RK_FloatMinMax) {
+      MinMaxResults[RdxPhi] = Scalar0;
+      MinMaxParts[RdxPhi] = RdxParts;
+    }
+
     // Now, we need to fix the users of the reduction variable
     // inside and outside of the scalar remainder loop.
     // We know that the loop is in LCSSA form. We need to update the
@@ -2489,6 +2778,10 @@ bool LoopVectorizationLegality::canVectorize() {
     return false;
   }
 
+  // Find the interleaved accesses before checking the memory dependences,
+  // which are more relaxed for the members of an interleave group.
+  analyzeInterleaving();
+
   // Go over each instruction and look at memory deps.
   if (!canVectorizeMemory()) {
     DEBUG(dbgs() << "LV: Can't vectorize due to memory conflicts\n");
@@ -2540,6 +2833,10 @@ bool LoopVectorizationLegality::canVectorizeInstrs() {
       AttributeSet::FunctionIndex,
       "no-nans-fp-math").getValueAsString() == "true";
 
+  // PHIs that may hold the position of a min/max. They are classified after
+  // the min/max reductions they depend on are known.
+  SmallVector<PHINode *, 2> MinMaxIndexPhis;
+
   // For each block in the loop.
   for (Loop::block_iterator bb = TheLoop->block_begin(),
        be = TheLoop->block_end(); bb != be; ++bb) {
@@ -2632,6 +2929,16 @@ bool LoopVectorizationLegality::canVectorizeInstrs() {
           DEBUG(dbgs() << "LV: Found an float MINMAX reduction PHI."<< *Phi <<"\n");
           continue;
         }
+        SelectInst *IdxSel = dyn_cast<SelectInst>(
+            Phi->getIncomingValueForBlock(TheLoop->getLoopLatch()));
+        if (IdxSel && isa<CmpInst>(IdxSel->getCondition()) &&
+            (IdxSel->getTrueValue() == Phi || IdxSel->getFalseValue() == Phi)) {
+          // The select may be used outside of the loop. We fail later if this
+          // turns out not to be a min/max index.
+          AllowedExit.insert(IdxSel);
+          MinMaxIndexPhis.push_back(Phi);
+          continue;
+        }
 
         DEBUG(dbgs() << "LV: Found an unidentified PHI."<< *Phi <<"\n");
         return false;
@@ -2676,6 +2983,33 @@ bool LoopVectorizationLegality::canVectorizeInstrs() {
 
   }
 
+  for (unsigned i = 0, e = MinMaxIndexPhis.size(); i != e; ++i) {
+    if (!AddMinMaxIndexVar(MinMaxIndexPhis[i])) {
+      DEBUG(dbgs() << "LV: Found an unidentified PHI."<< *MinMaxIndexPhis[i]
+            <<"\n");
+      return false;
+    }
+    DEBUG(dbgs() << "LV: Found a MINMAX index PHI."<< *MinMaxIndexPhis[i]
+          <<"\n");
+  }
+
+  // A min/max compare with a second select user is only safe if that select
+  // is the position of a min/max index reduction.
+  for (ReductionList::iterator I = Reductions.begin(), E = Reductions.end();
+       I != E; ++I) {
+    SelectInst *IdxSel = I->second.IndexSelect;
+    if (!IdxSel)
+      continue;
+    bool Tracked = false;
+    for (ReductionList::iterator J = Reductions.begin(); J != E; ++J)
+      Tracked |= J->second.Kind == RK_IntegerMinMaxIdx &&
+                 J->second.LoopExitInstr == IdxSel;
+    if (!Tracked) {
+      DEBUG(dbgs() << "LV: Found a min/max compare with other users.\n");
+      return false;
+    }
+  }
+
   if (!Induction) {
     DEBUG(dbgs() << "LV: Did not find one integer induction var.\n");
     if (Inductions.empty())
@@ -2873,8 +3207,13 @@ bool LoopVectorizationLegality::canVectorizeMemory() {
   AliasMap::iterator MI, ME;
   for (MI = ReadWrites.begin(), ME = ReadWrites.end(); MI != ME; ++MI) {
     Value *V = (*MI).first;
+    // An interleave group is checked as a whole through member zero.
+    const InterleaveGroup *Group = getInterleaveGroup((*MI).second);
+    if (Group && Group->getMember(0) != (*MI).second)
+      continue;
     if (hasComputableBounds(V)) {
-      PtrRtCheck.insert(SE, TheLoop, V, true);
+      PtrRtCheck.insert(SE, TheLoop, V, true,
+                        getInterleaveTailBytes(V, (*MI).second));
       NumWritePtrs++;
       DEBUG(dbgs() << "LV: Found a runtime check ptr:" << *V <<"\n");
     } else {
@@ -2884,8 +3223,15 @@ bool LoopVectorizationLegality::canVectorizeMemory() {
   }
   for (MI = Reads.begin(), ME = Reads.end(); MI != ME; ++MI) {
     Value *V = (*MI).first;
+    // A load group that is covered by a store group reads a subset of the
+    // memory that is checked for the store group.
+    const InterleaveGroup *Group = getInterleaveGroup((*MI).second);
+    if (Group && (Group->getMember(0) != (*MI).second ||
+                  getCoveringStoreGroup((*MI).second)))
+      continue;
     if (hasComputableBounds(V)) {
-      PtrRtCheck.insert(SE, TheLoop, V, false);
+      PtrRtCheck.insert(SE, TheLoop, V, false,
+                        getInterleaveTailBytes(V, (*MI).second));
       NumReadPtrs++;
       DEBUG(dbgs() << "LV: Found a runtime check ptr:" << *V <<"\n");
     } else {
@@ -2945,6 +3291,13 @@ bool LoopVectorizationLegality::canVectorizeMemory() {
         WriteObjects[*UI].push_back(Inst);
         continue;
       }
+      // The members of a store group write to disjoint offsets of the same
+      // object and are emitted as one wide store.
+      if (const InterleaveGroup *Group = getInterleaveGroup(Inst))
+        if (areAllInInterleaveGroup(WriteObjects[*UI], Group)) {
+          WriteObjects[*UI].push_back(Inst);
+          continue;
+        }
       // Direct alias found.
       if (!AA || dyn_cast<GlobalValue>(*UI) == NULL) {
         DEBUG(dbgs() << "LV: Found a possible write-write reorder:"
@@ -2975,6 +3328,7 @@ bool LoopVectorizationLegality::canVectorizeMemory() {
   /// Check that the reads don't conflict with the read-writes.
   for (MI = Reads.begin(), ME = Reads.end(); MI != ME; ++MI) {
     Value *Val = (*MI).first;
+    const InterleaveGroup *Covering = getCoveringStoreGroup((*MI).second);
     GetUnderlyingObjects(Val, TempObjects, DL);
     for (ValueVector::iterator UI=TempObjects.begin(), UE=TempObjects.end();
          UI != UE; ++UI) {
@@ -2988,6 +3342,9 @@ bool LoopVectorizationLegality::canVectorizeMemory() {
       // Never seen it before, can't alias.
       if (WriteObjects[*UI].empty())
         continue;
+      // Only written by the store group that covers this load group.
+      if (Covering && areAllInInterleaveGroup(WriteObjects[*UI], Covering))
+        continue;
       // Direct alias found.
       if (!AA || dyn_cast<GlobalValue>(*UI) == NULL) {
         DEBUG(dbgs() << "LV: Found a possible write-write reorder:"
@@ -3026,6 +3383,216 @@ bool LoopVectorizationLegality::canVectorizeMemory() {
   return true;
 }
 
+/// \brief Returns true if \p A comes before \p B in their basic block.
+static bool comesBefore(Instruction *A, Instruction *B) {
+  assert(A->getParent() == B->getParent() && "Different blocks");
+  for (BasicBlock::iterator It = A, E = A->getParent()->end(); It != E; ++It)
+    if (&*It == B)
+      return true;
+  return false;
+}
+
+namespace {
+/// \brief An interleave group under construction. Offsets are in elements,
+/// relative to the first access that was added to the group.
+struct InterleaveCandidate {
+  BasicBlock *BB;
+  bool IsStore;
+  Type *Ty;
+  unsigned Factor;
+  const SCEV *Start;
+  std::map<int64_t, Instruction*> Members;
+};
+}
+
+void LoopVectorizationLegality::analyzeInterleaving() {
+  InterleaveGroups.clear();
+  InterleaveGroupMap.clear();
+  if (!EnableInterleavedMemAccesses)
+    return;
+
+  SmallVector<InterleaveCandidate, 8> Candidates;
+
+  for (Loop::block_iterator bb = TheLoop->block_begin(),
+       be = TheLoop->block_end(); bb != be; ++bb) {
+    // Predicated accesses can't be combined into one unconditional access.
+    if (blockNeedsPredication(*bb))
+      continue;
+
+    for (BasicBlock::iterator it = (*bb)->begin(), e = (*bb)->end(); it != e;
+         ++it) {
+      LoadInst *Ld = dyn_cast<LoadInst>(it);
+      StoreInst *St = dyn_cast<StoreInst>(it);
+      if ((!Ld || !Ld->isSimple()) && (!St || !St->isSimple()))
+        continue;
+
+      Value *Ptr = Ld ? Ld->getPointerOperand() : St->getPointerOperand();
+      Type *Ty = Ld ? Ld->getType() : St->getValueOperand()->getType();
+      if (!Ty->isIntegerTy() && !Ty->isFloatingPointTy())
+        continue;
+      uint64_t Size = DL->getTypeAllocSize(Ty);
+      if (Size != DL->getTypeStoreSize(Ty))
+        continue;
+
+      // The address must be an affine recurrence of this loop with a
+      // constant stride that is a small multiple of the element size.
+      const SCEVAddRecExpr *AR =
+        dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Ptr));
+      if (!AR || AR->getLoop() != TheLoop || !AR->isAffine())
+        continue;
+      const SCEVConstant *Step =
+        dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+      if (!Step)
+        continue;
+      int64_t StepVal = Step->getValue()->getSExtValue();
+      if (StepVal <= 0 || StepVal % Size)
+        continue;
+      uint64_t Factor = StepVal / Size;
+      if (Factor < 2 || Factor > MaxInterleaveFactor)
+        continue;
+
+      // Add the access to the first compatible group, or start a new one.
+      bool Added = false;
+      for (unsigned i = 0, e = Candidates.size(); i != e && !Added; ++i) {
+        InterleaveCandidate &C = Candidates[i];
+        if (C.BB != *bb || C.IsStore != (St != 0) || C.Ty != Ty ||
+            C.Factor != Factor)
+          continue;
+        const SCEVConstant *Dist =
+          dyn_cast<SCEVConstant>(SE->getMinusSCEV(AR->getStart(), C.Start));
+        if (!Dist)
+          continue;
+        int64_t DistVal = Dist->getValue()->getSExtValue();
+        if (DistVal % (int64_t)Size)
+          continue;
+        int64_t Offset = DistVal / (int64_t)Size;
+        if (C.Members.count(Offset))
+          continue;
+        int64_t Lo = std::min(Offset, C.Members.begin()->first);
+        int64_t Hi = std::max(Offset, C.Members.rbegin()->first);
+        if (Hi - Lo >= (int64_t)Factor)
+          continue;
+        C.Members[Offset] = it;
+        Added = true;
+      }
+      if (Added)
+        continue;
+
+      InterleaveCandidate C;
+      C.BB = *bb;
+      C.IsStore = St != 0;
+      C.Ty = Ty;
+      C.Factor = Factor;
+      C.Start = AR->getStart();
+      C.Members[0] = it;
+      Candidates.push_back(C);
+    }
+  }
+
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    InterleaveCandidate &C = Candidates[i];
+    if (C.Members.size() < 2)
+      continue;
+
+    // Stores must write every element so that the wide store does not
+    // clobber memory the loop doesn't write. Loads must include the last
+    // member so that the wide load of the last iteration does not read past
+    // the memory accessed by the scalar loop.
+    int64_t Lo = C.Members.begin()->first;
+    int64_t Hi = C.Members.rbegin()->first;
+    if (Hi - Lo != (int64_t)C.Factor - 1 ||
+        (C.IsStore && C.Members.size() != C.Factor))
+      continue;
+
+    InterleaveGroup Group(C.Factor, C.IsStore);
+    for (std::map<int64_t, Instruction*>::iterator MI = C.Members.begin(),
+         ME = C.Members.end(); MI != ME; ++MI)
+      Group.Members[MI->first - Lo] = MI->second;
+
+    // Find the first and last members in program order.
+    for (BasicBlock::iterator it = C.BB->begin(), e = C.BB->end(); it != e;
+         ++it) {
+      if (std::find(Group.Members.begin(), Group.Members.end(), &*it) ==
+          Group.Members.end())
+        continue;
+      if (!Group.FirstInst)
+        Group.FirstInst = it;
+      Group.LastInst = it;
+    }
+
+    // Loads are hoisted to the first member and stores are sunk to the last
+    // one, so there must be no conflicting memory accesses in between.
+    bool Conflict = false;
+    for (BasicBlock::iterator it = Group.FirstInst, e = Group.LastInst;
+         it != e && !Conflict; ++it) {
+      if (std::find(Group.Members.begin(), Group.Members.end(), &*it) !=
+          Group.Members.end())
+        continue;
+      Conflict = C.IsStore ? it->mayReadOrWriteMemory() :
+                             it->mayWriteToMemory();
+    }
+    if (Conflict)
+      continue;
+
+    Instruction *Leader = Group.Members[0];
+    Value *LeaderPtr = C.IsStore ?
+      cast<StoreInst>(Leader)->getPointerOperand() :
+      cast<LoadInst>(Leader)->getPointerOperand();
+    Group.Start = cast<SCEVAddRecExpr>(SE->getSCEV(LeaderPtr))->getStart();
+    Group.Align = C.IsStore ? cast<StoreInst>(Leader)->getAlignment() :
+                              cast<LoadInst>(Leader)->getAlignment();
+    if (!Group.Align)
+      Group.Align = DL->getABITypeAlignment(C.Ty);
+
+    DEBUG(dbgs() << "LV: Found an interleaved " <<
+          (C.IsStore ? "store" : "load") << " group of factor " <<
+          C.Factor << " with " << C.Members.size() << " members.\n");
+    for (unsigned m = 0; m < C.Factor; ++m)
+      if (Group.Members[m])
+        InterleaveGroupMap[Group.Members[m]] = InterleaveGroups.size();
+    InterleaveGroups.push_back(Group);
+  }
+}
+
+const LoopVectorizationLegality::InterleaveGroup *
+LoopVectorizationLegality::getCoveringStoreGroup(Instruction *Ld) const {
+  const InterleaveGroup *LoadGroup = getInterleaveGroup(Ld);
+  if (!LoadGroup || LoadGroup->IsStore)
+    return 0;
+
+  Type *Ty = LoadGroup->getMember(0)->getType();
+  for (unsigned i = 0, e = InterleaveGroups.size(); i != e; ++i) {
+    const InterleaveGroup &G = InterleaveGroups[i];
+    if (!G.IsStore || G.Factor != LoadGroup->Factor ||
+        G.Start != LoadGroup->Start ||
+        cast<StoreInst>(G.getMember(0))->getValueOperand()->getType() != Ty ||
+        G.FirstInst->getParent() != LoadGroup->LastInst->getParent())
+      continue;
+    if (comesBefore(LoadGroup->LastInst, G.FirstInst))
+      return &G;
+  }
+  return 0;
+}
+
+bool LoopVectorizationLegality::areAllInInterleaveGroup(
+    const std::vector<Instruction*> &Insts, const InterleaveGroup *Group) const {
+  for (unsigned i = 0, e = Insts.size(); i != e; ++i)
+    if (getInterleaveGroup(Insts[i]) != Group)
+      return false;
+  return true;
+}
+
+uint64_t
+LoopVectorizationLegality::getInterleaveTailBytes(Value *Ptr,
+                                                  Instruction *Inst) const {
+  const InterleaveGroup *Group = getInterleaveGroup(Inst);
+  if (!Group)
+    return 0;
+  Type *Ty = cast<PointerType>(Ptr->getType())->getElementType();
+  return (Group->Factor - 1 - Group->getIndex(Inst)) *
+         DL->getTypeAllocSize(Ty);
+}
+
 static bool hasMultipleUsesOf(Instruction *I,
                               SmallPtrSet<Instruction *, 8> &Insts) {
   unsigned NumUses = 0;
@@ -3078,6 +3645,11 @@ bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
   //  to make sure we only see exactly the two instructions.
   unsigned NumCmpSelectPatternInst = 0;
   ReductionInstDesc ReduxDesc(false, 0);
+  // A min/max compare may feed one more select, which records the position
+  // of the min/max (see AddMinMaxIndexVar).
+  SelectInst *IndexSelect = 0;
+  // Selects that conditionally update a non min/max reduction.
+  SmallVector<SelectInst *, 4> CondSelects;
 
   SmallPtrSet<Instruction *, 8> VisitedInsts;
   SmallVector<Instruction *, 8> Worklist;
@@ -3127,9 +3699,13 @@ bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
       return false;
 
     // A reduction operation must only have one use of the reduction value.
-    if (!IsAPhi && Kind != RK_IntegerMinMax && Kind != RK_FloatMinMax &&
+    // A select may choose between two values of the reduction.
+    bool IsMinMax = Kind == RK_IntegerMinMax || Kind == RK_FloatMinMax;
+    if (!IsAPhi && !IsMinMax && !isa<SelectInst>(Cur) &&
         hasMultipleUsesOf(Cur, VisitedInsts))
       return false;
+    if (!IsMinMax && isa<SelectInst>(Cur))
+      CondSelects.push_back(cast<SelectInst>(Cur));
 
     // All inputs to a PHI node must be a reduction value.
     if(IsAPhi && Cur != Phi && !areAllUsesIn(Cur, VisitedInsts))
@@ -3164,6 +3740,16 @@ bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
         continue;
       }
 
+      // Skip the select that tracks the position of the min/max. We check
+      // that it is part of an index reduction once all PHIs are classified.
+      if (IsMinMax && isa<CmpInst>(Cur) && Usr != ReduxDesc.PatternLastInst &&
+          isa<SelectInst>(Usr) && cast<SelectInst>(Usr)->getCondition() == Cur) {
+        if (IndexSelect)
+          return false;
+        IndexSelect = cast<SelectInst>(Usr);
+        continue;
+      }
+
       // Process instructions only once (termination).
       if (VisitedInsts.insert(Usr)) {
         if (isa<PHINode>(Usr))
@@ -3185,9 +3771,28 @@ bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
       NumCmpSelectPatternInst != 2)
     return false;
 
+  // A min/max may only be computed to find its position, in which case its
+  // value does not leave the loop.
+  if (!ExitInstruction && IndexSelect)
+    ExitInstruction = dyn_cast<Instruction>(
+        Phi->getIncomingValueForBlock(TheLoop->getLoopLatch()));
+
   if (!FoundStartPHI || !FoundReduxOp || !ExitInstruction)
     return false;
 
+  // A conditional update must choose between two values of the reduction,
+  // under a condition that does not depend on the reduction. Otherwise the
+  // select could reset the reduction, which is not a per-lane operation.
+  for (unsigned i = 0, e = CondSelects.size(); i != e; ++i) {
+    SelectInst *Sel = CondSelects[i];
+    Instruction *TrueVal = dyn_cast<Instruction>(Sel->getTrueValue());
+    Instruction *FalseVal = dyn_cast<Instruction>(Sel->getFalseValue());
+    Instruction *Cond = dyn_cast<Instruction>(Sel->getCondition());
+    if (!TrueVal || !FalseVal || !VisitedInsts.count(TrueVal) ||
+        !VisitedInsts.count(FalseVal) || (Cond && VisitedInsts.count(Cond)))
+      return false;
+  }
+
   // We found a reduction var if we have reached the original phi node and we
   // only have a single instruction with out-of-loop users.
 
@@ -3197,6 +3802,7 @@ bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
   // Save the description of this reduction variable.
   ReductionDescriptor RD(RdxStart, ExitInstruction, Kind,
                          ReduxDesc.MinMaxKind);
+  RD.IndexSelect = IndexSelect;
   Reductions[Phi] = RD;
   // We've ended the cycle. This is a reduction variable if we have an
   // outside user and it has a binary op.
@@ -3204,6 +3810,115 @@ bool LoopVectorizationLegality::AddReductionVar(PHINode *Phi,
   return true;
 }
 
+/// Returns the select that picks one of the operands of the compare \p Cmp.
+/// The compare may have one more select user, which can track the position
+/// of the min/max.
+static SelectInst *getMinMaxSelectUser(Instruction *Cmp) {
+  if (Cmp->getNumUses() > 2)
+    return 0;
+  Value *Left = Cmp->getOperand(0);
+  Value *Right = Cmp->getOperand(1);
+  SelectInst *MinMax = 0;
+  for (Value::use_iterator UI = Cmp->use_begin(), E = Cmp->use_end(); UI != E;
+       ++UI) {
+    SelectInst *Sel = dyn_cast<SelectInst>(*UI);
+    if (!Sel || Sel->getCondition() != Cmp)
+      return 0;
+    if ((Sel->getTrueValue() == Left && Sel->getFalseValue() == Right) ||
+        (Sel->getTrueValue() == Right && Sel->getFalseValue() == Left)) {
+      if (MinMax)
+        return 0;
+      MinMax = Sel;
+    }
+  }
+  return MinMax;
+}
+
+/// Returns true if \p Pred only holds for operands that are not equal.
+static bool isStrictPredicate(CmpInst::Predicate Pred) {
+  switch (Pred) {
+  case CmpInst::ICMP_SLT: case CmpInst::ICMP_SGT:
+  case CmpInst::ICMP_ULT: case CmpInst::ICMP_UGT:
+  case CmpInst::FCMP_OLT: case CmpInst::FCMP_OGT:
+  case CmpInst::FCMP_ULT: case CmpInst::FCMP_UGT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool LoopVectorizationLegality::AddMinMaxIndexVar(PHINode *Phi) {
+  // We are looking for the index of the first min/max element:
+  //
+  //   %min = phi [ %start, %ph ], [ %min.next, %latch ]
+  //   %idx = phi [ %istart, %ph ], [ %idx.next, %latch ]
+  //   %cmp = icmp slt %x, %min
+  //   %min.next = select %cmp, %x, %min
+  //   %idx.next = select %cmp, %iv, %idx
+  //
+  // Every lane of the vector loop finds the position of its own min/max. The
+  // position of the overall min/max is the smallest position of the lanes that
+  // hold it, which is only the first occurrence if the compare is strict.
+  BasicBlock *Latch = TheLoop->getLoopLatch();
+  SelectInst *IdxSel = cast<SelectInst>(Phi->getIncomingValueForBlock(Latch));
+  if (!Phi->getType()->isIntegerTy() || !Phi->hasOneUse())
+    return false;
+
+  // The index only flows from the PHI to the select and out of the loop.
+  for (Value::use_iterator UI = IdxSel->use_begin(), E = IdxSel->use_end();
+       UI != E; ++UI) {
+    Instruction *U = cast<Instruction>(*UI);
+    if (TheLoop->contains(U) && U != Phi)
+      return false;
+  }
+
+  // Find the min/max reduction whose compare feeds this select.
+  PHINode *MinMaxPhi = 0;
+  for (ReductionList::iterator I = Reductions.begin(), E = Reductions.end();
+       I != E; ++I)
+    if (I->second.IndexSelect == IdxSel)
+      MinMaxPhi = I->first;
+  if (!MinMaxPhi)
+    return false;
+
+  CmpInst *Cmp = cast<CmpInst>(IdxSel->getCondition());
+  SelectInst *MinMaxSel = getMinMaxSelectUser(Cmp);
+  if (!MinMaxSel)
+    return false;
+
+  // The min/max select must take the new value from the current iteration
+  // exactly when the index select takes the induction variable.
+  bool NewIsTrue;
+  if (MinMaxSel->getFalseValue() == MinMaxPhi)
+    NewIsTrue = true;
+  else if (MinMaxSel->getTrueValue() == MinMaxPhi)
+    NewIsTrue = false;
+  else
+    return false;
+
+  Value *IndVal = NewIsTrue ? IdxSel->getTrueValue() : IdxSel->getFalseValue();
+  if ((NewIsTrue ? IdxSel->getFalseValue() : IdxSel->getTrueValue()) != Phi)
+    return false;
+
+  // Only update on a strictly better value to keep the first occurrence.
+  if (isStrictPredicate(Cmp->getPredicate()) != NewIsTrue)
+    return false;
+
+  // The position is a consecutive integer induction, possibly truncated.
+  if (TruncInst *Trunc = dyn_cast<TruncInst>(IndVal))
+    IndVal = Trunc->getOperand(0);
+  PHINode *IndPhi = dyn_cast<PHINode>(IndVal);
+  if (!IndPhi || !Inductions.count(IndPhi) ||
+      Inductions[IndPhi].IK != IK_IntInduction)
+    return false;
+
+  Value *Start = Phi->getIncomingValueForBlock(TheLoop->getLoopPreheader());
+  ReductionDescriptor RD(Start, IdxSel, RK_IntegerMinMaxIdx, MRK_SIntMin);
+  RD.MinMaxPhi = MinMaxPhi;
+  Reductions[Phi] = RD;
+  return true;
+}
+
 /// Returns true if the instruction is a Select(ICmp(X, Y), X, Y) instruction
 /// pattern corresponding to a min(X, Y) or max(X, Y).
 LoopVectorizationLegality::ReductionInstDesc
@@ -3218,7 +3933,7 @@ LoopVectorizationLegality::isMinMaxSelectCmpPattern(Instruction *I,
   // We must handle the select(cmp()) as a single instruction. Advance to the
   // select.
   if ((Cmp = dyn_cast<ICmpInst>(I)) || (Cmp = dyn_cast<FCmpInst>(I))) {
-    if (!Cmp->hasOneUse() || !(Select = dyn_cast<SelectInst>(*I->use_begin())))
+    if (!(Select = getMinMaxSelectUser(Cmp)))
       return ReductionInstDesc(false, I);
     return ReductionInstDesc(Select, Prev.MinMaxKind);
   }
@@ -3229,7 +3944,7 @@ LoopVectorizationLegality::isMinMaxSelectCmpPattern(Instruction *I,
   if (!(Cmp = dyn_cast<ICmpInst>(I->getOperand(0))) &&
       !(Cmp = dyn_cast<FCmpInst>(I->getOperand(0))))
     return ReductionInstDesc(false, I);
-  if (!Cmp->hasOneUse())
+  if (getMinMaxSelectUser(Cmp) != Select)
     return ReductionInstDesc(false, I);
 
   Value *CmpLeft;
@@ -3285,9 +4000,14 @@ LoopVectorizationLegality::isReductionInstr(Instruction *I,
     return ReductionInstDesc(Kind == RK_FloatMult && FastMath, I);
   case Instruction::FAdd:
     return ReductionInstDesc(Kind == RK_FloatAdd && FastMath, I);
+  case Instruction::Select:
+    // A select between two values of the reduction is a conditional update.
+    // AddReductionVar checks the operands once the whole chain is known.
+    if (Kind != RK_IntegerMinMax && Kind != RK_FloatMinMax)
+      return ReductionInstDesc(true, I);
+    // Fall through.
   case Instruction::FCmp:
   case Instruction::ICmp:
-  case Instruction::Select:
     if (Kind != RK_IntegerMinMax &&
         (!HasFunNoNaNAttr || Kind != RK_FloatMinMax))
       return ReductionInstDesc(false, I);
@@ -3828,6 +4548,22 @@ LoopVectorizationCostModel::getInstructionCost(Instruction *I, unsigned VF) {
       return TTI.getAddressComputationCost(VectorTy) +
         TTI.getMemoryOpCost(I->getOpcode(), VectorTy, Alignment, AS);
 
+    // Interleaved loads/stores. The whole group is accounted for at its
+    // insert position.
+    if (const LoopVectorizationLegality::InterleaveGroup *Group =
+          Legal->getInterleaveGroup(I)) {
+      if (I != Group->getInsertPos())
+        return 0;
+      Type *WideTy = VectorType::get(ValTy, VF * Group->Factor);
+      SmallVector<unsigned, 4> Indices;
+      for (unsigned i = 0; i < Group->Factor; ++i)
+        if (Group->getMember(i))
+          Indices.push_back(i);
+      return TTI.getAddressComputationCost(WideTy) +
+        TTI.getInterleavedMemoryOpCost(I->getOpcode(), WideTy, Group->Factor,
+                                       Indices, Group->Align, AS);
+    }
+
     // Scalarized loads/stores.
     int ConsecutiveStride = Legal->isConsecutivePtr(Ptr);
     bool Reverse = ConsecutiveStride < 0;
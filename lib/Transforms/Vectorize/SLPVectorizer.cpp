@@ -34,6 +34,7 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ValueHandle.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 
@@ -87,6 +88,9 @@ struct SLPVectorizer : public FunctionPass {
       // he store instructions.
       BoUpSLP R(BB, SE, DL, TTI, AA, LI->getLoopFor(BB));
 
+      // Vectorize trees that end at horizontal reductions.
+      BBChanged |= vectorizeHorReductions(BB, R);
+
       // Vectorize trees that end at reductions.
       BBChanged |= vectorizeReductions(BB, R);
 
@@ -146,6 +150,11 @@ private:
   /// vectorization chain.
   bool vectorizeReductions(BasicBlock *BB, BoUpSLP &R);
 
+  /// \brief Scan the basic block for trees of associative operations, such
+  /// as the sum of products of an unrolled dot product, and try to vectorize
+  /// them as horizontal reductions.
+  bool vectorizeHorReductions(BasicBlock *BB, BoUpSLP &R);
+
 private:
   StoreListMap StoreRefs;
 };
@@ -278,6 +287,33 @@ bool SLPVectorizer::vectorizeReductions(BasicBlock *BB, BoUpSLP &R) {
   return Changed;
 }
 
+bool SLPVectorizer::vectorizeHorReductions(BasicBlock *BB, BoUpSLP &R) {
+  // Collect the roots of the reduction trees first. Vectorizing a reduction
+  // deletes its scalar instructions.
+  SmallVector<WeakVH, 8> Roots;
+  for (BasicBlock::iterator it = BB->begin(), e = BB->end(); it != e; ++it) {
+    BinaryOperator *BI = dyn_cast<BinaryOperator>(it);
+    if (!BI)
+      continue;
+    // Inner nodes of the tree are visited from the root.
+    if (BI->hasOneUse()) {
+      BinaryOperator *User = dyn_cast<BinaryOperator>(*BI->use_begin());
+      if (User && User->getOpcode() == BI->getOpcode() &&
+          User->getParent() == BB)
+        continue;
+    }
+    Roots.push_back(BI);
+  }
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Roots.size(); i != e; ++i) {
+    Value *V = Roots[i];
+    if (BinaryOperator *BI = dyn_cast_or_null<BinaryOperator>(V))
+      Changed |= R.vectorizeHorReduction(BI, -SLPCostThreshold);
+  }
+  return Changed;
+}
+
 bool SLPVectorizer::vectorizeStoreChains(BoUpSLP &R) {
   bool Changed = false;
   // Attempt to sort and vectorize each of the store-groups.
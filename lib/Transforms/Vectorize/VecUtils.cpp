@@ -42,6 +42,8 @@ static const unsigned MinVecRegSize = 128;
 
 static const unsigned RecursionMaxDepth = 6;
 
+static const unsigned HorReductionMaxDepth = 32;
+
 namespace llvm {
 
 BoUpSLP::BoUpSLP(BasicBlock *Bb, ScalarEvolution *S, DataLayout *Dl,
@@ -236,6 +238,166 @@ void BoUpSLP::vectorizeArith(ArrayRef<Value *> Operands) {
   }
 }
 
+/// \returns true if \p Opcode can be reassociated to form a horizontal
+/// reduction.
+static bool isHorReductionOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  case Instruction::Add:
+  case Instruction::Mul:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+  case Instruction::FAdd:
+  case Instruction::FMul:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// \returns true if \p V is an inner node of a horizontal reduction of
+/// \p Opcode in \p BB.
+static bool isHorReductionOp(Value *V, unsigned Opcode, BasicBlock *BB) {
+  BinaryOperator *BI = dyn_cast<BinaryOperator>(V);
+  if (!BI || BI->getOpcode() != Opcode || BI->getParent() != BB ||
+      !BI->hasOneUse())
+    return false;
+  // Floating point operations can only be reassociated with unsafe algebra.
+  return !BI->getType()->isFloatingPointTy() || BI->hasUnsafeAlgebra();
+}
+
+/// \brief Collect the leaves of the reduction tree at \p I in operand order.
+static void collectHorReductionLeaves(Instruction *I, unsigned Opcode,
+                                      BasicBlock *BB,
+                                      BoUpSLP::ValueList &Leaves,
+                                      unsigned Depth) {
+  for (unsigned i = 0; i < 2; ++i) {
+    Value *Op = I->getOperand(i);
+    if (Depth < HorReductionMaxDepth && isHorReductionOp(Op, Opcode, BB))
+      collectHorReductionLeaves(cast<Instruction>(Op), Opcode, BB, Leaves,
+                                Depth + 1);
+    else
+      Leaves.push_back(Op);
+  }
+}
+
+namespace {
+/// Orders the leaves of a reduction by opcode, so that groups of leaves are
+/// likely to be isomorphic, and then by their position in the block, which
+/// usually matches the order of the memory accesses in unrolled code.
+struct LeafOrder {
+  const SmallDenseMap<Value*, int> &InstrIdx;
+  LeafOrder(const SmallDenseMap<Value*, int> &Idx) : InstrIdx(Idx) {}
+  static unsigned opcode(Value *V) {
+    Instruction *I = dyn_cast<Instruction>(V);
+    return I ? I->getOpcode() : ~0U;
+  }
+  bool operator()(Value *A, Value *B) const {
+    if (opcode(A) != opcode(B))
+      return opcode(A) < opcode(B);
+    return InstrIdx.lookup(A) < InstrIdx.lookup(B);
+  }
+};
+}
+
+int BoUpSLP::getHorReductionCost(unsigned Opcode, VectorType *VecTy) {
+  int Cost = 0;
+  for (unsigned i = VecTy->getNumElements(); i != 1; i >>= 1) {
+    Cost += TTI->getShuffleCost(TargetTransformInfo::SK_ExtractSubvector,
+                                VecTy, i / 2);
+    Cost += TTI->getArithmeticInstrCost(Opcode, VecTy);
+  }
+  return Cost + TTI->getVectorInstrCost(Instruction::ExtractElement, VecTy, 0);
+}
+
+bool BoUpSLP::vectorizeHorReduction(BinaryOperator *Root, int CostThreshold) {
+  unsigned Opcode = Root->getOpcode();
+  Type *Ty = Root->getType();
+  if (!isHorReductionOpcode(Opcode) || Root->getParent() != BB ||
+      !VectorType::isValidElementType(Ty))
+    return false;
+  if (Ty->isFloatingPointTy() && !Root->hasUnsafeAlgebra())
+    return false;
+
+  unsigned Sz = DL->getTypeSizeInBits(Ty);
+  unsigned VF = MinVecRegSize / Sz;
+  if (!isPowerOf2_32(Sz) || VF < 2)
+    return false;
+
+  ValueList Leaves;
+  collectHorReductionLeaves(Root, Opcode, BB, Leaves, 0);
+  if (Leaves.size() < VF)
+    return false;
+  std::stable_sort(Leaves.begin(), Leaves.end(), LeafOrder(InstrIdx));
+
+  // Vectorize full groups of VF leaves. The rest stays scalar.
+  unsigned NumVec = Leaves.size() / VF * VF;
+  ArrayRef<Value *> LeafRef(Leaves);
+  VectorType *VecTy = VectorType::get(Ty, VF);
+  int Cost = 0;
+  for (unsigned i = 0; i < NumVec; i += VF)
+    Cost += getTreeCost(LeafRef.slice(i, VF));
+  // We combine the groups, reduce the vector and extract the result instead
+  // of performing NumVec - 1 scalar operations.
+  Cost += (NumVec / VF - 1) * TTI->getArithmeticInstrCost(Opcode, VecTy);
+  Cost += getHorReductionCost(Opcode, VecTy);
+  Cost -= (NumVec - 1) * TTI->getArithmeticInstrCost(Opcode, Ty);
+  DEBUG(dbgs() << "SLP: Found cost=" << Cost << " for a horizontal reduction"
+        " of " << Leaves.size() << " values.\n");
+  if (Cost >= CostThreshold)
+    return false;
+
+  ValueList Vectors;
+  for (unsigned i = 0; i < NumVec; i += VF) {
+    // Vectorizing the tree uses the state that getTreeCost collects.
+    getTreeCost(LeafRef.slice(i, VF));
+    Vectors.push_back(vectorizeTree(LeafRef.slice(i, VF), VF));
+  }
+
+  IRBuilder<> Builder(Root);
+  Instruction::BinaryOps BinOp = (Instruction::BinaryOps)Opcode;
+  ValueList NewOps;
+  Value *VecRdx = Vectors[0];
+  for (unsigned i = 1, e = Vectors.size(); i != e; ++i) {
+    VecRdx = Builder.CreateBinOp(BinOp, VecRdx, Vectors[i], "bin.rdx");
+    NewOps.push_back(VecRdx);
+  }
+
+  SmallVector<Constant*, 16> ShuffleMask(VF, 0);
+  for (unsigned i = VF; i != 1; i >>= 1) {
+    // Move the upper half of the vector to the lower half.
+    for (unsigned j = 0; j != i/2; ++j)
+      ShuffleMask[j] = Builder.getInt32(i/2 + j);
+    std::fill(&ShuffleMask[i/2], ShuffleMask.end(),
+              UndefValue::get(Builder.getInt32Ty()));
+    Value *Shuf = Builder.CreateShuffleVector(VecRdx, UndefValue::get(VecTy),
+                                              ConstantVector::get(ShuffleMask),
+                                              "rdx.shuf");
+    VecRdx = Builder.CreateBinOp(BinOp, VecRdx, Shuf, "bin.rdx");
+    NewOps.push_back(VecRdx);
+  }
+
+  Value *Rdx = Builder.CreateExtractElement(VecRdx, Builder.getInt32(0));
+  for (unsigned i = NumVec, e = Leaves.size(); i != e; ++i) {
+    Rdx = Builder.CreateBinOp(BinOp, Rdx, Leaves[i], "bin.rdx");
+    NewOps.push_back(Rdx);
+  }
+
+  // The new operations reassociate the reduction just like the ones they
+  // replace.
+  if (Ty->isFloatingPointTy())
+    for (unsigned i = 0, e = NewOps.size(); i != e; ++i)
+      if (Instruction *I = dyn_cast<Instruction>(NewOps[i]))
+        I->copyFastMathFlags(Root);
+
+  Root->replaceAllUsesWith(Rdx);
+  RecursivelyDeleteTriviallyDeadInstructions(Root);
+
+  // We added and removed instructions. Number them again.
+  numberInstructions();
+  return true;
+}
+
 int BoUpSLP::getTreeCost(ArrayRef<Value *> VL) {
   // Get rid of the list of stores that were removed, and from the
   // lists of instructions with multiple users.
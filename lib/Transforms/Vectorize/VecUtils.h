@@ -23,7 +23,7 @@
 
 namespace llvm {
 
-class BasicBlock; class Instruction; class Type;
+class BasicBlock; class BinaryOperator; class Instruction; class Type;
 class VectorType; class StoreInst; class Value;
 class ScalarEvolution; class DataLayout;
 class TargetTransformInfo; class AliasAnalysis;
@@ -72,6 +72,13 @@ struct BoUpSLP  {
   /// \brief Vectorize a group of scalars into a vector tree.
   void vectorizeArith(ArrayRef<Value *> Operands);
 
+  /// \brief Attempts to vectorize the tree of associative operations that
+  /// ends at \p Root (such as the sum of products of an unrolled dot product).
+  /// The leaves of the tree are vectorized in groups that fill a vector
+  /// register, and the groups are reduced using log2 shuffles.
+  /// \returns true if the basic block was modified.
+  bool vectorizeHorReduction(BinaryOperator *Root, int CostThreshold);
+
   /// \returns the list of new instructions that were added in order to collect
   /// scalars into vectors. This list can be used to further optimize the gather
   /// sequences.
@@ -99,6 +106,10 @@ private:
   /// context means the creation of vectors from a group of scalars.
   int getScalarizationCost(Type *Ty);
 
+  /// \returns the cost of reducing a vector of type \p VecTy to a scalar with
+  /// the operation \p Opcode, using log2 shuffles and an extract.
+  int getHorReductionCost(unsigned Opcode, VectorType *VecTy);
+
   /// \returns the AA location that is being access by the instruction.
   AliasAnalysis::Location getLocation(Instruction *I);
 
@@ -20,9 +20,11 @@
 #include <stdio.h>
 #include <string.h>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <sys/mman.h>
 #include <unistd.h>
 #else
 #include <io.h>
+#include <windows.h>
 #endif
 #include <stdlib.h>
 
@@ -118,10 +120,11 @@ int getOutFile() {
   static int OutFile = -1;
 
   /* If this is the first time this function is called, open the output file
-   * for appending, creating it if it does not already exist.
+   * for appending, creating it if it does not already exist.  It is opened
+   * for reading as well so that records can be written through a mapping.
    */
   if (OutFile == -1) {
-    OutFile = open(OutputFilename, O_CREAT | O_WRONLY, 0666);
+    OutFile = open(OutputFilename, O_CREAT | O_RDWR, 0666);
     lseek(OutFile, 0, SEEK_END); /* O_APPEND prevents seeking */
     if (OutFile == -1) {
       fprintf(stderr, "LLVM profiling runtime: while opening '%s': ",
@@ -171,3 +174,78 @@ void write_profiling_data(enum ProfilingType PT, unsigned *Start,
     exit(0);
   }
 }
+
+/* llvm_next_counter_shard - Return a different number on each call.  Code
+ * instrumented with sharded counters calls this once per thread to pick the
+ * copy of the counters that the thread increments.
+ */
+unsigned llvm_next_counter_shard(void) {
+  static volatile long NextShard = 0;
+#if defined(_MSC_VER)
+  return (unsigned)InterlockedIncrement(&NextShard) - 1;
+#else
+  return (unsigned)__sync_fetch_and_add(&NextShard, 1);
+#endif
+}
+
+/* sum_counter_shards - Store the sums of NumShards copies of NumElements
+ * counters, ShardStride counters apart, into Sums.
+ */
+static void sum_counter_shards(unsigned *Sums, const unsigned *Start,
+                               unsigned NumElements, unsigned NumShards,
+                               unsigned ShardStride) {
+  unsigned i, Shard;
+  memcpy(Sums, Start, NumElements*sizeof(unsigned));
+  for (Shard = 1; Shard < NumShards; ++Shard) {
+    const unsigned *Counters = Start + Shard*ShardStride;
+    for (i = 0; i != NumElements; ++i)
+      Sums[i] += Counters[i];
+  }
+}
+
+/* write_sharded_profiling_data - Write a record of NumElements counters, each
+ * the sum of NumShards copies ShardStride counters apart.  Where possible the
+ * file is extended and mapped, and the sums are computed directly into the
+ * mapping rather than into a temporary buffer that is then written out.
+ */
+void write_sharded_profiling_data(enum ProfilingType PT, unsigned *Start,
+                                  unsigned NumElements, unsigned NumShards,
+                                  unsigned ShardStride) {
+  unsigned *Sums;
+  int outFile = getOutFile();
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+  off_t Offset = lseek(outFile, 0, SEEK_CUR);
+  size_t RecordSize = 2*sizeof(unsigned) + NumElements*sizeof(unsigned);
+  if (Offset != (off_t)-1 && ftruncate(outFile, Offset + RecordSize) == 0) {
+    /* The mapping has to start on a page boundary. */
+    off_t MapOffset = Offset & ~(off_t)(sysconf(_SC_PAGESIZE) - 1);
+    size_t MapSize = (size_t)(Offset - MapOffset) + RecordSize;
+    char *Map = (char*)mmap(0, MapSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                            outFile, MapOffset);
+    if (Map != (char*)MAP_FAILED) {
+      unsigned *Record = (unsigned*)(Map + (Offset - MapOffset));
+      Record[0] = PT;
+      Record[1] = NumElements;
+      sum_counter_shards(Record + 2, Start, NumElements, NumShards,
+                         ShardStride);
+      munmap(Map, MapSize);
+      lseek(outFile, Offset + RecordSize, SEEK_SET);
+      return;
+    }
+    /* Undo the extension and fall back to writing the record. */
+    if (ftruncate(outFile, Offset) != 0) {
+      fprintf(stderr,"error: unable to write to output file.");
+      exit(0);
+    }
+  }
+#endif
+
+  Sums = (unsigned*)malloc(NumElements*sizeof(unsigned));
+  if (!Sums) {
+    fprintf(stderr,"error: out of memory writing profile data.");
+    exit(0);
+  }
+  sum_counter_shards(Sums, Start, NumElements, NumShards, ShardStride);
+  write_profiling_data(PT, Sums, NumElements);
+  free(Sums);
+}
@@ -18,6 +18,8 @@
 
 static unsigned *ArrayStart;
 static unsigned NumElements;
+static unsigned NumShards;
+static unsigned ShardStride;
 
 /* EdgeProfAtExitHandler - When the program exits, just write out the profiling
  * data.
@@ -43,3 +45,28 @@ int llvm_start_edge_profiling(int argc, const char **argv,
   atexit(EdgeProfAtExitHandler);
   return Ret;
 }
+
+/* ShardedEdgeProfAtExitHandler - When the program exits, sum the copies of
+ * the counters and write out the sums.
+ */
+static void ShardedEdgeProfAtExitHandler(void) {
+  write_sharded_profiling_data(EdgeInfo, ArrayStart, NumElements, NumShards,
+                               ShardStride);
+}
+
+/* llvm_start_sharded_edge_profiling - The entry point for programs
+ * instrumented with -edge-profiling-shards.  The counters are numShards
+ * copies of numElements counters, each shardStride counters long.
+ */
+int llvm_start_sharded_edge_profiling(int argc, const char **argv,
+                                      unsigned *arrayStart, unsigned numShards,
+                                      unsigned numElements,
+                                      unsigned shardStride) {
+  int Ret = save_arguments(argc, argv);
+  ArrayStart = arrayStart;
+  NumElements = numElements;
+  NumShards = numShards;
+  ShardStride = shardStride;
+  atexit(ShardedEdgeProfAtExitHandler);
+  return Ret;
+}
@@ -33,4 +33,11 @@ int getOutFile();
 void write_profiling_data(enum ProfilingType PT, unsigned *Start,
                           unsigned NumElements);
 
+/* write_sharded_profiling_data - Write out a typed packet of profiling data
+ * that is the sum of several copies of the counters.
+ */
+void write_sharded_profiling_data(enum ProfilingType PT, unsigned *Start,
+                                  unsigned NumElements, unsigned NumShards,
+                                  unsigned ShardStride);
+
 #endif
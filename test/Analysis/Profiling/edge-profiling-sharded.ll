@@ -0,0 +1,50 @@
+; Test the edge profiling instrumentation with per-thread counter shards.
+; RUN: opt < %s -insert-edge-profiling -edge-profiling-shards=4 -S | FileCheck %s
+
+; Four shards of four counters, each padded to a 64 byte cache line.
+; CHECK: @EdgeProfCounters = internal global [4 x [16 x i32]] zeroinitializer, align 64
+; CHECK: @EdgeProfCountersShard = internal thread_local global [16 x i32]* null
+
+define i32 @f(i32 %x) {
+; CHECK: define i32 @f
+; CHECK: entry:
+; CHECK-NEXT: %a = alloca i32
+; CHECK-NEXT: [[SLOT:%[a-zA-Z0-9]+]] = load [16 x i32]** @EdgeProfCountersShard
+; CHECK-NEXT: [[NOSHARD:%[0-9]+]] = icmp eq [16 x i32]* [[SLOT]], null
+; CHECK-NEXT: br i1 [[NOSHARD]], label %shard.select, label %shard.selected, !prof
+
+; CHECK: shard.select:
+; CHECK-NEXT: [[N:%[0-9]+]] = call i32 @llvm_next_counter_shard()
+; CHECK-NEXT: [[IDX:%[0-9]+]] = urem i32 [[N]], 4
+; CHECK-NEXT: [[SHARD:%[0-9]+]] = getelementptr inbounds [4 x [16 x i32]]* @EdgeProfCounters, i32 0, i32 [[IDX]]
+; CHECK-NEXT: store [16 x i32]* [[SHARD]], [16 x i32]** @EdgeProfCountersShard
+; CHECK-NEXT: br label %shard.selected
+
+; The shard is loaded once, in the entry block, and kept in a phi.
+; CHECK: shard.selected:
+; CHECK-NEXT: [[CUR:%[a-zA-Z0-9]+]] = phi [16 x i32]* [ [[SLOT]], %entry ], [ [[SHARD]], %shard.select ]
+; CHECK-NEXT: getelementptr inbounds [16 x i32]* [[CUR]], i32 0, i32 0
+; CHECK-NOT: load [16 x i32]** @EdgeProfCountersShard
+entry:
+  %a = alloca i32
+  %c = icmp sgt i32 %x, 0
+  br i1 %c, label %t, label %e
+
+; CHECK: t:
+; CHECK-NEXT: getelementptr inbounds [16 x i32]* [[CUR]], i32 0, i32 1
+t:
+  ret i32 1
+
+; CHECK: e:
+; CHECK-NEXT: getelementptr inbounds [16 x i32]* [[CUR]], i32 0, i32 2
+e:
+  ret i32 0
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+; CHECK: define i32 @main
+; CHECK: call i32 @llvm_start_sharded_edge_profiling(i32 %argc, i8** %argv, [16 x i32]* getelementptr inbounds ([4 x [16 x i32]]* @EdgeProfCounters, i32 0, i32 0), i32 4, i32 4, i32 16)
+entry:
+  %r = call i32 @f(i32 %argc)
+  ret i32 %r
+}
@@ -0,0 +1,87 @@
+; RUN: opt -insert-edge-profiling -o %t1 < %s
+; RUN: rm -f %t1.prof_data
+; RUN: lli %defaultjit -load %llvmshlibdir/libprofile_rt%shlibext %t1 \
+; RUN:     -llvmprof-output %t1.prof_data
+; RUN: opt -profile-file %t1.prof_data -profile-metadata-loader -S -o - < %s \
+; RUN:     | FileCheck %s
+; RUN: opt -profile-file %t1.prof_data -profile-metadata-loader \
+; RUN:     -profile-hot-function-ratio=1 -S -o - < %s \
+; RUN:     | FileCheck %s -check-prefix=RATIO
+; RUN: rm -f %t1.prof_data
+
+; FIXME: profile_rt.dll could be built on win32.
+; REQUIRES: loadable_module
+
+;; Functions which are never entered are cold, the ones entered at least once
+;; per 1000 entries of the most frequently entered function are hot.
+
+;; func_hot - Entered 5000 times.
+define i32 @func_hot(i32 %N) nounwind uwtable {
+; CHECK: define i32 @func_hot(i32 %N) #[[HOT:[0-9]+]]
+; RATIO: define i32 @func_hot(i32 %N) #[[HOT:[0-9]+]]
+entry:
+  %add = add nsw i32 %N, 1
+  ret i32 %add
+}
+
+;; func_warm - Entered 5 times.
+define i32 @func_warm(i32 %N) nounwind uwtable {
+; CHECK: define i32 @func_warm(i32 %N) #[[HOT]]
+; RATIO: define i32 @func_warm(i32 %N) #[[NONE:[0-9]+]]
+entry:
+  %mul = mul nsw i32 %N, 3
+  ret i32 %mul
+}
+
+;; func_cold - Never entered.
+define i32 @func_cold(i32 %N) nounwind uwtable {
+; CHECK: define i32 @func_cold(i32 %N) #[[COLD:[0-9]+]]
+; RATIO: define i32 @func_cold(i32 %N) #[[COLD:[0-9]+]]
+entry:
+  %sub = sub nsw i32 %N, 1
+  ret i32 %sub
+}
+
+define i32 @main(i32 %argc, i8** %argv) nounwind uwtable {
+; CHECK: define i32 @main(i32 %argc, i8** %argv) #[[NONE:[0-9]+]]
+; RATIO: define i32 @main(i32 %argc, i8** %argv) #[[NONE]]
+entry:
+  br label %for.cond
+
+for.cond:
+  %i = phi i32 [ 0, %entry ], [ %inc, %for.inc ]
+  %cmp = icmp slt i32 %i, 5000
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %call = call i32 @func_hot(i32 %i)
+  %rem = srem i32 %i, 1000
+  %tobool = icmp eq i32 %rem, 0
+  br i1 %tobool, label %if.then, label %for.inc
+
+if.then:
+  %call1 = call i32 @func_warm(i32 %i)
+  br label %for.inc
+
+for.inc:
+  %inc = add nsw i32 %i, 1
+  br label %for.cond
+
+for.end:
+  %cmp2 = icmp slt i32 %argc, 0
+  br i1 %cmp2, label %if.cold, label %return
+
+if.cold:
+  %call2 = call i32 @func_cold(i32 %argc)
+  br label %return
+
+return:
+  ret i32 0
+}
+
+; CHECK-DAG: attributes #[[HOT]] = { nounwind uwtable "hot" }
+; CHECK-DAG: attributes #[[COLD]] = { nounwind uwtable "cold" }
+; CHECK-DAG: attributes #[[NONE]] = { nounwind uwtable }
+; RATIO-DAG: attributes #[[HOT]] = { nounwind uwtable "hot" }
+; RATIO-DAG: attributes #[[COLD]] = { nounwind uwtable "cold" }
+; RATIO-DAG: attributes #[[NONE]] = { nounwind uwtable }
@@ -0,0 +1,35 @@
+; RUN: llvm-as < %s | llvm-dis | FileCheck %s
+; RUN: llvm-as -parse-only -time-phases < %s 2>&1 | FileCheck -check-prefix=TIME %s
+
+; Forward references to named and numbered globals, and block addresses taken
+; before and after the function is defined.
+
+; TIME: llvm-as phases
+; TIME: Parse
+; TIME-NOT: Verify
+
+; CHECK: @before = global i8* blockaddress(@1, %b)
+@before = global i8* blockaddress(@1, %b)
+; CHECK: @fn = global void ()* @0
+@fn = global void ()* @0
+; CHECK: @named = global i8* blockaddress(@g, %c)
+@named = global i8* blockaddress(@g, %c)
+
+define void @0() {
+  ret void
+}
+
+define i8* @1() {
+  br label %b
+b:
+  ret i8* blockaddress(@g, %c)
+}
+
+define i8* @g() {
+  br label %c
+c:
+  ret i8* blockaddress(@1, %b)
+}
+
+; CHECK: @after = global i8* blockaddress(@g, %c)
+@after = global i8* blockaddress(@g, %c)
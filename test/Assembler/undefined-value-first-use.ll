@@ -0,0 +1,10 @@
+; RUN: not llvm-as < %s -o /dev/null 2>&1 | FileCheck %s
+
+; Of several undefined values, the one used first is reported.
+
+; CHECK: use of undefined value '@zzz'
+define void @f() {
+  call void @zzz()
+  call void @aaa()
+  ret void
+}
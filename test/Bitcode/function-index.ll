@@ -0,0 +1,58 @@
+; RUN: llvm-as -bitcode-function-index < %s > %t
+; RUN: llvm-bcanalyzer -dump %t | FileCheck -check-prefix=BC %s
+; RUN: llvm-dis < %t | FileCheck %s
+; RUN: llvm-as -bitcode-function-index -bitcode-writer-threads=2 < %s > %t2
+; RUN: cmp %t %t2
+; RUN: llvm-extract -func=g %t -S | FileCheck -check-prefix=EXTRACT %s
+
+; The function index follows the function bodies and the module points at it
+; with an offset record placed before them.
+
+; BC: <FNINDEXOFFSET
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_BLOCK
+; BC: <FUNCTION_INDEX_BLOCK
+; BC-NEXT: <ENTRY
+; BC-NEXT: <ENTRY
+; BC-NEXT: <ENTRY
+; BC-NEXT: </FUNCTION_INDEX_BLOCK>
+
+; Only the body of @g is read by llvm-extract.
+
+; EXTRACT: declare i32 @f(i32)
+; EXTRACT: define void @g(i32 %y)
+; EXTRACT-NEXT: entry:
+; EXTRACT-NEXT: %b = call i32 @f(i32 %y)
+; EXTRACT-NOT: define
+
+@count = global i32 0
+
+declare void @ext(i32)
+
+define i32 @f(i32 %x) {
+; CHECK: define i32 @f(i32 %x)
+entry:
+  %a = add i32 %x, 42
+; CHECK: %a = add i32 %x, 42
+  store i32 %a, i32* @count
+  ret i32 %a
+}
+
+define void @g(i32 %y) {
+; CHECK: define void @g(i32 %y)
+entry:
+  %b = call i32 @f(i32 %y)
+; CHECK: %b = call i32 @f(i32 %y)
+  call void @ext(i32 %b)
+  ret void
+}
+
+define i8* @h() {
+; CHECK: define i8* @h()
+entry:
+  br label %next
+next:
+  ret i8* blockaddress(@h, %next)
+; CHECK: ret i8* blockaddress(@h, %next)
+}
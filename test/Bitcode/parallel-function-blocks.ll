@@ -0,0 +1,54 @@
+; RUN: llvm-as < %s > %t0
+; RUN: llvm-as -bitcode-writer-threads=4 < %s > %t1
+; RUN: cmp %t0 %t1
+; RUN: llvm-dis < %t1 | FileCheck %s
+
+; Function blocks encoded on several threads are the same as the ones written
+; one by one, including function-local constants, metadata and block
+; addresses of other functions.
+
+@count = global i32 0
+
+define i32 @f(i32 %x) {
+; CHECK: define i32 @f(i32 %x)
+entry:
+  %a = add i32 %x, 42
+; CHECK: %a = add i32 %x, 42
+  store i32 %a, i32* @count, !tbaa !0
+  ret i32 %a
+}
+
+define void @g(i8** %p) {
+; CHECK: define void @g(i8** %p)
+entry:
+  store i8* blockaddress(@h, %here), i8** %p
+; CHECK: store i8* blockaddress(@h, %here), i8** %p
+  ret void
+}
+
+define i32 @h(double %d) {
+; CHECK: define i32 @h(double %d)
+entry:
+  br label %here
+
+here:
+  %c = fcmp olt double %d, 1.5
+; CHECK: %c = fcmp olt double %d, 1.500000e+00
+  %r = select i1 %c, i32 7, i32 9, !dbg !2
+  call void @llvm.dbg.value(metadata !{double %d}, i64 0, metadata !1)
+  ret i32 %r
+}
+
+define <2 x i32> @v(<2 x i32> %x) {
+; CHECK: define <2 x i32> @v(<2 x i32> %x)
+entry:
+  %s = shufflevector <2 x i32> %x, <2 x i32> <i32 1, i32 2>, <2 x i32> <i32 3, i32 0>
+; CHECK: shufflevector <2 x i32> %x, <2 x i32> <i32 1, i32 2>, <2 x i32> <i32 3, i32 0>
+  ret <2 x i32> %s
+}
+
+declare void @llvm.dbg.value(metadata, i64, metadata) nounwind readnone
+
+!0 = metadata !{metadata !"int", null}
+!1 = metadata !{i32 786688, null, metadata !"d", null, i32 1, null, i32 0, i32 0}
+!2 = metadata !{i32 3, i32 4, null, null}
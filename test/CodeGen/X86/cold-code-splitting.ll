@@ -0,0 +1,156 @@
+; RUN: llc < %s -mtriple=x86_64-pc-linux -fsplit-cold-code | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-pc-linux -fsplit-cold-code -ffunction-sections \
+; RUN:   | FileCheck %s -check-prefix=FSECT
+; RUN: llc < %s -mtriple=x86_64-pc-linux | FileCheck %s -check-prefix=NOSPLIT
+; RUN: llc < %s -mtriple=x86_64-pc-linux -fsplit-cold-code -filetype=obj -o %t
+; RUN: llvm-readobj -s -r %t | FileCheck %s -check-prefix=OBJ
+
+declare i32 @hot_callee(i32)
+declare i32 @cold_callee(i32)
+
+; The cold block is emitted in .text.unlikely, with a frame description of its
+; own that starts from the state at the end of the prologue.
+define i32 @split(i32 %x) uwtable {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %hot, !prof !0
+
+hot:
+  %r = call i32 @hot_callee(i32 %x)
+  %s = add i32 %r, 2
+  ret i32 %s
+
+cold:
+  %r2 = call i32 @cold_callee(i32 %x)
+  %s2 = add i32 %r2, 1
+  ret i32 %s2
+}
+
+; CHECK: .text
+; CHECK: split:
+; CHECK: .cfi_startproc
+; CHECK: pushq
+; CHECK: .cfi_def_cfa_offset 16
+; CHECK: je [[COLD:.LBB0_[0-9]+]]
+; CHECK: callq hot_callee
+; CHECK: ret
+; CHECK: [[HOTEND:.Ltmp[0-9]+]]:
+; CHECK-NEXT: .cfi_endproc
+; CHECK-NEXT: .section .text.unlikely,"ax",@progbits
+; CHECK-NEXT: .type split.cold,@function
+; CHECK-NEXT: split.cold:
+; CHECK-NEXT: .cfi_startproc
+; CHECK: .cfi_def_cfa_offset 16
+; CHECK-NEXT: [[COLD]]:
+; CHECK: callq cold_callee
+; CHECK: ret
+; CHECK: [[COLDEND:.Ltmp[0-9]+]]:
+; CHECK-NEXT: .size split.cold, [[COLDEND]]-split.cold
+; CHECK-NEXT: .size split, [[HOTEND]]-split
+; CHECK-NEXT: .cfi_endproc
+
+; FSECT: .section .text.split,"ax",@progbits
+; FSECT: .section .text.unlikely.split,"ax",@progbits
+; FSECT-NEXT: .type split.cold,@function
+
+; NOSPLIT-NOT: .text.unlikely
+; NOSPLIT-NOT: .cold
+
+; Cold blocks branch back into the hot part of the function.
+define i32 @rejoin(i32 %x) {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %hot, !prof !0
+
+cold:
+  %r = call i32 @cold_callee(i32 %x)
+  br label %join
+
+hot:
+  %r2 = call i32 @hot_callee(i32 %x)
+  br label %join
+
+join:
+  %p = phi i32 [ %r, %cold ], [ %r2, %hot ]
+  %s = add i32 %p, 3
+  ret i32 %s
+}
+
+; CHECK: rejoin:
+; CHECK: je [[RCOLD:.LBB1_[0-9]+]]
+; CHECK: callq hot_callee
+; CHECK: [[JOIN:.LBB1_[0-9]+]]:
+; CHECK: ret
+; CHECK: .section .text.unlikely,"ax",@progbits
+; CHECK: rejoin.cold:
+; CHECK: [[RCOLD]]:
+; CHECK: callq cold_callee
+; CHECK-NEXT: jmp [[JOIN]]
+
+; Linkonce functions keep their cold blocks in their section group.
+define linkonce_odr i32 @weak(i32 %x) {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %hot, !prof !0
+
+hot:
+  ret i32 %x
+
+cold:
+  %r2 = call i32 @cold_callee(i32 %x)
+  ret i32 %r2
+}
+
+; CHECK: .section .text.weak,"axG",@progbits,weak,comdat
+; CHECK-NOT: weak.cold
+; CHECK: .size weak,
+
+; Functions the profile found to be cold or hot are grouped in .text.unlikely
+; and .text.hot.
+define i32 @cold_function(i32 %x) #0 {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %hot, !prof !0
+
+hot:
+  ret i32 %x
+
+cold:
+  %r2 = call i32 @cold_callee(i32 %x)
+  ret i32 %r2
+}
+
+define i32 @hot_function(i32 %x) #1 {
+entry:
+  %a = add i32 %x, 1
+  ret i32 %a
+}
+
+; CHECK: .section .text.unlikely,"ax",@progbits
+; CHECK-NOT: .section
+; CHECK: cold_function:
+; CHECK-NOT: cold_function.cold
+; CHECK: .section .text.hot,"ax",@progbits
+; CHECK-NOT: .section
+; CHECK: hot_function:
+
+; FSECT: .section .text.unlikely.cold_function,"ax",@progbits
+; FSECT: .section .text.hot.hot_function,"ax",@progbits
+
+; NOSPLIT-NOT: .text.hot
+
+; OBJ: Name: .text.unlikely
+; OBJ: Relocations [
+; OBJ: Section {{.*}} .text {
+; OBJ: R_X86_64_PC32 .text.unlikely
+; OBJ: Section {{.*}} .text.unlikely {
+; OBJ: R_X86_64_PC32 cold_callee
+; OBJ: R_X86_64_PC32 .text
+; OBJ: Section {{.*}} .eh_frame {
+; OBJ-NEXT: R_X86_64_PC32 .text 0x0
+; OBJ-NEXT: R_X86_64_PC32 .text.unlikely 0x0
+
+attributes #0 = { "cold" }
+attributes #1 = { "hot" }
+
+!0 = metadata !{metadata !"branch_weights", i32 0, i32 100000}
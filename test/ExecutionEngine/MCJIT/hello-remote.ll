@@ -0,0 +1,15 @@
+; RUN: %lli_mcjit -remote-mcjit %s | FileCheck %s
+; XFAIL: arm, mips
+
+; The remote process can call the library functions of lli.
+
+; CHECK: Hello World
+
+@.LC0 = internal global [12 x i8] c"Hello World\00"
+
+declare i32 @puts(i8*)
+
+define i32 @main() {
+	%reg210 = call i32 @puts( i8* getelementptr ([12 x i8]* @.LC0, i64 0, i64 0) )
+	ret i32 0
+}
@@ -0,0 +1,37 @@
+; RUN: rm -rf %T/remote-restart.dir
+; RUN: cd %T && not %lli_mcjit -remote-mcjit %s 2>&1 \
+; RUN:   | FileCheck %s -check-prefix=CRASH
+; RUN: rm -rf %T/remote-restart.dir
+; RUN: cd %T && %lli_mcjit -remote-mcjit -remote-mcjit-restarts=1 %s 2>&1 \
+; RUN:   | FileCheck %s -check-prefix=RESTART
+; REQUIRES: shell
+; XFAIL: arm, mips
+
+; The first run of main creates the directory and crashes, the code is then
+; sent to a new remote process where main returns 0.
+
+; CRASH: ERROR: unable to get a reply from the remote process: terminated by signal
+; CRASH-NOT: restarting
+
+; RESTART: ERROR: unable to get a reply from the remote process: terminated by signal
+; RESTART: lli: restarting the remote process
+; RESTART-NOT: ERROR
+
+@dir = internal constant [19 x i8] c"remote-restart.dir\00"
+
+declare i32 @mkdir(i8*, i32)
+declare void @abort()
+
+define i32 @main() {
+entry:
+  %r = call i32 @mkdir(i8* getelementptr ([19 x i8]* @dir, i64 0, i64 0), i32 448)
+  %created = icmp eq i32 %r, 0
+  br i1 %created, label %crash, label %done
+
+crash:
+  call void @abort()
+  unreachable
+
+done:
+  ret i32 0
+}
@@ -0,0 +1,31 @@
+; RUN: %lli_mcjit -mcjit-link-threads=4 %s > /dev/null
+
+; Relocations patching code, read-only and writable data, resolved on
+; several threads.
+
+@str = private unnamed_addr constant [6 x i8] c"hello\00"
+@strptr = global i8* getelementptr inbounds ([6 x i8]* @str, i32 0, i32 0)
+@fnptr = global i32 (i32)* @inc
+@count = global i32 0
+
+declare i64 @strlen(i8*)
+
+define i32 @inc(i32 %x) {
+entry:
+  %y = add i32 %x, 1
+  ret i32 %y
+}
+
+define i32 @main() {
+entry:
+  %s = load i8** @strptr
+  %len = call i64 @strlen(i8* %s)
+  %len32 = trunc i64 %len to i32
+  %f = load i32 (i32)** @fnptr
+  %r = call i32 %f(i32 %len32)
+  store i32 %r, i32* @count
+  %c = load i32* @count
+  %d = call i32 @inc(i32 %c)
+  %res = sub i32 %d, 7
+  ret i32 %res
+}
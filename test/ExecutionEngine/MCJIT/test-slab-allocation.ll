@@ -0,0 +1,26 @@
+; RUN: %lli_mcjit -mcjit-slab-size=4096 %s > /dev/null
+; RUN: %lli_mcjit -mcjit-slab-size=4096 -mcjit-huge-pages %s > /dev/null
+
+; Code, read-only and writable data packed into slabs.
+
+@table = constant [4 x i32] [i32 1, i32 2, i32 3, i32 4], align 4
+@count = global i32 0, align 4
+
+define i32 @sum() {
+entry:
+  %p0 = getelementptr [4 x i32]* @table, i32 0, i32 0
+  %p3 = getelementptr [4 x i32]* @table, i32 0, i32 3
+  %a = load i32* %p0
+  %b = load i32* %p3
+  %s = add i32 %a, %b
+  store i32 %s, i32* @count
+  ret i32 %s
+}
+
+define i32 @main() {
+entry:
+  %s = call i32 @sum()
+  %c = load i32* @count
+  %r = sub i32 %s, %c
+  ret i32 %r
+}
@@ -0,0 +1,23 @@
+; RUN: opt < %s -instcombine -globaldce -pass-trace=%t -disable-output
+; RUN: FileCheck %s < %t
+; RUN: opt < %s -instcombine -pass-trace=%t.threshold \
+; RUN:   -pass-trace-threshold=100000000 -disable-output
+; RUN: FileCheck %s -check-prefix=THRESHOLD < %t.threshold
+
+; CHECK: pass,function,wall_usec,insts_before,insts_after,heap_growth
+; CHECK: "Combine redundant instructions","f",{{[0-9]+}},3,2,{{-?[0-9]+}}
+; CHECK: "Combine redundant instructions","g",{{[0-9]+}},1,1,{{-?[0-9]+}}
+; CHECK: "Dead Global Elimination","",{{[0-9]+}},3,3,{{-?[0-9]+}}
+
+; THRESHOLD: pass,function,wall_usec,insts_before,insts_after,heap_growth
+; THRESHOLD-NOT: Combine
+
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 0
+  %b = add i32 %a, 1
+  ret i32 %b
+}
+
+define void @g() {
+  ret void
+}
@@ -0,0 +1,35 @@
+; RUN: opt -instcombine -instcombine-sparse-revisit -stats -disable-output < %s 2>&1 | FileCheck %s --check-prefix=SPARSE
+; RUN: opt -instcombine -stats -disable-output < %s 2>&1 | FileCheck %s --check-prefix=SWEEP
+; REQUIRES: asserts
+
+; @test1 needs a second iteration, which only revisits the instructions the
+; first one changed.  @test2 folds a branch condition, so its second iteration
+; is a full sweep that cleans up the block made unreachable, and its third is
+; sparse again.
+
+; SPARSE: 3 instcombine - Number of full function sweeps
+; SPARSE: 21 instcombine - Number of insts visited
+
+; SWEEP: 5 instcombine - Number of full function sweeps
+; SWEEP: 23 instcombine - Number of insts visited
+
+define i32 @test1(i32 %x) {
+  %a = add i32 %x, %x
+  %b = add i32 %a, %a
+  %c = add i32 %b, %b
+  ret i32 %c
+}
+
+define i32 @test2(i32 %x) {
+entry:
+  %a = and i32 %x, 0
+  %c = icmp eq i32 %a, 0
+  br i1 %c, label %t, label %f
+
+t:
+  ret i32 1
+
+f:
+  %y = add i32 %x, 1
+  ret i32 %y
+}
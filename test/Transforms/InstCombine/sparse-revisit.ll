@@ -0,0 +1,43 @@
+; RUN: opt -instcombine -instcombine-sparse-revisit -S < %s | FileCheck %s
+; RUN: opt -instcombine -S < %s | FileCheck %s
+
+; Sparse revisiting must reach the same fixed point as full sweeps.
+
+; CHECK: @test1
+; CHECK-NEXT: %[[R:.*]] = shl i32 %x, 3
+; CHECK-NEXT: ret i32 %[[R]]
+define i32 @test1(i32 %x) {
+  %a = add i32 %x, %x
+  %b = add i32 %a, %a
+  %c = add i32 %b, %b
+  ret i32 %c
+}
+
+; CHECK: @test2
+; CHECK: ret i1 false
+define i1 @test2(i32 %x) {
+  %a = and i32 %x, 12
+  %b = or i32 %a, 1
+  %c = icmp eq i32 %b, 0
+  ret i1 %c
+}
+
+; Folding the branch condition makes %f unreachable.  The next iteration must
+; still be a full sweep, which empties it.
+; CHECK: @test3
+; CHECK: br i1 true, label %t, label %f
+; CHECK: f:
+; CHECK-NEXT: ret i32 undef
+define i32 @test3(i32 %x) {
+entry:
+  %a = and i32 %x, 0
+  %c = icmp eq i32 %a, 0
+  br i1 %c, label %t, label %f
+
+t:
+  ret i32 1
+
+f:
+  %y = add i32 %x, 1
+  ret i32 %y
+}
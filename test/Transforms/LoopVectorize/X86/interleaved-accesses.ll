@@ -0,0 +1,57 @@
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 -enable-interleaved-mem-accesses=false -S | FileCheck %s -check-prefix=NOINTERLEAVE
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; An array of complex numbers is profitable to vectorize with SSE once the
+; real and imaginary parts are loaded and stored as interleave groups.
+;   struct cplx { float re, im; };
+;   for (i = 0; i < 1024; ++i) {
+;     C[i].re = A[i].re * B[i].re - A[i].im * B[i].im;
+;     C[i].im = A[i].re * B[i].im + A[i].im * B[i].re;
+;   }
+
+; CHECK: @cmul
+; CHECK: load <8 x float>
+; CHECK: shufflevector <8 x float> %wide.vec
+; CHECK: store <8 x float> %interleaved.vec
+; CHECK: ret void
+
+; NOINTERLEAVE: @cmul
+; NOINTERLEAVE-NOT: shufflevector <8 x float>
+; NOINTERLEAVE: ret void
+define void @cmul(float* noalias nocapture %A, float* noalias nocapture %B,
+                  float* noalias nocapture %C) {
+entry:
+  br label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %re.idx = shl nsw i64 %indvars.iv, 1
+  %im.idx = or i64 %re.idx, 1
+  %a.re.ptr = getelementptr inbounds float* %A, i64 %re.idx
+  %a.re = load float* %a.re.ptr, align 4
+  %a.im.ptr = getelementptr inbounds float* %A, i64 %im.idx
+  %a.im = load float* %a.im.ptr, align 4
+  %b.re.ptr = getelementptr inbounds float* %B, i64 %re.idx
+  %b.re = load float* %b.re.ptr, align 4
+  %b.im.ptr = getelementptr inbounds float* %B, i64 %im.idx
+  %b.im = load float* %b.im.ptr, align 4
+  %m0 = fmul float %a.re, %b.re
+  %m1 = fmul float %a.im, %b.im
+  %re = fsub float %m0, %m1
+  %m2 = fmul float %a.re, %b.im
+  %m3 = fmul float %a.im, %b.re
+  %im = fadd float %m2, %m3
+  %c.re.ptr = getelementptr inbounds float* %C, i64 %re.idx
+  store float %re, float* %c.re.ptr, align 4
+  %c.im.ptr = getelementptr inbounds float* %C, i64 %im.idx
+  store float %im, float* %c.im.ptr, align 4
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -0,0 +1,119 @@
+; RUN: opt -S -loop-vectorize -dce -instcombine -force-vector-width=4 -force-vector-unroll=1 < %s | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = common global [1024 x i32] zeroinitializer, align 16
+@B = common global [1024 x i32] zeroinitializer, align 16
+
+; Sum the positive elements. The select chooses between two values of the
+; reduction.
+;   for (i = 0; i < 1024; ++i)
+;     s = A[i] > 0 ? s + A[i] : s;
+; CHECK: @cond_sum
+; CHECK: vector.body
+; CHECK: icmp sgt <4 x i32>
+; CHECK: add nsw <4 x i32>
+; CHECK: select <4 x i1>
+; CHECK: middle.block:
+; CHECK: add <4 x i32>
+define i32 @cond_sum(i32 %s) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %sum = phi i32 [ %s, %entry ], [ %sum.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %cmp = icmp sgt i32 %0, 0
+  %add = add nsw i32 %sum, %0
+  %sum.next = select i1 %cmp, i32 %add, i32 %sum
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %sum.next
+}
+
+; Both arms of the select update the reduction. InstCombine sinks the select
+; into the operand of the add.
+;   s = B[i] ? s + A[i] : s - A[i];
+; CHECK: @cond_add_sub
+; CHECK: vector.body
+; CHECK: icmp ne <4 x i32>
+; CHECK: select <4 x i1>
+; CHECK: add <4 x i32> %vec.phi
+; CHECK: middle.block:
+define i32 @cond_add_sub(i32 %s) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %sum = phi i32 [ %s, %entry ], [ %sum.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %arrayidx2 = getelementptr inbounds [1024 x i32]* @B, i64 0, i64 %iv
+  %1 = load i32* %arrayidx2, align 4
+  %tobool = icmp ne i32 %1, 0
+  %add = add nsw i32 %sum, %0
+  %sub = sub nsw i32 %sum, %0
+  %sum.next = select i1 %tobool, i32 %add, i32 %sub
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %sum.next
+}
+
+; Don't vectorize a select that resets the reduction.
+;   s = A[i] ? s + A[i] : 0;
+; CHECK: @cond_reset
+; CHECK-NOT: <4 x i32>
+; CHECK: ret
+define i32 @cond_reset(i32 %s) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %sum = phi i32 [ %s, %entry ], [ %sum.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %tobool = icmp ne i32 %0, 0
+  %add = add nsw i32 %sum, %0
+  %sum.next = select i1 %tobool, i32 %add, i32 0
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %sum.next
+}
+
+; Don't vectorize if the condition depends on the reduction.
+;   s = s > 100 ? s : s + A[i];
+; CHECK: @cond_on_reduction
+; CHECK-NOT: <4 x i32>
+; CHECK: ret
+define i32 @cond_on_reduction(i32 %s) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %sum = phi i32 [ %s, %entry ], [ %sum.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %cmp = icmp sgt i32 %sum, 100
+  %add = add nsw i32 %sum, %0
+  %sum.next = select i1 %cmp, i32 %sum, i32 %add
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %sum.next
+}
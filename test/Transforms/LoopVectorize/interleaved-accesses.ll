@@ -0,0 +1,141 @@
+; RUN: opt < %s -loop-vectorize -force-vector-width=4 -force-vector-unroll=1 -instcombine -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+; Load a group of factor three and store the sum of its members.
+;   for (i = 0; i < 1024; ++i)
+;     B[i] = A[3*i] + A[3*i+1] + A[3*i+2];
+
+; CHECK: @load_factor_3
+; CHECK: %wide.vec = load <12 x i32>* %{{.*}}, align 4
+; CHECK: shufflevector <12 x i32> %wide.vec, <12 x i32> undef, <4 x i32> <i32 0, i32 3, i32 6, i32 9>
+; CHECK: shufflevector <12 x i32> %wide.vec, <12 x i32> undef, <4 x i32> <i32 1, i32 4, i32 7, i32 10>
+; CHECK: shufflevector <12 x i32> %wide.vec, <12 x i32> undef, <4 x i32> <i32 2, i32 5, i32 8, i32 11>
+; CHECK: store <4 x i32>
+; CHECK: ret void
+define void @load_factor_3(i32* noalias nocapture %A, i32* noalias nocapture %B) {
+entry:
+  br label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %0 = mul nsw i64 %indvars.iv, 3
+  %arrayidx0 = getelementptr inbounds i32* %A, i64 %0
+  %1 = load i32* %arrayidx0, align 4
+  %2 = add nsw i64 %0, 1
+  %arrayidx1 = getelementptr inbounds i32* %A, i64 %2
+  %3 = load i32* %arrayidx1, align 4
+  %4 = add nsw i64 %0, 2
+  %arrayidx2 = getelementptr inbounds i32* %A, i64 %4
+  %5 = load i32* %arrayidx2, align 4
+  %add = add nsw i32 %3, %1
+  %add1 = add nsw i32 %add, %5
+  %arrayidx3 = getelementptr inbounds i32* %B, i64 %indvars.iv
+  store i32 %add1, i32* %arrayidx3, align 4
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; Store a group of factor two.
+;   for (i = 0; i < 1024; ++i) {
+;     B[2*i] = A[i];
+;     B[2*i+1] = -A[i];
+;   }
+
+; CHECK: @store_factor_2
+; CHECK: %interleaved.vec = shufflevector <4 x float> %{{.*}}, <4 x float> %{{.*}}, <8 x i32> <i32 0, i32 4, i32 1, i32 5, i32 2, i32 6, i32 3, i32 7>
+; CHECK: store <8 x float> %interleaved.vec, <8 x float>* %{{.*}}, align 4
+; CHECK: ret void
+define void @store_factor_2(float* noalias nocapture %A, float* noalias nocapture %B) {
+entry:
+  br label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %arrayidx = getelementptr inbounds float* %A, i64 %indvars.iv
+  %0 = load float* %arrayidx, align 4
+  %1 = shl nsw i64 %indvars.iv, 1
+  %arrayidx0 = getelementptr inbounds float* %B, i64 %1
+  store float %0, float* %arrayidx0, align 4
+  %neg = fsub float -0.000000e+00, %0
+  %2 = or i64 %1, 1
+  %arrayidx1 = getelementptr inbounds float* %B, i64 %2
+  store float %neg, float* %arrayidx1, align 4
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; Read-modify-write of both members of a group in the same array.
+;   for (i = 0; i < 1024; ++i) {
+;     A[2*i] += 1;
+;     A[2*i+1] *= 2;
+;   }
+; (the loads come before the stores in the IR below).
+
+; CHECK: @load_store_same_array
+; CHECK: %wide.vec = load <8 x i32>
+; CHECK: %interleaved.vec = shufflevector
+; CHECK: store <8 x i32> %interleaved.vec
+; CHECK: ret void
+define void @load_store_same_array(i32* nocapture %A) {
+entry:
+  br label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %0 = shl nsw i64 %indvars.iv, 1
+  %arrayidx0 = getelementptr inbounds i32* %A, i64 %0
+  %1 = or i64 %0, 1
+  %arrayidx1 = getelementptr inbounds i32* %A, i64 %1
+  %2 = load i32* %arrayidx0, align 4
+  %3 = load i32* %arrayidx1, align 4
+  %add = add nsw i32 %2, 1
+  %mul = shl nsw i32 %3, 1
+  store i32 %add, i32* %arrayidx0, align 4
+  store i32 %mul, i32* %arrayidx1, align 4
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; A load group with a gap at the end must not be combined; the wide load of
+; the last iteration would read past the end of the accessed memory.
+;   for (i = 0; i < 1024; ++i)
+;     B[i] = A[3*i] + A[3*i+1];
+
+; CHECK: @load_gap_at_end
+; CHECK-NOT: load <12 x i32>
+; CHECK: ret void
+define void @load_gap_at_end(i32* noalias nocapture %A, i32* noalias nocapture %B) {
+entry:
+  br label %for.body
+
+for.body:
+  %indvars.iv = phi i64 [ 0, %entry ], [ %indvars.iv.next, %for.body ]
+  %0 = mul nsw i64 %indvars.iv, 3
+  %arrayidx0 = getelementptr inbounds i32* %A, i64 %0
+  %1 = load i32* %arrayidx0, align 4
+  %2 = add nsw i64 %0, 1
+  %arrayidx1 = getelementptr inbounds i32* %A, i64 %2
+  %3 = load i32* %arrayidx1, align 4
+  %add = add nsw i32 %3, %1
+  %arrayidx3 = getelementptr inbounds i32* %B, i64 %indvars.iv
+  store i32 %add, i32* %arrayidx3, align 4
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %exitcond = icmp eq i64 %indvars.iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -0,0 +1,129 @@
+; RUN: opt -S -loop-vectorize -dce -instcombine -force-vector-width=4 -force-vector-unroll=2 < %s | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = common global [1024 x i32] zeroinitializer, align 16
+@fA = common global [1024 x float] zeroinitializer, align 16
+
+; Find the position of the first minimum.
+;   for (i = 0; i < 1024; ++i)
+;     if (A[i] < min) { min = A[i]; idx = i; }
+; The lanes holding the final minimum keep their position; the others are
+; replaced by the largest index before the positions are reduced with smin.
+; CHECK: @argmin
+; CHECK: vector.body
+; CHECK: icmp slt <4 x i32>
+; CHECK: select <4 x i1>
+; CHECK: select <4 x i1>
+; CHECK: middle.block
+; CHECK: icmp eq <4 x i32>
+; CHECK: select <4 x i1> {{.*}}, <4 x i32> <i32 2147483647, i32 2147483647, i32 2147483647, i32 2147483647>
+; CHECK: icmp eq <4 x i32>
+; CHECK: select <4 x i1> {{.*}}, <4 x i32> <i32 2147483647, i32 2147483647, i32 2147483647, i32 2147483647>
+; CHECK: icmp slt <4 x i32>
+; CHECK: ret i32
+define i32 @argmin(i32 %min, i32 %idx) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %m = phi i32 [ %min, %entry ], [ %m.next, %for.body ]
+  %pos = phi i32 [ %idx, %entry ], [ %pos.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %cmp = icmp slt i32 %0, %m
+  %m.next = select i1 %cmp, i32 %0, i32 %m
+  %i = trunc i64 %iv to i32
+  %pos.next = select i1 %cmp, i32 %i, i32 %pos
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %pos.next
+}
+
+; Same for the maximum of floats, written with inverted select operands.
+;   if (!(fA[i] <= max)) { max = fA[i]; idx = i; }
+; CHECK: @argmax_float
+; CHECK: vector.body
+; CHECK: fcmp ole <4 x float>
+; CHECK: middle.block
+; CHECK: fcmp oeq <4 x float>
+; CHECK: ret i64
+define i64 @argmax_float(float %max, i64 %idx) #0 {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %m = phi float [ %max, %entry ], [ %m.next, %for.body ]
+  %pos = phi i64 [ %idx, %entry ], [ %pos.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x float]* @fA, i64 0, i64 %iv
+  %0 = load float* %arrayidx, align 4
+  %cmp = fcmp ole float %0, %m
+  %m.next = select i1 %cmp, float %m, float %0
+  %pos.next = select i1 %cmp, i64 %pos, i64 %iv
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i64 %pos.next
+}
+
+; Don't vectorize the position of the last minimum. It is updated on equal
+; elements, which the lanes cannot tell apart.
+;   if (A[i] <= min) { min = A[i]; idx = i; }
+; CHECK: @argmin_last
+; CHECK-NOT: <4 x i32>
+; CHECK: ret i32
+define i32 @argmin_last(i32 %min, i32 %idx) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %m = phi i32 [ %min, %entry ], [ %m.next, %for.body ]
+  %pos = phi i32 [ %idx, %entry ], [ %pos.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %cmp = icmp sle i32 %0, %m
+  %m.next = select i1 %cmp, i32 %0, i32 %m
+  %i = trunc i64 %iv to i32
+  %pos.next = select i1 %cmp, i32 %i, i32 %pos
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %pos.next
+}
+
+; Don't vectorize if the min/max compare has other users.
+; CHECK: @minmax_cmp_other_use
+; CHECK-NOT: <4 x i32>
+; CHECK: ret i32
+define i32 @minmax_cmp_other_use(i32 %min) {
+entry:
+  br label %for.body
+
+for.body:
+  %iv = phi i64 [ 0, %entry ], [ %iv.next, %for.body ]
+  %m = phi i32 [ %min, %entry ], [ %m.next, %for.body ]
+  %arrayidx = getelementptr inbounds [1024 x i32]* @A, i64 0, i64 %iv
+  %0 = load i32* %arrayidx, align 4
+  %cmp = icmp slt i32 %0, %m
+  %m.next = select i1 %cmp, i32 %0, i32 %m
+  %flag = select i1 %cmp, i32 1, i32 0
+  store i32 %flag, i32* %arrayidx, align 4
+  %iv.next = add i64 %iv, 1
+  %exitcond = icmp eq i64 %iv.next, 1024
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret i32 %m.next
+}
+
+attributes #0 = { "no-nans-fp-math"="true" }
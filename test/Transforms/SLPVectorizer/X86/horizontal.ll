@@ -0,0 +1,147 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 | FileCheck %s
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; int dot4(int *a, int *b) {
+;   return a[0]*b[0] + a[1]*b[1] + a[2]*b[2] + a[3]*b[3];
+; }
+
+; CHECK: @dot4
+; CHECK: load <4 x i32>
+; CHECK: load <4 x i32>
+; CHECK: mul <4 x i32>
+; CHECK: shufflevector <4 x i32> {{.*}}, <4 x i32> <i32 2, i32 3, i32 undef, i32 undef>
+; CHECK: add <4 x i32>
+; CHECK: shufflevector <4 x i32> {{.*}}, <4 x i32> <i32 1, i32 undef, i32 undef, i32 undef>
+; CHECK: add <4 x i32>
+; CHECK: extractelement <4 x i32>
+; CHECK-NOT: add i32
+; CHECK: ret i32
+define i32 @dot4(i32* nocapture %a, i32* nocapture %b) {
+entry:
+  %0 = load i32* %a, align 4
+  %1 = load i32* %b, align 4
+  %mul = mul nsw i32 %1, %0
+  %arrayidx2 = getelementptr inbounds i32* %a, i64 1
+  %2 = load i32* %arrayidx2, align 4
+  %arrayidx3 = getelementptr inbounds i32* %b, i64 1
+  %3 = load i32* %arrayidx3, align 4
+  %mul4 = mul nsw i32 %3, %2
+  %add = add nsw i32 %mul4, %mul
+  %arrayidx5 = getelementptr inbounds i32* %a, i64 2
+  %4 = load i32* %arrayidx5, align 4
+  %arrayidx6 = getelementptr inbounds i32* %b, i64 2
+  %5 = load i32* %arrayidx6, align 4
+  %mul7 = mul nsw i32 %5, %4
+  %add8 = add nsw i32 %add, %mul7
+  %arrayidx9 = getelementptr inbounds i32* %a, i64 3
+  %6 = load i32* %arrayidx9, align 4
+  %arrayidx10 = getelementptr inbounds i32* %b, i64 3
+  %7 = load i32* %arrayidx10, align 4
+  %mul11 = mul nsw i32 %7, %6
+  %add12 = add nsw i32 %add8, %mul11
+  ret i32 %add12
+}
+
+; An unrolled fast-math dot product of eight floats plus an initial value. The
+; two groups of four products are added before the horizontal reduction, and
+; the initial value is added to the result.
+; float fdot8(float *a, float *b, float s) {
+;   for (int i = 0; i < 8; ++i)
+;     s += a[i] * b[i];
+;   return s;
+; }
+
+; CHECK: @fdot8
+; CHECK: fmul <4 x float>
+; CHECK: fmul <4 x float>
+; CHECK: fadd fast <4 x float>
+; CHECK: shufflevector <4 x float>
+; CHECK: fadd fast <4 x float>
+; CHECK: shufflevector <4 x float>
+; CHECK: fadd fast <4 x float>
+; CHECK: extractelement <4 x float>
+; CHECK: fadd fast float {{.*}}, %s
+; CHECK: ret float
+define float @fdot8(float* nocapture %a, float* nocapture %b, float %s) {
+entry:
+  %a0 = load float* %a, align 4
+  %b0 = load float* %b, align 4
+  %m0 = fmul fast float %a0, %b0
+  %s0 = fadd fast float %s, %m0
+  %pa1 = getelementptr inbounds float* %a, i64 1
+  %pb1 = getelementptr inbounds float* %b, i64 1
+  %a1 = load float* %pa1, align 4
+  %b1 = load float* %pb1, align 4
+  %m1 = fmul fast float %a1, %b1
+  %s1 = fadd fast float %s0, %m1
+  %pa2 = getelementptr inbounds float* %a, i64 2
+  %pb2 = getelementptr inbounds float* %b, i64 2
+  %a2 = load float* %pa2, align 4
+  %b2 = load float* %pb2, align 4
+  %m2 = fmul fast float %a2, %b2
+  %s2 = fadd fast float %s1, %m2
+  %pa3 = getelementptr inbounds float* %a, i64 3
+  %pb3 = getelementptr inbounds float* %b, i64 3
+  %a3 = load float* %pa3, align 4
+  %b3 = load float* %pb3, align 4
+  %m3 = fmul fast float %a3, %b3
+  %s3 = fadd fast float %s2, %m3
+  %pa4 = getelementptr inbounds float* %a, i64 4
+  %pb4 = getelementptr inbounds float* %b, i64 4
+  %a4 = load float* %pa4, align 4
+  %b4 = load float* %pb4, align 4
+  %m4 = fmul fast float %a4, %b4
+  %s4 = fadd fast float %s3, %m4
+  %pa5 = getelementptr inbounds float* %a, i64 5
+  %pb5 = getelementptr inbounds float* %b, i64 5
+  %a5 = load float* %pa5, align 4
+  %b5 = load float* %pb5, align 4
+  %m5 = fmul fast float %a5, %b5
+  %s5 = fadd fast float %s4, %m5
+  %pa6 = getelementptr inbounds float* %a, i64 6
+  %pb6 = getelementptr inbounds float* %b, i64 6
+  %a6 = load float* %pa6, align 4
+  %b6 = load float* %pb6, align 4
+  %m6 = fmul fast float %a6, %b6
+  %s6 = fadd fast float %s5, %m6
+  %pa7 = getelementptr inbounds float* %a, i64 7
+  %pb7 = getelementptr inbounds float* %b, i64 7
+  %a7 = load float* %pa7, align 4
+  %b7 = load float* %pb7, align 4
+  %m7 = fmul fast float %a7, %b7
+  %s7 = fadd fast float %s6, %m7
+  ret float %s7
+}
+
+; Without fast-math flags the additions must stay in order.
+; CHECK: @fdot4_strict
+; CHECK-NOT: <4 x float>
+; CHECK: ret float
+define float @fdot4_strict(float* nocapture %a, float* nocapture %b) {
+entry:
+  %a0 = load float* %a, align 4
+  %b0 = load float* %b, align 4
+  %m0 = fmul float %a0, %b0
+  %pa1 = getelementptr inbounds float* %a, i64 1
+  %pb1 = getelementptr inbounds float* %b, i64 1
+  %a1 = load float* %pa1, align 4
+  %b1 = load float* %pb1, align 4
+  %m1 = fmul float %a1, %b1
+  %s1 = fadd float %m0, %m1
+  %pa2 = getelementptr inbounds float* %a, i64 2
+  %pb2 = getelementptr inbounds float* %b, i64 2
+  %a2 = load float* %pa2, align 4
+  %b2 = load float* %pb2, align 4
+  %m2 = fmul float %a2, %b2
+  %s2 = fadd float %s1, %m2
+  %pa3 = getelementptr inbounds float* %a, i64 3
+  %pb3 = getelementptr inbounds float* %b, i64 3
+  %a3 = load float* %pa3, align 4
+  %b3 = load float* %pb3, align 4
+  %m3 = fmul float %a3, %b3
+  %s3 = fadd float %s2, %m3
+  ret float %s3
+}
@@ -0,0 +1,51 @@
+; RUN: not llvm-as < %s -o /dev/null -verifier-threads=3 2>&1 | FileCheck %s
+; RUN: not llvm-as < %s -o /dev/null -verifier-threads=3 -time-passes 2>&1 \
+; RUN:   | FileCheck %s -check-prefix=TIME
+
+; Diagnostics of function bodies checked on several threads are reported in
+; module order, followed by those of the module-level checks.
+
+define i32 @f1(i32 %x) {
+  %y = add i32 %z, 1
+  %z = add i32 %x, 1
+  ret i32 %y
+}
+
+define void @f2() {
+  ret void
+}
+
+define i32 @f3(i32 %i, i32 %j, i1 %c) {
+  br i1 %c, label %A, label %B
+A:
+  br label %C
+B:
+  br label %C
+C:
+  %a = phi i32 [%i, %A], [%j, %B]
+  %x = add i32 %a, 0
+  %b = phi i32 [%i, %A], [%j, %B]
+  ret i32 %x
+}
+
+define void @f4(i32 %x) {
+  %y = add i32 %x, %y
+  ret void
+}
+
+@llvm.used = appending global [1 x i32] [i32 0], section "llvm.metadata"
+
+; CHECK: Instruction does not dominate all uses!
+; CHECK-NEXT: %z = add i32 %x, 1
+; CHECK-NEXT: %y = add i32 %z, 1
+; CHECK: Broken module found, compilation terminated.
+; CHECK: PHI nodes not grouped at top of basic block!
+; CHECK-NEXT: %b = phi i32 [ %i, %A ], [ %j, %B ]
+; CHECK: Only PHI nodes may reference their own value!
+; CHECK-NEXT: %y = add i32 %x, %y
+; CHECK: wrong type for intrinsic global variable
+; CHECK-NEXT: [1 x i32]* @llvm.used
+
+; TIME: Module Verifier
+; TIME-DAG: Function checks
+; TIME-DAG: Module-level checks
@@ -157,6 +157,16 @@ static tool_output_file *GetOutputStream(const char *TargetName,
   return FDOut;
 }
 
+// initializeLLCPasses - Register the codegen and IR passes used by llc, so
+// that the -print-after, -print-before, and -stop-after options work.
+static void initializeLLCPasses(PassRegistry &Registry) {
+  initializeCore(Registry);
+  initializeCodeGen(Registry);
+  initializeLoopStrengthReducePass(Registry);
+  initializeLowerIntrinsicsPass(Registry);
+  initializeUnreachableBlockElimPass(Registry);
+}
+
 // main - Entry point for the llc compiler.
 //
 int main(int argc, char **argv) {
@@ -175,14 +185,8 @@ int main(int argc, char **argv) {
   InitializeAllAsmPrinters();
   InitializeAllAsmParsers();
 
-  // Initialize codegen and IR passes used by llc so that the -print-after,
-  // -print-before, and -stop-after options work.
-  PassRegistry *Registry = PassRegistry::getPassRegistry();
-  initializeCore(*Registry);
-  initializeCodeGen(*Registry);
-  initializeLoopStrengthReducePass(*Registry);
-  initializeLowerIntrinsicsPass(*Registry);
-  initializeUnreachableBlockElimPass(*Registry);
+  // Initialize codegen and IR passes once one is needed.
+  PassRegistry::getPassRegistry()->addLazyInitializer(initializeLLCPasses);
 
   // Register the target printer for --version.
   cl::AddExtraVersionPrinter(TargetRegistry::printRegisteredTargetsForVersion);
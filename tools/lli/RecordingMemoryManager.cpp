@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "RecordingMemoryManager.h"
+#include "llvm/Support/DynamicLibrary.h"
 using namespace llvm;
 
 RecordingMemoryManager::~RecordingMemoryManager() {
@@ -113,5 +114,12 @@ void *RecordingMemoryManager::getPointerToNamedFunction(const std::string &Name,
   // is called before ExecutionEngine::runFunctionAsMain() is called.
   if (Name == "__main") return (void*)(intptr_t)&jit_noop;
 
+  // The remote targets run the code in this process or in a child forked
+  // from it, where the libraries lli uses are mapped at the same addresses.
+  const char *NameStr = Name.c_str();
+  if (void *Ptr = sys::DynamicLibrary::SearchForAddressOfSymbol(NameStr))
+    return Ptr;
+  if (NameStr[0] == '_')
+    return sys::DynamicLibrary::SearchForAddressOfSymbol(NameStr+1);
   return NULL;
 }
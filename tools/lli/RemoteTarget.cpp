@@ -30,6 +30,7 @@ bool RemoteTarget::allocateSpace(size_t Size, unsigned Alignment,
     ErrorMsg = "unable to allocate sufficiently aligned memory";
     return true;
   }
+  Allocations.push_back(Mem);
   Address = reinterpret_cast<uint64_t>(Mem.base());
   return false;
 }
@@ -52,10 +53,14 @@ bool RemoteTarget::executeCode(uint64_t Address, int &RetVal) {
   return false;
 }
 
-void RemoteTarget::create() {
+bool RemoteTarget::create() {
+  IsRunning = true;
+  return false;
 }
 
 void RemoteTarget::stop() {
   for (unsigned i = 0, e = Allocations.size(); i != e; ++i)
     sys::Memory::ReleaseRWX(Allocations[i]);
+  Allocations.clear();
+  IsRunning = false;
 }
@@ -8,7 +8,9 @@
 //===----------------------------------------------------------------------===//
 //
 // Definition of the RemoteTarget class which executes JITed code in a
-// separate address range from where it was built.
+// separate address range from where it was built. This implementation
+// executes the code in the lli process itself; RemoteTargetExternal executes
+// it in a child process.
 //
 //===----------------------------------------------------------------------===//
 
@@ -25,11 +27,12 @@
 namespace llvm {
 
 class RemoteTarget {
+  SmallVector<sys::MemoryBlock, 16> Allocations;
+
+protected:
   std::string ErrorMsg;
   bool IsRunning;
 
-  SmallVector<sys::MemoryBlock, 16> Allocations;
-
 public:
   StringRef getErrorMsg() const { return ErrorMsg; }
 
@@ -41,7 +44,8 @@ public:
   ///
   /// @returns False on success. On failure, ErrorMsg is updated with
   ///          descriptive text of the encountered error.
-  bool allocateSpace(size_t Size, unsigned Alignment, uint64_t &Address);
+  virtual bool allocateSpace(size_t Size, unsigned Alignment,
+                             uint64_t &Address);
 
   /// Load data into the target address space.
   ///
@@ -51,7 +55,7 @@ public:
   ///
   /// @returns False on success. On failure, ErrorMsg is updated with
   ///          descriptive text of the encountered error.
-  bool loadData(uint64_t Address, const void *Data, size_t Size);
+  virtual bool loadData(uint64_t Address, const void *Data, size_t Size);
 
   /// Load code into the target address space and prepare it for execution.
   ///
@@ -61,7 +65,7 @@ public:
   ///
   /// @returns False on success. On failure, ErrorMsg is updated with
   ///          descriptive text of the encountered error.
-  bool loadCode(uint64_t Address, const void *Data, size_t Size);
+  virtual bool loadCode(uint64_t Address, const void *Data, size_t Size);
 
   /// Execute code in the target process. The called function is required
   /// to be of signature int "(*)(void)".
@@ -72,28 +76,26 @@ public:
   ///
   /// @returns False on success. On failure, ErrorMsg is updated with
   ///          descriptive text of the encountered error.
-  bool executeCode(uint64_t Address, int &RetVal);
+  virtual bool executeCode(uint64_t Address, int &RetVal);
 
   /// Minimum alignment for memory permissions. Used to seperate code and
   /// data regions to make sure data doesn't get marked as code or vice
   /// versa.
   ///
   /// @returns Page alignment return value. Default of 4k.
-  unsigned getPageAlignment() { return 4096; }
+  virtual unsigned getPageAlignment() { return 4096; }
 
   /// Start the remote process.
-  void create();
+  ///
+  /// @returns False on success. On failure, ErrorMsg is updated with
+  ///          descriptive text of the encountered error.
+  virtual bool create();
 
   /// Terminate the remote process.
-  void stop();
+  virtual void stop();
 
   RemoteTarget() : ErrorMsg(""), IsRunning(false) {}
-  ~RemoteTarget() { if (IsRunning) stop(); }
-
-private:
-  // Main processing function for the remote target process. Command messages
-  // are received on file descriptor CmdFD and responses come back on OutFD.
-  static void doRemoteTargeting(int CmdFD, int OutFD);
+  virtual ~RemoteTarget() { if (IsRunning) stop(); }
 };
 
 } // end namespace llvm
@@ -0,0 +1,404 @@
+//===- RemoteTargetExternal.cpp - LLVM out-of-process JIT execution -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of the RemoteTargetExternal class which executes JITed code
+// in a child process, sending it the code and data over a pair of pipes.
+//
+// The child is forked from lli once the code has been compiled, so addresses
+// of symbols in lli and in the libraries it loaded are valid in the child.
+// Every request is a message header followed by its payload, and all
+// requests but the last one get a reply with the same kind.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "lli"
+#include "RemoteTargetExternal.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/DataTypes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/Memory.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef LLVM_ON_UNIX
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+
+STATISTIC(NumRemoteMessages, "Number of requests sent to the remote process");
+STATISTIC(NumRemoteBytes, "Number of bytes sent to the remote process");
+STATISTIC(NumRemoteLoads, "Number of sections loaded in the remote process");
+
+namespace {
+enum MessageKind {
+  LLI_AllocateSpace = 1, // AllocateRequest -> uint64_t address, 0 on failure
+  LLI_LoadBatch,         // (LoadHeader, bytes)... -> uint32_t status
+  LLI_Execute,           // uint64_t address -> int32_t return value
+  LLI_Terminate          // no payload, no reply
+};
+
+struct MessageHeader {
+  uint32_t Kind;
+  uint32_t Size;
+};
+
+struct AllocateRequest {
+  uint64_t Size;
+  uint64_t Alignment;
+};
+
+struct LoadHeader {
+  uint64_t Address;
+  uint64_t Size;
+  uint64_t IsCode;
+};
+}
+
+// Loads are sent to the child once this many bytes are pending.
+static const size_t MaxPendingLoadBytes = 1024 * 1024;
+
+#ifdef LLVM_ON_UNIX
+static bool writeAll(int FD, const void *Data, size_t Size) {
+  const char *P = static_cast<const char *>(Data);
+  while (Size) {
+    ssize_t N = ::write(FD, P, Size);
+    if (N < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    P += N;
+    Size -= N;
+  }
+  return true;
+}
+
+static bool readAll(int FD, void *Data, size_t Size) {
+  char *P = static_cast<char *>(Data);
+  while (Size) {
+    ssize_t N = ::read(FD, P, Size);
+    if (N < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    if (N == 0)
+      return false;
+    P += N;
+    Size -= N;
+  }
+  return true;
+}
+#else
+static bool writeAll(int FD, const void *Data, size_t Size) { return false; }
+static bool readAll(int FD, void *Data, size_t Size) { return false; }
+#endif
+
+static bool writeMessage(int FD, unsigned Kind, const void *Data,
+                         size_t Size) {
+  MessageHeader Header = { Kind, static_cast<uint32_t>(Size) };
+  return writeAll(FD, &Header, sizeof(Header)) && writeAll(FD, Data, Size);
+}
+
+bool RemoteTargetExternal::isSupported() {
+#ifdef LLVM_ON_UNIX
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool RemoteTargetExternal::sendMessage(unsigned Kind, const void *Data,
+                                       size_t Size) {
+  ++NumRemoteMessages;
+  NumRemoteBytes += sizeof(MessageHeader) + Size;
+  if (!writeMessage(CmdFD, Kind, Data, Size)) {
+    childFailed("send a request to");
+    return true;
+  }
+  return false;
+}
+
+bool RemoteTargetExternal::receiveMessage(unsigned Kind, void *Data,
+                                          size_t Size) {
+  MessageHeader Header;
+  if (!readAll(OutFD, &Header, sizeof(Header)) || Header.Kind != Kind ||
+      Header.Size != Size || !readAll(OutFD, Data, Size)) {
+    childFailed("get a reply from");
+    return true;
+  }
+  return false;
+}
+
+void RemoteTargetExternal::childFailed(StringRef Action) {
+  ErrorMsg = "unable to " + Action.str() + " the remote process";
+#ifdef LLVM_ON_UNIX
+  ::close(CmdFD);
+  ::close(OutFD);
+
+  // A child which is still running does not follow the protocol, kill it.
+  int Status;
+  pid_t Pid = ::waitpid(ChildPID, &Status, WNOHANG);
+  if (Pid == 0) {
+    ::kill(ChildPID, SIGKILL);
+    Pid = ::waitpid(ChildPID, &Status, 0);
+  }
+  if (Pid == ChildPID) {
+    std::string Reason;
+    raw_string_ostream OS(Reason);
+    if (WIFSIGNALED(Status))
+      OS << ": terminated by signal " << WTERMSIG(Status);
+    else if (WIFEXITED(Status))
+      OS << ": exited with status " << WEXITSTATUS(Status);
+    ErrorMsg += OS.str();
+  }
+#endif
+  CmdFD = OutFD = -1;
+  ChildPID = 0;
+  PendingLoads.clear();
+  IsRunning = false;
+}
+
+bool RemoteTargetExternal::queueLoad(uint64_t Address, const void *Data,
+                                     size_t Size, bool IsCode) {
+  if (!IsRunning) {
+    ErrorMsg = "the remote process is not running";
+    return true;
+  }
+  ++NumRemoteLoads;
+  LoadHeader Header = { Address, Size, IsCode };
+  const char *H = reinterpret_cast<const char *>(&Header);
+  PendingLoads.insert(PendingLoads.end(), H, H + sizeof(Header));
+  PendingLoads.insert(PendingLoads.end(), static_cast<const char *>(Data),
+                      static_cast<const char *>(Data) + Size);
+  if (PendingLoads.size() >= MaxPendingLoadBytes)
+    return flushLoads();
+  return false;
+}
+
+bool RemoteTargetExternal::flushLoads() {
+  if (PendingLoads.empty())
+    return false;
+  DEBUG(dbgs() << "Sending " << PendingLoads.size()
+               << " bytes of loads to the remote process\n");
+  bool Failed = sendMessage(LLI_LoadBatch, &PendingLoads[0],
+                            PendingLoads.size());
+  PendingLoads.clear();
+  uint32_t Status;
+  if (Failed || receiveMessage(LLI_LoadBatch, &Status, sizeof(Status)))
+    return true;
+  if (Status) {
+    ErrorMsg = "the remote process rejected a load outside of its memory";
+    return true;
+  }
+  return false;
+}
+
+bool RemoteTargetExternal::loadData(uint64_t Address, const void *Data,
+                                    size_t Size) {
+  return queueLoad(Address, Data, Size, false);
+}
+
+bool RemoteTargetExternal::loadCode(uint64_t Address, const void *Data,
+                                    size_t Size) {
+  return queueLoad(Address, Data, Size, true);
+}
+
+bool RemoteTargetExternal::allocateSpace(size_t Size, unsigned Alignment,
+                                         uint64_t &Address) {
+  if (!IsRunning) {
+    ErrorMsg = "the remote process is not running";
+    return true;
+  }
+  AllocateRequest Request = { Size, Alignment };
+  uint64_t Result;
+  if (flushLoads() ||
+      sendMessage(LLI_AllocateSpace, &Request, sizeof(Request)) ||
+      receiveMessage(LLI_AllocateSpace, &Result, sizeof(Result)))
+    return true;
+  if (!Result) {
+    ErrorMsg = "unable to allocate memory in the remote process";
+    return true;
+  }
+  Address = Result;
+  return false;
+}
+
+bool RemoteTargetExternal::executeCode(uint64_t Address, int &RetVal) {
+  if (!IsRunning) {
+    ErrorMsg = "the remote process is not running";
+    return true;
+  }
+  int32_t Result;
+  if (flushLoads() ||
+      sendMessage(LLI_Execute, &Address, sizeof(Address)) ||
+      receiveMessage(LLI_Execute, &Result, sizeof(Result)))
+    return true;
+  RetVal = Result;
+  return false;
+}
+
+bool RemoteTargetExternal::create() {
+#ifdef LLVM_ON_UNIX
+  int ToChild[2], FromChild[2];
+  if (::pipe(ToChild)) {
+    ErrorMsg = std::string("unable to create a pipe: ") + strerror(errno);
+    return true;
+  }
+  if (::pipe(FromChild)) {
+    ErrorMsg = std::string("unable to create a pipe: ") + strerror(errno);
+    ::close(ToChild[0]);
+    ::close(ToChild[1]);
+    return true;
+  }
+
+  // Output buffered so far must not be written by the child as well.
+  outs().flush();
+  errs().flush();
+  fflush(0);
+
+  pid_t Pid = ::fork();
+  if (Pid < 0) {
+    ErrorMsg = std::string("unable to fork: ") + strerror(errno);
+    ::close(ToChild[0]);
+    ::close(ToChild[1]);
+    ::close(FromChild[0]);
+    ::close(FromChild[1]);
+    return true;
+  }
+
+  if (Pid == 0) {
+    ::close(ToChild[1]);
+    ::close(FromChild[0]);
+    doRemoteTargeting(ToChild[0], FromChild[1]);
+    ::_exit(0);
+  }
+
+  ::close(ToChild[0]);
+  ::close(FromChild[1]);
+  CmdFD = ToChild[1];
+  OutFD = FromChild[0];
+  ChildPID = Pid;
+  IsRunning = true;
+
+  // Writing to a child which died must fail instead of killing lli.
+  ::signal(SIGPIPE, SIG_IGN);
+  return false;
+#else
+  ErrorMsg = "out-of-process execution is not supported on this host";
+  return true;
+#endif
+}
+
+void RemoteTargetExternal::stop() {
+  if (!IsRunning)
+    return;
+  PendingLoads.clear();
+  if (sendMessage(LLI_Terminate, 0, 0))
+    return;
+#ifdef LLVM_ON_UNIX
+  ::close(CmdFD);
+  ::close(OutFD);
+  int Status;
+  ::waitpid(ChildPID, &Status, 0);
+#endif
+  CmdFD = OutFD = -1;
+  ChildPID = 0;
+  IsRunning = false;
+}
+
+static bool isAllocated(ArrayRef<sys::MemoryBlock> Allocations,
+                        uint64_t Address, uint64_t Size) {
+  for (unsigned i = 0, e = Allocations.size(); i != e; ++i) {
+    uint64_t Base = reinterpret_cast<uintptr_t>(Allocations[i].base());
+    if (Address >= Base && Address - Base <= Allocations[i].size() &&
+        Size <= Allocations[i].size() - (Address - Base))
+      return true;
+  }
+  return false;
+}
+
+void RemoteTargetExternal::doRemoteTargeting(int CmdFD, int OutFD) {
+  SmallVector<sys::MemoryBlock, 16> Allocations;
+  std::vector<char> Payload;
+  MessageHeader Header;
+  while (readAll(CmdFD, &Header, sizeof(Header))) {
+    Payload.resize(Header.Size);
+    if (Header.Size && !readAll(CmdFD, &Payload[0], Header.Size))
+      break;
+
+    if (Header.Kind == LLI_AllocateSpace &&
+        Payload.size() == sizeof(AllocateRequest)) {
+      AllocateRequest Request;
+      memcpy(&Request, &Payload[0], sizeof(Request));
+      sys::MemoryBlock *Prev = Allocations.empty() ? 0 : &Allocations.back();
+      std::string Error;
+      sys::MemoryBlock Mem = sys::Memory::AllocateRWX(Request.Size, Prev,
+                                                      &Error);
+      uint64_t Address = reinterpret_cast<uintptr_t>(Mem.base());
+      if (Address && Request.Alignment && Address % Request.Alignment) {
+        sys::Memory::ReleaseRWX(Mem);
+        Address = 0;
+      } else if (Address) {
+        Allocations.push_back(Mem);
+      }
+      if (!writeMessage(OutFD, LLI_AllocateSpace, &Address, sizeof(Address)))
+        break;
+    } else if (Header.Kind == LLI_LoadBatch) {
+      uint32_t Status = 0;
+      for (size_t Pos = 0; Pos != Payload.size();) {
+        LoadHeader Load;
+        if (Payload.size() - Pos < sizeof(Load)) {
+          Status = 1;
+          break;
+        }
+        memcpy(&Load, &Payload[Pos], sizeof(Load));
+        Pos += sizeof(Load);
+        if (Payload.size() - Pos < Load.Size ||
+            !isAllocated(Allocations, Load.Address, Load.Size)) {
+          Status = 1;
+          break;
+        }
+        void *Dest = reinterpret_cast<void *>(
+          static_cast<uintptr_t>(Load.Address));
+        memcpy(Dest, &Payload[Pos], Load.Size);
+        if (Load.IsCode)
+          sys::Memory::InvalidateInstructionCache(Dest, Load.Size);
+        Pos += Load.Size;
+      }
+      if (!writeMessage(OutFD, LLI_LoadBatch, &Status, sizeof(Status)))
+        break;
+    } else if (Header.Kind == LLI_Execute &&
+               Payload.size() == sizeof(uint64_t)) {
+      uint64_t Address;
+      memcpy(&Address, &Payload[0], sizeof(Address));
+      int (*Fn)(void) = (int(*)(void))(intptr_t)Address;
+      int32_t Result = Fn();
+      // lli may exit as soon as it has the result.
+      fflush(0);
+      if (!writeMessage(OutFD, LLI_Execute, &Result, sizeof(Result)))
+        break;
+    } else {
+      // LLI_Terminate, or a request which does not follow the protocol.
+      break;
+    }
+  }
+
+  fflush(0);
+  for (unsigned i = 0, e = Allocations.size(); i != e; ++i)
+    sys::Memory::ReleaseRWX(Allocations[i]);
+}
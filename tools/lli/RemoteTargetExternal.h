@@ -0,0 +1,82 @@
+//===- RemoteTargetExternal.h - LLVM out-of-process JIT execution ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Definition of the RemoteTargetExternal class which executes JITed code in a
+// child process, sending it the code and data over a pair of pipes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef REMOTETARGETEXTERNAL_H
+#define REMOTETARGETEXTERNAL_H
+
+#include "RemoteTarget.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/DataTypes.h"
+#include <vector>
+
+namespace llvm {
+
+class RemoteTargetExternal : public RemoteTarget {
+  // The pipes to and from the child process.
+  int CmdFD;
+  int OutFD;
+#ifdef LLVM_ON_UNIX
+  pid_t ChildPID;
+#else
+  int ChildPID;
+#endif
+
+  // Loads which have not been sent to the child process yet. They are sent
+  // together, with a single reply, before any other request.
+  std::vector<char> PendingLoads;
+
+public:
+  /// Queue the data to be loaded at Address in the child process. The loads
+  /// are sent in batches; a failure may be reported by a later call.
+  virtual bool loadData(uint64_t Address, const void *Data, size_t Size);
+
+  /// Queue the code to be loaded at Address in the child process and be
+  /// prepared for execution.
+  virtual bool loadCode(uint64_t Address, const void *Data, size_t Size);
+
+  virtual bool allocateSpace(size_t Size, unsigned Alignment,
+                             uint64_t &Address);
+
+  /// Execute code in the child process. If the child process dies, the
+  /// target is stopped and ErrorMsg describes how it terminated.
+  virtual bool executeCode(uint64_t Address, int &RetVal);
+
+  /// Fork the child process.
+  virtual bool create();
+
+  /// Terminate the child process and wait for it to exit.
+  virtual void stop();
+
+  /// Whether out-of-process execution is available on the host.
+  static bool isSupported();
+
+  RemoteTargetExternal() : CmdFD(-1), OutFD(-1), ChildPID(0) {}
+  virtual ~RemoteTargetExternal() { if (IsRunning) stop(); }
+
+private:
+  bool queueLoad(uint64_t Address, const void *Data, size_t Size,
+                 bool IsCode);
+  bool flushLoads();
+  bool sendMessage(unsigned Kind, const void *Data, size_t Size);
+  bool receiveMessage(unsigned Kind, void *Data, size_t Size);
+  void childFailed(StringRef Action);
+
+  // Main processing function for the remote target process. Command messages
+  // are received on file descriptor CmdFD and responses come back on OutFD.
+  static void doRemoteTargeting(int CmdFD, int OutFD);
+};
+
+} // end namespace llvm
+
+#endif
@@ -17,6 +17,8 @@
 #include "llvm/IR/LLVMContext.h"
 #include "RecordingMemoryManager.h"
 #include "RemoteTarget.h"
+#include "RemoteTargetExternal.h"
+#include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
@@ -78,6 +80,29 @@ namespace {
     cl::desc("Execute MCJIT'ed code in a separate process."),
     cl::init(false));
 
+  cl::opt<bool> RemoteInProcess("remote-mcjit-in-process",
+    cl::desc("Execute remote MCJIT'ed code in a separate address range of "
+             "this process instead of a child process."),
+    cl::init(false));
+
+  // The compiled code stays in lli when the child process crashes, so it can
+  // be sent to a new child without compiling it again.
+  cl::opt<unsigned> RemoteRestarts("remote-mcjit-restarts",
+    cl::desc("Number of times a crashed remote process is restarted "
+             "(default = 0)"),
+    cl::init(0));
+
+  // Mapping MCJIT sections in large slabs keeps the code of the program close
+  // together, and lets it be backed by huge pages.
+  cl::opt<unsigned> MCJITSlabSize("mcjit-slab-size",
+    cl::desc("Map MCJIT section memory in slabs of at least this many KB "
+             "(default = 0, one mapping per section)"),
+    cl::init(0));
+
+  cl::opt<bool> MCJITHugePages("mcjit-huge-pages",
+    cl::desc("Back MCJIT section memory slabs by huge pages where possible"),
+    cl::init(false));
+
   // Determine optimization level.
   cl::opt<char>
   OptLevel("O",
@@ -266,12 +291,14 @@ void layoutRemoteTargetMemory(RemoteTarget *T, RecordingMemoryManager *JMM) {
     uint64_t Addr = RemoteAddr + Offsets[i].second;
 
     if (i < FirstDataIndex) {
-      T->loadCode(Addr, Offsets[i].first, Sizes[i]);
+      if (T->loadCode(Addr, Offsets[i].first, Sizes[i]))
+        report_fatal_error(T->getErrorMsg());
 
       DEBUG(dbgs() << "  loading code: " << Offsets[i].first
             << " to remote: " << format("%p", Addr) << "\n");
     } else {
-      T->loadData(Addr, Offsets[i].first, Sizes[i]);
+      if (T->loadData(Addr, Offsets[i].first, Sizes[i]))
+        report_fatal_error(T->getErrorMsg());
 
       DEBUG(dbgs() << "  loading data: " << Offsets[i].first
             << " to remote: " << format("%p", Addr) << "\n");
@@ -343,7 +370,8 @@ int main(int argc, char **argv, char * const *envp) {
     if (RemoteMCJIT)
       RTDyldMM = new RecordingMemoryManager();
     else
-      RTDyldMM = new SectionMemoryManager();
+      RTDyldMM = new SectionMemoryManager((size_t)MCJITSlabSize * 1024,
+                                          MCJITHugePages);
     builder.setMCJITMemoryManager(RTDyldMM);
   } else {
     if (RemoteMCJIT) {
@@ -462,34 +490,48 @@ int main(int argc, char **argv, char * const *envp) {
   int Result;
   if (RemoteMCJIT) {
     RecordingMemoryManager *MM = static_cast<RecordingMemoryManager*>(RTDyldMM);
-    // Everything is prepared now, so lay out our program for the target
-    // address space, assign the section addresses to resolve any relocations,
-    // and send it to the target.
-    RemoteTarget Target;
-    Target.create();
-
     // Ask for a pointer to the entry function. This triggers the actual
     // compilation.
     (void)EE->getPointerToFunction(EntryFn);
 
-    // Enough has been compiled to execute the entry function now, so
-    // layout the target memory.
-    layoutRemoteTargetMemory(&Target, MM);
-
-    // Since we're executing in a (at least simulated) remote address space,
-    // we can't use the ExecutionEngine::runFunctionAsMain(). We have to
-    // grab the function address directly here and tell the remote target
-    // to execute the function.
-    // FIXME: argv and envp handling.
-    uint64_t Entry = (uint64_t)EE->getPointerToFunction(EntryFn);
-
-    DEBUG(dbgs() << "Executing '" << EntryFn->getName() << "' at "
-                 << format("%p", Entry) << "\n");
-
-    if (Target.executeCode(Entry, Result))
-      errs() << "ERROR: " << Target.getErrorMsg() << "\n";
+    for (unsigned Restarts = 0;; ++Restarts) {
+      // Everything is prepared now, so lay out our program for the target
+      // address space, assign the section addresses to resolve any
+      // relocations, and send it to the target.
+      OwningPtr<RemoteTarget> Target;
+      if (RemoteInProcess || !RemoteTargetExternal::isSupported())
+        Target.reset(new RemoteTarget());
+      else
+        Target.reset(new RemoteTargetExternal());
+      if (Target->create())
+        report_fatal_error(Target->getErrorMsg());
+
+      // Enough has been compiled to execute the entry function now, so
+      // layout the target memory.
+      layoutRemoteTargetMemory(Target.get(), MM);
+
+      // Since we're executing in a (at least simulated) remote address space,
+      // we can't use the ExecutionEngine::runFunctionAsMain(). We have to
+      // grab the function address directly here and tell the remote target
+      // to execute the function.
+      // FIXME: argv and envp handling.
+      uint64_t Entry = (uint64_t)EE->getPointerToFunction(EntryFn);
+
+      DEBUG(dbgs() << "Executing '" << EntryFn->getName() << "' at "
+                   << format("%p", Entry) << "\n");
+
+      if (!Target->executeCode(Entry, Result)) {
+        Target->stop();
+        break;
+      }
 
-    Target.stop();
+      errs() << "ERROR: " << Target->getErrorMsg() << "\n";
+      Result = 1;
+      Target->stop();
+      if (Restarts == RemoteRestarts)
+        break;
+      errs() << "lli: restarting the remote process\n";
+    }
   } else {
     // Trigger compilation separately so code regions that need to be 
     // invalidated will be known.
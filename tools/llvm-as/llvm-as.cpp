@@ -26,6 +26,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include <memory>
 using namespace llvm;
@@ -50,6 +51,15 @@ static cl::opt<bool>
 DisableVerify("disable-verify", cl::Hidden,
               cl::desc("Do not run verifier on input LLVM (dangerous!)"));
 
+static cl::opt<bool>
+ParseOnly("parse-only",
+          cl::desc("Stop after parsing the input, without verifying or "
+                   "writing it"));
+
+static cl::opt<bool>
+TimePhases("time-phases",
+           cl::desc("Time parsing, verification and bitcode writing"));
+
 static void WriteOutputFile(const Module *M) {
   // Infer the output filename if needed.
   if (OutputFilename.empty()) {
@@ -94,13 +104,21 @@ int main(int argc, char **argv) {
 
   // Parse the file now...
   SMDiagnostic Err;
-  OwningPtr<Module> M(ParseAssemblyFile(InputFilename, Err, Context));
+  OwningPtr<Module> M;
+  {
+    NamedRegionTimer T("Parse", "llvm-as phases", TimePhases);
+    M.reset(ParseAssemblyFile(InputFilename, Err, Context));
+  }
   if (M.get() == 0) {
     Err.print(argv[0], errs());
     return 1;
   }
 
+  if (ParseOnly)
+    return 0;
+
   if (!DisableVerify) {
+    NamedRegionTimer T("Verify", "llvm-as phases", TimePhases);
     std::string Err;
     if (verifyModule(*M.get(), ReturnStatusAction, &Err)) {
       errs() << argv[0]
@@ -112,8 +130,10 @@ int main(int argc, char **argv) {
 
   if (DumpAsm) errs() << "Here's the assembly:\n" << *M.get();
 
-  if (!DisableOutput)
+  if (!DisableOutput) {
+    NamedRegionTimer T("Write bitcode", "llvm-as phases", TimePhases);
     WriteOutputFile(M.get());
+  }
 
   return 0;
 }
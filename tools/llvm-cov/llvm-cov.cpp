@@ -12,13 +12,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/GCOV.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryObject.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/system_error.h"
+#include <algorithm>
+#include <vector>
 using namespace llvm;
 
 static cl::opt<bool>
@@ -30,6 +36,87 @@ InputGCNO("gcno", cl::desc("<input gcno file>"), cl::init(""));
 static cl::opt<std::string>
 InputGCDA("gcda", cl::desc("<input gcda file>"), cl::init(""));
 
+static cl::list<std::string>
+InputFiles(cl::Positional, cl::ZeroOrMore,
+           cl::desc("<input gcda or gcno files>"));
+
+static cl::opt<bool>
+Summary("summary", cl::init(false),
+        cl::desc("Print the executed line counts of each source file "
+                 "instead of the annotated sources"));
+
+static cl::opt<unsigned>
+NumThreads("j", cl::init(1), cl::value_desc("N"),
+           cl::desc("Number of inputs to read in parallel"));
+
+namespace {
+/// CoverageInput - One .gcno/.gcda pair and the line counts read from it.
+struct CoverageInput {
+  std::string GCNO;
+  std::string GCDA;
+  FileInfo FI;
+  std::string Errors;
+  bool Failed;
+
+  CoverageInput(StringRef GCNO, StringRef GCDA)
+    : GCNO(GCNO), GCDA(GCDA), Failed(false) {}
+};
+}
+
+static bool readGCOVFile(GCOVFile &GF, StringRef Filename, StringRef Kind,
+                         OwningPtr<MemoryBuffer> &Buff, raw_ostream &ES) {
+  if (error_code ec = MemoryBuffer::getFileOrSTDIN(Filename, Buff)) {
+    ES << Filename << ": " << ec.message() << "\n";
+    return false;
+  }
+  GCOVBuffer GB(Buff.get());
+  if (!GF.read(GB)) {
+    ES << Filename << ": Invalid " << Kind << " File!\n";
+    return false;
+  }
+  return true;
+}
+
+/// readCoverage - Read the pair of files of Input and collect its line
+/// counts. Errors are kept in Input.Errors so that parallel reads can report
+/// them in input order.
+static void readCoverage(void *Data, unsigned Index) {
+  std::vector<CoverageInput> &Inputs =
+    *static_cast<std::vector<CoverageInput>*>(Data);
+  CoverageInput &Input = Inputs[Index];
+  raw_string_ostream ES(Input.Errors);
+
+  // The functions of GF refer to the contents of the buffers.
+  GCOVFile GF;
+  OwningPtr<MemoryBuffer> GCNO_Buff, GCDA_Buff;
+  if (!readGCOVFile(GF, Input.GCNO, ".gcno", GCNO_Buff, ES) ||
+      (!Input.GCDA.empty() &&
+       !readGCOVFile(GF, Input.GCDA, ".gcda", GCDA_Buff, ES))) {
+    Input.Failed = true;
+    return;
+  }
+
+  if (DumpGCOV)
+    GF.dump();
+  GF.collectLineCounts(Input.FI);
+}
+
+/// addInputFile - Add the .gcno/.gcda pair named by a positional argument.
+/// Either file of the pair may be given; the .gcda file is optional and all
+/// counts are zero without it.
+static void addInputFile(StringRef Filename,
+                         std::vector<CoverageInput> &Inputs) {
+  SmallString<128> Stem(Filename);
+  StringRef Ext = sys::path::extension(Stem);
+  if (Ext == ".gcno" || Ext == ".gcda")
+    sys::path::replace_extension(Stem, "");
+
+  std::string GCNO = (Stem + ".gcno").str();
+  std::string GCDA = (Stem + ".gcda").str();
+  if (Ext != ".gcda" && !sys::fs::exists(GCDA))
+    GCDA.clear();
+  Inputs.push_back(CoverageInput(GCNO, GCDA));
+}
 
 //===----------------------------------------------------------------------===//
 int main(int argc, char **argv) {
@@ -40,39 +127,47 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm cov\n");
 
-  GCOVFile GF;
-  if (InputGCNO.empty())
+  std::vector<std::string> Files(InputFiles.begin(), InputFiles.end());
+  if (InputGCNO.empty() && Files.empty()) {
     errs() << " " << argv[0] << ": No gcov input file!\n";
-
-  OwningPtr<MemoryBuffer> GCNO_Buff;
-  if (error_code ec = MemoryBuffer::getFileOrSTDIN(InputGCNO, GCNO_Buff)) {
-    errs() << InputGCNO << ": " << ec.message() << "\n";
-    return 1;
-  }
-  GCOVBuffer GCNO_GB(GCNO_Buff.take());
-  if (!GF.read(GCNO_GB)) {
-    errs() << "Invalid .gcno File!\n";
     return 1;
   }
 
-  if (!InputGCDA.empty()) {
-    OwningPtr<MemoryBuffer> GCDA_Buff;
-    if (error_code ec = MemoryBuffer::getFileOrSTDIN(InputGCDA, GCDA_Buff)) {
-      errs() << InputGCDA << ": " << ec.message() << "\n";
-      return 1;
-    }
-    GCOVBuffer GCDA_GB(GCDA_Buff.take());
-    if (!GF.read(GCDA_GB)) {
-      errs() << "Invalid .gcda File!\n";
-      return 1;
+  // -dump writes to outs() while reading, so read one input at a time.
+  unsigned Threads = DumpGCOV ? 1 : std::max(1u, unsigned(NumThreads));
+  if (Threads > 1)
+    llvm_start_multithreaded();
+
+  // Inputs are read in batches so that the per-input counts of only one
+  // batch are alive at a time. Each batch is merged in input order.
+  const size_t BatchSize = Threads * 64;
+  FileInfo Total;
+  bool Failed = false;
+  for (size_t Next = 0, NumInputs = Files.size() + !InputGCNO.empty();
+       Next < NumInputs; Next += BatchSize) {
+    std::vector<CoverageInput> Batch;
+    for (size_t i = Next, e = std::min(NumInputs, Next + BatchSize); i != e;
+         ++i) {
+      if (!InputGCNO.empty() && i == 0)
+        Batch.push_back(CoverageInput(InputGCNO, InputGCDA));
+      else
+        addInputFile(Files[i - !InputGCNO.empty()], Batch);
     }
-  }
 
+    llvm_parallel_for(Batch.size(), readCoverage, &Batch, Threads);
 
-  if (DumpGCOV)
-    GF.dump();
+    for (unsigned i = 0, e = Batch.size(); i != e; ++i) {
+      errs() << Batch[i].Errors;
+      if (Batch[i].Failed)
+        Failed = true;
+      else
+        Total.merge(Batch[i].FI);
+    }
+  }
 
-  FileInfo FI;
-  GF.collectLineCounts(FI);
-  return 0;
+  if (Summary)
+    Total.printSummary(outs());
+  else
+    Total.print(outs());
+  return Failed ? 1 : 0;
 }
@@ -52,6 +52,10 @@ static cl::opt<bool>
 PrintInlining("inlining", cl::init(false),
               cl::desc("Print all inlined frames for a given address"));
 
+static cl::opt<unsigned>
+NumThreads("j", cl::init(1),
+           cl::desc("Number of threads used to parse compile units"));
+
 static cl::opt<DIDumpType>
 DumpType("debug-dump", cl::init(DIDT_All),
   cl::desc("Dump of debug sections:"),
@@ -93,7 +97,7 @@ static void DumpInput(const StringRef &Filename) {
     return;
   }
 
-  OwningPtr<DIContext> DICtx(DIContext::getDWARFContext(Obj.get()));
+  OwningPtr<DIContext> DICtx(DIContext::getDWARFContext(Obj.get(), NumThreads));
 
   if (Address == -1ULL) {
     outs() << Filename
@@ -21,15 +21,18 @@
 #include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/ELF.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ParallelJobs.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
 #include <algorithm>
@@ -117,6 +120,10 @@ namespace {
     cl::desc("Print the archive map"));
   cl::alias ArchiveMaps("s", cl::desc("Alias for --print-armap"),
                                  cl::aliasopt(ArchiveMap));
+
+  cl::opt<unsigned> NumThreads("j",
+    cl::desc("Number of input files and archive members to process in "
+             "parallel"), cl::init(1));
   bool PrintAddress = true;
 
   bool MultipleFiles = false;
@@ -125,13 +132,13 @@ namespace {
 }
 
 
-static void error(Twine message, Twine path = Twine()) {
-  errs() << ToolName << ": " << path << ": " << message << ".\n";
+static void error(raw_ostream &ES, Twine message, Twine path = Twine()) {
+  ES << ToolName << ": " << path << ": " << message << ".\n";
 }
 
-static bool error(error_code ec, Twine path = Twine()) {
+static bool error(raw_ostream &ES, error_code ec, Twine path = Twine()) {
   if (ec) {
-    error(ec.message(), path);
+    error(ES, ec.message(), path);
     return true;
   }
   return false;
@@ -179,12 +186,12 @@ namespace {
       return false;
   }
 
-  StringRef CurrentFilename;
   typedef std::vector<NMSymbol> SymbolListT;
-  SymbolListT SymbolList;
 }
 
-static void SortAndPrintSymbolList() {
+static void SortAndPrintSymbolList(SymbolListT &SymbolList,
+                                   StringRef CurrentFilename,
+                                   raw_ostream &OS) {
   if (!NoSort) {
     if (NumericSort)
       std::sort(SymbolList.begin(), SymbolList.end(), CompareSymbolAddress);
@@ -195,13 +202,13 @@ static void SortAndPrintSymbolList() {
   }
 
   if (OutputFormat == posix && MultipleFiles) {
-    outs() << '\n' << CurrentFilename << ":\n";
+    OS << '\n' << CurrentFilename << ":\n";
   } else if (OutputFormat == bsd && MultipleFiles) {
-    outs() << "\n" << CurrentFilename << ":\n";
+    OS << "\n" << CurrentFilename << ":\n";
   } else if (OutputFormat == sysv) {
-    outs() << "\n\nSymbols from " << CurrentFilename << ":\n\n"
-           << "Name                  Value   Class        Type"
-           << "         Size   Line  Section\n";
+    OS << "\n\nSymbols from " << CurrentFilename << ":\n\n"
+       << "Name                  Value   Class        Type"
+       << "         Size   Line  Section\n";
   }
 
   for (SymbolListT::iterator i = SymbolList.begin(),
@@ -228,24 +235,24 @@ static void SortAndPrintSymbolList() {
       format("%08" PRIx64, i->Size).print(SymbolSizeStr, sizeof(SymbolSizeStr));
 
     if (OutputFormat == posix) {
-      outs() << i->Name << " " << i->TypeChar << " "
-             << SymbolAddrStr << SymbolSizeStr << "\n";
+      OS << i->Name << " " << i->TypeChar << " "
+         << SymbolAddrStr << SymbolSizeStr << "\n";
     } else if (OutputFormat == bsd) {
       if (PrintAddress)
-        outs() << SymbolAddrStr << ' ';
+        OS << SymbolAddrStr << ' ';
       if (PrintSize) {
-        outs() << SymbolSizeStr;
+        OS << SymbolSizeStr;
         if (i->Size != object::UnknownAddressOrSize)
-          outs() << ' ';
+          OS << ' ';
       }
-      outs() << i->TypeChar << " " << i->Name  << "\n";
+      OS << i->TypeChar << " " << i->Name  << "\n";
     } else if (OutputFormat == sysv) {
       std::string PaddedName (i->Name);
       while (PaddedName.length () < 20)
         PaddedName += " ";
-      outs() << PaddedName << "|" << SymbolAddrStr << "|   "
-             << i->TypeChar
-             << "  |                  |" << SymbolSizeStr << "|     |\n";
+      OS << PaddedName << "|" << SymbolAddrStr << "|   "
+         << i->TypeChar
+         << "  |                  |" << SymbolSizeStr << "|     |\n";
     }
   }
 
@@ -269,7 +276,8 @@ static char TypeCharForSymbol(GlobalValue &GV) {
                                                            return '?';
 }
 
-static void DumpSymbolNameForGlobalValue(GlobalValue &GV) {
+static void DumpSymbolNameForGlobalValue(GlobalValue &GV,
+                                         SymbolListT &SymbolList) {
   // Private linkage and available_externally linkage don't exist in symtab.
   if (GV.hasPrivateLinkage() ||
       GV.hasLinkerPrivateLinkage() ||
@@ -288,19 +296,83 @@ static void DumpSymbolNameForGlobalValue(GlobalValue &GV) {
   SymbolList.push_back(s);
 }
 
-static void DumpSymbolNamesFromModule(Module *M) {
-  CurrentFilename = M->getModuleIdentifier();
-  std::for_each (M->begin(), M->end(), DumpSymbolNameForGlobalValue);
-  std::for_each (M->global_begin(), M->global_end(),
-                 DumpSymbolNameForGlobalValue);
+static void DumpSymbolNamesFromModule(Module *M, raw_ostream &OS) {
+  SymbolListT SymbolList;
+  for (Module::iterator I = M->begin(), E = M->end(); I != E; ++I)
+    DumpSymbolNameForGlobalValue(*I, SymbolList);
+  for (Module::global_iterator I = M->global_begin(), E = M->global_end();
+       I != E; ++I)
+    DumpSymbolNameForGlobalValue(*I, SymbolList);
   if (!WithoutAliases)
-    std::for_each (M->alias_begin(), M->alias_end(),
-		   DumpSymbolNameForGlobalValue);
+    for (Module::alias_iterator I = M->alias_begin(), E = M->alias_end();
+         I != E; ++I)
+      DumpSymbolNameForGlobalValue(*I, SymbolList);
 
-  SortAndPrintSymbolList();
+  SortAndPrintSymbolList(SymbolList, M->getModuleIdentifier(), OS);
+}
+
+template<class ELFT>
+static error_code
+DumpELFSymbolTable(const ELFObjectFile<ELFT> *obj,
+                   const typename ELFObjectFile<ELFT>::Elf_Shdr *SymTab,
+                   SymbolListT &SymbolList) {
+  typedef typename ELFObjectFile<ELFT>::Elf_Sym_iterator Elf_Sym_iterator;
+  for (Elf_Sym_iterator i = obj->begin_elf_symbols(SymTab),
+                        e = obj->end_elf_symbols(SymTab); i != e; ++i) {
+    uint32_t symflags = obj->getElfSymbolFlags(&*i);
+    if (!DebugSyms && (symflags & SymbolRef::SF_FormatSpecific))
+      continue;
+    NMSymbol s;
+    s.Size = object::UnknownAddressOrSize;
+    s.Address = object::UnknownAddressOrSize;
+    if (PrintSize || SizeSort)
+      s.Size = obj->getElfSymbolSize(&*i);
+    error_code ec;
+    if (PrintAddress && (ec = obj->getElfSymbolAddress(&*i, s.Address)))
+      return ec;
+    if ((ec = obj->getElfSymbolNMTypeChar(SymTab, &*i, s.TypeChar)))
+      return ec;
+    if ((ec = obj->getElfSymbolName(SymTab, &*i, s.Name)))
+      return ec;
+    SymbolList.push_back(s);
+  }
+  return error_code::success();
 }
 
-static void DumpSymbolNamesFromObject(ObjectFile *obj) {
+// ELF objects read their symbol tables directly instead of going through
+// the SymbolRef interface, which makes several virtual calls per symbol.
+template<class ELFT>
+static void DumpSymbolNamesFromELF(const ELFObjectFile<ELFT> *obj,
+                                   raw_ostream &OS, raw_ostream &ES) {
+  typedef typename ELFObjectFile<ELFT>::Elf_Shdr Elf_Shdr;
+  SymbolListT SymbolList;
+  if (DynamicSyms) {
+    if (const Elf_Shdr *DynSymtab = obj->getDynamicSymbolTableSectionHeader())
+      error(ES, DumpELFSymbolTable(obj, DynSymtab, SymbolList),
+            obj->getFileName());
+  } else {
+    ArrayRef<const Elf_Shdr *> SymTabs = obj->getSymbolTableSectionHeaders();
+    for (unsigned i = 0, e = SymTabs.size(); i != e; ++i)
+      if (error(ES, DumpELFSymbolTable(obj, SymTabs[i], SymbolList),
+                obj->getFileName()))
+        break;
+  }
+
+  SortAndPrintSymbolList(SymbolList, obj->getFileName(), OS);
+}
+
+static void DumpSymbolNamesFromObject(ObjectFile *obj, raw_ostream &OS,
+                                      raw_ostream &ES) {
+  if (const ELF32LEObjectFile *ELF = dyn_cast<ELF32LEObjectFile>(obj))
+    return DumpSymbolNamesFromELF(ELF, OS, ES);
+  if (const ELF64LEObjectFile *ELF = dyn_cast<ELF64LEObjectFile>(obj))
+    return DumpSymbolNamesFromELF(ELF, OS, ES);
+  if (const ELF32BEObjectFile *ELF = dyn_cast<ELF32BEObjectFile>(obj))
+    return DumpSymbolNamesFromELF(ELF, OS, ES);
+  if (const ELF64BEObjectFile *ELF = dyn_cast<ELF64BEObjectFile>(obj))
+    return DumpSymbolNamesFromELF(ELF, OS, ES);
+
+  SymbolListT SymbolList;
   error_code ec;
   symbol_iterator ibegin = obj->begin_symbols();
   symbol_iterator iend = obj->end_symbols();
@@ -309,113 +381,186 @@ static void DumpSymbolNamesFromObject(ObjectFile *obj) {
     iend = obj->end_dynamic_symbols();
   }
   for (symbol_iterator i = ibegin; i != iend; i.increment(ec)) {
-    if (error(ec)) break;
+    if (error(ES, ec)) break;
     uint32_t symflags;
-    if (error(i->getFlags(symflags))) break;
+    if (error(ES, i->getFlags(symflags))) break;
     if (!DebugSyms && (symflags & SymbolRef::SF_FormatSpecific))
       continue;
     NMSymbol s;
     s.Size = object::UnknownAddressOrSize;
     s.Address = object::UnknownAddressOrSize;
     if (PrintSize || SizeSort) {
-      if (error(i->getSize(s.Size))) break;
+      if (error(ES, i->getSize(s.Size))) break;
     }
     if (PrintAddress)
-      if (error(i->getAddress(s.Address))) break;
-    if (error(i->getNMTypeChar(s.TypeChar))) break;
-    if (error(i->getName(s.Name))) break;
+      if (error(ES, i->getAddress(s.Address))) break;
+    if (error(ES, i->getNMTypeChar(s.TypeChar))) break;
+    if (error(ES, i->getName(s.Name))) break;
     SymbolList.push_back(s);
   }
 
-  CurrentFilename = obj->getFileName();
-  SortAndPrintSymbolList();
+  SortAndPrintSymbolList(SymbolList, obj->getFileName(), OS);
+}
+
+// Dump the symbols of a bitcode file or archive member.
+static void DumpSymbolNamesFromBitcode(MemoryBuffer *Buffer, raw_ostream &OS,
+                                       std::string *ErrorMessage) {
+  // Each input gets its own context so that inputs can be dumped in parallel.
+  LLVMContext Context;
+  if (Module *Result = ParseBitcodeFile(Buffer, Context, ErrorMessage)) {
+    DumpSymbolNamesFromModule(Result, OS);
+    delete Result;
+  }
+}
+
+static bool PrintArchiveMap(object::Archive *a, raw_ostream &OS,
+                            raw_ostream &ES) {
+  OS << "Archive map" << "\n";
+  for (object::Archive::symbol_iterator i = a->begin_symbols(),
+       e = a->end_symbols(); i != e; ++i) {
+    object::Archive::child_iterator c;
+    StringRef symname;
+    StringRef filename;
+    if (error(ES, i->getMember(c)))
+        return true;
+    if (error(ES, i->getName(symname)))
+        return true;
+    if (error(ES, c->getName(filename)))
+        return true;
+    OS << symname << " in " << filename << "\n";
+  }
+  OS << "\n";
+  return false;
+}
+
+static void DumpSymbolNamesFromMember(object::Archive::child_iterator i,
+                                      raw_ostream &OS, raw_ostream &ES) {
+  OwningPtr<Binary> child;
+  if (i->getAsBinary(child)) {
+    // Try opening it as a bitcode file.
+    OwningPtr<MemoryBuffer> buff;
+    if (error(ES, i->getMemoryBuffer(buff)))
+      return;
+    std::string ErrorMessage;
+    if (buff)
+      DumpSymbolNamesFromBitcode(buff.get(), OS, &ErrorMessage);
+    return;
+  }
+  if (object::ObjectFile *o = dyn_cast<ObjectFile>(child.get())) {
+    OS << o->getFileName() << ":\n";
+    DumpSymbolNamesFromObject(o, OS, ES);
+  }
 }
 
-static void DumpSymbolNamesFromFile(std::string &Filename) {
+static void DumpSymbolNamesFromFile(StringRef Filename, raw_ostream &OS,
+                                    raw_ostream &ES) {
   if (Filename != "-" && !sys::fs::exists(Filename)) {
-    errs() << ToolName << ": '" << Filename << "': " << "No such file\n";
+    ES << ToolName << ": '" << Filename << "': " << "No such file\n";
     return;
   }
 
   OwningPtr<MemoryBuffer> Buffer;
-  if (error(MemoryBuffer::getFileOrSTDIN(Filename, Buffer), Filename))
+  if (error(ES, MemoryBuffer::getFileOrSTDIN(Filename, Buffer), Filename))
     return;
 
   sys::fs::file_magic magic = sys::fs::identify_magic(Buffer->getBuffer());
 
-  LLVMContext &Context = getGlobalContext();
   std::string ErrorMessage;
   if (magic == sys::fs::file_magic::bitcode) {
-    Module *Result = 0;
-    Result = ParseBitcodeFile(Buffer.get(), Context, &ErrorMessage);
-    if (Result) {
-      DumpSymbolNamesFromModule(Result);
-      delete Result;
-    } else {
-      error(ErrorMessage, Filename);
+    DumpSymbolNamesFromBitcode(Buffer.get(), OS, &ErrorMessage);
+    if (!ErrorMessage.empty()) {
+      error(ES, ErrorMessage, Filename);
       return;
     }
   } else if (magic == sys::fs::file_magic::archive) {
     OwningPtr<Binary> arch;
-    if (error(object::createBinary(Buffer.take(), arch), Filename))
+    if (error(ES, object::createBinary(Buffer.take(), arch), Filename))
       return;
 
     if (object::Archive *a = dyn_cast<object::Archive>(arch.get())) {
-      if (ArchiveMap) {
-        outs() << "Archive map" << "\n";
-        for (object::Archive::symbol_iterator i = a->begin_symbols(), 
-             e = a->end_symbols(); i != e; ++i) {
-          object::Archive::child_iterator c;
-          StringRef symname;
-          StringRef filename;
-          if (error(i->getMember(c))) 
-              return;
-          if (error(i->getName(symname)))
-              return;
-          if (error(c->getName(filename)))
-              return;
-          outs() << symname << " in " << filename << "\n";
-        }
-        outs() << "\n";
-      }
+      if (ArchiveMap && PrintArchiveMap(a, OS, ES))
+        return;
 
       for (object::Archive::child_iterator i = a->begin_children(),
-                                           e = a->end_children(); i != e; ++i) {
-        OwningPtr<Binary> child;
-        if (i->getAsBinary(child)) {
-          // Try opening it as a bitcode file.
-          OwningPtr<MemoryBuffer> buff;
-          if (error(i->getMemoryBuffer(buff)))
-            return;
-          Module *Result = 0;
-          if (buff)
-            Result = ParseBitcodeFile(buff.get(), Context, &ErrorMessage);
-
-          if (Result) {
-            DumpSymbolNamesFromModule(Result);
-            delete Result;
-          }
-          continue;
-        }
-        if (object::ObjectFile *o = dyn_cast<ObjectFile>(child.get())) {
-          outs() << o->getFileName() << ":\n";
-          DumpSymbolNamesFromObject(o);
-        }
-      }
+                                           e = a->end_children(); i != e; ++i)
+        DumpSymbolNamesFromMember(i, OS, ES);
     }
   } else if (magic.is_object()) {
     OwningPtr<Binary> obj;
-    if (error(object::createBinary(Buffer.take(), obj), Filename))
+    if (error(ES, object::createBinary(Buffer.take(), obj), Filename))
       return;
     if (object::ObjectFile *o = dyn_cast<ObjectFile>(obj.get()))
-      DumpSymbolNamesFromObject(o);
+      DumpSymbolNamesFromObject(o, OS, ES);
   } else {
-    errs() << ToolName << ": " << Filename << ": "
-           << "unrecognizable file type\n";
+    ES << ToolName << ": " << Filename << ": "
+       << "unrecognizable file type\n";
     return;
   }
 }
 
+namespace {
+  /// An input file or archive member dumped on its own with -j.
+  struct NMJob {
+    StringRef Filename;
+    object::Archive::child_iterator Member;
+    bool IsMember;
+
+    NMJob() : IsMember(false) {}
+    explicit NMJob(StringRef Filename) : Filename(Filename), IsMember(false) {}
+    explicit NMJob(object::Archive::child_iterator Member)
+      : Member(Member), IsMember(true) {}
+  };
+}
+
+static void RunJob(NMJob &Job, raw_ostream &OS, raw_ostream &ES) {
+  if (Job.IsMember)
+    DumpSymbolNamesFromMember(Job.Member, OS, ES);
+  else
+    DumpSymbolNamesFromFile(Job.Filename, OS, ES);
+}
+
+// Dump the input files, splitting archives into their members, using
+// NumThreads threads. The output matches dumping the inputs one by one.
+static void DumpSymbolNamesInParallel() {
+  ParallelJobQueue<NMJob> Jobs(RunJob, NumThreads);
+  for (unsigned i = 0, e = InputFilenames.size(); i != e; ++i) {
+    StringRef Filename = InputFilenames[i];
+    sys::fs::file_magic magic;
+    OwningPtr<MemoryBuffer> Buffer;
+    OwningPtr<Binary> arch;
+    object::Archive *a = 0;
+    // Anything that is not a readable archive is dumped by a single job, which
+    // also reports any errors.
+    if (Filename != "-" && !sys::fs::identify_magic(Filename, magic) &&
+        magic == sys::fs::file_magic::archive &&
+        !MemoryBuffer::getFile(Filename, Buffer) &&
+        !object::createBinary(Buffer.take(), arch))
+      a = dyn_cast<object::Archive>(arch.get());
+    if (!a) {
+      Jobs.add(NMJob(Filename));
+      continue;
+    }
+
+    if (ArchiveMap) {
+      std::string Out, Err;
+      raw_string_ostream OS(Out), ES(Err);
+      bool Failed = PrintArchiveMap(a, OS, ES);
+      OS.flush();
+      ES.flush();
+      Jobs.addOutput(Out, Err);
+      if (Failed)
+        continue;
+    }
+
+    for (object::Archive::child_iterator c = a->begin_children(),
+                                         ce = a->end_children(); c != ce; ++c)
+      Jobs.add(NMJob(c));
+
+    // The members point into the archive, so finish them before it goes away.
+    Jobs.flush();
+  }
+}
+
 int main(int argc, char **argv) {
   // Print a stack trace if we signal out.
   sys::PrintStackTraceOnErrorSignal();
@@ -425,7 +570,7 @@ int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(argc, argv, "llvm symbol table dumper\n");
 
   // llvm-nm only reads binary files.
-  if (error(sys::Program::ChangeStdinToBinary()))
+  if (error(errs(), sys::Program::ChangeStdinToBinary()))
     return 1;
 
   ToolName = argv[0];
@@ -444,7 +589,13 @@ int main(int argc, char **argv) {
   default: MultipleFiles = true;
   }
 
-  std::for_each(InputFilenames.begin(), InputFilenames.end(),
-                DumpSymbolNamesFromFile);
+  if (NumThreads > 1) {
+    llvm_start_multithreaded();
+    DumpSymbolNamesInParallel();
+    return 0;
+  }
+
+  for (unsigned i = 0, e = InputFilenames.size(); i != e; ++i)
+    DumpSymbolNamesFromFile(InputFilenames[i], outs(), errs());
   return 0;
 }
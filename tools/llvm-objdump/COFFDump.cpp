@@ -93,62 +93,63 @@ static unsigned getNumUsedSlots(const UnwindCode &UnwindCode) {
 // the unwind codes array, this function requires that the correct number of
 // slots is provided.
 static void printUnwindCode(ArrayRef<UnwindCode> UCs) {
+  raw_ostream &OS = jobOuts();
   assert(UCs.size() >= getNumUsedSlots(UCs[0]));
-  outs() <<  format("    0x%02x: ", unsigned(UCs[0].u.CodeOffset))
-         << getUnwindCodeTypeName(UCs[0].getUnwindOp());
+  OS <<  format("    0x%02x: ", unsigned(UCs[0].u.CodeOffset))
+     << getUnwindCodeTypeName(UCs[0].getUnwindOp());
   switch (UCs[0].getUnwindOp()) {
   case UOP_PushNonVol:
-    outs() << " " << getUnwindRegisterName(UCs[0].getOpInfo());
+    OS << " " << getUnwindRegisterName(UCs[0].getOpInfo());
     break;
   case UOP_AllocLarge:
     if (UCs[0].getOpInfo() == 0) {
-      outs() << " " << UCs[1].FrameOffset;
+      OS << " " << UCs[1].FrameOffset;
     } else {
-      outs() << " " << UCs[1].FrameOffset
-                       + (static_cast<uint32_t>(UCs[2].FrameOffset) << 16);
+      OS << " " << UCs[1].FrameOffset
+                           + (static_cast<uint32_t>(UCs[2].FrameOffset) << 16);
     }
     break;
   case UOP_AllocSmall:
-    outs() << " " << ((UCs[0].getOpInfo() + 1) * 8);
+    OS << " " << ((UCs[0].getOpInfo() + 1) * 8);
     break;
   case UOP_SetFPReg:
-    outs() << " ";
+    OS << " ";
     break;
   case UOP_SaveNonVol:
-    outs() << " " << getUnwindRegisterName(UCs[0].getOpInfo())
-           << format(" [0x%04x]", 8 * UCs[1].FrameOffset);
+    OS << " " << getUnwindRegisterName(UCs[0].getOpInfo())
+       << format(" [0x%04x]", 8 * UCs[1].FrameOffset);
     break;
   case UOP_SaveNonVolBig:
-    outs() << " " << getUnwindRegisterName(UCs[0].getOpInfo())
-           << format(" [0x%08x]", UCs[1].FrameOffset
-                    + (static_cast<uint32_t>(UCs[2].FrameOffset) << 16));
+    OS << " " << getUnwindRegisterName(UCs[0].getOpInfo())
+       << format(" [0x%08x]", UCs[1].FrameOffset
+                + (static_cast<uint32_t>(UCs[2].FrameOffset) << 16));
     break;
   case UOP_SaveXMM128:
-    outs() << " XMM" << static_cast<uint32_t>(UCs[0].getOpInfo())
-           << format(" [0x%04x]", 16 * UCs[1].FrameOffset);
+    OS << " XMM" << static_cast<uint32_t>(UCs[0].getOpInfo())
+       << format(" [0x%04x]", 16 * UCs[1].FrameOffset);
     break;
   case UOP_SaveXMM128Big:
-    outs() << " XMM" << UCs[0].getOpInfo()
-           << format(" [0x%08x]", UCs[1].FrameOffset
-                           + (static_cast<uint32_t>(UCs[2].FrameOffset) << 16));
+    OS << " XMM" << UCs[0].getOpInfo()
+       << format(" [0x%08x]", UCs[1].FrameOffset
+                + (static_cast<uint32_t>(UCs[2].FrameOffset) << 16));
     break;
   case UOP_PushMachFrame:
-    outs() << " " << (UCs[0].getOpInfo() ? "w/o" : "w")
-           << " error code";
+    OS << " " << (UCs[0].getOpInfo() ? "w/o" : "w")
+       << " error code";
     break;
   }
-  outs() << "\n";
+  OS << "\n";
 }
 
 static void printAllUnwindCodes(ArrayRef<UnwindCode> UCs) {
   for (const UnwindCode *I = UCs.begin(), *E = UCs.end(); I < E; ) {
     unsigned UsedSlots = getNumUsedSlots(*I);
     if (UsedSlots > UCs.size()) {
-      outs() << "Unwind data corrupted: Encountered unwind op "
-             << getUnwindCodeTypeName((*I).getUnwindOp())
-             << " which requires " << UsedSlots
-             << " slots, but only " << UCs.size()
-             << " remaining in buffer";
+      jobOuts() << "Unwind data corrupted: Encountered unwind op "
+                << getUnwindCodeTypeName((*I).getUnwindOp())
+                << " which requires " << UsedSlots
+                << " slots, but only " << UCs.size()
+                << " remaining in buffer";
       return ;
     }
     printUnwindCode(ArrayRef<UnwindCode>(I, E));
@@ -228,12 +229,13 @@ static void printCOFFSymbolAddress(llvm::raw_ostream &Out,
 }
 
 void llvm::printCOFFUnwindInfo(const COFFObjectFile *Obj) {
+  raw_ostream &OS = jobOuts();
   const coff_file_header *Header;
   if (error(Obj->getHeader(Header))) return;
 
   if (Header->Machine != COFF::IMAGE_FILE_MACHINE_AMD64) {
-    errs() << "Unsupported image machine type "
-              "(currently only AMD64 is supported).\n";
+    jobErrs() << "Unsupported image machine type "
+                  "(currently only AMD64 is supported).\n";
     return;
   }
 
@@ -273,25 +275,25 @@ void llvm::printCOFFUnwindInfo(const COFFObjectFile *Obj) {
       const uint64_t SectionOffset = std::distance(RFs.begin(), I)
                                      * sizeof(RuntimeFunction);
 
-      outs() << "Function Table:\n";
+      OS << "Function Table:\n";
 
-      outs() << "  Start Address: ";
-      printCOFFSymbolAddress(outs(), Rels, SectionOffset +
+      OS << "  Start Address: ";
+      printCOFFSymbolAddress(OS, Rels, SectionOffset +
                              /*offsetof(RuntimeFunction, StartAddress)*/ 0,
                              I->StartAddress);
-      outs() << "\n";
+      OS << "\n";
 
-      outs() << "  End Address: ";
-      printCOFFSymbolAddress(outs(), Rels, SectionOffset +
+      OS << "  End Address: ";
+      printCOFFSymbolAddress(OS, Rels, SectionOffset +
                              /*offsetof(RuntimeFunction, EndAddress)*/ 4,
                              I->EndAddress);
-      outs() << "\n";
+      OS << "\n";
 
-      outs() << "  Unwind Info Address: ";
-      printCOFFSymbolAddress(outs(), Rels, SectionOffset +
+      OS << "  Unwind Info Address: ";
+      printCOFFSymbolAddress(OS, Rels, SectionOffset +
                              /*offsetof(RuntimeFunction, UnwindInfoOffset)*/ 8,
                              I->UnwindInfoOffset);
-      outs() << "\n";
+      OS << "\n";
 
       ArrayRef<uint8_t> XContents;
       uint64_t UnwindInfoOffset = 0;
@@ -310,31 +312,31 @@ void llvm::printCOFFUnwindInfo(const COFFObjectFile *Obj) {
       // The casts to int are required in order to output the value as number.
       // Without the casts the value would be interpreted as char data (which
       // results in garbage output).
-      outs() << "  Version: " << static_cast<int>(UI->getVersion()) << "\n";
-      outs() << "  Flags: " << static_cast<int>(UI->getFlags());
+      OS << "  Version: " << static_cast<int>(UI->getVersion()) << "\n";
+      OS << "  Flags: " << static_cast<int>(UI->getFlags());
       if (UI->getFlags()) {
           if (UI->getFlags() & UNW_ExceptionHandler)
-            outs() << " UNW_ExceptionHandler";
+            OS << " UNW_ExceptionHandler";
           if (UI->getFlags() & UNW_TerminateHandler)
-            outs() << " UNW_TerminateHandler";
+            OS << " UNW_TerminateHandler";
           if (UI->getFlags() & UNW_ChainInfo)
-            outs() << " UNW_ChainInfo";
+            OS << " UNW_ChainInfo";
       }
-      outs() << "\n";
-      outs() << "  Size of prolog: "
-             << static_cast<int>(UI->PrologSize) << "\n";
-      outs() << "  Number of Codes: "
-             << static_cast<int>(UI->NumCodes) << "\n";
+      OS << "\n";
+      OS << "  Size of prolog: "
+         << static_cast<int>(UI->PrologSize) << "\n";
+      OS << "  Number of Codes: "
+         << static_cast<int>(UI->NumCodes) << "\n";
       // Maybe this should move to output of UOP_SetFPReg?
       if (UI->getFrameRegister()) {
-        outs() << "  Frame register: "
-                << getUnwindRegisterName(UI->getFrameRegister())
-                << "\n";
-        outs() << "  Frame offset: "
-                << 16 * UI->getFrameOffset()
-                << "\n";
+        OS << "  Frame register: "
+           << getUnwindRegisterName(UI->getFrameRegister())
+           << "\n";
+        OS << "  Frame offset: "
+           << 16 * UI->getFrameOffset()
+           << "\n";
       } else {
-        outs() << "  No frame pointer used\n";
+        OS << "  No frame pointer used\n";
       }
       if (UI->getFlags() & (UNW_ExceptionHandler | UNW_TerminateHandler)) {
         // FIXME: Output exception handler data
@@ -343,13 +345,13 @@ void llvm::printCOFFUnwindInfo(const COFFObjectFile *Obj) {
       }
 
       if (UI->NumCodes)
-        outs() << "  Unwind Codes:\n";
+        OS << "  Unwind Codes:\n";
 
       printAllUnwindCodes(ArrayRef<UnwindCode>(&UI->UnwindCodes[0],
                           UI->NumCodes));
 
-      outs() << "\n\n";
-      outs().flush();
+      OS << "\n\n";
+      OS.flush();
     }
   }
 }
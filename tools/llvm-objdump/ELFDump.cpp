@@ -24,57 +24,58 @@ using namespace llvm::object;
 template<class ELFT>
 void printProgramHeaders(
     const ELFObjectFile<ELFT> *o) {
+  raw_ostream &OS = jobOuts();
   typedef ELFObjectFile<ELFT> ELFO;
-  outs() << "Program Header:\n";
+  OS << "Program Header:\n";
   for (typename ELFO::Elf_Phdr_Iter pi = o->begin_program_headers(),
                                     pe = o->end_program_headers();
                                     pi != pe; ++pi) {
     switch (pi->p_type) {
     case ELF::PT_LOAD:
-      outs() << "    LOAD ";
+      OS << "    LOAD ";
       break;
     case ELF::PT_GNU_STACK:
-      outs() << "   STACK ";
+      OS << "   STACK ";
       break;
     case ELF::PT_GNU_EH_FRAME:
-      outs() << "EH_FRAME ";
+      OS << "EH_FRAME ";
       break;
     case ELF::PT_INTERP:
-      outs() << "  INTERP ";
+      OS << "  INTERP ";
       break;
     case ELF::PT_DYNAMIC:
-      outs() << " DYNAMIC ";
+      OS << " DYNAMIC ";
       break;
     case ELF::PT_PHDR:
-      outs() << "    PHDR ";
+      OS << "    PHDR ";
       break;
     case ELF::PT_TLS:
-      outs() << "    TLS ";
+      OS << "    TLS ";
       break;
     default:
-      outs() << " UNKNOWN ";
+      OS << " UNKNOWN ";
     }
 
     const char *Fmt = ELFT::Is64Bits ? "0x%016" PRIx64 " " : "0x%08" PRIx64 " ";
 
-    outs() << "off    "
-           << format(Fmt, (uint64_t)pi->p_offset)
-           << "vaddr "
-           << format(Fmt, (uint64_t)pi->p_vaddr)
-           << "paddr "
-           << format(Fmt, (uint64_t)pi->p_paddr)
-           << format("align 2**%u\n", CountTrailingZeros_64(pi->p_align))
-           << "         filesz "
-           << format(Fmt, (uint64_t)pi->p_filesz)
-           << "memsz "
-           << format(Fmt, (uint64_t)pi->p_memsz)
-           << "flags "
-           << ((pi->p_flags & ELF::PF_R) ? "r" : "-")
-           << ((pi->p_flags & ELF::PF_W) ? "w" : "-")
-           << ((pi->p_flags & ELF::PF_X) ? "x" : "-")
-           << "\n";
+    OS << "off    "
+       << format(Fmt, (uint64_t)pi->p_offset)
+       << "vaddr "
+       << format(Fmt, (uint64_t)pi->p_vaddr)
+       << "paddr "
+       << format(Fmt, (uint64_t)pi->p_paddr)
+       << format("align 2**%u\n", CountTrailingZeros_64(pi->p_align))
+       << "         filesz "
+       << format(Fmt, (uint64_t)pi->p_filesz)
+       << "memsz "
+       << format(Fmt, (uint64_t)pi->p_memsz)
+       << "flags "
+       << ((pi->p_flags & ELF::PF_R) ? "r" : "-")
+       << ((pi->p_flags & ELF::PF_W) ? "w" : "-")
+       << ((pi->p_flags & ELF::PF_X) ? "x" : "-")
+       << "\n";
   }
-  outs() << "\n";
+  OS << "\n";
 }
 
 void llvm::printELFFileHeader(const object::ObjectFile *Obj) {
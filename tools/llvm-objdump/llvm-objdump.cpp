@@ -48,11 +48,13 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/system_error.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <vector>
 using namespace llvm;
 using namespace object;
 
@@ -123,17 +125,23 @@ static cl::alias
 PrivateHeadersShort("p", cl::desc("Alias for --private-headers"),
                     cl::aliasopt(PrivateHeaders));
 
+static cl::opt<unsigned>
+NumThreads("j", cl::desc("Number of input files and archive members to dump "
+                         "in parallel"), cl::init(1));
+
 static StringRef ToolName;
 
 bool llvm::error(error_code ec) {
+  raw_ostream &OS = jobOuts();
   if (!ec) return false;
 
-  outs() << ToolName << ": error reading file: " << ec.message() << ".\n";
-  outs().flush();
+  OS << ToolName << ": error reading file: " << ec.message() << ".\n";
+  OS.flush();
   return true;
 }
 
-static const Target *getTarget(const ObjectFile *Obj = NULL) {
+static const Target *getTarget(const ObjectFile *Obj,
+                               std::string &TheTripleName) {
   // Figure out the target triple.
   llvm::Triple TheTriple("unknown-unknown-unknown");
   if (TripleName.empty()) {
@@ -147,12 +155,14 @@ static const Target *getTarget(const ObjectFile *Obj = NULL) {
   const Target *TheTarget = TargetRegistry::lookupTarget(ArchName, TheTriple,
                                                          Error);
   if (!TheTarget) {
-    errs() << ToolName << ": " << Error;
+    jobErrs() << ToolName << ": " << Error;
     return 0;
   }
 
-  // Update the triple name and return the found target.
-  TripleName = TheTriple.getTriple();
+  // Return the triple name along with the found target. The -triple option is
+  // left alone, so objects of different architectures can be dumped together
+  // and concurrently.
+  TheTripleName = TheTriple.getTriple();
   return TheTarget;
 }
 
@@ -181,7 +191,7 @@ void llvm::DumpBytes(StringRef bytes) {
   }
 
   output[sizeof(output) - 1] = 0;
-  outs() << output;
+  jobOuts() << output;
 }
 
 bool llvm::RelocAddressLess(RelocationRef a, RelocationRef b) {
@@ -192,7 +202,9 @@ bool llvm::RelocAddressLess(RelocationRef a, RelocationRef b) {
 }
 
 static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
-  const Target *TheTarget = getTarget(Obj);
+  raw_ostream &OS = jobOuts();
+  std::string TripleName;
+  const Target *TheTarget = getTarget(Obj, TripleName);
   // getTarget() will have already issued a diagnostic if necessary, so
   // just bail here if it failed.
   if (!TheTarget)
@@ -262,10 +274,10 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     }
     StringRef name;
     if (error(i->getName(name))) break;
-    outs() << "Disassembly of section ";
+    OS << "Disassembly of section ";
     if (!SegmentName.empty())
-      outs() << SegmentName << ",";
-    outs() << name << ':';
+      OS << SegmentName << ",";
+    OS << name << ':';
 
     // If the section has no symbols just insert a dummy one and disassemble
     // the whole section.
@@ -274,7 +286,7 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
     OwningPtr<const MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
     if (!MRI) {
-      errs() << "error: no register info for target " << TripleName << "\n";
+      jobErrs() << "error: no register info for target " << TripleName << "\n";
       return;
     }
 
@@ -283,7 +295,7 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         TheTarget->createMCAsmInfo(*MRI, TripleName));
 
     if (!AsmInfo) {
-      errs() << "error: no assembly info for target " << TripleName << "\n";
+      jobErrs() << "error: no assembly info for target " << TripleName << "\n";
       return;
     }
 
@@ -291,20 +303,22 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
       TheTarget->createMCSubtargetInfo(TripleName, "", FeaturesStr));
 
     if (!STI) {
-      errs() << "error: no subtarget info for target " << TripleName << "\n";
+      jobErrs() << "error: no subtarget info for target " << TripleName
+                << "\n";
       return;
     }
 
     OwningPtr<const MCDisassembler> DisAsm(
       TheTarget->createMCDisassembler(*STI));
     if (!DisAsm) {
-      errs() << "error: no disassembler for target " << TripleName << "\n";
+      jobErrs() << "error: no disassembler for target " << TripleName << "\n";
       return;
     }
 
     OwningPtr<const MCInstrInfo> MII(TheTarget->createMCInstrInfo());
     if (!MII) {
-      errs() << "error: no instruction info for target " << TripleName << "\n";
+      jobErrs() << "error: no instruction info for target " << TripleName
+                << "\n";
       return;
     }
 
@@ -312,8 +326,8 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     OwningPtr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
                                 AsmPrinterVariant, *AsmInfo, *MII, *MRI, *STI));
     if (!IP) {
-      errs() << "error: no instruction printer for target " << TripleName
-             << '\n';
+      jobErrs() << "error: no instruction printer for target " << TripleName
+                << '\n';
       return;
     }
 
@@ -342,7 +356,7 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         // This symbol has the same address as the next symbol. Skip it.
         continue;
 
-      outs() << '\n' << Symbols[si].second << ":\n";
+      OS << '\n' << Symbols[si].second << ":\n";
 
 #ifndef NDEBUG
         raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
@@ -355,15 +369,15 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
         if (DisAsm->getInstruction(Inst, Size, memoryObject, Index,
                                    DebugOut, nulls())) {
-          outs() << format("%8" PRIx64 ":", SectionAddr + Index);
+          OS << format("%8" PRIx64 ":", SectionAddr + Index);
           if (!NoShowRawInsn) {
-            outs() << "\t";
+            OS << "\t";
             DumpBytes(StringRef(Bytes.data() + Index, Size));
           }
-          IP->printInst(&Inst, outs(), "");
-          outs() << "\n";
+          IP->printInst(&Inst, OS, "");
+          OS << "\n";
         } else {
-          errs() << ToolName << ": warning: invalid instruction encoding\n";
+          jobErrs() << ToolName << ": warning: invalid instruction encoding\n";
           if (Size == 0)
             Size = 1; // skip illegible bytes
         }
@@ -385,8 +399,8 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
           if (error(rel_cur->getTypeName(name))) goto skip_print_rel;
           if (error(rel_cur->getValueString(val))) goto skip_print_rel;
 
-          outs() << format("\t\t\t%8" PRIx64 ": ", SectionAddr + addr) << name
-                 << "\t" << val << "\n";
+          OS << format("\t\t\t%8" PRIx64 ": ", SectionAddr + addr)
+             << name << "\t" << val << "\n";
 
         skip_print_rel:
           ++rel_cur;
@@ -397,6 +411,7 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 }
 
 static void PrintRelocations(const ObjectFile *o) {
+  raw_ostream &OS = jobOuts();
   error_code ec;
   for (section_iterator si = o->begin_sections(), se = o->end_sections();
                                                   si != se; si.increment(ec)){
@@ -405,7 +420,7 @@ static void PrintRelocations(const ObjectFile *o) {
       continue;
     StringRef secname;
     if (error(si->getName(secname))) continue;
-    outs() << "RELOCATION RECORDS FOR [" << secname << "]:\n";
+    OS << "RELOCATION RECORDS FOR [" << secname << "]:\n";
     for (relocation_iterator ri = si->begin_relocations(),
                              re = si->end_relocations();
                              ri != re; ri.increment(ec)) {
@@ -420,15 +435,16 @@ static void PrintRelocations(const ObjectFile *o) {
       if (error(ri->getTypeName(relocname))) continue;
       if (error(ri->getOffset(address))) continue;
       if (error(ri->getValueString(valuestr))) continue;
-      outs() << address << " " << relocname << " " << valuestr << "\n";
+      OS << address << " " << relocname << " " << valuestr << "\n";
     }
-    outs() << "\n";
+    OS << "\n";
   }
 }
 
 static void PrintSectionHeaders(const ObjectFile *o) {
-  outs() << "Sections:\n"
-            "Idx Name          Size      Address          Type\n";
+  raw_ostream &OS = jobOuts();
+  OS << "Sections:\n"
+                "Idx Name          Size      Address          Type\n";
   error_code ec;
   unsigned i = 0;
   for (section_iterator si = o->begin_sections(), se = o->end_sections();
@@ -446,13 +462,14 @@ static void PrintSectionHeaders(const ObjectFile *o) {
     if (error(si->isBSS(BSS))) return;
     std::string Type = (std::string(Text ? "TEXT " : "") +
                         (Data ? "DATA " : "") + (BSS ? "BSS" : ""));
-    outs() << format("%3d %-13s %08" PRIx64 " %016" PRIx64 " %s\n",
+    OS << format("%3d %-13s %08" PRIx64 " %016" PRIx64 " %s\n",
                      i, Name.str().c_str(), Size, Address, Type.c_str());
     ++i;
   }
 }
 
 static void PrintSectionContents(const ObjectFile *o) {
+  raw_ostream &OS = jobOuts();
   error_code ec;
   for (section_iterator si = o->begin_sections(),
                         se = o->end_sections();
@@ -467,9 +484,9 @@ static void PrintSectionContents(const ObjectFile *o) {
     if (error(si->getAddress(BaseAddr))) continue;
     if (error(si->isBSS(BSS))) continue;
 
-    outs() << "Contents of section " << Name << ":\n";
+    OS << "Contents of section " << Name << ":\n";
     if (BSS) {
-      outs() << format("<skipping contents of bss section at [%04" PRIx64
+      OS << format("<skipping contents of bss section at [%04" PRIx64
                        ", %04" PRIx64 ")>\n", BaseAddr,
                        BaseAddr + Contents.size());
       continue;
@@ -477,31 +494,32 @@ static void PrintSectionContents(const ObjectFile *o) {
 
     // Dump out the content as hex and printable ascii characters.
     for (std::size_t addr = 0, end = Contents.size(); addr < end; addr += 16) {
-      outs() << format(" %04" PRIx64 " ", BaseAddr + addr);
+      OS << format(" %04" PRIx64 " ", BaseAddr + addr);
       // Dump line of hex.
       for (std::size_t i = 0; i < 16; ++i) {
         if (i != 0 && i % 4 == 0)
-          outs() << ' ';
+          OS << ' ';
         if (addr + i < end)
-          outs() << hexdigit((Contents[addr + i] >> 4) & 0xF, true)
-                 << hexdigit(Contents[addr + i] & 0xF, true);
+          OS << hexdigit((Contents[addr + i] >> 4) & 0xF, true)
+             << hexdigit(Contents[addr + i] & 0xF, true);
         else
-          outs() << "  ";
+          OS << "  ";
       }
       // Print ascii.
-      outs() << "  ";
+      OS << "  ";
       for (std::size_t i = 0; i < 16 && addr + i < end; ++i) {
         if (std::isprint(static_cast<unsigned char>(Contents[addr + i]) & 0xFF))
-          outs() << Contents[addr + i];
+          OS << Contents[addr + i];
         else
-          outs() << ".";
+          OS << ".";
       }
-      outs() << "\n";
+      OS << "\n";
     }
   }
 }
 
 static void PrintCOFFSymbolTable(const COFFObjectFile *coff) {
+  raw_ostream &OS = jobOuts();
   const coff_file_header *header;
   if (error(coff->getHeader(header))) return;
   int aux_count = 0;
@@ -514,36 +532,38 @@ static void PrintCOFFSymbolTable(const COFFObjectFile *coff) {
         const coff_aux_section_definition *asd;
         if (error(coff->getAuxSymbol<coff_aux_section_definition>(i, asd)))
           return;
-        outs() << "AUX "
-               << format("scnlen 0x%x nreloc %d nlnno %d checksum 0x%x "
-                         , unsigned(asd->Length)
-                         , unsigned(asd->NumberOfRelocations)
-                         , unsigned(asd->NumberOfLinenumbers)
-                         , unsigned(asd->CheckSum))
-               << format("assoc %d comdat %d\n"
-                         , unsigned(asd->Number)
-                         , unsigned(asd->Selection));
+        OS << "AUX "
+           << format("scnlen 0x%x nreloc %d nlnno %d checksum 0x%x "
+                    , unsigned(asd->Length)
+                    , unsigned(asd->NumberOfRelocations)
+                    , unsigned(asd->NumberOfLinenumbers)
+                    , unsigned(asd->CheckSum))
+           << format("assoc %d comdat %d\n"
+                    , unsigned(asd->Number)
+                    , unsigned(asd->Selection));
       } else
-        outs() << "AUX Unknown\n";
+        OS << "AUX Unknown\n";
     } else {
       StringRef name;
       if (error(coff->getSymbol(i, symbol))) return;
       if (error(coff->getSymbolName(symbol, name))) return;
-      outs() << "[" << format("%2d", i) << "]"
-             << "(sec " << format("%2d", int(symbol->SectionNumber)) << ")"
-             << "(fl 0x00)" // Flag bits, which COFF doesn't have.
-             << "(ty " << format("%3x", unsigned(symbol->Type)) << ")"
-             << "(scl " << format("%3x", unsigned(symbol->StorageClass)) << ") "
-             << "(nx " << unsigned(symbol->NumberOfAuxSymbols) << ") "
-             << "0x" << format("%08x", unsigned(symbol->Value)) << " "
-             << name << "\n";
+      OS << "[" << format("%2d", i) << "]"
+         << "(sec " << format("%2d", int(symbol->SectionNumber)) << ")"
+         << "(fl 0x00)" // Flag bits, which COFF doesn't have.
+         << "(ty " << format("%3x", unsigned(symbol->Type)) << ")"
+         << "(scl " << format("%3x", unsigned(symbol->StorageClass))
+         << ") "
+         << "(nx " << unsigned(symbol->NumberOfAuxSymbols) << ") "
+         << "0x" << format("%08x", unsigned(symbol->Value)) << " "
+         << name << "\n";
       aux_count = symbol->NumberOfAuxSymbols;
     }
   }
 }
 
 static void PrintSymbolTable(const ObjectFile *o) {
-  outs() << "SYMBOL TABLE:\n";
+  raw_ostream &OS = jobOuts();
+  OS << "SYMBOL TABLE:\n";
 
   if (const COFFObjectFile *coff = dyn_cast<const COFFObjectFile>(o))
     PrintCOFFSymbolTable(coff);
@@ -587,56 +607,57 @@ static void PrintSymbolTable(const ObjectFile *o) {
       const char *Fmt = o->getBytesInAddress() > 4 ? "%016" PRIx64 :
                                                      "%08" PRIx64;
 
-      outs() << format(Fmt, Address) << " "
-             << GlobLoc // Local -> 'l', Global -> 'g', Neither -> ' '
-             << (Weak ? 'w' : ' ') // Weak?
-             << ' ' // Constructor. Not supported yet.
-             << ' ' // Warning. Not supported yet.
-             << ' ' // Indirect reference to another symbol.
-             << Debug // Debugging (d) or dynamic (D) symbol.
-             << FileFunc // Name of function (F), file (f) or object (O).
-             << ' ';
+      OS << format(Fmt, Address) << " "
+         << GlobLoc // Local -> 'l', Global -> 'g', Neither -> ' '
+         << (Weak ? 'w' : ' ') // Weak?
+         << ' ' // Constructor. Not supported yet.
+         << ' ' // Warning. Not supported yet.
+         << ' ' // Indirect reference to another symbol.
+         << Debug // Debugging (d) or dynamic (D) symbol.
+         << FileFunc // Name of function (F), file (f) or object (O).
+         << ' ';
       if (Absolute)
-        outs() << "*ABS*";
+        OS << "*ABS*";
       else if (Section == o->end_sections())
-        outs() << "*UND*";
+        OS << "*UND*";
       else {
         if (const MachOObjectFile *MachO =
             dyn_cast<const MachOObjectFile>(o)) {
           DataRefImpl DR = Section->getRawDataRefImpl();
           StringRef SegmentName = MachO->getSectionFinalSegmentName(DR);
-          outs() << SegmentName << ",";
+          OS << SegmentName << ",";
         }
         StringRef SectionName;
         if (error(Section->getName(SectionName)))
           SectionName = "";
-        outs() << SectionName;
+        OS << SectionName;
       }
-      outs() << '\t'
-             << format("%08" PRIx64 " ", Size)
-             << Name
-             << '\n';
+      OS << '\t'
+         << format("%08" PRIx64 " ", Size)
+         << Name
+         << '\n';
     }
   }
 }
 
 static void PrintUnwindInfo(const ObjectFile *o) {
-  outs() << "Unwind info:\n\n";
+  jobOuts() << "Unwind info:\n\n";
 
   if (const COFFObjectFile *coff = dyn_cast<COFFObjectFile>(o)) {
     printCOFFUnwindInfo(coff);
   } else {
     // TODO: Extract DWARF dump tool to objdump.
-    errs() << "This operation is only currently supported "
-              "for COFF object files.\n";
+    jobErrs() << "This operation is only currently supported "
+                  "for COFF object files.\n";
     return;
   }
 }
 
 static void DumpObject(const ObjectFile *o) {
-  outs() << '\n';
-  outs() << o->getFileName()
-         << ":\tfile format " << o->getFileFormatName() << "\n\n";
+  raw_ostream &OS = jobOuts();
+  OS << '\n';
+  OS << o->getFileName()
+     << ":\tfile format " << o->getFileFormatName() << "\n\n";
 
   if (Disassemble)
     DisassembleObject(o, Relocations);
@@ -654,31 +675,35 @@ static void DumpObject(const ObjectFile *o) {
     printELFFileHeader(o);
 }
 
+/// @brief Dump the object file \a i of \a a.
+static void DumpArchiveMember(const Archive *a, Archive::child_iterator i) {
+  OwningPtr<Binary> child;
+  if (error_code ec = i->getAsBinary(child)) {
+    // Ignore non-object files.
+    if (ec != object_error::invalid_file_type)
+      jobErrs() << ToolName << ": '" << a->getFileName() << "': "
+                << ec.message() << ".\n";
+    return;
+  }
+  if (ObjectFile *o = dyn_cast<ObjectFile>(child.get()))
+    DumpObject(o);
+  else
+    jobErrs() << ToolName << ": '" << a->getFileName() << "': "
+              << "Unrecognized file type.\n";
+}
+
 /// @brief Dump each object file in \a a;
 static void DumpArchive(const Archive *a) {
   for (Archive::child_iterator i = a->begin_children(),
-                               e = a->end_children(); i != e; ++i) {
-    OwningPtr<Binary> child;
-    if (error_code ec = i->getAsBinary(child)) {
-      // Ignore non-object files.
-      if (ec != object_error::invalid_file_type)
-        errs() << ToolName << ": '" << a->getFileName() << "': " << ec.message()
-               << ".\n";
-      continue;
-    }
-    if (ObjectFile *o = dyn_cast<ObjectFile>(child.get()))
-      DumpObject(o);
-    else
-      errs() << ToolName << ": '" << a->getFileName() << "': "
-              << "Unrecognized file type.\n";
-  }
+                               e = a->end_children(); i != e; ++i)
+    DumpArchiveMember(a, i);
 }
 
 /// @brief Open file and figure out how to dump it.
 static void DumpInput(StringRef file) {
   // If file isn't stdin, check that it exists.
   if (file != "-" && !sys::fs::exists(file)) {
-    errs() << ToolName << ": '" << file << "': " << "No such file\n";
+    jobErrs() << ToolName << ": '" << file << "': " << "No such file\n";
     return;
   }
 
@@ -690,7 +715,7 @@ static void DumpInput(StringRef file) {
   // Attempt to open the binary.
   OwningPtr<Binary> binary;
   if (error_code ec = createBinary(file, binary)) {
-    errs() << ToolName << ": '" << file << "': " << ec.message() << ".\n";
+    jobErrs() << ToolName << ": '" << file << "': " << ec.message() << ".\n";
     return;
   }
 
@@ -699,7 +724,57 @@ static void DumpInput(StringRef file) {
   else if (ObjectFile *o = dyn_cast<ObjectFile>(binary.get()))
     DumpObject(o);
   else
-    errs() << ToolName << ": '" << file << "': " << "Unrecognized file type.\n";
+    jobErrs() << ToolName << ": '" << file << "': "
+              << "Unrecognized file type.\n";
+}
+
+namespace {
+/// An input file or archive member dumped on its own with -j.
+struct DumpJob {
+  StringRef File;
+  const Archive *Arc;
+  Archive::child_iterator Member;
+
+  DumpJob() : Arc(0) {}
+  explicit DumpJob(StringRef File) : File(File), Arc(0) {}
+  DumpJob(const Archive *Arc, Archive::child_iterator Member)
+    : Arc(Arc), Member(Member) {}
+};
+}
+
+static void RunJob(DumpJob &Job, raw_ostream &, raw_ostream &) {
+  if (Job.Arc)
+    DumpArchiveMember(Job.Arc, Job.Member);
+  else
+    DumpInput(Job.File);
+}
+
+/// @brief Dump the inputs on NumThreads threads, splitting archives into their
+/// members. The output matches dumping the inputs one by one.
+static void DumpInputsInParallel() {
+  ParallelJobQueue<DumpJob> Jobs(RunJob, NumThreads);
+  for (unsigned i = 0, e = InputFilenames.size(); i != e; ++i) {
+    StringRef file = InputFilenames[i];
+    sys::fs::file_magic magic;
+    OwningPtr<Binary> binary;
+    const Archive *a = 0;
+    // Anything that is not a readable archive is dumped by a single job, which
+    // also reports any errors.
+    if (file != "-" && !sys::fs::identify_magic(file, magic) &&
+        magic == sys::fs::file_magic::archive && !createBinary(file, binary))
+      a = dyn_cast<Archive>(binary.get());
+    if (!a) {
+      Jobs.add(DumpJob(file));
+      continue;
+    }
+
+    for (Archive::child_iterator c = a->begin_children(),
+                                 ce = a->end_children(); c != ce; ++c)
+      Jobs.add(DumpJob(a, c));
+
+    // The members point into the archive, so finish them before it goes away.
+    Jobs.flush();
+  }
 }
 
 int main(int argc, char **argv) {
@@ -737,6 +812,14 @@ int main(int argc, char **argv) {
     return 2;
   }
 
+  // The Mach-O disassembler picks its target through the -triple option, so
+  // it always runs serially.
+  if (NumThreads > 1 && !(MachOOpt && Disassemble)) {
+    llvm_start_multithreaded();
+    DumpInputsInParallel();
+    return 0;
+  }
+
   std::for_each(InputFilenames.begin(), InputFilenames.end(),
                 DumpInput);
 
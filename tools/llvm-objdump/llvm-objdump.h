@@ -14,6 +14,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/MemoryObject.h"
+#include "llvm/Support/ParallelJobs.h"
 
 namespace llvm {
 
@@ -23,12 +24,14 @@ namespace object {
   class RelocationRef;
 }
 class error_code;
+class raw_ostream;
 
 extern cl::opt<std::string> TripleName;
 extern cl::opt<std::string> ArchName;
 
 // Various helper functions.
 bool error(error_code ec);
+
 bool RelocAddressLess(object::RelocationRef a, object::RelocationRef b);
 void DumpBytes(StringRef bytes);
 void DisassembleInputMachO(StringRef Filename);
@@ -939,7 +939,7 @@ void COFFDumper::printUnwindInfo(
     for (const UnwindCode *I = UCs.begin(), *E = UCs.end(); I < E; ++I) {
       unsigned UsedSlots = getNumUsedSlots(*I);
       if (UsedSlots > UCs.size()) {
-        errs() << "Corrupt unwind data";
+        jobErrs() << "Corrupt unwind data";
         return;
       }
       printUnwindCode(UI, ArrayRef<UnwindCode>(I, E));
@@ -972,14 +972,15 @@ void COFFDumper::printUnwindCode(const Win64EH::UnwindInfo& UI,
                                  ArrayRef<UnwindCode> UCs) {
   assert(UCs.size() >= getNumUsedSlots(UCs[0]));
 
-  W.startLine() << format("0x%02X: ", unsigned(UCs[0].u.CodeOffset))
-                << getUnwindCodeTypeName(UCs[0].getUnwindOp());
+  raw_ostream &OS = W.startLine();
+  OS << format("0x%02X: ", unsigned(UCs[0].u.CodeOffset))
+     << getUnwindCodeTypeName(UCs[0].getUnwindOp());
 
   uint32_t AllocSize = 0;
 
   switch (UCs[0].getUnwindOp()) {
   case UOP_PushNonVol:
-    outs() << " reg=" << getUnwindRegisterName(UCs[0].getOpInfo());
+    OS << " reg=" << getUnwindRegisterName(UCs[0].getOpInfo());
     break;
 
   case UOP_AllocLarge:
@@ -988,39 +989,39 @@ void COFFDumper::printUnwindCode(const Win64EH::UnwindInfo& UI,
     } else {
       AllocSize = getLargeSlotValue(UCs);
     }
-    outs() << " size=" << AllocSize;
+    OS << " size=" << AllocSize;
     break;
   case UOP_AllocSmall:
-    outs() << " size=" << ((UCs[0].getOpInfo() + 1) * 8);
+    OS << " size=" << ((UCs[0].getOpInfo() + 1) * 8);
     break;
   case UOP_SetFPReg:
     if (UI.getFrameRegister() == 0) {
-      outs() << " reg=<invalid>";
+      OS << " reg=<invalid>";
     } else {
-      outs() << " reg=" << getUnwindRegisterName(UI.getFrameRegister())
-             << format(", offset=0x%X", UI.getFrameOffset() * 16);
+      OS << " reg=" << getUnwindRegisterName(UI.getFrameRegister())
+         << format(", offset=0x%X", UI.getFrameOffset() * 16);
     }
     break;
   case UOP_SaveNonVol:
-    outs() << " reg=" << getUnwindRegisterName(UCs[0].getOpInfo())
-           << format(", offset=0x%X", UCs[1].FrameOffset * 8);
+    OS << " reg=" << getUnwindRegisterName(UCs[0].getOpInfo())
+       << format(", offset=0x%X", UCs[1].FrameOffset * 8);
     break;
   case UOP_SaveNonVolBig:
-    outs() << " reg=" << getUnwindRegisterName(UCs[0].getOpInfo())
-           << format(", offset=0x%X", getLargeSlotValue(UCs));
+    OS << " reg=" << getUnwindRegisterName(UCs[0].getOpInfo())
+       << format(", offset=0x%X", getLargeSlotValue(UCs));
     break;
   case UOP_SaveXMM128:
-    outs() << " reg=XMM" << static_cast<uint32_t>(UCs[0].getOpInfo())
-           << format(", offset=0x%X", UCs[1].FrameOffset * 16);
+    OS << " reg=XMM" << static_cast<uint32_t>(UCs[0].getOpInfo())
+       << format(", offset=0x%X", UCs[1].FrameOffset * 16);
     break;
   case UOP_SaveXMM128Big:
-    outs() << " reg=XMM" << static_cast<uint32_t>(UCs[0].getOpInfo())
-           << format(", offset=0x%X", getLargeSlotValue(UCs));
+    OS << " reg=XMM" << static_cast<uint32_t>(UCs[0].getOpInfo())
+       << format(", offset=0x%X", getLargeSlotValue(UCs));
     break;
   case UOP_PushMachFrame:
-    outs() << " errcode=" << (UCs[0].getOpInfo() == 0 ? "no" : "yes");
+    OS << " errcode=" << (UCs[0].getOpInfo() == 0 ? "no" : "yes");
     break;
   }
 
-  outs() << "\n";
+  OS << "\n";
 }
@@ -826,7 +826,7 @@ void ELFDumper<ELFT>::printNeededLibraries() {
                                   I != E; ++I) {
     StringRef Path;
     I->getPath(Path);
-    outs() << "  " << Path << "\n";
+    W.getOStream() << "  " << Path << "\n";
   }
 }
 
@@ -37,9 +37,11 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/system_error.h"
 
 #include <string>
+#include <vector>
 
 
 using namespace llvm;
@@ -128,6 +130,11 @@ namespace opts {
   // -expand-relocs
   cl::opt<bool> ExpandRelocs("expand-relocs",
     cl::desc("Expand each shown relocation to multiple lines"));
+
+  // -j
+  cl::opt<unsigned> NumThreads("j",
+    cl::desc("Number of input files and archive members to dump in parallel"),
+    cl::init(1));
 } // namespace opts
 
 namespace llvm {
@@ -136,8 +143,9 @@ bool error(error_code EC) {
   if (!EC)
     return false;
 
-  outs() << "\nError reading file: " << EC.message() << ".\n";
-  outs().flush();
+  raw_ostream &OS = jobOuts();
+  OS << "\nError reading file: " << EC.message() << ".\n";
+  OS.flush();
   return true;
 }
 
@@ -155,15 +163,16 @@ static void reportError(StringRef Input, error_code EC) {
   if (Input == "-")
     Input = "<stdin>";
 
-  errs() << Input << ": " << EC.message() << "\n";
-  errs().flush();
+  raw_ostream &ES = jobErrs();
+  ES << Input << ": " << EC.message() << "\n";
+  ES.flush();
 }
 
 static void reportError(StringRef Input, StringRef Message) {
   if (Input == "-")
     Input = "<stdin>";
 
-  errs() << Input << ": " << Message << "\n";
+  jobErrs() << Input << ": " << Message << "\n";
 }
 
 /// @brief Creates an format-specific object file dumper.
@@ -186,22 +195,22 @@ static error_code createDumper(const ObjectFile *Obj,
 
 /// @brief Dumps the specified object file.
 static void dumpObject(const ObjectFile *Obj) {
-  StreamWriter Writer(outs());
+  StreamWriter Writer(jobOuts());
   OwningPtr<ObjDumper> Dumper;
   if (error_code EC = createDumper(Obj, Writer, Dumper)) {
     reportError(Obj->getFileName(), EC);
     return;
   }
 
-  outs() << '\n';
-  outs() << "File: " << Obj->getFileName() << "\n";
-  outs() << "Format: " << Obj->getFileFormatName() << "\n";
-  outs() << "Arch: "
-         << Triple::getArchTypeName((llvm::Triple::ArchType)Obj->getArch())
-         << "\n";
-  outs() << "AddressSize: " << (8*Obj->getBytesInAddress()) << "bit\n";
+  jobOuts() << '\n';
+  jobOuts() << "File: " << Obj->getFileName() << "\n";
+  jobOuts() << "Format: " << Obj->getFileFormatName() << "\n";
+  jobOuts() << "Arch: "
+            << Triple::getArchTypeName((llvm::Triple::ArchType)Obj->getArch())
+            << "\n";
+  jobOuts() << "AddressSize: " << (8*Obj->getBytesInAddress()) << "bit\n";
   if (Obj->isELF())
-    outs() << "LoadName: " << Obj->getLoadName() << "\n";
+    jobOuts() << "LoadName: " << Obj->getLoadName() << "\n";
 
   if (opts::FileHeaders)
     Dumper->printFileHeaders();
@@ -224,24 +233,30 @@ static void dumpObject(const ObjectFile *Obj) {
 }
 
 
+/// @brief Dumps the object file \a ArcI of \a Arc.
+static void dumpArchiveMember(const Archive *Arc,
+                              Archive::child_iterator ArcI) {
+  OwningPtr<Binary> child;
+  if (error_code EC = ArcI->getAsBinary(child)) {
+    // Ignore non-object files.
+    if (EC != object_error::invalid_file_type)
+      reportError(Arc->getFileName(), EC.message());
+    return;
+  }
+
+  if (ObjectFile *Obj = dyn_cast<ObjectFile>(child.get()))
+    dumpObject(Obj);
+  else
+    reportError(Arc->getFileName(), readobj_error::unrecognized_file_format);
+}
+
+
 /// @brief Dumps each object file in \a Arc;
 static void dumpArchive(const Archive *Arc) {
   for (Archive::child_iterator ArcI = Arc->begin_children(),
                                ArcE = Arc->end_children();
-                               ArcI != ArcE; ++ArcI) {
-    OwningPtr<Binary> child;
-    if (error_code EC = ArcI->getAsBinary(child)) {
-      // Ignore non-object files.
-      if (EC != object_error::invalid_file_type)
-        reportError(Arc->getFileName(), EC.message());
-      continue;
-    }
-
-    if (ObjectFile *Obj = dyn_cast<ObjectFile>(child.get()))
-      dumpObject(Obj);
-    else
-      reportError(Arc->getFileName(), readobj_error::unrecognized_file_format);
-  }
+                               ArcI != ArcE; ++ArcI)
+    dumpArchiveMember(Arc, ArcI);
 }
 
 
@@ -269,6 +284,59 @@ static void dumpInput(StringRef File) {
 }
 
 
+namespace {
+  /// An input file or archive member dumped on its own with -j.
+  struct DumpJob {
+    StringRef File;
+    const Archive *Arc;
+    Archive::child_iterator Member;
+
+    DumpJob() : Arc(0) {}
+    explicit DumpJob(StringRef File) : File(File), Arc(0) {}
+    DumpJob(const Archive *Arc, Archive::child_iterator Member)
+      : Arc(Arc), Member(Member) {}
+  };
+}
+
+
+static void runJob(DumpJob &Job, raw_ostream &, raw_ostream &) {
+  if (Job.Arc)
+    dumpArchiveMember(Job.Arc, Job.Member);
+  else
+    dumpInput(Job.File);
+}
+
+
+/// @brief Dumps the inputs on opts::NumThreads threads, splitting archives
+/// into their members. The output matches dumping the inputs one by one.
+static void dumpInputsInParallel() {
+  ParallelJobQueue<DumpJob> Jobs(runJob, opts::NumThreads);
+  for (unsigned i = 0, e = opts::InputFilenames.size(); i != e; ++i) {
+    StringRef File = opts::InputFilenames[i];
+    sys::fs::file_magic Magic;
+    OwningPtr<Binary> Binary;
+    const Archive *Arc = 0;
+    // Anything that is not a readable archive is dumped by a single job, which
+    // also reports any errors.
+    if (File != "-" && !sys::fs::identify_magic(File, Magic) &&
+        Magic == sys::fs::file_magic::archive && !createBinary(File, Binary))
+      Arc = dyn_cast<Archive>(Binary.get());
+    if (!Arc) {
+      Jobs.add(DumpJob(File));
+      continue;
+    }
+
+    for (Archive::child_iterator ArcI = Arc->begin_children(),
+                                 ArcE = Arc->end_children();
+                                 ArcI != ArcE; ++ArcI)
+      Jobs.add(DumpJob(Arc, ArcI));
+
+    // The members point into the archive, so finish them before it goes away.
+    Jobs.flush();
+  }
+}
+
+
 int main(int argc, const char *argv[]) {
   sys::PrintStackTraceOnErrorSignal();
   PrettyStackTraceProgram X(argc, argv);
@@ -286,6 +354,12 @@ int main(int argc, const char *argv[]) {
   if (opts::InputFilenames.size() == 0)
     opts::InputFilenames.push_back("-");
 
+  if (opts::NumThreads > 1) {
+    llvm_start_multithreaded();
+    dumpInputsInParallel();
+    return 0;
+  }
+
   std::for_each(opts::InputFilenames.begin(), opts::InputFilenames.end(),
                 dumpInput);
 
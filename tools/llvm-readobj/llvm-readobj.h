@@ -11,6 +11,7 @@
 #define LLVM_TOOLS_READ_OBJ_H
 
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ParallelJobs.h"
 #include <string>
 
 namespace llvm {
@@ -19,9 +20,11 @@ namespace llvm {
   }
 
   class error_code;
+  class raw_ostream;
 
   // Various helper functions.
   bool error(error_code ec);
+
   bool relocAddressLess(object::RelocationRef A,
                         object::RelocationRef B);
 } // namespace llvm
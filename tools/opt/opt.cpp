@@ -548,6 +548,33 @@ static TargetMachine* GetTargetMachine(Triple TheTriple) {
                                         GetCodeGenOptLevel());
 }
 
+//===----------------------------------------------------------------------===//
+// Pass registration.
+//
+/// initializeOptPasses - Register every pass opt can run by name.  main defers
+/// this until a pass is needed, so that runs that end before any pass is
+/// scheduled, like -version or a bad command line, do not pay for it.
+static void initializeOptPasses(PassRegistry &Registry) {
+  initializeCore(Registry);
+  initializeDebugIRPass(Registry);
+  initializeScalarOpts(Registry);
+  initializeObjCARCOpts(Registry);
+  initializeVectorization(Registry);
+  initializeIPO(Registry);
+  initializeAnalysis(Registry);
+  initializeIPA(Registry);
+  initializeTransformUtils(Registry);
+  initializeInstCombine(Registry);
+  initializeInstrumentation(Registry);
+  initializeTarget(Registry);
+}
+
+/// registerPassOptions - Register the passes, which adds their names to the
+/// options PassList accepts.
+static void registerPassOptions() {
+  PassRegistry::getPassRegistry()->runLazyInitializers();
+}
+
 //===----------------------------------------------------------------------===//
 // main for opt
 //
@@ -564,20 +591,10 @@ int main(int argc, char **argv) {
   InitializeAllTargets();
   InitializeAllTargetMCs();
 
-  // Initialize passes
-  PassRegistry &Registry = *PassRegistry::getPassRegistry();
-  initializeCore(Registry);
-  initializeDebugIRPass(Registry);
-  initializeScalarOpts(Registry);
-  initializeObjCARCOpts(Registry);
-  initializeVectorization(Registry);
-  initializeIPO(Registry);
-  initializeAnalysis(Registry);
-  initializeIPA(Registry);
-  initializeTransformUtils(Registry);
-  initializeInstCombine(Registry);
-  initializeInstrumentation(Registry);
-  initializeTarget(Registry);
+  // Initialize passes once one is needed, and when the command line names an
+  // option that may be a pass.
+  PassRegistry::getPassRegistry()->addLazyInitializer(initializeOptPasses);
+  cl::AddLazyOptionRegistrar(registerPassOptions);
 
   cl::ParseCommandLineOptions(argc, argv,
     "llvm .bc -> .bc modular optimizer and analysis printer\n");
@@ -0,0 +1,107 @@
+//===- llvm/unittest/ADT/StatisticTest.cpp - Statistic unit tests ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+// Test the statistics whether or not this is an asserts build.
+#define LLVM_ENABLE_STATS 1
+#define DEBUG_TYPE "unittest"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Config/config.h"
+#include "llvm/Support/Threading.h"
+#include "gtest/gtest.h"
+#include <cstring>
+using namespace llvm;
+
+STATISTIC(Counter, "Counts things");
+STATISTIC(Counter2, "Counts other things");
+STATISTIC(Counter3, "Counts things on short-lived threads");
+
+namespace {
+
+unsigned getSnapshotValue(const char *Desc) {
+  std::vector<StatisticSnapshot> Stats = GetStatistics();
+  for (unsigned i = 0, e = Stats.size(); i != e; ++i)
+    if (std::strcmp(Stats[i].Desc, Desc) == 0)
+      return Stats[i].Value;
+  return ~0U;
+}
+
+void BumpCounter(void *, unsigned) {
+  for (unsigned i = 0; i != 1000; ++i)
+    ++Counter2;
+}
+
+void BumpCounter3(void *) {
+  for (unsigned i = 0; i != 10; ++i)
+    ++Counter3;
+}
+
+// Bump Counter3 and check that the counts stay in a per-thread counter
+// instead of going to the shared value.
+void BumpCounter3Sharded(void *Data) {
+  unsigned Before = Counter3.Value;
+  for (unsigned i = 0; i != 10; ++i)
+    ++Counter3;
+  *static_cast<bool*>(Data) = Counter3.Value == Before;
+}
+
+TEST(StatisticTest, Count) {
+  EnableStatistics();
+
+  Counter = 0;
+  EXPECT_EQ(0u, Counter);
+  Counter++;
+  Counter++;
+  EXPECT_EQ(2u, Counter);
+  Counter += 5;
+  Counter -= 1;
+  EXPECT_EQ(6u, Counter);
+  Counter *= 3;
+  Counter /= 2;
+  EXPECT_EQ(9u, Counter);
+  EXPECT_EQ(9u, getSnapshotValue("Counts things"));
+
+  ResetStatistics();
+  EXPECT_EQ(0u, Counter);
+  EXPECT_EQ(0u, getSnapshotValue("Counts things"));
+}
+
+TEST(StatisticTest, Threads) {
+  EnableStatistics();
+
+  Counter2 = 0;
+  llvm_parallel_for(8, BumpCounter, 0, 4);
+  EXPECT_EQ(8000u, Counter2);
+  EXPECT_EQ(8000u, getSnapshotValue("Counts other things"));
+
+  ResetStatistics();
+  EXPECT_EQ(0u, Counter2);
+  ++Counter2;
+  EXPECT_EQ(1u, Counter2);
+}
+
+#if LLVM_ENABLE_THREADS != 0 && defined(HAVE_PTHREAD_H)
+// Threads that have exited give their counters back, so that more threads than
+// there are sets of counters can come and go without losing counts or falling
+// back to updating the shared value.
+TEST(StatisticTest, ShortLivedThreads) {
+  EnableStatistics();
+
+  Counter3 = 0;
+  for (unsigned i = 0; i != 300; ++i)
+    llvm_execute_on_thread(BumpCounter3, 0);
+  EXPECT_EQ(3000u, Counter3);
+
+  bool Sharded = false;
+  llvm_execute_on_thread(BumpCounter3Sharded, &Sharded);
+  EXPECT_TRUE(Sharded);
+  EXPECT_EQ(3010u, Counter3);
+}
+#endif
+
+} // end anonymous namespace
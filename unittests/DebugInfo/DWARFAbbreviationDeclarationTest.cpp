@@ -0,0 +1,85 @@
+//===- llvm/unittest/DebugInfo/DWARFAbbreviationDeclarationTest.cpp -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../../lib/DebugInfo/DWARFAbbreviationDeclaration.h"
+#include "llvm/DebugInfo/DWARFFormValue.h"
+#include "llvm/Support/Dwarf.h"
+#include "gtest/gtest.h"
+using namespace llvm;
+using namespace dwarf;
+
+namespace {
+
+bool extractAbbrev(const char *Data, size_t Size,
+                   DWARFAbbreviationDeclaration &Abbrev) {
+  DataExtractor Extractor(StringRef(Data, Size), true, 8);
+  uint32_t Offset = 0;
+  return Abbrev.extract(Extractor, &Offset);
+}
+
+TEST(DWARFAbbreviationDeclaration, FixedOffsetsStopAfterVariableForm) {
+  const char Data[] = {
+    1, DW_TAG_subprogram, DW_CHILDREN_no,
+    DW_AT_name, DW_FORM_strp,
+    DW_AT_low_pc, DW_FORM_addr,
+    DW_AT_high_pc, DW_FORM_addr,
+    DW_AT_decl_file, DW_FORM_data1,
+    DW_AT_frame_base, DW_FORM_block1,
+    DW_AT_external, DW_FORM_flag_present,
+    0, 0
+  };
+  DWARFAbbreviationDeclaration Abbrev;
+  ASSERT_TRUE(extractAbbrev(Data, sizeof(Data), Abbrev));
+  EXPECT_EQ(6U, Abbrev.getNumAttributes());
+  // Offsets are known up to DW_AT_frame_base, but not past its block.
+  ASSERT_EQ(5U, Abbrev.getNumFixedOffsets());
+
+  const uint8_t *Sizes64 = DWARFFormValue::getFixedFormSizes(8, 2);
+  EXPECT_EQ(0U, Abbrev.getFixedOffset(0, Sizes64));
+  EXPECT_EQ(4U, Abbrev.getFixedOffset(1, Sizes64));
+  EXPECT_EQ(12U, Abbrev.getFixedOffset(2, Sizes64));
+  EXPECT_EQ(20U, Abbrev.getFixedOffset(3, Sizes64));
+  EXPECT_EQ(21U, Abbrev.getFixedOffset(4, Sizes64));
+
+  const uint8_t *Sizes32 = DWARFFormValue::getFixedFormSizes(4, 2);
+  EXPECT_EQ(13U, Abbrev.getFixedOffset(4, Sizes32));
+}
+
+TEST(DWARFAbbreviationDeclaration, FixedOffsetsCoverAllFixedForms) {
+  const char Data[] = {
+    2, DW_TAG_member, DW_CHILDREN_no,
+    DW_AT_name, DW_FORM_strp,
+    DW_AT_type, DW_FORM_ref4,
+    DW_AT_specification, DW_FORM_ref_addr,
+    DW_AT_artificial, DW_FORM_flag_present,
+    DW_AT_decl_line, DW_FORM_data2,
+    0, 0
+  };
+  DWARFAbbreviationDeclaration Abbrev;
+  ASSERT_TRUE(extractAbbrev(Data, sizeof(Data), Abbrev));
+  // One more than the number of attributes: the size of all of them.
+  ASSERT_EQ(6U, Abbrev.getNumFixedOffsets());
+
+  // DW_FORM_ref_addr is address sized in DWARF2 and 4 bytes in DWARF3.
+  EXPECT_EQ(18U, Abbrev.getFixedOffset(5,
+                                       DWARFFormValue::getFixedFormSizes(8, 2)));
+  EXPECT_EQ(14U, Abbrev.getFixedOffset(5,
+                                       DWARFFormValue::getFixedFormSizes(8, 3)));
+}
+
+TEST(DWARFAbbreviationDeclaration, NoAttributes) {
+  const char Data[] = { 3, DW_TAG_base_type, DW_CHILDREN_no, 0, 0 };
+  DWARFAbbreviationDeclaration Abbrev;
+  ASSERT_TRUE(extractAbbrev(Data, sizeof(Data), Abbrev));
+  ASSERT_EQ(1U, Abbrev.getNumFixedOffsets());
+  EXPECT_EQ(0U, Abbrev.getFixedOffset(0,
+                                      DWARFFormValue::getFixedFormSizes(8, 2)));
+}
+
+} // end anonymous namespace
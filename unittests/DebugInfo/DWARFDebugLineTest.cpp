@@ -0,0 +1,76 @@
+//===- llvm/unittest/DebugInfo/DWARFDebugLineTest.cpp ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../../lib/DebugInfo/DWARFDebugLine.h"
+#include "gtest/gtest.h"
+using namespace llvm;
+
+namespace {
+
+typedef DWARFDebugLine::LineTable LineTable;
+
+// Appends a sequence with a row at each of the given addresses; the last
+// address ends the sequence.
+void appendSequence(LineTable &Table, const uint64_t *Addresses, unsigned N,
+                    uint32_t FirstLine) {
+  DWARFDebugLine::Sequence Seq;
+  Seq.Empty = false;
+  Seq.LowPC = Addresses[0];
+  Seq.HighPC = Addresses[N - 1];
+  Seq.FirstRowIndex = Table.getNumRows();
+  for (unsigned i = 0; i != N; ++i) {
+    DWARFDebugLine::Row Row;
+    Row.Address = Addresses[i];
+    Row.Line = FirstLine + i;
+    Row.Column = i;
+    Row.File = 1 + i % 3;
+    Row.EndSequence = i + 1 == N;
+    Table.appendRow(Row);
+  }
+  Seq.LastRowIndex = Table.getNumRows();
+  Table.appendSequence(Seq);
+}
+
+class DWARFDebugLineTest : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    // Two sequences with a gap in between, including a repeated address.
+    const uint64_t Seq1[] = { 0x100, 0x104, 0x104, 0x110, 0x120 };
+    const uint64_t Seq2[] = { 0x200, 0x208, 0x230 };
+    appendSequence(Table, Seq1, 5, 10);
+    appendSequence(Table, Seq2, 3, 50);
+  }
+
+  LineTable Table;
+};
+
+TEST_F(DWARFDebugLineTest, RowsRoundTrip) {
+  ASSERT_EQ(8U, Table.getNumRows());
+  DWARFDebugLine::Row Row = Table.getRow(4);
+  EXPECT_EQ(0x120U, Row.Address);
+  EXPECT_EQ(14U, Row.Line);
+  EXPECT_EQ(4U, Row.Column);
+  EXPECT_EQ(2U, Row.File);
+  EXPECT_TRUE(Row.EndSequence);
+  EXPECT_FALSE(Table.getRow(3).EndSequence);
+}
+
+TEST_F(DWARFDebugLineTest, LookupAddress) {
+  EXPECT_EQ(UINT32_MAX, Table.lookupAddress(0xff));
+  EXPECT_EQ(0U, Table.lookupAddress(0x100));
+  EXPECT_EQ(0U, Table.lookupAddress(0x103));
+  EXPECT_EQ(1U, Table.lookupAddress(0x104));
+  EXPECT_EQ(3U, Table.lookupAddress(0x11f));
+  EXPECT_EQ(UINT32_MAX, Table.lookupAddress(0x120));
+  EXPECT_EQ(UINT32_MAX, Table.lookupAddress(0x1ff));
+  EXPECT_EQ(6U, Table.lookupAddress(0x22f));
+  EXPECT_EQ(UINT32_MAX, Table.lookupAddress(0x230));
+}
+
+} // end anonymous namespace
@@ -168,5 +168,89 @@ TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   }
 }
 
+TEST(MCJITMemoryManagerTest, FreeOwnerSections) {
+  OwningPtr<SectionMemoryManager> MemMgr(new SectionMemoryManager());
+  int OwnerA, OwnerB, OwnerC;
+
+  MemMgr->setSectionOwner(&OwnerA);
+  uint8_t *codeA = MemMgr->allocateCodeSection(256, 0, 1);
+  uint8_t *dataA = MemMgr->allocateDataSection(256, 0, 2, false);
+  MemMgr->setSectionOwner(&OwnerB);
+  uint8_t *codeB = MemMgr->allocateCodeSection(256, 0, 3);
+  uint8_t *dataB = MemMgr->allocateDataSection(256, 0, 4, false);
+
+  EXPECT_NE((uint8_t*)0, codeA);
+  EXPECT_NE((uint8_t*)0, dataA);
+  EXPECT_NE((uint8_t*)0, codeB);
+  EXPECT_NE((uint8_t*)0, dataB);
+
+  SectionMemoryManager::MemoryStats Stats = MemMgr->getMemoryStats();
+  EXPECT_EQ(4U, Stats.NumAllocatedBlocks);
+  EXPECT_EQ(1024U, Stats.SectionBytes);
+  EXPECT_EQ(0U, Stats.NumReleasedBlocks);
+
+  for (unsigned i = 0; i < 256; ++i)
+    codeB[i] = dataB[i] = 5;
+
+  // The blocks of the owner are kept for reuse, the others are untouched.
+  MemMgr->freeSections(&OwnerA);
+  Stats = MemMgr->getMemoryStats();
+  EXPECT_EQ(2U, Stats.NumAllocatedBlocks);
+  EXPECT_EQ(512U, Stats.SectionBytes);
+  EXPECT_EQ(2U, Stats.NumReleasedBlocks);
+  EXPECT_NE(0U, Stats.ReleasedBytes);
+  for (unsigned i = 0; i < 256; ++i) {
+    EXPECT_EQ(5, codeB[i]);
+    EXPECT_EQ(5, dataB[i]);
+  }
+
+  // A new owner gets the released memory back.
+  MemMgr->setSectionOwner(&OwnerC);
+  uint8_t *codeC = MemMgr->allocateCodeSection(256, 0, 5);
+  uint8_t *dataC = MemMgr->allocateDataSection(256, 0, 6, false);
+  EXPECT_EQ(codeA, codeC);
+  EXPECT_EQ(dataA, dataC);
+  for (unsigned i = 0; i < 256; ++i)
+    codeC[i] = dataC[i] = 6;
+
+  Stats = MemMgr->getMemoryStats();
+  EXPECT_EQ(4U, Stats.NumAllocatedBlocks);
+  EXPECT_EQ(0U, Stats.NumReleasedBlocks);
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr->applyPermissions(&Error));
+}
+
+TEST(MCJITMemoryManagerTest, SlabAllocations) {
+  OwningPtr<SectionMemoryManager> MemMgr(new SectionMemoryManager(1 << 20));
+
+  uint8_t *code1 = MemMgr->allocateCodeSection(256, 0, 1);
+  uint8_t *code2 = MemMgr->allocateCodeSection(256, 0, 2);
+  EXPECT_NE((uint8_t*)0, code1);
+  EXPECT_NE((uint8_t*)0, code2);
+  for (unsigned i = 0; i < 256; ++i)
+    code1[i] = code2[i] = 0xC3;
+
+  SectionMemoryManager::MemoryStats Stats = MemMgr->getMemoryStats();
+  EXPECT_EQ(1U, Stats.NumAllocatedBlocks);
+  EXPECT_LE(uint64_t(1 << 20), Stats.MappedBytes);
+
+  std::string Error;
+  EXPECT_FALSE(MemMgr->applyPermissions(&Error));
+
+  // The rest of the slab is still writable and is used for the next object.
+  uint8_t *code3 = MemMgr->allocateCodeSection(256, 0, 3);
+  EXPECT_NE((uint8_t*)0, code3);
+  for (unsigned i = 0; i < 256; ++i)
+    code3[i] = 0xC3;
+  Stats = MemMgr->getMemoryStats();
+  EXPECT_EQ(1U, Stats.NumAllocatedBlocks);
+  EXPECT_LT(code2, code3);
+  EXPECT_EQ(0xC3, code1[0]);
+
+  EXPECT_FALSE(MemMgr->applyPermissions(&Error));
+  EXPECT_EQ(0xC3, code3[255]);
+}
+
 } // Namespace
 
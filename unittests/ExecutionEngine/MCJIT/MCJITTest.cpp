@@ -14,6 +14,7 @@
 
 #include "llvm/ExecutionEngine/MCJIT.h"
 #include "MCJITTestBase.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -111,6 +112,80 @@ TEST_F(MCJITTest, return_global) {
     << "Invalid value for global returned from JITted function";
 }
 
+TEST_F(MCJITTest, remove_module) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  Module *First = M.get();
+  Function *Main = insertMainFunction(First, 6);
+  createJIT(M.take());
+  void *vPtr = TheJIT->getPointerToFunction(Main);
+  MM->applyPermissions();
+  static_cast<SectionMemoryManager*>(MM)->invalidateInstructionCache();
+  EXPECT_TRUE(0 != vPtr)
+    << "Unable to get pointer to main() from JIT";
+  EXPECT_EQ(6, ((int(*)(void))(intptr_t)vPtr)());
+
+  // Removing the module frees its sections.
+  EXPECT_TRUE(TheJIT->removeModule(First));
+  delete First;
+  SectionMemoryManager::MemoryStats Stats =
+    static_cast<SectionMemoryManager*>(MM)->getMemoryStats();
+  EXPECT_EQ(0U, Stats.NumAllocatedBlocks);
+  EXPECT_NE(0U, Stats.NumReleasedBlocks);
+
+  // The next module takes its place.
+  M.reset(createEmptyModule("<second module>"));
+  Main = insertMainFunction(M.get(), 7);
+  TheJIT->addModule(M.take());
+  vPtr = TheJIT->getPointerToFunction(Main);
+  MM->applyPermissions();
+  static_cast<SectionMemoryManager*>(MM)->invalidateInstructionCache();
+  EXPECT_TRUE(0 != vPtr)
+    << "Unable to get pointer to main() of the second module from JIT";
+  EXPECT_EQ(7, ((int(*)(void))(intptr_t)vPtr)());
+}
+
+class RelocationStatsListener : public JITEventListener {
+public:
+  RelocationStatsListener() : NumNotifications(0) {}
+
+  virtual void NotifyRelocationsResolved(const ObjectImage &Obj,
+                                   const RuntimeDyld::ResolveStats &S) {
+    ++NumNotifications;
+    Stats = S;
+  }
+
+  unsigned NumNotifications;
+  RuntimeDyld::ResolveStats Stats;
+};
+
+TEST_F(MCJITTest, relocation_stats) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  GlobalVariable *GV = insertGlobalInt32(M.get(), "myglob", 7);
+  Function *ReturnGlobal = startFunction<int32_t(void)>(M.get(),
+                                                        "ReturnGlobal");
+  Value *ReadGlobal = Builder.CreateLoad(GV);
+  endFunctionWithRet(ReturnGlobal, ReadGlobal);
+
+  RelocationStatsListener Listener;
+  createJIT(M.take());
+  TheJIT->RegisterJITEventListener(&Listener);
+  void *rgvPtr = TheJIT->getPointerToFunction(ReturnGlobal);
+  EXPECT_EQ(1U, Listener.NumNotifications);
+  EXPECT_NE(0U, Listener.Stats.NumRelocations);
+  EXPECT_LE(0.0, Listener.Stats.ApplyTime);
+
+  // Relocations are resolved again when the object is finalized.
+  TheJIT->finalizeObject();
+  EXPECT_EQ(2U, Listener.NumNotifications);
+  EXPECT_NE(0U, Listener.Stats.NumRelocations);
+  TheJIT->UnregisterJITEventListener(&Listener);
+
+  int32_t(*FuncPtr)(void) = (int32_t(*)(void))(intptr_t)rgvPtr;
+  EXPECT_EQ(7, FuncPtr());
+}
+
 // FIXME: This case fails due to a bug with getPointerToGlobal().
 // The bug is due to MCJIT not having an implementation of getPointerToGlobal()
 // which results in falling back on the ExecutionEngine implementation that
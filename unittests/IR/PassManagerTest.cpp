@@ -38,6 +38,7 @@ namespace llvm {
   void initializeCGPassPass(PassRegistry&);
   void initializeLPassPass(PassRegistry&);
   void initializeBPassPass(PassRegistry&);
+  void initializeModuleLazyPass(PassRegistry&);
 
   namespace {
     // ND = no deps
@@ -104,6 +105,38 @@ namespace llvm {
     char ModuleDNM::ID=0;
     char ModuleDNM::run=0;
 
+    // A pass that does not register itself; it is only registered by the
+    // lazy initializer added in the LazyInitializer test.
+    struct ModuleLazy : public ModulePass {
+    public:
+      static char run;
+      static char ID;
+      ModuleLazy() : ModulePass(ID) {}
+      virtual bool runOnModule(Module &M) {
+        run++;
+        return false;
+      }
+    };
+    char ModuleLazy::ID=0;
+    char ModuleLazy::run=0;
+
+    struct ModuleLazyUser : public ModulePass {
+    public:
+      static char run;
+      static char ID;
+      ModuleLazyUser() : ModulePass(ID) {}
+      virtual bool runOnModule(Module &M) {
+        run++;
+        return false;
+      }
+      virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+        AU.addRequired<ModuleLazy>();
+        AU.setPreservesAll();
+      }
+    };
+    char ModuleLazyUser::ID=0;
+    char ModuleLazyUser::run=0;
+
     template<typename P>
     struct PassTestBase : public P {
     protected:
@@ -310,6 +343,25 @@ namespace llvm {
       EXPECT_EQ(1, mNDM2->run);
     }
 
+    TEST(PassManager, LazyInitializer) {
+      Module M("test-lazy", getGlobalContext());
+      PassRegistry &Registry = *PassRegistry::getPassRegistry();
+      Registry.addLazyInitializer(initializeModuleLazyPass);
+      EXPECT_TRUE(Registry.getPassInfo(&ModuleLazy::ID) == 0);
+
+      ModuleLazy::run = ModuleLazyUser::run = 0;
+
+      // Scheduling a pass registers the deferred passes, so that the pass it
+      // requires can be created.
+      PassManager Passes;
+      Passes.add(new ModuleLazyUser());
+      EXPECT_TRUE(Registry.getPassInfo(&ModuleLazy::ID) != 0);
+
+      Passes.run(M);
+      EXPECT_EQ(1, ModuleLazy::run);
+      EXPECT_EQ(1, ModuleLazyUser::run);
+    }
+
     TEST(PassManager, ReRun) {
       Module M("test-rerun", getGlobalContext());
       struct ModuleNDNM *mNDNM = new ModuleNDNM();
@@ -550,3 +602,4 @@ INITIALIZE_PASS_BEGIN(LPass, "lp","lp", false, false)
 INITIALIZE_PASS_DEPENDENCY(LoopInfo)
 INITIALIZE_PASS_END(LPass, "lp","lp", false, false)
 INITIALIZE_PASS(BPass, "bp","bp", false, false)
+INITIALIZE_PASS(ModuleLazy, "mlazy", "mlazy", false, false)
@@ -15,8 +15,11 @@
 #include "llvm/IR/GlobalAlias.h"
 #include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/Instructions.h"
+#include "llvm/IR/Intrinsics.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
 #include "gtest/gtest.h"
 
 namespace llvm {
@@ -60,5 +63,53 @@ TEST(VerifierTest, AliasUnnamedAddr) {
   EXPECT_TRUE(verifyModule(M, ReturnStatusAction, &Error));
   EXPECT_TRUE(StringRef(Error).startswith("Alias cannot have unnamed_addr"));
 }
+
+static std::string verifyWithThreads(Module &M, unsigned Threads) {
+  StringMap<cl::Option*> Options;
+  cl::getRegisteredOptions(Options);
+  cl::opt<unsigned> *VerifierThreads =
+    static_cast<cl::opt<unsigned>*>(Options["verifier-threads"]);
+  unsigned OldThreads = *VerifierThreads;
+  *VerifierThreads = Threads;
+  std::string Error;
+  EXPECT_TRUE(verifyModule(M, ReturnStatusAction, &Error));
+  *VerifierThreads = OldThreads;
+  return Error;
+}
+
+TEST(VerifierTest, ParallelSharedMetadata) {
+  LLVMContext C;
+  Module M("M", C);
+  Type *I32 = Type::getInt32Ty(C);
+  Function *DbgValue = Intrinsic::getDeclaration(&M, Intrinsic::dbg_value);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(C), I32, false);
+
+  // Every function refers to a broken global node, and to a node local to
+  // the first function.  The serial verifier reports the broken node once
+  // and only checks the local node in the function it belongs to.
+  MDNode *Local = 0, *Broken = 0;
+  for (unsigned i = 0; i != 16; ++i) {
+    Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage, "f", &M);
+    if (!Local) {
+      Value *Arg = F->arg_begin();
+      Local = MDNode::get(C, Arg);
+      Value *LocalOp = Local;
+      Broken = MDNode::getWhenValsUnresolved(C, LocalOp, false);
+    }
+    BasicBlock *BB = BasicBlock::Create(C, "entry", F);
+    Value *Args[] = { Broken, ConstantInt::get(Type::getInt64Ty(C), 0), Local };
+    CallInst::Create(DbgValue, Args, "", BB);
+    ReturnInst::Create(C, BB);
+  }
+  M.getOrInsertNamedMetadata("nmd")->addOperand(Broken);
+
+  std::string Serial = verifyWithThreads(M, 1);
+  StringRef Message = "Global metadata operand cannot be function local!";
+  size_t First = Serial.find(Message);
+  EXPECT_NE(std::string::npos, First);
+  EXPECT_EQ(std::string::npos, Serial.find(Message, First + 1));
+  EXPECT_EQ(std::string::npos, Serial.find("wrong function"));
+  EXPECT_EQ(Serial, verifyWithThreads(M, 4));
+}
 }
 }
@@ -0,0 +1,161 @@
+//===- llvm/unittest/Object/ArchiveTest.cpp -------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/Archive.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+using namespace llvm;
+using namespace object;
+
+namespace {
+
+std::string makeHeader(StringRef Name, size_t Size) {
+  char Buf[sizeof(ArchiveMemberHeader) + 1];
+  sprintf(Buf, "%-16s%-12u%-6u%-6u%-8o%-10u`\n", Name.str().c_str(), 0u, 0u,
+          0u, 0644u, unsigned(Size));
+  return std::string(Buf, sizeof(ArchiveMemberHeader));
+}
+
+void appendBigEndian32(std::string &S, uint32_t V) {
+  S += char(V >> 24);
+  S += char(V >> 16);
+  S += char(V >> 8);
+  S += char(V);
+}
+
+// Builds a GNU archive with NumMembers members, each defining
+// SymbolsPerMember symbols named "m<member>_s<symbol>". Every member also
+// defines "common", so its first definition is in member 0.
+std::string makeArchive(unsigned NumMembers, unsigned SymbolsPerMember) {
+  std::vector<std::string> Members;
+  for (unsigned i = 0; i != NumMembers; ++i) {
+    std::string Name = "m" + utostr(i) + ".o/";
+    Members.push_back(makeHeader(Name, 2) + "xx");
+  }
+
+  std::string Names;
+  std::vector<unsigned> SymbolMembers;
+  for (unsigned i = 0; i != NumMembers; ++i) {
+    for (unsigned j = 0; j != SymbolsPerMember; ++j) {
+      Names += "m" + utostr(i) + "_s" + utostr(j);
+      Names += '\0';
+      SymbolMembers.push_back(i);
+    }
+    Names += "common";
+    Names += '\0';
+    SymbolMembers.push_back(i);
+  }
+
+  size_t SymTabSize = 4 + 4 * SymbolMembers.size() + Names.size();
+  size_t FirstMember = 8 + sizeof(ArchiveMemberHeader) + SymTabSize +
+                       (SymTabSize & 1);
+  std::vector<uint32_t> MemberOffsets;
+  for (unsigned i = 0; i != NumMembers; ++i)
+    MemberOffsets.push_back(FirstMember + i * Members[0].size());
+
+  std::string SymTab;
+  appendBigEndian32(SymTab, SymbolMembers.size());
+  for (unsigned i = 0, e = SymbolMembers.size(); i != e; ++i)
+    appendBigEndian32(SymTab, MemberOffsets[SymbolMembers[i]]);
+  SymTab += Names;
+  if (SymTab.size() & 1)
+    SymTab += '\n';
+
+  std::string Result = "!<arch>\n" + makeHeader("/", SymTabSize) + SymTab;
+  for (unsigned i = 0; i != NumMembers; ++i)
+    Result += Members[i];
+  return Result;
+}
+
+Archive *createArchive(StringRef Data) {
+  error_code ec;
+  Archive *A = new Archive(MemoryBuffer::getMemBuffer(Data, "", false), ec);
+  EXPECT_FALSE(ec);
+  return A;
+}
+
+std::string memberName(Archive::child_iterator I) {
+  StringRef Name;
+  if (I->getName(Name))
+    return "<error>";
+  return Name;
+}
+
+void checkLookups(const Archive &A) {
+  EXPECT_EQ("m0.o", memberName(A.findSym("m0_s0")));
+  EXPECT_EQ("m0.o", memberName(A.findSym("m0_s2")));
+  EXPECT_EQ("m3.o", memberName(A.findSym("m3_s1")));
+  EXPECT_EQ("m0.o", memberName(A.findSym("common")));
+  EXPECT_TRUE(A.findSym("m4_s0") == A.end_children());
+  EXPECT_TRUE(A.findSym("") == A.end_children());
+}
+
+TEST(ArchiveTest, FindSym) {
+  std::string Data = makeArchive(4, 3);
+  OwningPtr<Archive> A(createArchive(Data));
+  checkLookups(*A);
+  EXPECT_FALSE(A->hasSymbolIndex());
+}
+
+TEST(ArchiveTest, FindSymWithIndex) {
+  std::string Data = makeArchive(4, 3);
+  OwningPtr<Archive> A(createArchive(Data));
+  A->enableSymbolIndex();
+  EXPECT_FALSE(A->hasSymbolIndex());
+  checkLookups(*A);
+  EXPECT_TRUE(A->hasSymbolIndex());
+
+  // The index returns the same members as the scan.
+  OwningPtr<Archive> Linear(createArchive(Data));
+  for (Archive::child_iterator I = A->begin_children(),
+       E = A->end_children(); I != E; ++I) {
+    std::string Sym = memberName(I).substr(0, 2) + "_s1";
+    EXPECT_EQ(memberName(Linear->findSym(Sym)), memberName(A->findSym(Sym)));
+  }
+}
+
+// Compares scanning the symbol table against the hash index. This is a
+// microbenchmark, run it with --gtest_also_run_disabled_tests.
+TEST(ArchiveTest, DISABLED_FindSymBenchmark) {
+  const unsigned NumMembers = 2000, SymbolsPerMember = 10;
+  const unsigned NumLookups = 2000;
+  std::string Data = makeArchive(NumMembers, SymbolsPerMember);
+
+  std::vector<std::string> Names;
+  for (unsigned i = 0; i != NumLookups; ++i)
+    Names.push_back("m" + utostr((i * 7919) % NumMembers) + "_s" +
+                    utostr(i % SymbolsPerMember));
+
+  double Times[2];
+  for (unsigned Indexed = 0; Indexed != 2; ++Indexed) {
+    OwningPtr<Archive> A(createArchive(Data));
+    if (Indexed)
+      A->enableSymbolIndex();
+    TimeRecord Start = TimeRecord::getCurrentTime(true);
+    unsigned Found = 0;
+    for (unsigned i = 0; i != NumLookups; ++i)
+      Found += A->findSym(Names[i]) != A->end_children();
+    Times[Indexed] =
+        TimeRecord::getCurrentTime(false).getWallTime() - Start.getWallTime();
+    EXPECT_EQ(NumLookups, Found);
+  }
+
+  outs() << NumLookups << " lookups in " << NumMembers * (SymbolsPerMember + 1)
+         << " symbols: scan " << format("%.4f", Times[0]) << "s, index "
+         << format("%.4f", Times[1]) << "s\n";
+}
+
+} // end anonymous namespace
@@ -80,6 +80,39 @@ TEST(CommandLineTest, ModifyExisitingOption) {
   ASSERT_EQ(cl::Hidden, TestOption.getOptionHiddenFlag()) <<
     "Failed to modify option's hidden flag.";
 }
+
+unsigned LazyRegistrarRuns = 0;
+cl::opt<std::string> *LazyTestOption = 0;
+cl::opt<std::string> KnownTestOption("known-test-opt", cl::ZeroOrMore);
+
+void RegisterLazyTestOption() {
+  static cl::opt<std::string> Option("lazy-test-opt", cl::ZeroOrMore);
+  LazyTestOption = &Option;
+  ++LazyRegistrarRuns;
+}
+
+TEST(CommandLineTest, LazyOptionRegistrar) {
+  cl::AddLazyOptionRegistrar(RegisterLazyTestOption);
+
+  // Known options do not need the lazy options.
+  const char *KnownArgs[] = { "CommandLineTest", "-known-test-opt=known" };
+  cl::ParseCommandLineOptions(2, KnownArgs);
+  EXPECT_EQ("known", KnownTestOption);
+  EXPECT_EQ(0u, LazyRegistrarRuns);
+
+  const char *LazyArgs[] = { "CommandLineTest", "-lazy-test-opt=lazy" };
+  cl::ParseCommandLineOptions(2, LazyArgs);
+  EXPECT_EQ(1u, LazyRegistrarRuns);
+  ASSERT_TRUE(LazyTestOption != 0);
+  EXPECT_EQ("lazy", *LazyTestOption);
+
+  // Once registered, the option is found without running the registrar again.
+  const char *AgainArgs[] = { "CommandLineTest", "-lazy-test-opt=again" };
+  cl::ParseCommandLineOptions(2, AgainArgs);
+  EXPECT_EQ(1u, LazyRegistrarRuns);
+  EXPECT_EQ("again", *LazyTestOption);
+}
+
 #ifndef SKIP_ENVIRONMENT_TESTS
 
 const char test_env_var[] = "LLVM_TEST_COMMAND_LINE_FLAGS";
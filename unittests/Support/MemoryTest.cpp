@@ -339,6 +339,34 @@ TEST_P(MappedMemoryTest, UnalignedNear) {
   EXPECT_FALSE(Memory::releaseMappedMemory(M1));
 }
 
+TEST_P(MappedMemoryTest, HugeHint) {
+  // This test applies only to readable and writeable combinations
+  if (!((Flags & Memory::MF_READ) && (Flags & Memory::MF_WRITE)))
+    return;
+
+  error_code EC;
+  size_t Size = 4 * 1024 * 1024;
+  MemoryBlock M1 = Memory::allocateMappedMemory(Size, 0,
+                                                Flags | Memory::MF_HUGE_HINT,
+                                                EC);
+  EXPECT_EQ(error_code::success(), EC);
+
+  EXPECT_NE((void*)0, M1.base());
+  EXPECT_LE(Size, M1.size());
+
+  char *a = (char*)M1.base();
+  a[0] = 1;
+  a[Size - 1] = 2;
+  EXPECT_EQ(1, a[0]);
+  EXPECT_EQ(2, a[Size - 1]);
+
+  EXPECT_FALSE(Memory::protectMappedMemory(M1, Memory::MF_READ |
+                                                Memory::MF_HUGE_HINT));
+  EXPECT_EQ(2, a[Size - 1]);
+
+  EXPECT_FALSE(Memory::releaseMappedMemory(M1));
+}
+
 // Note that Memory::MF_WRITE is not supported exclusively across
 // operating systems and architectures and can imply MF_READ|MF_WRITE
 unsigned MemoryFlags[] = {
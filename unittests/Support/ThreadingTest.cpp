@@ -0,0 +1,39 @@
+//===- llvm/unittest/Support/ThreadingTest.cpp - Threading tests ----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/Threading.h"
+#include "llvm/ADT/STLExtras.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+void markItem(void *Data, unsigned Index) {
+  ++(*static_cast<std::vector<unsigned> *>(Data))[Index];
+}
+
+TEST(Threading, ParallelForVisitsEachItemOnce) {
+  const unsigned NumThreads[] = { 0, 1, 3, 8, 100 };
+  for (unsigned i = 0; i != array_lengthof(NumThreads); ++i) {
+    std::vector<unsigned> Visits(37);
+    llvm_parallel_for(Visits.size(), markItem, &Visits, NumThreads[i]);
+    for (unsigned j = 0, e = Visits.size(); j != e; ++j)
+      EXPECT_EQ(1U, Visits[j]);
+  }
+}
+
+TEST(Threading, ParallelForNoItems) {
+  std::vector<unsigned> Visits;
+  llvm_parallel_for(0, markItem, &Visits, 4);
+  EXPECT_TRUE(Visits.empty());
+}
+
+} // anonymous namespace
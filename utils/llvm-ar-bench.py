@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+
+"""
+Time building a bitcode archive with a symbol table.
+
+Generates a set of bitcode members with llvm-as and times 'llvm-ar rs' on
+them for each llvm-ar binary given, reporting the wall time and the peak
+resident set size of the archiver. Passing an llvm-ar from before and after
+a change compares the two writers on the same inputs.
+
+Usage:
+  llvm-ar-bench.py [options] <llvm-as> <llvm-ar> [<llvm-ar> ...]
+"""
+
+import optparse
+import os
+import resource
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+def write_member(path, index, num_functions):
+    f = open(path, 'w')
+    f.write('@g%d = global i32 %d\n' % (index, index))
+    f.write('declare i32 @ext(i32)\n')
+    for i in range(num_functions):
+        f.write('define i32 @f%d_%d(i32 %%x) {\n' % (index, i))
+        f.write('  %%a = add i32 %%x, %d\n' % i)
+        f.write('  %a1 = call i32 @ext(i32 %a)\n')
+        f.write('  %b = mul i32 %a1, %x\n')
+        f.write('  ret i32 %b\n')
+        f.write('}\n')
+    f.close()
+
+def make_members(llvm_as, dir, num_members, num_functions):
+    members = []
+    for i in range(num_members):
+        ll = os.path.join(dir, 'm%d.ll' % i)
+        bc = os.path.join(dir, 'm%d.bc' % i)
+        write_member(ll, i, num_functions)
+        subprocess.check_call([llvm_as, ll, '-o', bc])
+        os.remove(ll)
+        members.append('m%d.bc' % i)
+    return members
+
+def run_ar(llvm_ar, dir, members):
+    archive = os.path.join(dir, 'bench.a')
+    if os.path.exists(archive):
+        os.remove(archive)
+    start = time.time()
+    pid = os.fork()
+    if pid == 0:
+        try:
+            os.chdir(dir)
+            devnull = os.open(os.devnull, os.O_WRONLY)
+            os.dup2(devnull, 2)
+            os.execv(llvm_ar, [llvm_ar, 'rs', archive] + members)
+        finally:
+            os._exit(127)
+    _, status, usage = os.wait4(pid, 0)
+    elapsed = time.time() - start
+    if status != 0:
+        raise RuntimeError('%s failed' % llvm_ar)
+    return elapsed, usage.ru_maxrss
+
+def main():
+    parser = optparse.OptionParser(usage=__doc__.strip())
+    parser.add_option('-m', '--members', type='int', default=2000,
+                      help='number of bitcode members [%default]')
+    parser.add_option('-f', '--functions', type='int', default=20,
+                      help='functions per member [%default]')
+    parser.add_option('-r', '--runs', type='int', default=3,
+                      help='runs per llvm-ar, the best is reported '
+                           '[%default]')
+    opts, args = parser.parse_args()
+    if len(args) < 2:
+        parser.error('expected llvm-as and at least one llvm-ar')
+
+    dir = tempfile.mkdtemp(prefix='llvm-ar-bench')
+    try:
+        members = make_members(os.path.abspath(args[0]), dir, opts.members,
+                               opts.functions)
+        for llvm_ar in map(os.path.abspath, args[1:]):
+            best_time, best_rss = None, None
+            for i in range(opts.runs):
+                elapsed, rss = run_ar(llvm_ar, dir, members)
+                if best_time is None or elapsed < best_time:
+                    best_time = elapsed
+                if best_rss is None or rss < best_rss:
+                    best_rss = rss
+            print('%s: %.3fs, %d KB max RSS' % (llvm_ar, best_time, best_rss))
+    finally:
+        shutil.rmtree(dir)
+
+if __name__ == '__main__':
+    main()
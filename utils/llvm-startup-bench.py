@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+
+"""
+Time the startup of the LLVM tools.
+
+Runs opt, llc and llvm-mc many times on tiny inputs from each directory of
+binaries given and reports the wall time and the CPU time (user plus system)
+of one invocation. With inputs this small the time is almost all process
+startup: static constructors, command line option registration and parsing,
+and pass registration. Passing the bin directories of builds from before and
+after a change compares the two on the same commands; the directories take
+turns on each run so that they see the same machine load.
+
+Usage:
+  llvm-startup-bench.py [options] <bindir> [<bindir> ...]
+"""
+
+import optparse
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+TINY_LL = '''\
+define i32 @f(i32 %x) {
+  %a = add i32 %x, 1
+  ret i32 %a
+}
+'''
+
+TINY_S = '''\
+  .text
+  movl %eax, %ebx
+  ret
+'''
+
+# The commands timed for each bin directory, as (name, tool, arguments).
+# %ll and %s stand for the tiny inputs.
+COMMANDS = [
+    ('opt -version', 'opt', ['-version']),
+    ('opt -instcombine', 'opt', ['-instcombine', '%ll', '-o', os.devnull]),
+    ('llc -version', 'llc', ['-version']),
+    ('llc -O0', 'llc', ['-O0', '%ll', '-o', os.devnull]),
+    ('llvm-mc -version', 'llvm-mc', ['-version']),
+    ('llvm-mc -filetype=obj', 'llvm-mc',
+     ['-triple=x86_64-unknown-linux', '-filetype=obj', '%s', '-o',
+      os.devnull]),
+]
+
+def check(argv):
+    # -version exits with status 1, so look for diagnostics instead.
+    p = subprocess.Popen(argv, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    _, err = p.communicate()
+    if err:
+        raise RuntimeError('%s failed:\n%s' % (' '.join(argv), err))
+
+def run(argv, count):
+    devnull = open(os.devnull, 'w')
+    try:
+        start, start_times = time.time(), os.times()
+        for i in range(count):
+            subprocess.call(argv, stdout=devnull, stderr=devnull)
+        end, end_times = time.time(), os.times()
+    finally:
+        devnull.close()
+    cpu = (end_times[2] - start_times[2]) + (end_times[3] - start_times[3])
+    return (end - start) / count, cpu / count
+
+def main():
+    parser = optparse.OptionParser(usage=__doc__.strip())
+    parser.add_option('-n', '--count', type='int', default=200,
+                      help='invocations per command and run [%default]')
+    parser.add_option('-r', '--runs', type='int', default=3,
+                      help='runs per command, the best is reported '
+                           '[%default]')
+    opts, args = parser.parse_args()
+    if not args:
+        parser.error('expected at least one bin directory')
+
+    dir = tempfile.mkdtemp(prefix='llvm-startup-bench')
+    try:
+        inputs = {'%ll': os.path.join(dir, 'tiny.ll'),
+                  '%s': os.path.join(dir, 'tiny.s')}
+        open(inputs['%ll'], 'w').write(TINY_LL)
+        open(inputs['%s'], 'w').write(TINY_S)
+
+        bindirs = list(map(os.path.abspath, args))
+        print('%-24s %-s' % ('', '  '.join(['%17s' % ('[%d] wall    cpu' % i)
+                                            for i in range(len(bindirs))])))
+        for name, tool, tool_args in COMMANDS:
+            argvs = []
+            for bindir in bindirs:
+                argv = [os.path.join(bindir, tool)]
+                argv += [inputs.get(a, a) for a in tool_args]
+                check(argv)
+                argvs.append(argv)
+            best = [None] * len(argvs)
+            for i in range(opts.runs):
+                for j, argv in enumerate(argvs):
+                    wall, cpu = run(argv, opts.count)
+                    if best[j] is None:
+                        best[j] = (wall, cpu)
+                    else:
+                        best[j] = (min(best[j][0], wall), min(best[j][1], cpu))
+            print('%-24s %s' % (name, '  '.join(['%7.2f %7.2f ms' % (w * 1000,
+                                                                     c * 1000)
+                                                 for w, c in best])))
+            sys.stdout.flush()
+        for i, bindir in enumerate(bindirs):
+            print('[%d] %s' % (i, bindir))
+    finally:
+        shutil.rmtree(dir)
+
+if __name__ == '__main__':
+    main()